@@ -5,8 +5,11 @@
 /// loader uses the executable directory; no full path is passed.
 library;
 
+import 'dart:async';
 import 'dart:ffi';
 import 'dart:io';
+import 'dart:isolate';
+import 'dart:math' as math;
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
@@ -19,6 +22,19 @@ typedef IrisCutResult = ({
   int height,
 });
 
+/// Detected circles in the circling UI's view parameters (see [NativeIrisBridge.cutAndWarpIris]).
+/// Confidences are 0..1; a pupil guessed from the iris has confidence 0.
+typedef IrisViewCircles = ({
+  double outerR,
+  double innerR,
+  double outerDx,
+  double outerDy,
+  double innerDx,
+  double innerDy,
+  double irisConfidence,
+  double pupilConfidence,
+});
+
 // FFI types matching iris_engine_ffi.h
 typedef _ProcessIrisCutFromViewNative = Int32 Function(
   Pointer<Utf8> imagePath,
@@ -49,6 +65,92 @@ typedef _ProcessIrisCutFromViewDart = int Function(
   Pointer<Int32> outHeight,
 );
 
+/// Mirrors IrisCutOptions in iris_engine_ffi.h.
+final class _IrisCutOptions extends Struct {
+  @Int32()
+  external int numThreads;
+  @Int32()
+  external int interpolation;
+  @Int32()
+  external int preview;
+  @Float()
+  external double previewPixelRatio;
+}
+
+typedef _ProcessIrisCutFromViewExNative = Int32 Function(
+  Pointer<Utf8> imagePath,
+  Double viewW,
+  Double viewH,
+  Double outerR,
+  Double innerR,
+  Double outerDx,
+  Double outerDy,
+  Double innerDx,
+  Double innerDy,
+  Pointer<_IrisCutOptions> options,
+  Pointer<Pointer<Uint8>> outRgba,
+  Pointer<Int32> outWidth,
+  Pointer<Int32> outHeight,
+);
+typedef _ProcessIrisCutFromViewExDart = int Function(
+  Pointer<Utf8> imagePath,
+  double viewW,
+  double viewH,
+  double outerR,
+  double innerR,
+  double outerDx,
+  double outerDy,
+  double innerDx,
+  double innerDy,
+  Pointer<_IrisCutOptions> options,
+  Pointer<Pointer<Uint8>> outRgba,
+  Pointer<Int32> outWidth,
+  Pointer<Int32> outHeight,
+);
+
+typedef _JobsInitNative = Int32 Function(Pointer<Void> postCObject);
+typedef _JobsInitDart = int Function(Pointer<Void> postCObject);
+typedef _SubmitCutFromViewNative = Int64 Function(
+  Pointer<Utf8> imagePath,
+  Double viewW,
+  Double viewH,
+  Double outerR,
+  Double innerR,
+  Double outerDx,
+  Double outerDy,
+  Double innerDx,
+  Double innerDy,
+  Pointer<_IrisCutOptions> options,
+  Int64 replyPort,
+  Pointer<Utf8> group,
+);
+typedef _SubmitCutFromViewDart = int Function(
+  Pointer<Utf8> imagePath,
+  double viewW,
+  double viewH,
+  double outerR,
+  double innerR,
+  double outerDx,
+  double outerDy,
+  double innerDx,
+  double innerDy,
+  Pointer<_IrisCutOptions> options,
+  int replyPort,
+  Pointer<Utf8> group,
+);
+typedef _JobTakeResultNative = Int32 Function(
+  Int64 job,
+  Pointer<Pointer<Uint8>> outRgba,
+  Pointer<Int32> outWidth,
+  Pointer<Int32> outHeight,
+);
+typedef _JobTakeResultDart = int Function(
+  int job,
+  Pointer<Pointer<Uint8>> outRgba,
+  Pointer<Int32> outWidth,
+  Pointer<Int32> outHeight,
+);
+
 typedef _FreeNative = Void Function(Pointer<Void> ptr);
 typedef _FreeDart = void Function(Pointer<Void> ptr);
 typedef _HasOpenCvNative = Int32 Function();
@@ -56,6 +158,40 @@ typedef _HasOpenCvDart = int Function();
 typedef _InitNative = Int32 Function();
 typedef _InitDart = int Function();
 
+/// Matches IrisCircle in iris_engine_ffi.h (image pixels).
+final class _IrisCircle extends Struct {
+  @Float()
+  external double centerX;
+  @Float()
+  external double centerY;
+  @Float()
+  external double radius;
+  @Float()
+  external double confidence;
+  @Int32()
+  external int valid;
+}
+
+typedef _DetectCirclesFileNative = Int32 Function(
+  Pointer<Utf8> imagePath,
+  Pointer<_IrisCircle> outIris,
+  Pointer<_IrisCircle> outPupil,
+  Pointer<Int32> outW,
+  Pointer<Int32> outH,
+);
+typedef _DetectCirclesFileDart = int Function(
+  Pointer<Utf8> imagePath,
+  Pointer<_IrisCircle> outIris,
+  Pointer<_IrisCircle> outPupil,
+  Pointer<Int32> outW,
+  Pointer<Int32> outH,
+);
+
+// Job protocol constants (iris_engine_ffi.h).
+const int _jobMessageDone = 1; // IRIS_JOB_MSG_DONE
+const int _jobSucceeded = 3; // IRIS_JOB_SUCCEEDED
+const String _previewGroup = 'preview';
+
 DynamicLibrary? _loadEngine() {
   if (!Platform.isWindows) return null;
   return loadIrisEngine();
@@ -120,6 +256,80 @@ class NativeIrisBridge {
     }
   }
 
+  _ProcessIrisCutFromViewExDart? get _processFromViewEx {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_ProcessIrisCutFromViewExNative>>(
+              'iris_engine_process_iris_cut_from_view_ex')
+          .asFunction<_ProcessIrisCutFromViewExDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _JobsInitDart? get _jobsInit {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_JobsInitNative>>('iris_engine_jobs_init')
+          .asFunction<_JobsInitDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _SubmitCutFromViewDart? get _submitCutFromView {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_SubmitCutFromViewNative>>(
+              'iris_engine_submit_cut_from_view')
+          .asFunction<_SubmitCutFromViewDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _JobTakeResultDart? get _jobTakeResult {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_JobTakeResultNative>>('iris_engine_job_take_result')
+          .asFunction<_JobTakeResultDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  bool _jobsReady = false;
+
+  /// True when previews can render on an engine job thread; installs the message poster once.
+  bool get _canRunJobs {
+    if (_jobsReady) return true;
+    final init = _jobsInit;
+    if (init == null || _submitCutFromView == null || _jobTakeResult == null) return false;
+    _jobsReady = init(NativeApi.postCObject.cast()) != 0;
+    return _jobsReady;
+  }
+
+  _DetectCirclesFileDart? get _detectCirclesFile {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_DetectCirclesFileNative>>(
+              'iris_engine_detect_circles_file')
+          .asFunction<_DetectCirclesFileDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
   _FreeDart? get _free {
     _ensureInit();
     if (_lib == null) return null;
@@ -132,6 +342,27 @@ class NativeIrisBridge {
     }
   }
 
+  /// Address of iris_engine_free, used as the finalizer of adopted result buffers.
+  Pointer<NativeFinalizerFunction>? get _freeAddress {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!.lookup<NativeFunction<_FreeNative>>('iris_engine_free').cast();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  /// Hands an engine-allocated result to the Dart heap without copying: the view frees
+  /// the native buffer when it is garbage collected.
+  Uint8List _adoptEngineBuffer(Pointer<Uint8> ptr, int len, _FreeDart freeFn) {
+    final finalizer = _freeAddress;
+    if (finalizer != null) return ptr.asTypedList(len, finalizer: finalizer);
+    final copy = Uint8List.fromList(ptr.asTypedList(len));
+    freeFn(ptr.cast());
+    return copy;
+  }
+
   _HasOpenCvDart? get _hasOpenCv {
     _ensureInit();
     if (_lib == null) return null;
@@ -158,6 +389,179 @@ class NativeIrisBridge {
   /// True when the native engine was built with OpenCV support.
   bool get hasOpenCv => (_hasOpenCv?.call() ?? 0) != 0;
 
+  /// True when the DLL supports preview-resolution cuts ([previewCutAndWarpIris]).
+  bool get canPreview => _processFromViewEx != null;
+
+  /// Interactive cut-and-warp for circle dragging: same geometry as [cutAndWarpIris] but
+  /// rendered from the source mip level matching the view, so the result is roughly
+  /// view-sized. [pixelRatio] = device pixels per logical pixel. Commit with [cutAndWarpIris].
+  ///
+  /// When the engine supports jobs the render runs off the UI thread, and each call
+  /// supersedes the previous one: a preview overtaken by a newer drag position
+  /// completes with null instead of its stale image.
+  Future<IrisCutResult?> previewCutAndWarpIris({
+    required String imagePath,
+    required double viewW,
+    required double viewH,
+    required double outerR,
+    required double innerR,
+    required double outerDx,
+    required double outerDy,
+    required double innerDx,
+    required double innerDy,
+    double pixelRatio = 1.0,
+  }) {
+    if (_canRunJobs) {
+      return _previewJob(imagePath, viewW, viewH, outerR, innerR, outerDx, outerDy, innerDx,
+          innerDy, pixelRatio);
+    }
+    return Future.microtask(() {
+      final fn = _processFromViewEx;
+      final freeFn = _free;
+      if (fn == null || freeFn == null) return null;
+      return using((Arena arena) {
+        final pathPtr = imagePath.toNativeUtf8(allocator: arena);
+        final options = arena<_IrisCutOptions>();
+        options.ref
+          ..numThreads = 0
+          ..interpolation = 0
+          ..preview = 1
+          ..previewPixelRatio = pixelRatio;
+        final pOutRgba = arena.allocate(sizeOf<Pointer<Uint8>>()).cast<Pointer<Uint8>>();
+        final pOutW = arena.allocate(sizeOf<Int32>()).cast<Int32>();
+        final pOutH = arena.allocate(sizeOf<Int32>()).cast<Int32>();
+        final ok = fn(
+          pathPtr,
+          viewW,
+          viewH,
+          outerR,
+          innerR,
+          outerDx,
+          outerDy,
+          innerDx,
+          innerDy,
+          options,
+          pOutRgba,
+          pOutW,
+          pOutH,
+        );
+        if (ok != 1) return null;
+        final ptr = pOutRgba.value;
+        final w = pOutW.value;
+        final h = pOutH.value;
+        if (ptr == nullptr || w <= 0 || h <= 0) return null;
+        return (rgba: _adoptEngineBuffer(ptr, w * h * 4, freeFn), width: w, height: h);
+      });
+    });
+  }
+
+  Future<IrisCutResult?> _previewJob(
+    String imagePath,
+    double viewW,
+    double viewH,
+    double outerR,
+    double innerR,
+    double outerDx,
+    double outerDy,
+    double innerDx,
+    double innerDy,
+    double pixelRatio,
+  ) {
+    final submit = _submitCutFromView!;
+    final take = _jobTakeResult!;
+    final freeFn = _free;
+    if (freeFn == null) return Future.value(null);
+    final port = ReceivePort();
+    final job = using((Arena arena) {
+      final options = arena<_IrisCutOptions>();
+      options.ref
+        ..numThreads = 0
+        ..interpolation = 0
+        ..preview = 1
+        ..previewPixelRatio = pixelRatio;
+      return submit(
+        imagePath.toNativeUtf8(allocator: arena),
+        viewW,
+        viewH,
+        outerR,
+        innerR,
+        outerDx,
+        outerDy,
+        innerDx,
+        innerDy,
+        options,
+        port.sendPort.nativePort,
+        _previewGroup.toNativeUtf8(allocator: arena),
+      );
+    });
+    if (job == 0) {
+      port.close();
+      return Future.value(null);
+    }
+    final done = Completer<IrisCutResult?>();
+    port.listen((message) {
+      final m = message as List;
+      if (m[1] != _jobMessageDone) return;
+      port.close();
+      if (m[2] != _jobSucceeded) {
+        done.complete(null);
+        return;
+      }
+      done.complete(using((Arena arena) {
+        final pOutRgba = arena.allocate(sizeOf<Pointer<Uint8>>()).cast<Pointer<Uint8>>();
+        final pOutW = arena.allocate(sizeOf<Int32>()).cast<Int32>();
+        final pOutH = arena.allocate(sizeOf<Int32>()).cast<Int32>();
+        if (take(job, pOutRgba, pOutW, pOutH) != 1) return null;
+        final ptr = pOutRgba.value;
+        final w = pOutW.value;
+        final h = pOutH.value;
+        if (ptr == nullptr || w <= 0 || h <= 0) return null;
+        return (rgba: _adoptEngineBuffer(ptr, w * h * 4, freeFn), width: w, height: h);
+      }));
+    });
+    return done.future;
+  }
+
+  /// True when the DLL exports automatic iris/pupil detection ([detectCircles]).
+  bool get canDetectCircles => _detectCirclesFile != null;
+
+  /// Detects iris and pupil in [imagePath] and maps them into the circling view of size
+  /// [viewW] x [viewH] (image fitted and centered), the inverse of the cut's view mapping.
+  /// Returns null when the engine is unavailable or nothing was found.
+  Future<IrisViewCircles?> detectCircles({
+    required String imagePath,
+    required double viewW,
+    required double viewH,
+  }) {
+    return Future.microtask(() {
+      final fn = _detectCirclesFile;
+      if (fn == null || viewW <= 0 || viewH <= 0) return null;
+      return using((Arena arena) {
+        final pathPtr = imagePath.toNativeUtf8(allocator: arena);
+        final iris = arena<_IrisCircle>();
+        final pupil = arena<_IrisCircle>();
+        final pOutW = arena.allocate(sizeOf<Int32>()).cast<Int32>();
+        final pOutH = arena.allocate(sizeOf<Int32>()).cast<Int32>();
+        if (fn(pathPtr, iris, pupil, pOutW, pOutH) != 1) return null;
+        final w = pOutW.value.toDouble();
+        final h = pOutH.value.toDouble();
+        if (w <= 0 || h <= 0 || iris.ref.valid == 0 || pupil.ref.valid == 0) return null;
+        final scale = math.min(viewW / w, viewH / h);
+        final halfShortest = math.min(viewW, viewH) / 2;
+        return (
+          outerR: iris.ref.radius * scale / halfShortest,
+          innerR: pupil.ref.radius * scale / halfShortest,
+          outerDx: (iris.ref.centerX - w / 2) * scale / viewW,
+          outerDy: (iris.ref.centerY - h / 2) * scale / viewH,
+          innerDx: (pupil.ref.centerX - w / 2) * scale / viewW,
+          innerDy: (pupil.ref.centerY - h / 2) * scale / viewH,
+          irisConfidence: iris.ref.confidence,
+          pupilConfidence: pupil.ref.confidence,
+        );
+      });
+    });
+  }
+
   /// Runs the native cut-and-warp. View params match the circling UI (outer=iris, inner=pupil).
   /// Returns (rgba, width, height) or null if engine unavailable or native returns failure.
   Future<IrisCutResult?> cutAndWarpIris({
@@ -199,10 +603,7 @@ class NativeIrisBridge {
         final w = pOutW.value;
         final h = pOutH.value;
         if (ptr == nullptr || w <= 0 || h <= 0) return null;
-        final len = w * h * 4;
-        final list = ptr.cast<Uint8>().asTypedList(len).toList();
-        freeFn(ptr.cast());
-        return (rgba: Uint8List.fromList(list), width: w, height: h);
+        return (rgba: _adoptEngineBuffer(ptr, w * h * 4, freeFn), width: w, height: h);
       });
     });
   }
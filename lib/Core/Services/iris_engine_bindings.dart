@@ -6,8 +6,10 @@
 /// or if the DLL is missing, operations no-op or return null/false.
 library;
 
+import 'dart:async';
 import 'dart:ffi';
 import 'dart:io';
+import 'dart:isolate';
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
@@ -28,6 +30,12 @@ typedef _GrayscaleDart = int Function(
   int height,
 );
 
+typedef _SetDefaultThreadsNative = Void Function(Int32 numThreads);
+typedef _SetDefaultThreadsDart = void Function(int numThreads);
+
+typedef _SetThreadsNative = Int32 Function(Pointer<Void> handle, Int32 numThreads);
+typedef _SetThreadsDart = int Function(Pointer<Void> handle, int numThreads);
+
 typedef _CreateNative = Pointer<Void> Function();
 typedef _CreateDart = Pointer<Void> Function();
 
@@ -47,6 +55,33 @@ typedef _LoadRgbaDart = int Function(
   int height,
 );
 
+typedef _LoadFileNative = Int32 Function(Pointer<Void> handle, Pointer<Utf8> path);
+typedef _LoadFileDart = int Function(Pointer<Void> handle, Pointer<Utf8> path);
+
+typedef _SaveFileNative = Int32 Function(
+  Pointer<Void> handle,
+  Pointer<Utf8> path,
+  Int32 format,
+  Int32 quality,
+);
+typedef _SaveFileDart = int Function(
+  Pointer<Void> handle,
+  Pointer<Utf8> path,
+  int format,
+  int quality,
+);
+
+typedef _GetSizeNative = Int32 Function(
+  Pointer<Void> handle,
+  Pointer<Int32> outWidth,
+  Pointer<Int32> outHeight,
+);
+typedef _GetSizeDart = int Function(
+  Pointer<Void> handle,
+  Pointer<Int32> outWidth,
+  Pointer<Int32> outHeight,
+);
+
 typedef _GetRgbaNative = Int32 Function(
   Pointer<Void> handle,
   Pointer<Uint8> outRgba,
@@ -60,8 +95,34 @@ typedef _GetRgbaDart = int Function(
   int height,
 );
 
+/// Mirrors IrisBufferView in iris_engine_ffi.h.
+final class _IrisBufferView extends Struct {
+  external Pointer<Uint8> data;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+  @Int32()
+  external int stride;
+  external Pointer<Void> pin;
+}
+
+typedef _BorrowRgbaNative = Int32 Function(
+  Pointer<Void> handle,
+  Pointer<_IrisBufferView> outView,
+);
+typedef _BorrowRgbaDart = int Function(
+  Pointer<Void> handle,
+  Pointer<_IrisBufferView> outView,
+);
+
+typedef _ReleaseBufferNative = Void Function(Pointer<Void> pin);
+typedef _ReleaseBufferDart = void Function(Pointer<Void> pin);
+
 typedef _CutIrisNative = Int32 Function(Pointer<Void> handle);
 typedef _CutIrisDart = int Function(Pointer<Void> handle);
+typedef _CutIrisExNative = Int32 Function(Pointer<Void> handle, Float irisRadiusScale, Int32 antialias);
+typedef _CutIrisExDart = int Function(Pointer<Void> handle, double irisRadiusScale, int antialias);
 
 typedef _RemoveFlashNative = Int32 Function(
   Pointer<Void> handle,
@@ -74,6 +135,54 @@ typedef _RemoveFlashDart = int Function(
   int dilatePixels,
 );
 
+/// Mirrors IrisFlashOptions in iris_engine_ffi.h.
+final class _IrisFlashOptions extends Struct {
+  @Int32()
+  external int inpaintMethod;
+  @Float()
+  external double inpaintRadius;
+  @Float()
+  external double searchCx;
+  @Float()
+  external double searchCy;
+  @Float()
+  external double searchOuterR;
+  @Float()
+  external double searchInnerR;
+}
+
+typedef _CmdRemoveFlashExNative = Int32 Function(
+  Pointer<Void> cmd,
+  Float threshold,
+  Int32 dilatePixels,
+  Pointer<_IrisFlashOptions> options,
+);
+typedef _CmdRemoveFlashExDart = int Function(
+  Pointer<Void> cmd,
+  double threshold,
+  int dilatePixels,
+  Pointer<_IrisFlashOptions> options,
+);
+
+typedef _RemoveFlashInAnnulusNative = Int32 Function(
+  Pointer<Void> handle,
+  Float threshold,
+  Int32 dilatePixels,
+  Float cx,
+  Float cy,
+  Float outerR,
+  Float innerR,
+);
+typedef _RemoveFlashInAnnulusDart = int Function(
+  Pointer<Void> handle,
+  double threshold,
+  int dilatePixels,
+  double cx,
+  double cy,
+  double outerR,
+  double innerR,
+);
+
 typedef _ApplyEffectsNative = Int32 Function(
   Pointer<Void> handle,
   Float vibrance,
@@ -89,6 +198,504 @@ typedef _ApplyEffectsDart = int Function(
   double clarity,
 );
 
+/// Mirrors IrisColorPreset in iris_engine_ffi.h.
+final class _IrisColorPreset extends Struct {
+  @Float()
+  external double brightness;
+  @Float()
+  external double contrast;
+  @Float()
+  external double saturation;
+  @Float()
+  external double hueDeg;
+}
+
+typedef _DefinePresetLutNative = Int32 Function(
+  Pointer<Void> handle,
+  Pointer<Utf8> name,
+  Pointer<_IrisColorPreset> preset,
+  Int32 lutSize,
+);
+typedef _DefinePresetLutDart = int Function(
+  Pointer<Void> handle,
+  Pointer<Utf8> name,
+  Pointer<_IrisColorPreset> preset,
+  int lutSize,
+);
+typedef _LoadCubeLutNative = Int32 Function(Pointer<Void> handle, Pointer<Utf8> name, Pointer<Utf8> path);
+typedef _LoadCubeLutDart = int Function(Pointer<Void> handle, Pointer<Utf8> name, Pointer<Utf8> path);
+
+/// Mirrors IrisColorProfile in iris_engine_ffi.h.
+final class _IrisColorProfile extends Struct {
+  external Pointer<Utf8> cmykProfile;
+  external Pointer<Utf8> sourceProfile;
+  @Int32()
+  external int intent;
+  @Int32()
+  external int noBlackPointCompensation;
+  @Int32()
+  external int simulatePaper;
+}
+
+typedef _ColorManagementAvailableNative = Int32 Function();
+typedef _ColorManagementAvailableDart = int Function();
+typedef _DefineProofLutNative = Int32 Function(
+    Pointer<Void> handle, Pointer<Utf8> name, Pointer<_IrisColorProfile> profile);
+typedef _DefineProofLutDart = int Function(Pointer<Void> handle, Pointer<Utf8> name, Pointer<_IrisColorProfile> profile);
+
+typedef _CmdCreateNative = Pointer<Void> Function();
+typedef _CmdCreateDart = Pointer<Void> Function();
+typedef _CmdPathNative = Int32 Function(Pointer<Void> cmd, Pointer<Utf8> path);
+typedef _CmdPathDart = int Function(Pointer<Void> cmd, Pointer<Utf8> path);
+typedef _CmdCutAutoNative = Int32 Function(Pointer<Void> cmd, Float irisRadiusScale);
+typedef _CmdCutAutoDart = int Function(Pointer<Void> cmd, double irisRadiusScale);
+typedef _CmdCutFromViewNative = Int32 Function(
+  Pointer<Void> cmd,
+  Double viewW,
+  Double viewH,
+  Double outerR,
+  Double innerR,
+  Double outerDx,
+  Double outerDy,
+  Pointer<Void> options,
+);
+typedef _CmdCutFromViewDart = int Function(
+  Pointer<Void> cmd,
+  double viewW,
+  double viewH,
+  double outerR,
+  double innerR,
+  double outerDx,
+  double outerDy,
+  Pointer<Void> options,
+);
+typedef _CmdCropNative = Int32 Function(Pointer<Void> cmd, Int32 x, Int32 y, Int32 width, Int32 height);
+typedef _CmdCropDart = int Function(Pointer<Void> cmd, int x, int y, int width, int height);
+typedef _CmdExportNative = Int32 Function(Pointer<Void> cmd, Pointer<Utf8> path, Int32 format, Int32 quality);
+typedef _CmdExportDart = int Function(Pointer<Void> cmd, Pointer<Utf8> path, int format, int quality);
+/// Mirrors IrisPrintOptions in iris_engine_ffi.h.
+final class _IrisPrintOptions extends Struct {
+  @Int32()
+  external int format;
+  @Int32()
+  external int interpolation;
+  @Int32()
+  external int dropAlpha;
+  @Int32()
+  external int stripRows;
+  @Int32()
+  external int numThreads;
+  external _IrisColorProfile cmyk;
+}
+
+typedef _ExportPrintNative = Int32 Function(
+    Pointer<Void> target, Pointer<Utf8> path, Int32 dpi, Float widthCm, Pointer<_IrisPrintOptions> options);
+typedef _ExportPrintDart = int Function(
+    Pointer<Void> target, Pointer<Utf8> path, int dpi, double widthCm, Pointer<_IrisPrintOptions> options);
+/// Mirrors IrisSoloEffectParams in iris_engine_ffi.h.
+final class _IrisSoloEffectParams extends Struct {
+  @Int32()
+  external int effect;
+  @Uint32()
+  external int seed;
+  @Float()
+  external double extent;
+  @Float()
+  external double intensity;
+  @Float()
+  external double size;
+  @Int32()
+  external int count;
+  @Array(3)
+  external Array<Uint8> colorRgb;
+  @Uint8()
+  external int reserved;
+  @Int32()
+  external int maxSide;
+  @Int32()
+  external int numThreads;
+}
+
+typedef _CmdSoloEffectNative = Int32 Function(Pointer<Void> cmd, Pointer<_IrisSoloEffectParams> params);
+typedef _CmdSoloEffectDart = int Function(Pointer<Void> cmd, Pointer<_IrisSoloEffectParams> params);
+
+/// Mirrors IrisDuoEffectParams in iris_engine_ffi.h.
+final class _IrisDuoEffectParams extends Struct {
+  @Int32()
+  external int effect;
+  @Float()
+  external double angleDeg;
+  @Float()
+  external double softness;
+  @Float()
+  external double offset;
+  @Float()
+  external double extent;
+  @Int32()
+  external int maxSide;
+  @Int32()
+  external int numThreads;
+}
+
+typedef _CmdDuoEffectNative = Int32 Function(
+    Pointer<Void> cmd, Pointer<Utf8> secondPath, Pointer<_IrisDuoEffectParams> params);
+typedef _CmdDuoEffectDart = int Function(
+    Pointer<Void> cmd, Pointer<Utf8> secondPath, Pointer<_IrisDuoEffectParams> params);
+
+/// Mirrors IrisCircle in iris_engine_ffi.h (image pixels).
+final class _IrisCircle extends Struct {
+  @Float()
+  external double centerX;
+  @Float()
+  external double centerY;
+  @Float()
+  external double radius;
+  @Float()
+  external double confidence;
+  @Int32()
+  external int valid;
+}
+
+/// Mirrors IrisEditStack in iris_engine_ffi.h.
+final class _IrisEditStack extends Struct {
+  @Int32()
+  external int cut;
+  @Float()
+  external double irisRadiusScale;
+  @Int32()
+  external int antialias;
+  external _IrisCircle iris;
+  external _IrisCircle pupil;
+  @Int32()
+  external int flash;
+  @Float()
+  external double flashThreshold;
+  @Int32()
+  external int flashDilatePixels;
+  external _IrisFlashOptions flashOptions;
+  @Int32()
+  external int effects;
+  @Float()
+  external double vibrance;
+  @Float()
+  external double gamma;
+  @Float()
+  external double sharpness;
+  @Float()
+  external double clarity;
+}
+
+/// Native layer path array and spec for [IrisEngineBindings.compose] and
+/// [IrisCommandBuffer.compose], allocated in [arena].
+(Pointer<Pointer<Utf8>>, Pointer<_IrisCompositeSpec>) _compositeArgs(
+  Arena arena,
+  List<String> layerPaths,
+  int layout,
+  double widthCm,
+  double heightCm,
+  int dpi,
+  List<int> background,
+  int interpolation,
+) {
+  final paths = arena<Pointer<Utf8>>(layerPaths.length);
+  for (var i = 0; i < layerPaths.length; i++) {
+    paths[i] = layerPaths[i].toNativeUtf8(allocator: arena);
+  }
+  final spec = arena<_IrisCompositeSpec>();
+  spec.ref
+    ..layout = layout
+    ..widthCm = widthCm
+    ..heightCm = heightCm
+    ..dpi = dpi
+    ..interpolation = interpolation;
+  for (var i = 0; i < 4 && i < background.length; i++) {
+    spec.ref.backgroundRgba[i] = background[i];
+  }
+  return (paths, spec);
+}
+
+typedef _CmdComposeNative = Int32 Function(
+    Pointer<Void> cmd, Pointer<Pointer<Utf8>> layerPaths, Int32 count, Pointer<_IrisCompositeSpec> spec);
+typedef _CmdComposeDart = int Function(
+    Pointer<Void> cmd, Pointer<Pointer<Utf8>> layerPaths, int count, Pointer<_IrisCompositeSpec> spec);
+typedef _CmdEditRenderNative = Int32 Function(Pointer<Void> cmd, Pointer<_IrisEditStack> stack);
+typedef _CmdEditRenderDart = int Function(Pointer<Void> cmd, Pointer<_IrisEditStack> stack);
+typedef _EditSetBudgetNative = Void Function(Pointer<Void> handle, Int64 bytes);
+typedef _EditSetBudgetDart = void Function(Pointer<Void> handle, int bytes);
+
+/// Mirrors IrisCompositeSpec in iris_engine_ffi.h.
+final class _IrisCompositeSpec extends Struct {
+  @Int32()
+  external int layout;
+  @Float()
+  external double widthCm;
+  @Float()
+  external double heightCm;
+  @Int32()
+  external int dpi;
+  @Float()
+  external double gap;
+  @Float()
+  external double margin;
+  @Array(4)
+  external Array<Uint8> backgroundRgba;
+  @Int32()
+  external int interpolation;
+  @Int32()
+  external int numThreads;
+}
+
+typedef _ComposeNative = Int32 Function(
+    Pointer<Void> target, Pointer<Pointer<Utf8>> layerPaths, Int32 count, Pointer<_IrisCompositeSpec> spec);
+typedef _ComposeDart = int Function(
+    Pointer<Void> target, Pointer<Pointer<Utf8>> layerPaths, int count, Pointer<_IrisCompositeSpec> spec);
+typedef _CmdSubmitNative = Int32 Function(Pointer<Void> cmd, Pointer<Void> handle, Pointer<Int32> outFailedIndex);
+typedef _CmdSubmitDart = int Function(Pointer<Void> cmd, Pointer<Void> handle, Pointer<Int32> outFailedIndex);
+typedef _JobsInitNative = Int32 Function(Pointer<Void> postCObject);
+typedef _JobsInitDart = int Function(Pointer<Void> postCObject);
+typedef _SubmitJobNative = Int64 Function(Pointer<Void> cmd, Pointer<Void> handle, Int64 replyPort, Pointer<Utf8> group);
+typedef _SubmitJobDart = int Function(Pointer<Void> cmd, Pointer<Void> handle, int replyPort, Pointer<Utf8> group);
+typedef _CancelJobNative = Int32 Function(Int64 job);
+typedef _CancelJobDart = int Function(int job);
+
+/// Mirrors IrisBatchOptions in iris_engine_ffi.h.
+final class _IrisBatchOptions extends Struct {
+  @Int64()
+  external int memoryBudgetBytes;
+  @Int32()
+  external int maxConcurrent;
+  @Int32()
+  external int threadsPerImage;
+}
+
+/// Mirrors IrisBatchItemResult in iris_engine_ffi.h.
+final class _IrisBatchItemResult extends Struct {
+  @Int64()
+  external int estimatedBytes;
+  @Double()
+  external double waitMs;
+  @Double()
+  external double loadMs;
+  @Double()
+  external double processMs;
+  @Double()
+  external double exportMs;
+  @Double()
+  external double totalMs;
+  @Int32()
+  external int ok;
+  @Int32()
+  external int started;
+  @Int32()
+  external int failedIndex;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+}
+
+typedef _BatchAddNative = Int32 Function(Pointer<Void> batch, Pointer<Void> cmd);
+typedef _BatchAddDart = int Function(Pointer<Void> batch, Pointer<Void> cmd);
+typedef _BatchRunNative = Int32 Function(Pointer<Void> batch, Pointer<_IrisBatchOptions> options);
+typedef _BatchRunDart = int Function(Pointer<Void> batch, Pointer<_IrisBatchOptions> options);
+typedef _BatchSubmitNative = Int64 Function(
+    Pointer<Void> batch, Pointer<_IrisBatchOptions> options, Int64 replyPort, Pointer<Utf8> group);
+typedef _BatchSubmitDart = int Function(
+    Pointer<Void> batch, Pointer<_IrisBatchOptions> options, int replyPort, Pointer<Utf8> group);
+typedef _BatchGetResultNative = Int32 Function(Pointer<Void> batch, Int32 index, Pointer<_IrisBatchItemResult> out);
+typedef _BatchGetResultDart = int Function(Pointer<Void> batch, int index, Pointer<_IrisBatchItemResult> out);
+
+/// Mirrors IrisStageStats in iris_engine_ffi.h.
+final class _IrisStageStats extends Struct {
+  @Uint64()
+  external int calls;
+  @Uint64()
+  external int totalNs;
+  @Uint64()
+  external int maxNs;
+}
+
+/// Mirrors IrisEngineStats in iris_engine_ffi.h.
+final class _IrisEngineStats extends Struct {
+  @Array(IrisStage.count)
+  external Array<_IrisStageStats> stages;
+  @Uint64()
+  external int allocations;
+  @Uint64()
+  external int allocatedBytes;
+  @Uint64()
+  external int residentBytes;
+  @Uint64()
+  external int peakBytes;
+  @Uint64()
+  external int processWorkingSetBytes;
+  @Uint64()
+  external int processPeakWorkingSetBytes;
+}
+
+typedef _GetStatsNative = Int32 Function(Pointer<Void> handle, Pointer<_IrisEngineStats> out);
+typedef _GetStatsDart = int Function(Pointer<Void> handle, Pointer<_IrisEngineStats> out);
+typedef _TraceStartNative = Void Function(Int32 maxEvents);
+typedef _TraceStartDart = void Function(int maxEvents);
+typedef _TraceStopNative = Int32 Function(Pointer<Utf8> path);
+typedef _TraceStopDart = int Function(Pointer<Utf8> path);
+
+/// Encoded formats for [IrisEngineBindings.saveFile] (IRIS_FORMAT_* in iris_engine_ffi.h).
+abstract final class IrisImageFormat {
+  static const int auto = 0;
+  static const int png = 1;
+  static const int jpeg = 2;
+  static const int webp = 3;
+  static const int tiff = 4;
+  static const int bmp = 5;
+}
+
+/// Job states posted by the engine (IRIS_JOB_* in iris_engine_ffi.h).
+abstract final class IrisJobStatus {
+  static const int unknown = 0;
+  static const int pending = 1;
+  static const int running = 2;
+  static const int succeeded = 3;
+  static const int failed = 4;
+  static const int cancelled = 5;
+}
+
+/// Message kind of progress posts (IRIS_JOB_MSG_PROGRESS); the other kind is the final post.
+const int _jobMessageProgress = 0;
+
+/// Outcome of [IrisCommandBuffer.submitAsync]. [failedIndex] is -1 unless a command failed.
+typedef IrisJobResult = ({int status, int failedIndex});
+
+/// One image of an [IrisBatch] run. Times are wall-clock milliseconds; [waitMs] runs
+/// from the start of the batch until the image was admitted under the RAM budget.
+typedef IrisBatchItemReport = ({
+  bool ok,
+  bool started,
+  int failedIndex,
+  int width,
+  int height,
+  int estimatedBytes,
+  double waitMs,
+  double loadMs,
+  double processMs,
+  double exportMs,
+  double totalMs,
+});
+
+/// Timed engine stages, the indices of [IrisEngineStatsReport.stages] (IRIS_STAGE_*).
+abstract final class IrisStage {
+  static const int decode = 0;
+  static const int colorConvert = 1;
+  static const int hough = 2;
+  static const int inpaint = 3;
+  static const int clahe = 4;
+  static const int warp = 5;
+  static const int copyOut = 6;
+  static const int count = 7;
+}
+
+/// Calls and time of one [IrisStage].
+typedef IrisStageTime = ({int calls, double totalMs, double maxMs});
+
+/// Stage times and memory counters of a handle or of the process ([IrisEngineBindings.getStats]).
+typedef IrisEngineStatsReport = ({
+  List<IrisStageTime> stages,
+  int allocations,
+  int allocatedBytes,
+  int residentBytes,
+  int peakBytes,
+  int processWorkingSetBytes,
+  int processPeakWorkingSetBytes,
+});
+
+/// Flash inpainting backends (IRIS_INPAINT_* in iris_engine_ffi.h).
+abstract final class IrisInpaintMethod {
+  static const int telea = 0;
+  static const int navierStokes = 1;
+
+  /// Pyramid push-pull fill: linear time, smooth on large flash blooms.
+  static const int pushPull = 2;
+}
+
+/// Resampling filters (IRIS_INTERP_* in iris_engine_ffi.h).
+abstract final class IrisInterpolation {
+  static const int nearest = 1;
+  static const int bilinear = 2;
+  static const int bicubic = 3;
+  static const int lanczos3 = 4;
+}
+
+/// Art Studio solo effects (IRIS_SOLO_* in iris_engine_ffi.h).
+abstract final class IrisSoloEffect {
+  static const int pure = 0;
+  static const int halo = 1;
+  static const int dust = 2;
+  static const int sun = 3;
+  static const int explosion = 4;
+}
+
+/// Art Studio duo effects (IRIS_DUO_* in iris_engine_ffi.h).
+abstract final class IrisDuoEffect {
+  static const int fusion = 0;
+  static const int collision = 1;
+  static const int balance = 2;
+  static const int binary = 3;
+  static const int eclipse = 4;
+}
+
+/// Art Studio canvas layouts (IRIS_LAYOUT_* in iris_engine_ffi.h).
+abstract final class IrisLayout {
+  static const int square = 0;
+  static const int row = 1;
+  static const int column = 2;
+  static const int round = 3;
+  static const int rectangle = 4;
+}
+
+/// ICC rendering intents (IRIS_INTENT_* in iris_engine_ffi.h).
+abstract final class IrisRenderingIntent {
+  static const int perceptual = 0;
+  static const int relativeColorimetric = 1;
+  static const int saturation = 2;
+  static const int absoluteColorimetric = 3;
+}
+
+/// Fills [profile] (an IrisColorProfile inside [arena]'s allocation).
+void _fillColorProfile(
+  Arena arena,
+  _IrisColorProfile profile,
+  String cmykProfile, {
+  String? sourceProfile,
+  int intent = IrisRenderingIntent.perceptual,
+  bool blackPointCompensation = true,
+  bool simulatePaper = false,
+}) {
+  profile
+    ..cmykProfile = cmykProfile.toNativeUtf8(allocator: arena)
+    ..sourceProfile = sourceProfile == null ? nullptr : sourceProfile.toNativeUtf8(allocator: arena)
+    ..intent = intent
+    ..noBlackPointCompensation = blackPointCompensation ? 0 : 1
+    ..simulatePaper = simulatePaper ? 1 : 0;
+}
+
+/// Fills [options] for iris_engine_export_print / iris_engine_cmd_export_print.
+Pointer<_IrisPrintOptions> _printOptions(
+  Arena arena,
+  int format,
+  int interpolation,
+  bool keepAlpha,
+  String? cmykProfile,
+  int cmykIntent,
+) {
+  final options = arena<_IrisPrintOptions>();
+  options.ref
+    ..format = format
+    ..interpolation = interpolation
+    ..dropAlpha = keepAlpha ? 0 : 1;
+  if (cmykProfile != null) _fillColorProfile(arena, options.ref.cmyk, cmykProfile, intent: cmykIntent);
+  return options;
+}
+
 // -----------------------------------------------------------------------------
 // Lazy-loaded DLL and symbols
 // -----------------------------------------------------------------------------
@@ -133,6 +740,22 @@ class IrisEngineBindings {
         .asFunction<_GrayscaleDart>();
   }
 
+  _SetDefaultThreadsDart? get _setDefaultThreads {
+    _ensureInit();
+    if (_lib == null) return null;
+    return _lib!
+        .lookup<NativeFunction<_SetDefaultThreadsNative>>('iris_engine_set_default_threads')
+        .asFunction<_SetDefaultThreadsDart>();
+  }
+
+  _SetThreadsDart? get _setThreads {
+    _ensureInit();
+    if (_lib == null) return null;
+    return _lib!
+        .lookup<NativeFunction<_SetThreadsNative>>('iris_engine_set_threads')
+        .asFunction<_SetThreadsDart>();
+  }
+
   _CreateDart? get _create {
     _ensureInit();
     if (_lib == null) return null;
@@ -157,6 +780,626 @@ class IrisEngineBindings {
         .asFunction<_LoadRgbaDart>();
   }
 
+  _LoadFileDart? get _loadFile {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_LoadFileNative>>('iris_engine_load_file')
+          .asFunction<_LoadFileDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _SaveFileDart? get _saveFile {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_SaveFileNative>>('iris_engine_save_file')
+          .asFunction<_SaveFileDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _GetSizeDart? get _getSize {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_GetSizeNative>>('iris_engine_get_size')
+          .asFunction<_GetSizeDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _DefinePresetLutDart? get _definePresetLut {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_DefinePresetLutNative>>('iris_engine_define_preset_lut')
+          .asFunction<_DefinePresetLutDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _ColorManagementAvailableDart? get _colorManagementAvailable {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_ColorManagementAvailableNative>>('iris_engine_color_management_available')
+          .asFunction<_ColorManagementAvailableDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _DefineProofLutDart? get _defineProofLut {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_DefineProofLutNative>>('iris_engine_define_proof_lut')
+          .asFunction<_DefineProofLutDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _LoadCubeLutDart? get _loadCubeLut {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_LoadCubeLutNative>>('iris_engine_load_cube_lut')
+          .asFunction<_LoadCubeLutDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _LoadFileDart? get _applyLut {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_LoadFileNative>>('iris_engine_apply_lut')
+          .asFunction<_LoadFileDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _LoadFileDart? get _hasLut {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_LoadFileNative>>('iris_engine_has_lut')
+          .asFunction<_LoadFileDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _DestroyDart? get _clearLuts {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_DestroyNative>>('iris_engine_clear_luts')
+          .asFunction<_DestroyDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdCreateDart? get _cmdCreate {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdCreateNative>>('iris_engine_cmd_create')
+          .asFunction<_CmdCreateDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _DestroyDart? get _cmdDestroy {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_DestroyNative>>('iris_engine_cmd_destroy')
+          .asFunction<_DestroyDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdPathDart? get _cmdLoadFile {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdPathNative>>('iris_engine_cmd_load_file')
+          .asFunction<_CmdPathDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdCutAutoDart? get _cmdCutAuto {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdCutAutoNative>>('iris_engine_cmd_cut_auto')
+          .asFunction<_CmdCutAutoDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdCutFromViewDart? get _cmdCutFromView {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdCutFromViewNative>>('iris_engine_cmd_cut_from_view')
+          .asFunction<_CmdCutFromViewDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _RemoveFlashDart? get _cmdRemoveFlash {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_RemoveFlashNative>>('iris_engine_cmd_remove_flash')
+          .asFunction<_RemoveFlashDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdRemoveFlashExDart? get _cmdRemoveFlashEx {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdRemoveFlashExNative>>('iris_engine_cmd_remove_flash_ex')
+          .asFunction<_CmdRemoveFlashExDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _ApplyEffectsDart? get _cmdApplyEffects {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_ApplyEffectsNative>>('iris_engine_cmd_apply_effects')
+          .asFunction<_ApplyEffectsDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdSoloEffectDart? get _cmdSoloEffect {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdSoloEffectNative>>('iris_engine_cmd_solo_effect')
+          .asFunction<_CmdSoloEffectDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdDuoEffectDart? get _cmdDuoEffect {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdDuoEffectNative>>('iris_engine_cmd_duo_effect')
+          .asFunction<_CmdDuoEffectDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdComposeDart? get _cmdCompose {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!.lookup<NativeFunction<_CmdComposeNative>>('iris_engine_cmd_compose').asFunction<_CmdComposeDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdEditRenderDart? get _cmdEditRender {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdEditRenderNative>>('iris_engine_cmd_edit_render')
+          .asFunction<_CmdEditRenderDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _DestroyDart? get _editReset {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_DestroyNative>>('iris_engine_edit_reset')
+          .asFunction<_DestroyDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _EditSetBudgetDart? get _editSetBudget {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_EditSetBudgetNative>>('iris_engine_edit_set_budget')
+          .asFunction<_EditSetBudgetDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdPathDart? get _cmdApplyLut {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdPathNative>>('iris_engine_cmd_apply_lut')
+          .asFunction<_CmdPathDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdCropDart? get _cmdCrop {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdCropNative>>('iris_engine_cmd_crop')
+          .asFunction<_CmdCropDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdExportDart? get _cmdExport {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdExportNative>>('iris_engine_cmd_export')
+          .asFunction<_CmdExportDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _ExportPrintDart? get _cmdExportPrint {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_ExportPrintNative>>('iris_engine_cmd_export_print')
+          .asFunction<_ExportPrintDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _ExportPrintDart? get _exportPrint {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_ExportPrintNative>>('iris_engine_export_print')
+          .asFunction<_ExportPrintDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _ComposeDart? get _compose {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!.lookup<NativeFunction<_ComposeNative>>('iris_engine_compose').asFunction<_ComposeDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CmdSubmitDart? get _cmdSubmit {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdSubmitNative>>('iris_engine_cmd_submit')
+          .asFunction<_CmdSubmitDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _JobsInitDart? get _jobsInit {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_JobsInitNative>>('iris_engine_jobs_init')
+          .asFunction<_JobsInitDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _SubmitJobDart? get _submitJob {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_SubmitJobNative>>('iris_engine_submit')
+          .asFunction<_SubmitJobDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _CancelJobDart? get _cancelJob {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CancelJobNative>>('iris_engine_cancel')
+          .asFunction<_CancelJobDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  bool _jobsReady = false;
+
+  /// True when the DLL runs command buffers as background jobs ([IrisCommandBuffer.submitAsync]).
+  /// The first call hands the engine Dart's message poster.
+  bool get canRunJobs {
+    if (_jobsReady) return true;
+    final init = _jobsInit;
+    if (init == null || _submitJob == null) return false;
+    _jobsReady = init(NativeApi.postCObject.cast()) != 0;
+    return _jobsReady;
+  }
+
+  /// Requests cancellation of a queued or running job. False when it already finished.
+  bool cancelJob(int job) => (_cancelJob?.call(job) ?? 0) != 0;
+
+  _CmdCreateDart? get _batchCreate {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CmdCreateNative>>('iris_engine_batch_create')
+          .asFunction<_CmdCreateDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _DestroyDart? get _batchDestroy {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_DestroyNative>>('iris_engine_batch_destroy')
+          .asFunction<_DestroyDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _BatchAddDart? get _batchAdd {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_BatchAddNative>>('iris_engine_batch_add')
+          .asFunction<_BatchAddDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _BatchRunDart? get _batchRun {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_BatchRunNative>>('iris_engine_batch_run')
+          .asFunction<_BatchRunDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _BatchSubmitDart? get _batchSubmit {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_BatchSubmitNative>>('iris_engine_batch_submit')
+          .asFunction<_BatchSubmitDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _BatchGetResultDart? get _batchGetResult {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_BatchGetResultNative>>('iris_engine_batch_get_result')
+          .asFunction<_BatchGetResultDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _GetStatsDart? get _getStats {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_GetStatsNative>>('iris_engine_get_stats')
+          .asFunction<_GetStatsDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _DestroyDart? get _resetStats {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_DestroyNative>>('iris_engine_reset_stats')
+          .asFunction<_DestroyDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _TraceStartDart? get _traceStart {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_TraceStartNative>>('iris_engine_trace_start')
+          .asFunction<_TraceStartDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _TraceStopDart? get _traceStop {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_TraceStopNative>>('iris_engine_trace_stop')
+          .asFunction<_TraceStopDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  /// True when the DLL reports stage times and memory counters ([getStats]) and traces.
+  bool get canUseStats => _getStats != null && _traceStart != null && _traceStop != null;
+
+  /// Stage times and memory of [handle], or of the whole process when null. Null when unsupported.
+  IrisEngineStatsReport? getStats([Pointer<Void>? handle]) {
+    final fn = _getStats;
+    if (fn == null) return null;
+    return using((Arena a) {
+      final s = a<_IrisEngineStats>();
+      if (fn(handle ?? nullptr, s) == 0) return null;
+      final v = s.ref;
+      return (
+        stages: List<IrisStageTime>.generate(IrisStage.count, (i) {
+          final t = v.stages[i];
+          return (calls: t.calls, totalMs: t.totalNs / 1e6, maxMs: t.maxNs / 1e6);
+        }),
+        allocations: v.allocations,
+        allocatedBytes: v.allocatedBytes,
+        residentBytes: v.residentBytes,
+        peakBytes: v.peakBytes,
+        processWorkingSetBytes: v.processWorkingSetBytes,
+        processPeakWorkingSetBytes: v.processPeakWorkingSetBytes,
+      );
+    });
+  }
+
+  /// Zeroes the counters of [handle], or of the process when null.
+  void resetStats([Pointer<Void>? handle]) => _resetStats?.call(handle ?? nullptr);
+
+  /// Records every timed stage until [stopTrace]; [maxEvents] 0 = 1M.
+  void startTrace({int maxEvents = 0}) => _traceStart?.call(maxEvents);
+
+  /// Ends the trace and writes it to [path] as Chrome trace JSON (null discards it).
+  /// Returns true on success.
+  bool stopTrace(String? path) {
+    final fn = _traceStop;
+    if (fn == null) return false;
+    if (path == null) return fn(nullptr) != 0;
+    return using((Arena a) => fn(path.toNativeUtf8(allocator: a)) != 0);
+  }
+
+  /// True when the DLL runs many edits concurrently under a RAM budget ([createBatch]).
+  bool get canUseBatches => _batchCreate != null && _batchRun != null && canUseCommandBuffers;
+
+  /// New native batch, or null when unsupported. Call [IrisBatch.dispose].
+  IrisBatch? createBatch() {
+    final create = _batchCreate;
+    if (create == null) return null;
+    final batch = create();
+    if (batch == nullptr) return null;
+    return IrisBatch._(this, batch);
+  }
+
+  /// True when the DLL supports recorded command buffers ([createCommandBuffer]).
+  bool get canUseCommandBuffers => _cmdCreate != null;
+
+  /// True when command buffers can record Art Studio effects ([IrisCommandBuffer.soloEffect]).
+  bool get canUseArtEffects => canUseCommandBuffers && _cmdSoloEffect != null;
+
+  /// True when command buffers can record duo effects ([IrisCommandBuffer.duoEffect]).
+  bool get canUseDuoEffects => canUseCommandBuffers && _cmdDuoEffect != null;
+
+  /// True when handles keep a memoized edit stack ([IrisCommandBuffer.editRender]).
+  bool get canUseEditStack => canUseCommandBuffers && _cmdEditRender != null;
+
+  /// Drops the edit source and cached stages of [handle]; the next render starts from its pixels.
+  void editReset(Pointer<Void> handle) => _editReset?.call(handle);
+
+  /// Caps the cached stage outputs of [handle] at [bytes] (0 = 512 MB). The kept source is
+  /// held on top of the budget.
+  void editSetBudget(Pointer<Void> handle, int bytes) => _editSetBudget?.call(handle, bytes);
+
+  /// New native command buffer, or null when unsupported. Call [IrisCommandBuffer.dispose].
+  IrisCommandBuffer? createCommandBuffer() {
+    final create = _cmdCreate;
+    if (create == null) return null;
+    final cmd = create();
+    if (cmd == nullptr) return null;
+    return IrisCommandBuffer._(this, cmd);
+  }
+
   _GetRgbaDart? get _getRgba {
     _ensureInit();
     if (_lib == null) return null;
@@ -165,6 +1408,30 @@ class IrisEngineBindings {
         .asFunction<_GetRgbaDart>();
   }
 
+  _BorrowRgbaDart? get _borrowRgba {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_BorrowRgbaNative>>('iris_engine_borrow_rgba')
+          .asFunction<_BorrowRgbaDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
+  _ReleaseBufferDart? get _releaseBuffer {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_ReleaseBufferNative>>('iris_engine_release_buffer')
+          .asFunction<_ReleaseBufferDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
   _CutIrisDart? get _cutIris {
     _ensureInit();
     if (_lib == null) return null;
@@ -173,6 +1440,18 @@ class IrisEngineBindings {
         .asFunction<_CutIrisDart>();
   }
 
+  _CutIrisExDart? get _cutIrisEx {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_CutIrisExNative>>('iris_engine_cut_iris_ex')
+          .asFunction<_CutIrisExDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
   _RemoveFlashDart? get _removeFlash {
     _ensureInit();
     if (_lib == null) return null;
@@ -181,6 +1460,18 @@ class IrisEngineBindings {
         .asFunction<_RemoveFlashDart>();
   }
 
+  _RemoveFlashInAnnulusDart? get _removeFlashInAnnulus {
+    _ensureInit();
+    if (_lib == null) return null;
+    try {
+      return _lib!
+          .lookup<NativeFunction<_RemoveFlashInAnnulusNative>>('iris_engine_remove_flash_in_annulus')
+          .asFunction<_RemoveFlashInAnnulusDart>();
+    } catch (_) {
+      return null;
+    }
+  }
+
   _ApplyEffectsDart? get _applyEffects {
     _ensureInit();
     if (_lib == null) return null;
@@ -195,20 +1486,24 @@ class IrisEngineBindings {
     final fn = _grayscale;
     if (fn == null || rgba.length < width * height * 4) return false;
     return using((Arena arena) {
-      final p = arena.allocate(rgba.length).cast<Uint8>();
-      for (int i = 0; i < rgba.length; i++) {
-        p[i] = rgba[i];
-      }
+      final p = arena.allocate<Uint8>(rgba.length);
+      final native = p.asTypedList(rgba.length)..setAll(0, rgba);
       final r = fn(p, width, height);
-      if (r != 0) {
-        for (int i = 0; i < rgba.length; i++) {
-          rgba[i] = p[i];
-        }
-      }
+      if (r != 0) rgba.setAll(0, native);
       return r != 0;
     });
   }
 
+  /// Process-wide thread budget for engine kernels. [numThreads] <= 0 = all cores.
+  void setDefaultThreads(int numThreads) => _setDefaultThreads?.call(numThreads);
+
+  /// Thread budget for one handle's kernels. 0 = engine default. Returns true on success.
+  bool setThreads(Pointer<Void> handle, int numThreads) {
+    final fn = _setThreads;
+    if (fn == null) return false;
+    return fn(handle, numThreads) != 0;
+  }
+
   /// Optional: create an engine handle for future load_rgba / get_rgba / effects.
   Pointer<Void>? createHandle() => _create?.call();
 
@@ -221,24 +1516,226 @@ class IrisEngineBindings {
     final fn = _loadRgba;
     if (fn == null || rgba.length < width * height * 4) return false;
     return using((Arena arena) {
-      final p = arena.allocate(rgba.length).cast<Uint8>();
-      for (int i = 0; i < rgba.length; i++) p[i] = rgba[i];
+      final len = width * height * 4;
+      final p = arena.allocate<Uint8>(len);
+      p.asTypedList(len).setRange(0, len, rgba);
       return fn(handle, p, width, height) != 0;
     });
   }
 
+  /// True when the DLL can decode/encode files itself ([loadFile] / [saveFile]).
+  bool get canUseFiles => _loadFile != null && _saveFile != null;
+
+  /// Decode [path] natively into the handle (EXIF orientation applied). Returns true on success.
+  bool loadFile(Pointer<Void> handle, String path) {
+    final fn = _loadFile;
+    if (fn == null) return false;
+    return using((Arena arena) => fn(handle, path.toNativeUtf8(allocator: arena)) != 0);
+  }
+
+  /// Encode the handle's image to [path]. [format] = [IrisImageFormat] value (auto = from
+  /// extension); [quality] JPEG/WebP 1..100, PNG 0..9, -1 = default. Returns true on success.
+  bool saveFile(Pointer<Void> handle, String path, {int format = IrisImageFormat.auto, int quality = -1}) {
+    final fn = _saveFile;
+    if (fn == null) return false;
+    return using((Arena arena) => fn(handle, path.toNativeUtf8(allocator: arena), format, quality) != 0);
+  }
+
+  /// True when the DLL can write print files ([exportPrint]).
+  bool get canExportPrint => _exportPrint != null;
+
+  /// Writes the handle's image for printing at [dpi], as TIFF or PNG with the resolution
+  /// stored in the file. [widthCm] > 0 resamples to that printed width (aspect kept);
+  /// 0 keeps the pixel size. [format] = [IrisImageFormat.tiff] / [IrisImageFormat.png]
+  /// (auto = from extension). The engine streams the output in strips, so large prints
+  /// do not need the full output in memory. [cmykProfile] (needs [canUseColorManagement])
+  /// writes a CMYK TIFF through that printer profile instead. Returns true on success.
+  bool exportPrint(
+    Pointer<Void> handle,
+    String path, {
+    int dpi = 300,
+    double widthCm = 0,
+    int format = IrisImageFormat.auto,
+    int interpolation = IrisInterpolation.bicubic,
+    bool keepAlpha = true,
+    String? cmykProfile,
+    int cmykIntent = IrisRenderingIntent.perceptual,
+  }) {
+    final fn = _exportPrint;
+    if (fn == null) return false;
+    return using((Arena arena) =>
+        fn(handle, path.toNativeUtf8(allocator: arena), dpi, widthCm,
+            _printOptions(arena, format, interpolation, keepAlpha, cmykProfile, cmykIntent)) !=
+        0);
+  }
+
+  /// True when the DLL has the Art Studio compositor ([compose]).
+  bool get canCompose => _compose != null;
+
+  /// True when command buffers can record the compositor ([IrisCommandBuffer.compose]).
+  bool get canRecordCompose => canUseCommandBuffers && _cmdCompose != null;
+
+  /// Lays out 1–6 cut irises ([layerPaths], drawn in order) on a [widthCm] x [heightCm]
+  /// canvas at [dpi] and loads the result into [handle]. [heightCm] 0 = square; the
+  /// [IrisLayout.round] canvas is a disc of [widthCm]. [background] is RGBA (straight
+  /// alpha), transparent by default. Returns true on success.
+  bool compose(
+    Pointer<Void> handle,
+    List<String> layerPaths, {
+    int layout = IrisLayout.square,
+    required double widthCm,
+    double heightCm = 0,
+    int dpi = 300,
+    List<int> background = const [0, 0, 0, 0],
+    int interpolation = IrisInterpolation.bicubic,
+  }) {
+    final fn = _compose;
+    if (fn == null || layerPaths.isEmpty) return false;
+    return using((Arena arena) {
+      final (paths, spec) =
+          _compositeArgs(arena, layerPaths, layout, widthCm, heightCm, dpi, background, interpolation);
+      return fn(handle, paths, layerPaths.length, spec) != 0;
+    });
+  }
+
+  /// Current image size, or null when nothing is loaded.
+  ({int width, int height})? getSize(Pointer<Void> handle) {
+    final fn = _getSize;
+    if (fn == null) return null;
+    return using((Arena arena) {
+      final w = arena<Int32>();
+      final h = arena<Int32>();
+      if (fn(handle, w, h) == 0) return null;
+      return (width: w.value, height: h.value);
+    });
+  }
+
+  /// True when the DLL supports named 3D LUTs ([definePresetLut] / [loadCubeLut] / [applyLut]).
+  bool get canUseLuts => _definePresetLut != null && _applyLut != null;
+
+  /// Compiles a color preset (adjustColor-style multipliers, 1 = no change) into a 3D LUT
+  /// stored on the handle as [name]. [lutSize] 0 = 33, else 2..65. Returns true on success.
+  bool definePresetLut(
+    Pointer<Void> handle,
+    String name, {
+    double brightness = 1.0,
+    double contrast = 1.0,
+    double saturation = 1.0,
+    double hueDeg = 0.0,
+    int lutSize = 0,
+  }) {
+    final fn = _definePresetLut;
+    if (fn == null) return false;
+    return using((Arena arena) {
+      final p = arena<_IrisColorPreset>();
+      p.ref
+        ..brightness = brightness
+        ..contrast = contrast
+        ..saturation = saturation
+        ..hueDeg = hueDeg;
+      return fn(handle, name.toNativeUtf8(allocator: arena), p, lutSize) != 0;
+    });
+  }
+
+  /// Parses a .cube file (3D, DOMAIN 0..1) and stores it on the handle as [name].
+  bool loadCubeLut(Pointer<Void> handle, String name, String cubePath) {
+    final fn = _loadCubeLut;
+    if (fn == null) return false;
+    return using((Arena arena) =>
+        fn(handle, name.toNativeUtf8(allocator: arena), cubePath.toNativeUtf8(allocator: arena)) != 0);
+  }
+
+  /// Applies the LUT stored as [name] to the current image. Returns true on success.
+  bool applyLut(Pointer<Void> handle, String name) {
+    final fn = _applyLut;
+    if (fn == null) return false;
+    return using((Arena arena) => fn(handle, name.toNativeUtf8(allocator: arena)) != 0);
+  }
+
+  bool hasLut(Pointer<Void> handle, String name) {
+    final fn = _hasLut;
+    if (fn == null) return false;
+    return using((Arena arena) => fn(handle, name.toNativeUtf8(allocator: arena)) != 0);
+  }
+
+  void clearLuts(Pointer<Void> handle) => _clearLuts?.call(handle);
+
+  /// True when the DLL was built with LittleCMS ([defineProofLut], CMYK [exportPrint]).
+  bool get canUseColorManagement => (_colorManagementAvailable?.call() ?? 0) != 0 && _defineProofLut != null;
+
+  /// Stores a soft proof of printing through [cmykProfile] (an .icc/.icm path) as the LUT
+  /// [name]; [applyLut] / [IrisCommandBuffer.applyLut] then show it. The engine caches
+  /// the ICC transform and the proof, so proofing the same profile again is immediate.
+  /// [intent] = [IrisRenderingIntent] value. Returns true on success.
+  bool defineProofLut(
+    Pointer<Void> handle,
+    String name,
+    String cmykProfile, {
+    String? sourceProfile,
+    int intent = IrisRenderingIntent.perceptual,
+    bool blackPointCompensation = true,
+    bool simulatePaper = false,
+  }) {
+    final fn = _defineProofLut;
+    if (fn == null) return false;
+    return using((Arena arena) {
+      final profile = arena<_IrisColorProfile>();
+      _fillColorProfile(
+        arena,
+        profile.ref,
+        cmykProfile,
+        sourceProfile: sourceProfile,
+        intent: intent,
+        blackPointCompensation: blackPointCompensation,
+        simulatePaper: simulatePaper,
+      );
+      return fn(handle, name.toNativeUtf8(allocator: arena), profile) != 0;
+    });
+  }
+
   /// Write current image from the engine into [outRgba]. Returns true on success.
+  /// One copy straight from the engine's buffer when borrowing is available.
   bool getRgba(Pointer<Void> handle, Uint8List outRgba, int width, int height) {
+    final len = width * height * 4;
+    if (outRgba.length < len) return false;
+    final copied = withBorrowedRgba(handle, (view, w, h, stride) {
+      if (w != width || h != height) return false;
+      outRgba.setRange(0, len, view);
+      return true;
+    });
+    if (copied != null) return copied;
     final fn = _getRgba;
-    if (fn == null || outRgba.length < width * height * 4) return false;
+    if (fn == null) return false;
     return using((Arena arena) {
-      final p = arena.allocate(outRgba.length).cast<Uint8>();
+      final p = arena.allocate<Uint8>(len);
       if (fn(handle, p, width, height) == 0) return false;
-      for (int i = 0; i < outRgba.length; i++) outRgba[i] = p[i];
+      outRgba.setRange(0, len, p.asTypedList(len));
       return true;
     });
   }
 
+  /// Runs [body] on a read-only, zero-copy view of the handle's current RGBA (stride in
+  /// bytes). The view is only valid inside [body]; the pin is released afterwards.
+  /// Returns null if borrowing is unavailable or no image is loaded.
+  T? withBorrowedRgba<T>(
+    Pointer<Void> handle,
+    T Function(Uint8List view, int width, int height, int stride) body,
+  ) {
+    final borrow = _borrowRgba;
+    final release = _releaseBuffer;
+    if (borrow == null || release == null) return null;
+    return using((Arena arena) {
+      final v = arena<_IrisBufferView>();
+      if (borrow(handle, v) == 0) return null;
+      final ref = v.ref;
+      try {
+        return body(ref.data.asTypedList(ref.stride * ref.height), ref.width, ref.height, ref.stride);
+      } finally {
+        release(ref.pin);
+      }
+    });
+  }
+
   /// Phase 2: Detect + cut iris (alpha outside iris = 0). Returns true on success.
   bool cutIris(Pointer<Void> handle) {
     final fn = _cutIris;
@@ -246,6 +1743,15 @@ class IrisEngineBindings {
     return fn(handle) != 0;
   }
 
+  /// Re-cuttable iris cut: the circles are detected once per image and reused, and each
+  /// call replaces the previous cut ([irisRadiusScale] scales the iris circle).
+  /// [antialias] ramps alpha over one pixel at both edges. Returns true on success.
+  bool cutIrisEx(Pointer<Void> handle, {double irisRadiusScale = 1.0, bool antialias = false}) {
+    final fn = _cutIrisEx;
+    if (fn == null) return false;
+    return fn(handle, irisRadiusScale, antialias ? 1 : 0) != 0;
+  }
+
   /// Phase 3: Remove flash (threshold 0..1, dilate 2–3). Returns true on success.
   bool removeFlash(Pointer<Void> handle, {double threshold = 0.95, int dilatePixels = 3}) {
     final fn = _removeFlash;
@@ -253,6 +1759,22 @@ class IrisEngineBindings {
     return fn(handle, threshold, dilatePixels) != 0;
   }
 
+  /// Phase 3 limited to the iris annulus [innerR]..[outerR] around ([cx], [cy]) in image
+  /// pixels; highlights elsewhere (e.g. in the sclera) are left alone. Returns true on success.
+  bool removeFlashInAnnulus(
+    Pointer<Void> handle, {
+    required double cx,
+    required double cy,
+    required double outerR,
+    double innerR = 0.0,
+    double threshold = 0.95,
+    int dilatePixels = 3,
+  }) {
+    final fn = _removeFlashInAnnulus;
+    if (fn == null) return false;
+    return fn(handle, threshold, dilatePixels, cx, cy, outerR, innerR) != 0;
+  }
+
   /// Phase 4: Apply effects. gamma/vibrance ~1 = no change; sharpness/clarity 0..4.
   bool applyEffects(Pointer<Void> handle, {
     double vibrance = 1.0,
@@ -265,3 +1787,373 @@ class IrisEngineBindings {
     return fn(handle, vibrance, gamma, sharpness, clarity) != 0;
   }
 }
+
+/// A recorded edit (iris_engine_cmd_* in iris_engine_ffi.h). Record steps in order, then
+/// [submit] once; the whole edit runs natively with no per-step marshalling.
+class IrisCommandBuffer {
+  IrisCommandBuffer._(this._bindings, this._cmd);
+
+  final IrisEngineBindings _bindings;
+  Pointer<Void> _cmd;
+
+  bool _record(bool Function(Pointer<Void> cmd) fn) => _cmd != nullptr && fn(_cmd);
+
+  bool loadFile(String path) => _record((cmd) {
+        final fn = _bindings._cmdLoadFile;
+        return fn != null && using((Arena a) => fn(cmd, path.toNativeUtf8(allocator: a)) != 0);
+      });
+
+  bool cutAuto({double irisRadiusScale = 1.0}) => _record((cmd) {
+        final fn = _bindings._cmdCutAuto;
+        return fn != null && fn(cmd, irisRadiusScale) != 0;
+      });
+
+  bool cutFromView({
+    required double viewW,
+    required double viewH,
+    required double outerR,
+    required double innerR,
+    required double outerDx,
+    required double outerDy,
+  }) =>
+      _record((cmd) {
+        final fn = _bindings._cmdCutFromView;
+        return fn != null && fn(cmd, viewW, viewH, outerR, innerR, outerDx, outerDy, nullptr) != 0;
+      });
+
+  /// [inpaintMethod] = [IrisInpaintMethod] value; non-default methods need a DLL with
+  /// iris_engine_cmd_remove_flash_ex.
+  bool removeFlash({
+    double threshold = 0.95,
+    int dilatePixels = 3,
+    int inpaintMethod = IrisInpaintMethod.telea,
+  }) =>
+      _record((cmd) {
+        if (inpaintMethod == IrisInpaintMethod.telea) {
+          final fn = _bindings._cmdRemoveFlash;
+          return fn != null && fn(cmd, threshold, dilatePixels) != 0;
+        }
+        final fn = _bindings._cmdRemoveFlashEx;
+        if (fn == null) return false;
+        return using((Arena a) {
+          final options = a<_IrisFlashOptions>();
+          options.ref.inpaintMethod = inpaintMethod;
+          return fn(cmd, threshold, dilatePixels, options) != 0;
+        });
+      });
+
+  bool applyEffects({
+    double vibrance = 1.0,
+    double gamma = 1.0,
+    double sharpness = 0.0,
+    double clarity = 0.0,
+  }) =>
+      _record((cmd) {
+        final fn = _bindings._cmdApplyEffects;
+        return fn != null && fn(cmd, vibrance, gamma, sharpness, clarity) != 0;
+      });
+
+  /// Applies a LUT stored on the submitted handle ([IrisEngineBindings.definePresetLut]).
+  bool applyLut(String name) => _record((cmd) {
+        final fn = _bindings._cmdApplyLut;
+        return fn != null && using((Arena a) => fn(cmd, name.toNativeUtf8(allocator: a)) != 0);
+      });
+
+  /// Art Studio solo effect ([IrisSoloEffect]) around the cut iris. The image becomes a
+  /// square canvas of [extent] iris radii; [maxSide] > 0 renders a smaller preview.
+  /// 0 for [intensity], [size] or [extent] keeps the engine default.
+  bool soloEffect(
+    int effect, {
+    int seed = 1,
+    double intensity = 0,
+    double size = 0,
+    double extent = 0,
+    int count = 0,
+    int maxSide = 0,
+  }) =>
+      _record((cmd) {
+        final fn = _bindings._cmdSoloEffect;
+        if (fn == null) return false;
+        return using((Arena a) {
+          final params = a<_IrisSoloEffectParams>();
+          params.ref
+            ..effect = effect
+            ..seed = seed
+            ..intensity = intensity
+            ..size = size
+            ..extent = extent
+            ..count = count
+            ..maxSide = maxSide;
+          return fn(cmd, params) != 0;
+        });
+      });
+
+  /// Art Studio duo effect ([IrisDuoEffect]) joining the image with the cut iris in
+  /// [secondPath]. The image becomes a square canvas; [maxSide] > 0 renders a smaller
+  /// preview. 0 for [softness], [offset] or [extent] keeps the effect's default.
+  bool duoEffect(
+    String secondPath,
+    int effect, {
+    double angleDeg = 0,
+    double softness = 0,
+    double offset = 0,
+    double extent = 0,
+    int maxSide = 0,
+  }) =>
+      _record((cmd) {
+        final fn = _bindings._cmdDuoEffect;
+        if (fn == null) return false;
+        return using((Arena a) {
+          final params = a<_IrisDuoEffectParams>();
+          params.ref
+            ..effect = effect
+            ..angleDeg = angleDeg
+            ..softness = softness
+            ..offset = offset
+            ..extent = extent
+            ..maxSide = maxSide;
+          return fn(cmd, secondPath.toNativeUtf8(allocator: a), params) != 0;
+        });
+      });
+
+  /// Compositor step, as [IrisEngineBindings.compose]: the layout becomes the image, so it
+  /// takes the place of [loadFile] and runs inside the submit (or job) with the export.
+  bool compose(
+    List<String> layerPaths, {
+    int layout = IrisLayout.square,
+    required double widthCm,
+    double heightCm = 0,
+    int dpi = 300,
+    List<int> background = const [0, 0, 0, 0],
+    int interpolation = IrisInterpolation.bicubic,
+  }) =>
+      _record((cmd) {
+        final fn = _bindings._cmdCompose;
+        if (fn == null || layerPaths.isEmpty) return false;
+        return using((Arena a) {
+          final (paths, spec) =
+              _compositeArgs(a, layerPaths, layout, widthCm, heightCm, dpi, background, interpolation);
+          return fn(cmd, paths, layerPaths.length, spec) != 0;
+        });
+      });
+
+  /// Re-renders the handle's edit stack: cut → flash → effects over the source the first
+  /// render after a load kept. Only stages whose parameters (or upstream ones) changed
+  /// since the last render run; the rest come from the handle's cache.
+  bool editRender({
+    bool cut = false,
+    double irisRadiusScale = 1.0,
+    bool antialias = false,
+    bool flash = false,
+    double flashThreshold = 0.95,
+    int flashDilatePixels = 3,
+    int inpaintMethod = IrisInpaintMethod.telea,
+    bool effects = false,
+    double vibrance = 1.0,
+    double gamma = 1.0,
+    double sharpness = 0.0,
+    double clarity = 0.0,
+  }) =>
+      _record((cmd) {
+        final fn = _bindings._cmdEditRender;
+        if (fn == null) return false;
+        return using((Arena a) {
+          final stack = a<_IrisEditStack>();
+          stack.ref
+            ..cut = cut ? 1 : 0
+            ..irisRadiusScale = irisRadiusScale
+            ..antialias = antialias ? 1 : 0
+            ..flash = flash ? 1 : 0
+            ..flashThreshold = flashThreshold
+            ..flashDilatePixels = flashDilatePixels
+            ..effects = effects ? 1 : 0
+            ..vibrance = vibrance
+            ..gamma = gamma
+            ..sharpness = sharpness
+            ..clarity = clarity;
+          stack.ref.flashOptions.inpaintMethod = inpaintMethod;
+          return fn(cmd, stack) != 0;
+        });
+      });
+
+  bool crop(int x, int y, int width, int height) => _record((cmd) {
+        final fn = _bindings._cmdCrop;
+        return fn != null && fn(cmd, x, y, width, height) != 0;
+      });
+
+  bool exportFile(String path, {int format = IrisImageFormat.auto, int quality = -1}) => _record((cmd) {
+        final fn = _bindings._cmdExport;
+        return fn != null && using((Arena a) => fn(cmd, path.toNativeUtf8(allocator: a), format, quality) != 0);
+      });
+
+  /// Print export step, as [IrisEngineBindings.exportPrint].
+  bool exportPrint(
+    String path, {
+    int dpi = 300,
+    double widthCm = 0,
+    int format = IrisImageFormat.auto,
+    int interpolation = IrisInterpolation.bicubic,
+    bool keepAlpha = true,
+    String? cmykProfile,
+    int cmykIntent = IrisRenderingIntent.perceptual,
+  }) =>
+      _record((cmd) {
+        final fn = _bindings._cmdExportPrint;
+        return fn != null &&
+            using((Arena a) =>
+                fn(cmd, path.toNativeUtf8(allocator: a), dpi, widthCm,
+                    _printOptions(a, format, interpolation, keepAlpha, cmykProfile, cmykIntent)) !=
+                0);
+      });
+
+  /// Runs the recorded edit on [handle]. Returns -1 on success, else the index of the
+  /// failing command (steps before it stay applied).
+  int submit(Pointer<Void> handle) {
+    final fn = _bindings._cmdSubmit;
+    if (fn == null || _cmd == nullptr) return 0;
+    return using((Arena arena) {
+      final failed = arena<Int32>();
+      return fn(_cmd, handle, failed) != 0 ? -1 : failed.value;
+    });
+  }
+
+  /// Runs the recorded edit on [handle] on an engine job thread; the UI isolate does not
+  /// block. Submitting into a [group] cancels that group's older jobs, so only the newest
+  /// of a burst of previews renders. [onProgress] receives (steps done, total steps).
+  /// The buffer may be disposed as soon as this returns; [handle] must outlive the job.
+  Future<IrisJobResult> submitAsync(
+    Pointer<Void> handle, {
+    String? group,
+    void Function(int done, int total)? onProgress,
+  }) {
+    final fn = _bindings._submitJob;
+    if (fn == null || _cmd == nullptr || !_bindings.canRunJobs) {
+      return Future.value((status: IrisJobStatus.failed, failedIndex: 0));
+    }
+    final port = ReceivePort();
+    final done = Completer<IrisJobResult>();
+    final job = using((Arena a) =>
+        fn(_cmd, handle, port.sendPort.nativePort, group == null ? nullptr : group.toNativeUtf8(allocator: a)));
+    if (job == 0) {
+      port.close();
+      return Future.value((status: IrisJobStatus.failed, failedIndex: 0));
+    }
+    port.listen((message) {
+      final m = message as List;
+      if (m[1] == _jobMessageProgress) {
+        onProgress?.call(m[2] as int, m[3] as int);
+        return;
+      }
+      port.close();
+      done.complete((status: m[2] as int, failedIndex: m[3] as int));
+    });
+    return done.future;
+  }
+
+  void dispose() {
+    if (_cmd == nullptr) return;
+    _bindings._cmdDestroy?.call(_cmd);
+    _cmd = nullptr;
+  }
+}
+
+/// Recorded edits for several images, run concurrently by the engine. Images are admitted
+/// in order while their estimated footprint fits the RAM budget.
+class IrisBatch {
+  IrisBatch._(this._bindings, this._batch);
+
+  final IrisEngineBindings _bindings;
+  Pointer<Void> _batch;
+  int _count = 0;
+
+  int get length => _count;
+
+  /// Adds a copy of [cmd] (load → edits → export) as the next image. False on failure.
+  bool add(IrisCommandBuffer cmd) {
+    final fn = _bindings._batchAdd;
+    if (fn == null || _batch == nullptr || cmd._cmd == nullptr) return false;
+    if (fn(_batch, cmd._cmd) < 0) return false;
+    _count++;
+    return true;
+  }
+
+  /// Runs every image; off the UI thread when the engine supports jobs. [memoryBudgetBytes]
+  /// 0 = a quarter of physical memory; [maxConcurrent] and [threadsPerImage] 0 = engine
+  /// default. [onProgress] receives (images finished, total). True when all succeeded.
+  /// The batch must not be disposed before the future completes.
+  Future<bool> run({
+    int memoryBudgetBytes = 0,
+    int maxConcurrent = 0,
+    int threadsPerImage = 0,
+    String? group,
+    void Function(int done, int total)? onProgress,
+  }) {
+    if (_batch == nullptr) return Future.value(false);
+    // The engine copies the options before either call returns.
+    void fill(Pointer<_IrisBatchOptions> options) => options.ref
+      ..memoryBudgetBytes = memoryBudgetBytes
+      ..maxConcurrent = maxConcurrent
+      ..threadsPerImage = threadsPerImage;
+    final submit = _bindings._batchSubmit;
+    if (submit == null || !_bindings.canRunJobs) {
+      final ok = using((Arena a) {
+        final options = a<_IrisBatchOptions>();
+        fill(options);
+        return (_bindings._batchRun?.call(_batch, options) ?? 0) != 0;
+      });
+      return Future.value(ok);
+    }
+    final port = ReceivePort();
+    final job = using((Arena a) {
+      final options = a<_IrisBatchOptions>();
+      fill(options);
+      return submit(_batch, options, port.sendPort.nativePort,
+          group == null ? nullptr : group.toNativeUtf8(allocator: a));
+    });
+    if (job == 0) {
+      port.close();
+      return Future.value(false);
+    }
+    final done = Completer<bool>();
+    port.listen((message) {
+      final m = message as List;
+      if (m[1] == _jobMessageProgress) {
+        onProgress?.call(m[2] as int, m[3] as int);
+        return;
+      }
+      port.close();
+      done.complete(m[2] == IrisJobStatus.succeeded);
+    });
+    return done.future;
+  }
+
+  /// Outcome of image [index] from the last finished [run], or null.
+  IrisBatchItemReport? result(int index) {
+    final fn = _bindings._batchGetResult;
+    if (fn == null || _batch == nullptr) return null;
+    return using((Arena a) {
+      final r = a<_IrisBatchItemResult>();
+      if (fn(_batch, index, r) == 0) return null;
+      final v = r.ref;
+      return (
+        ok: v.ok != 0,
+        started: v.started != 0,
+        failedIndex: v.failedIndex,
+        width: v.width,
+        height: v.height,
+        estimatedBytes: v.estimatedBytes,
+        waitMs: v.waitMs,
+        loadMs: v.loadMs,
+        processMs: v.processMs,
+        exportMs: v.exportMs,
+        totalMs: v.totalMs,
+      );
+    });
+  }
+
+  void dispose() {
+    if (_batch == nullptr) return;
+    _bindings._batchDestroy?.call(_batch);
+    _batch = nullptr;
+  }
+}
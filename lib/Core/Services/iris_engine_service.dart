@@ -1,21 +1,52 @@
+import 'dart:ffi';
 import 'dart:io';
-import 'dart:typed_data';
 
-import 'package:image/image.dart' as img;
 import 'package:path_provider/path_provider.dart';
 
 import 'package:iris_designer/Core/Native/native_iris_bridge.dart';
 
 import 'iris_engine_bindings.dart';
 
+/// One image of [IrisEngineService.processBatch]: its source and its recorded edit steps.
+typedef IrisBatchEdit = ({String inputPath, bool Function(IrisCommandBuffer cmd) record});
+
+/// Per-image result of [IrisEngineService.processBatch].
+typedef IrisBatchOutcome = ({String? outputPath, IrisBatchItemReport? report});
+
+/// Handle kept across edits of one source so its edit stack (and cached stages) survive.
+class _EditSession {
+  _EditSession(this.sourcePath, this.handle);
+
+  final String sourcePath;
+  final Pointer<Void> handle;
+  bool loaded = false;
+  bool closed = false;
+  int running = 0;
+}
+
 /// High-level service: file in → Iris Engine → file out.
-/// Runs on main isolate (FFI must run on main). Use from editor: try engine first, then Dart/Photopea.
+/// Called on the main isolate (FFI must run on main); long edits run on engine job threads.
+/// Use from editor: try engine first, then Dart/Photopea.
 class IrisEngineService {
   static final _bindings = IrisEngineBindings.instance;
   static final _nativeBridge = NativeIrisBridge.instance;
 
   static bool get isAvailable => _bindings.isAvailable;
 
+  static IrisEngineStatsReport? _lastEditStats;
+
+  /// Stage times and memory of the most recent [_runEdit] handle, or null.
+  static IrisEngineStatsReport? get lastEditStats => _lastEditStats;
+
+  /// Stage times and memory of every edit in this process, or null when unsupported.
+  static IrisEngineStatsReport? processStats() => _bindings.getStats();
+
+  /// Records engine stages on every thread until [stopTrace].
+  static void startTrace() => _bindings.startTrace();
+
+  /// Writes the trace since [startTrace] to [outPath] (open in chrome://tracing or Perfetto).
+  static bool stopTrace(String outPath) => _bindings.stopTrace(outPath);
+
   /// True when Phase 1 cut-and-warp (user circles, radial stretch) is available.
   static bool get isCutAndWarpAvailable =>
       _nativeBridge.isAvailable && _nativeBridge.canCutAndWarp;
@@ -23,39 +54,173 @@ class IrisEngineService {
   /// True when the native engine was built with OpenCV support.
   static bool get isOpenCvAvailable => _nativeBridge.hasOpenCv;
 
-  static Uint8List? _imageToRgba(img.Image src) {
-    final w = src.width;
-    final h = src.height;
-    if (w <= 0 || h <= 0) return null;
-    final out = Uint8List(w * h * 4);
-    for (int y = 0; y < h; y++) {
-      for (int x = 0; x < w; x++) {
-        final p = src.getPixel(x, y);
-        final i = (y * w + x) * 4;
-        out[i] = p.r.toInt().clamp(0, 255);
-        out[i + 1] = p.g.toInt().clamp(0, 255);
-        out[i + 2] = p.b.toInt().clamp(0, 255);
-        out[i + 3] = p.a.toInt().clamp(0, 255);
+  /// True when the engine can place the circles automatically ([detectCirclesForView]).
+  static bool get isCircleDetectionAvailable =>
+      _nativeBridge.isAvailable && _nativeBridge.canDetectCircles;
+
+  /// Detects iris and pupil in [inputPath], returned as circling view params for a view
+  /// of [viewW] x [viewH]. Null when unavailable or no circle was found.
+  static Future<IrisViewCircles?> detectCirclesForView(
+    String inputPath, {
+    required double viewW,
+    required double viewH,
+  }) {
+    return _nativeBridge.detectCircles(imagePath: inputPath, viewW: viewW, viewH: viewH);
+  }
+
+  static Future<String> _tempPngPath() async {
+    final tempDir = await getTemporaryDirectory();
+    return '${tempDir.path}/edited_${DateTime.now().millisecondsSinceEpoch}.png';
+  }
+
+  /// Newest preview PNG per preview group; each new one deletes the one it replaces, so
+  /// scrubbing a slider keeps a single preview file on disk.
+  static final Map<String, String> _previewFiles = {};
+
+  static Future<String?> _keepLatestPreview(String group, Future<String?> render) async {
+    final path = await render;
+    if (path == null) return null;
+    final previous = _previewFiles[group];
+    _previewFiles[group] = path;
+    if (previous != null && previous != path) {
+      try {
+        await File(previous).delete();
+      } on FileSystemException {
+        // Already gone.
       }
     }
-    return out;
+    return path;
   }
 
-  static img.Image? _rgbaToImage(Uint8List rgba, int w, int h) {
-    if (rgba.length < w * h * 4) return null;
-    final out = img.Image(width: w, height: h, numChannels: 4);
-    for (int y = 0; y < h; y++) {
-      for (int x = 0; x < w; x++) {
-        final i = (y * w + x) * 4;
-        out.setPixel(x, y, img.ColorRgba8(rgba[i], rgba[i + 1], rgba[i + 2], rgba[i + 3]));
+  /// Records load → [record] → PNG export into one command buffer and submits it, so
+  /// the whole edit runs natively in a single call (as a background job when supported). [prepare] runs on the fresh handle
+  /// before submit (e.g. to define LUTs the commands refer to). A job in [group] cancels
+  /// that group's older jobs. Returns the output path, or null on failure and when a newer
+  /// call in the same [group] superseded this one (its result is the one to show).
+  static Future<String?> _runEdit(
+    String inputPath,
+    bool Function(IrisCommandBuffer cmd) record, {
+    bool Function(Pointer<Void> handle)? prepare,
+    String? group,
+  }) async {
+    if (!_bindings.isAvailable || !_bindings.canUseCommandBuffers) return null;
+    final outPath = await _tempPngPath();
+    final cmd = _bindings.createCommandBuffer();
+    if (cmd == null) return null;
+    final handle = _bindings.createHandle();
+    try {
+      if (handle == null) return null;
+      if (prepare != null && !prepare(handle)) return null;
+      if (!cmd.loadFile(inputPath) ||
+          !record(cmd) ||
+          !cmd.exportFile(outPath, format: IrisImageFormat.png)) {
+        return null;
+      }
+      if (_bindings.canRunJobs) {
+        // Off the UI thread; the handle is destroyed only once the job has finished.
+        final result = await cmd.submitAsync(handle, group: group);
+        return result.status == IrisJobStatus.succeeded ? outPath : null;
       }
+      return cmd.submit(handle) < 0 ? outPath : null;
+    } finally {
+      if (handle != null) _lastEditStats = _bindings.getStats(handle);
+      _bindings.destroyHandle(handle);
+      cmd.dispose();
     }
-    return out;
   }
 
-  /// Phase 1: User-defined circles + 50% pupil shrink (radial warp). View params from circling UI.
-  /// Returns output path or null. Prefer this when [isCutAndWarpAvailable] and view size is known.
-  static Future<String?> processCirclingWithViewParams(
+  /// Writes [inputPath] to [outPath] as a print file (TIFF or PNG, from the extension) at
+  /// [dpi], resampled to [widthCm] printed width (0 = keep the pixel size). The engine
+  /// streams the output, so 600 dpi posters do not need the full raster in memory.
+  /// [cmykProfile] (a printer .icc path) writes a CMYK TIFF instead; it needs
+  /// [isColorManagementAvailable]. Returns [outPath], or null on failure.
+  static Future<String?> exportForPrint(
+    String inputPath,
+    String outPath, {
+    int dpi = 300,
+    double widthCm = 0,
+    String? cmykProfile,
+  }) async {
+    if (!_bindings.isAvailable || !_bindings.canUseCommandBuffers || !_bindings.canExportPrint) return null;
+    if (cmykProfile != null && !isColorManagementAvailable) return null;
+    final cmd = _bindings.createCommandBuffer();
+    if (cmd == null) return null;
+    final handle = _bindings.createHandle();
+    try {
+      if (handle == null) return null;
+      if (!cmd.loadFile(inputPath) ||
+          !cmd.exportPrint(outPath, dpi: dpi, widthCm: widthCm, cmykProfile: cmykProfile)) {
+        return null;
+      }
+      if (_bindings.canRunJobs) {
+        final result = await cmd.submitAsync(handle);
+        return result.status == IrisJobStatus.succeeded ? outPath : null;
+      }
+      return cmd.submit(handle) < 0 ? outPath : null;
+    } finally {
+      _bindings.destroyHandle(handle);
+      cmd.dispose();
+    }
+  }
+
+  /// True when several images can be edited in one native batch ([processBatch]).
+  static bool get isBatchAvailable => _bindings.isAvailable && _bindings.canUseBatches;
+
+  /// Edits every image of [edits] in one native batch. Each entry's recorder adds that
+  /// image's own steps (circles, flash, effects), as the single-image methods do. Images run
+  /// concurrently while their full-resolution footprint fits [memoryBudgetBytes]
+  /// (0 = a quarter of RAM). Returns one entry per image, in order: the output path (null
+  /// when that image failed) and its timings. Null when batches are unavailable.
+  static Future<List<IrisBatchOutcome>?> processBatch(
+    List<IrisBatchEdit> edits, {
+    int memoryBudgetBytes = 0,
+    void Function(int done, int total)? onProgress,
+  }) async {
+    if (!isBatchAvailable) return null;
+    final batch = _bindings.createBatch();
+    if (batch == null) return null;
+    try {
+      // Timestamped names can collide within a batch, so each image gets an index suffix.
+      final base = (await _tempPngPath()).replaceFirst(RegExp(r'\.png$'), '');
+      final outPaths = List<String?>.filled(edits.length, null);
+      final batchIndex = List<int>.filled(edits.length, -1);
+      for (var i = 0; i < edits.length; i++) {
+        final cmd = _bindings.createCommandBuffer();
+        if (cmd == null) return null;
+        try {
+          final outPath = '${base}_$i.png';
+          // An image whose steps cannot be recorded is left out and reported as failed.
+          if (cmd.loadFile(edits[i].inputPath) &&
+              edits[i].record(cmd) &&
+              cmd.exportFile(outPath, format: IrisImageFormat.png) &&
+              batch.add(cmd)) {
+            batchIndex[i] = batch.length - 1;
+            outPaths[i] = outPath;
+          }
+        } finally {
+          cmd.dispose();
+        }
+      }
+      if (batch.length > 0) {
+        await batch.run(memoryBudgetBytes: memoryBudgetBytes, onProgress: onProgress);
+      }
+      final outcomes = <IrisBatchOutcome>[];
+      for (var i = 0; i < edits.length; i++) {
+        final report = batchIndex[i] < 0 ? null : batch.result(batchIndex[i]);
+        outcomes.add((outputPath: (report?.ok ?? false) ? outPaths[i] : null, report: report));
+      }
+      return outcomes;
+    } finally {
+      batch.dispose();
+    }
+  }
+
+  /// True when the engine renders preview-resolution cuts while circles are dragged.
+  static bool get isCutPreviewAvailable => isCutAndWarpAvailable && _nativeBridge.canPreview;
+
+  /// Phase 1 live feedback: the cut at the view's mip level, for drag updates. Each call
+  /// supersedes the previous one (engine `'preview'` group); an overtaken preview gives null.
+  static Future<IrisCutResult?> previewCircling(
     String inputPath, {
     required double viewW,
     required double viewH,
@@ -65,9 +230,9 @@ class IrisEngineService {
     required double outerDy,
     required double innerDx,
     required double innerDy,
-  }) async {
-    if (!_nativeBridge.isAvailable) return null;
-    final result = await _nativeBridge.cutAndWarpIris(
+    double pixelRatio = 1.0,
+  }) {
+    return _nativeBridge.previewCutAndWarpIris(
       imagePath: inputPath,
       viewW: viewW,
       viewH: viewH,
@@ -77,115 +242,439 @@ class IrisEngineService {
       outerDy: outerDy,
       innerDx: innerDx,
       innerDy: innerDy,
+      pixelRatio: pixelRatio,
+    );
+  }
+
+  /// Phase 1: the full-resolution cut in memory, for when a drag ends. Null when unavailable.
+  static Future<IrisCutResult?> renderCircling(
+    String inputPath, {
+    required double viewW,
+    required double viewH,
+    required double outerR,
+    required double innerR,
+    required double outerDx,
+    required double outerDy,
+    required double innerDx,
+    required double innerDy,
+  }) {
+    return _nativeBridge.cutAndWarpIris(
+      imagePath: inputPath,
+      viewW: viewW,
+      viewH: viewH,
+      outerR: outerR,
+      innerR: innerR,
+      outerDx: outerDx,
+      outerDy: outerDy,
+      innerDx: innerDx,
+      innerDy: innerDy,
+    );
+  }
+
+  /// Phase 1: User-defined circles + 50% pupil shrink (radial warp). View params from circling UI.
+  /// Returns output path or null. Prefer this when [isCutAndWarpAvailable] and view size is known.
+  static Future<String?> processCirclingWithViewParams(
+    String inputPath, {
+    required double viewW,
+    required double viewH,
+    required double outerR,
+    required double innerR,
+    required double outerDx,
+    required double outerDy,
+    required double innerDx,
+    required double innerDy,
+  }) async {
+    return _runEdit(
+      inputPath,
+      (cmd) => cmd.cutFromView(
+        viewW: viewW,
+        viewH: viewH,
+        outerR: outerR,
+        innerR: innerR,
+        outerDx: outerDx,
+        outerDy: outerDy,
+      ),
     );
-    if (result == null) return null;
-    final out = _rgbaToImage(result.rgba, result.width, result.height);
-    if (out == null) return null;
-    final tempDir = await getTemporaryDirectory();
-    final outPath = '${tempDir.path}/edited_${DateTime.now().millisecondsSinceEpoch}.png';
-    await File(outPath).writeAsBytes(Uint8List.fromList(img.encodePng(out)));
-    return outPath;
   }
 
   /// Phase 2: Auto-detect iris/pupil (Hough), cut to alpha. Returns output path or null.
-  static Future<String?> processCircling(String inputPath) async {
-    if (!_bindings.isAvailable) return null;
-    final bytes = File(inputPath).readAsBytesSync();
-    img.Image? decoded = img.decodeImage(bytes);
-    if (decoded == null) return null;
-    if (decoded.hasPalette) decoded = decoded.convert(numChannels: decoded.numChannels);
-    final w = decoded.width;
-    final h = decoded.height;
-    if (w <= 0 || h <= 0) return null;
-    final rgba = _imageToRgba(decoded);
-    if (rgba == null) return null;
+  static Future<String?> processCircling(String inputPath) =>
+      _runEdit(inputPath, (cmd) => cmd.cutAuto());
 
-    final handle = _bindings.createHandle();
-    if (handle == null) return null;
-    try {
-      if (!_bindings.loadRgba(handle, rgba, w, h)) return null;
-      if (!_bindings.cutIris(handle)) return null;
-      if (!_bindings.getRgba(handle, rgba, w, h)) return null;
-    } finally {
-      _bindings.destroyHandle(handle);
+  /// Phase 3: Remove flash. [inpaintMethod] = [IrisInpaintMethod] value (push-pull for
+  /// large blooms). Returns output path or null.
+  static Future<String?> processFlashRemoval(
+    String inputPath, {
+    double threshold = 0.95,
+    int dilatePixels = 3,
+    int inpaintMethod = IrisInpaintMethod.telea,
+  }) =>
+      _runEdit(
+        inputPath,
+        (cmd) => cmd.removeFlash(threshold: threshold, dilatePixels: dilatePixels, inpaintMethod: inpaintMethod),
+      );
+
+  /// Supersede group of the color step: a newer color render cancels the older ones.
+  static const String _colorPreviewGroup = 'color-preview';
+
+  /// Phase 4: Apply effects. brightness/contrast/saturation/vibrance (slider -100..100) map to engine params.
+  /// With an edit stack, repeated calls on the same [inputPath] keep it decoded and rerun
+  /// only the effects; pass the pre-color image so settings replace rather than stack.
+  /// Color renders supersede each other; a superseded call returns null.
+  static Future<String?> processColorEffects(String inputPath, {
+    double brightness = 0,
+    double contrast = 0,
+    double saturation = 0,
+    double vibrance = 0,
+  }) async {
+    if (_bindings.isAvailable && _bindings.canUseEditStack) {
+      final e = _colorEffectParams(brightness, contrast, saturation, vibrance);
+      return _runEditStack(
+        inputPath,
+        (cmd) => cmd.editRender(
+          effects: true,
+          vibrance: e.vibrance,
+          gamma: e.gamma,
+          sharpness: e.sharpness,
+          clarity: e.clarity,
+        ),
+        group: _colorPreviewGroup,
+      );
     }
+    return _runEdit(
+      inputPath,
+      (cmd) => _recordColorEffects(cmd, brightness, contrast, saturation, vibrance),
+      group: _colorPreviewGroup,
+    );
+  }
 
-    final out = _rgbaToImage(rgba, w, h);
-    if (out == null) return null;
-    final tempDir = await getTemporaryDirectory();
-    final outPath = '${tempDir.path}/edited_${DateTime.now().millisecondsSinceEpoch}.png';
-    await File(outPath).writeAsBytes(Uint8List.fromList(img.encodePng(out)));
-    return outPath;
-  }
-
-  /// Phase 3: Remove flash. Returns output path or null.
-  static Future<String?> processFlashRemoval(String inputPath, {double threshold = 0.95, int dilatePixels = 3}) async {
-    if (!_bindings.isAvailable) return null;
-    final bytes = File(inputPath).readAsBytesSync();
-    img.Image? decoded = img.decodeImage(bytes);
-    if (decoded == null) return null;
-    if (decoded.hasPalette) decoded = decoded.convert(numChannels: decoded.numChannels);
-    final w = decoded.width;
-    final h = decoded.height;
-    if (w <= 0 || h <= 0) return null;
-    final rgba = _imageToRgba(decoded);
-    if (rgba == null) return null;
+  static ({double vibrance, double gamma, double sharpness, double clarity}) _colorEffectParams(
+    double brightness,
+    double contrast,
+    double saturation,
+    double vibrance,
+  ) =>
+      (
+        vibrance: (1.0 + (saturation + vibrance) / 100.0).clamp(0.0, 2.0),
+        gamma: (1.0 + brightness / 100.0).clamp(0.5, 2.0),
+        sharpness: 0.2,
+        clarity: (1.0 + contrast / 50.0).clamp(0.5, 2.0),
+      );
 
-    final handle = _bindings.createHandle();
-    if (handle == null) return null;
+  static bool _recordColorEffects(
+    IrisCommandBuffer cmd,
+    double brightness,
+    double contrast,
+    double saturation,
+    double vibrance,
+  ) {
+    final e = _colorEffectParams(brightness, contrast, saturation, vibrance);
+    return cmd.applyEffects(vibrance: e.vibrance, gamma: e.gamma, sharpness: e.sharpness, clarity: e.clarity);
+  }
+
+  static _EditSession? _editSession;
+
+  /// Like [_runEdit], but on a handle kept for [sourcePath]: the first edit loads it, later
+  /// ones re-render its edit stack from the cached stages. Opening another source closes
+  /// the previous session. [group] supersedes like [_runEdit].
+  static Future<String?> _runEditStack(
+    String sourcePath,
+    bool Function(IrisCommandBuffer cmd) record, {
+    String? group,
+  }) async {
+    final outPath = await _tempPngPath();
+    var session = _editSession;
+    if (session == null || session.sourcePath != sourcePath) {
+      closeEditSession();
+      final handle = _bindings.createHandle();
+      if (handle == null) return null;
+      session = _editSession = _EditSession(sourcePath, handle);
+    }
+    final cmd = _bindings.createCommandBuffer();
+    if (cmd == null) return null;
+    session.running++;
     try {
-      if (!_bindings.loadRgba(handle, rgba, w, h)) return null;
-      if (!_bindings.removeFlash(handle, threshold: threshold, dilatePixels: dilatePixels)) return null;
-      if (!_bindings.getRgba(handle, rgba, w, h)) return null;
+      if ((!session.loaded && !cmd.loadFile(sourcePath)) ||
+          !record(cmd) ||
+          !cmd.exportFile(outPath, format: IrisImageFormat.png)) {
+        return null;
+      }
+      final bool ok;
+      var cancelled = false;
+      if (_bindings.canRunJobs) {
+        // Jobs on one handle run in order, so back-to-back edits never overlap.
+        final result = await cmd.submitAsync(session.handle, group: group);
+        ok = result.status == IrisJobStatus.succeeded;
+        cancelled = result.status == IrisJobStatus.cancelled;
+      } else {
+        // No job runtime: run on this isolate. submit returns -1 once every step ran, the
+        // failing step's index otherwise (0 also when submit itself is missing).
+        ok = cmd.submit(session.handle) < 0;
+      }
+      // After a failure the next edit reloads, which also resets the stack. A superseded
+      // render stopped between steps, so the handle still holds a valid stack.
+      if (!cancelled) session.loaded = ok;
+      _lastEditStats = _bindings.getStats(session.handle);
+      return ok ? outPath : null;
     } finally {
-      _bindings.destroyHandle(handle);
+      cmd.dispose();
+      session.running--;
+      _releaseEditSession(session);
     }
+  }
 
-    final out = _rgbaToImage(rgba, w, h);
-    if (out == null) return null;
-    final tempDir = await getTemporaryDirectory();
-    final outPath = '${tempDir.path}/edited_${DateTime.now().millisecondsSinceEpoch}.png';
-    await File(outPath).writeAsBytes(Uint8List.fromList(img.encodePng(out)));
-    return outPath;
+  static void _releaseEditSession(_EditSession session) {
+    if (session.closed && session.running == 0) _bindings.destroyHandle(session.handle);
   }
 
-  /// Phase 4: Apply effects. brightness/contrast/saturation/vibrance (slider -100..100) map to engine params.
-  static Future<String?> processColorEffects(String inputPath, {
+  /// Frees the kept edit handle and its cached stages (e.g. when the editor closes).
+  static void closeEditSession() {
+    final session = _editSession;
+    if (session == null) return;
+    _editSession = null;
+    session.closed = true;
+    _releaseEditSession(session);
+  }
+
+  /// Batch recorder for the steps an image still needs: auto circling, flash removal with
+  /// the editor defaults, then the color sliders (mapped as in [processColorEffects]).
+  static bool Function(IrisCommandBuffer cmd) recordPendingSteps({
+    bool circling = true,
+    bool flash = true,
+    bool color = true,
     double brightness = 0,
     double contrast = 0,
     double saturation = 0,
     double vibrance = 0,
+  }) {
+    return (cmd) =>
+        (!circling || cmd.cutAuto()) &&
+        (!flash || cmd.removeFlash(threshold: 0.95, dilatePixels: 3)) &&
+        (!color || _recordColorEffects(cmd, brightness, contrast, saturation, vibrance));
+  }
+
+  /// True when color presets and .cube files can run as native 3D LUTs.
+  static bool get isLutAvailable =>
+      _bindings.isAvailable && _bindings.canUseLuts && _bindings.canUseCommandBuffers;
+
+  /// Color preset via a native 3D LUT. Sliders (-100..100) and [hueDeg] map to the same
+  /// adjustColor multipliers as the Dart fallback; [grayscale] forces saturation 0.
+  /// Pass the pre-color image, as for [processColorEffects], so one preset replaces the
+  /// last instead of stacking on it. Supersedes other color renders like [processColorEffects].
+  static Future<String?> processColorPreset(String inputPath, {
+    double brightness = 0,
+    double contrast = 0,
+    double saturation = 0,
+    double vibrance = 0,
+    double? hueDeg,
+    bool grayscale = false,
+  }) async {
+    if (!isLutAvailable) return null;
+    final b = (1.0 + brightness / 100.0).clamp(0.0, 3.0);
+    final c = (1.0 + contrast / 100.0).clamp(0.0, 2.0);
+    final s = grayscale ? 0.0 : ((1.0 + saturation / 100.0) * (1.0 + vibrance / 100.0)).clamp(0.0, 2.0);
+
+    return _runEdit(
+      inputPath,
+      (cmd) => cmd.applyLut('preset'),
+      prepare: (handle) => _bindings.definePresetLut(
+        handle,
+        'preset',
+        brightness: b,
+        contrast: c,
+        saturation: s,
+        hueDeg: hueDeg ?? 0.0,
+      ),
+      group: _colorPreviewGroup,
+    );
+  }
+
+  /// Applies a .cube 3D LUT file. Returns output path or null (also on a malformed file).
+  static Future<String?> processCubeLut(String inputPath, String cubePath) async {
+    if (!isLutAvailable) return null;
+    return _runEdit(
+      inputPath,
+      (cmd) => cmd.applyLut('cube'),
+      prepare: (handle) => _bindings.loadCubeLut(handle, 'cube', cubePath),
+    );
+  }
+
+  /// True when the engine can convert to printer CMYK and soft-proof ([processSoftProof]).
+  static bool get isColorManagementAvailable => _bindings.isAvailable && _bindings.canUseColorManagement;
+
+  /// Previews how [inputPath] prints through [cmykProfile] (a printer .icc path).
+  /// The engine caches the profile's transform and proof, so proofing the same profile
+  /// again is one LUT pass. Returns the output path, or null.
+  static Future<String?> processSoftProof(
+    String inputPath,
+    String cmykProfile, {
+    int intent = IrisRenderingIntent.perceptual,
+    bool simulatePaper = false,
   }) async {
-    if (!_bindings.isAvailable) return null;
-    final bytes = File(inputPath).readAsBytesSync();
-    img.Image? decoded = img.decodeImage(bytes);
-    if (decoded == null) return null;
-    if (decoded.hasPalette) decoded = decoded.convert(numChannels: decoded.numChannels);
-    final w = decoded.width;
-    final h = decoded.height;
-    if (w <= 0 || h <= 0) return null;
-    final rgba = _imageToRgba(decoded);
-    if (rgba == null) return null;
-
-    final g = (1.0 + brightness / 100.0).clamp(0.5, 2.0);
-    final v = (1.0 + (saturation + vibrance) / 100.0).clamp(0.0, 2.0);
-    final clarity = (1.0 + contrast / 50.0).clamp(0.5, 2.0);
+    if (!isColorManagementAvailable || !isLutAvailable) return null;
+    return _runEdit(
+      inputPath,
+      (cmd) => cmd.applyLut('proof'),
+      prepare: (handle) =>
+          _bindings.defineProofLut(handle, 'proof', cmykProfile, intent: intent, simulatePaper: simulatePaper),
+    );
+  }
+
+  /// True when the engine can lay out Art Studio canvases ([composeLayout]).
+  static bool get isComposeAvailable => _bindings.isAvailable && _bindings.canRecordCompose;
 
+  static int _layoutFor(String alignment) => switch (alignment) {
+        'Row' => IrisLayout.row,
+        'Column' => IrisLayout.column,
+        'Round' => IrisLayout.round,
+        'Rectangle' => IrisLayout.rectangle,
+        _ => IrisLayout.square,
+      };
+
+  /// Records compose → [export] into one command buffer and runs it on a fresh handle,
+  /// as a job when the engine has them: the layers are decoded and the canvas is built
+  /// on a job thread, not on this isolate. Returns true when every step succeeded.
+  static Future<bool> _runLayout(
+    List<String> images,
+    String alignment,
+    double widthCm,
+    double heightCm,
+    int dpi,
+    bool Function(IrisCommandBuffer cmd) export,
+  ) async {
+    final cmd = _bindings.createCommandBuffer();
+    if (cmd == null) return false;
     final handle = _bindings.createHandle();
-    if (handle == null) return null;
     try {
-      if (!_bindings.loadRgba(handle, rgba, w, h)) return null;
-      if (!_bindings.applyEffects(handle, vibrance: v, gamma: g, sharpness: 0.2, clarity: clarity)) return null;
-      if (!_bindings.getRgba(handle, rgba, w, h)) return null;
+      if (handle == null) return false;
+      if (!cmd.compose(images, layout: _layoutFor(alignment), widthCm: widthCm, heightCm: heightCm, dpi: dpi) ||
+          !export(cmd)) {
+        return false;
+      }
+      if (_bindings.canRunJobs) {
+        // The handle is destroyed only once the job has finished.
+        final result = await cmd.submitAsync(handle);
+        return result.status == IrisJobStatus.succeeded;
+      }
+      return cmd.submit(handle) < 0;
     } finally {
       _bindings.destroyHandle(handle);
+      cmd.dispose();
     }
+  }
 
-    final out = _rgbaToImage(rgba, w, h);
-    if (out == null) return null;
-    final tempDir = await getTemporaryDirectory();
-    final outPath = '${tempDir.path}/edited_${DateTime.now().millisecondsSinceEpoch}.png';
-    await File(outPath).writeAsBytes(Uint8List.fromList(img.encodePng(out)));
-    return outPath;
+  /// Lays out [images] (cut irises, 1–6, in order) as the studio's [alignment]
+  /// ('Square', 'Row', 'Column', 'Round' or 'Rectangle') on a [widthCm] x [heightCm]
+  /// canvas at [dpi], and writes it to a temporary PNG. Round canvases are [widthCm]
+  /// across. Returns the PNG path, or null.
+  static Future<String?> composeLayout(
+    List<String> images,
+    String alignment,
+    double widthCm,
+    double heightCm, {
+    int dpi = 300,
+  }) async {
+    if (!isComposeAvailable) return null;
+    final outPath = await _tempPngPath();
+    final ok = await _runLayout(
+        images, alignment, widthCm, heightCm, dpi, (cmd) => cmd.exportFile(outPath, format: IrisImageFormat.png));
+    return ok ? outPath : null;
+  }
+
+  /// True when a composed layout can be written as a print file ([exportLayoutForPrint]).
+  /// Needs engine jobs: a print-size canvas is never composed on the UI isolate.
+  static bool get isLayoutPrintAvailable => isComposeAvailable && _bindings.canExportPrint && _bindings.canRunJobs;
+
+  /// Composes the layout as [composeLayout] does, at the print [dpi], and streams it to
+  /// [outPath] through the print export (TIFF or PNG from the extension, DPI tags set).
+  /// The canvas is composed at its printed size in the same job, so no resampling
+  /// follows. Returns [outPath], or null.
+  static Future<String?> exportLayoutForPrint(
+    List<String> images,
+    String alignment,
+    double widthCm,
+    double heightCm,
+    String outPath, {
+    int dpi = 300,
+  }) async {
+    if (!isLayoutPrintAvailable) return null;
+    final ok =
+        await _runLayout(images, alignment, widthCm, heightCm, dpi, (cmd) => cmd.exportPrint(outPath, dpi: dpi));
+    return ok ? outPath : null;
+  }
+
+  /// True when the engine renders the Art Studio solo effects ([processSoloEffect]).
+  static bool get isArtEffectsAvailable => _bindings.isAvailable && _bindings.canUseArtEffects;
+
+  /// Renders the solo [effect] ('Pure', 'Halo', 'Dust', 'Sun' or 'Explosion') around the
+  /// cut iris in [inputPath]. The same [seed] always gives the same image. [previewMaxSide]
+  /// > 0 renders a small preview; previews supersede each other, so scrubbing a slider
+  /// only renders the newest value (superseded calls return null), and each preview
+  /// deletes the previous preview file. Returns the PNG path.
+  static Future<String?> processSoloEffect(
+    String inputPath,
+    String effect, {
+    int seed = 1,
+    double intensity = 1.0,
+    double size = 0.35,
+    int previewMaxSide = 0,
+  }) async {
+    if (!isArtEffectsAvailable) return null;
+    final id = switch (effect) {
+      'Halo' => IrisSoloEffect.halo,
+      'Dust' => IrisSoloEffect.dust,
+      'Sun' => IrisSoloEffect.sun,
+      'Explosion' => IrisSoloEffect.explosion,
+      _ => IrisSoloEffect.pure,
+    };
+    if (previewMaxSide <= 0) {
+      return _runEdit(inputPath, (cmd) => cmd.soloEffect(id, seed: seed, intensity: intensity, size: size));
+    }
+    const group = 'solo-effect-preview';
+    return _keepLatestPreview(
+      group,
+      _runEdit(
+        inputPath,
+        (cmd) => cmd.soloEffect(id, seed: seed, intensity: intensity, size: size, maxSide: previewMaxSide),
+        group: group,
+      ),
+    );
+  }
+
+  /// True when the engine renders the Art Studio duo effects ([processDuoEffect]).
+  static bool get isDuoEffectsAvailable => _bindings.isAvailable && _bindings.canUseDuoEffects;
+
+  /// Joins the cut irises in [firstPath] and [secondPath] with the duo [effect] ('Fusion',
+  /// 'Collision', 'Balance', 'Binary' or 'Eclipse'). [angle] turns the split axis in
+  /// degrees; [softness] 0 keeps the effect's edge. Previews ([previewMaxSide] > 0)
+  /// supersede each other like [processSoloEffect]. Returns the PNG path.
+  static Future<String?> processDuoEffect(
+    String firstPath,
+    String secondPath,
+    String effect, {
+    double angle = 0,
+    double softness = 0,
+    int previewMaxSide = 0,
+  }) async {
+    if (!isDuoEffectsAvailable) return null;
+    final id = switch (effect) {
+      'Collision' => IrisDuoEffect.collision,
+      'Balance' => IrisDuoEffect.balance,
+      'Binary' => IrisDuoEffect.binary,
+      'Eclipse' => IrisDuoEffect.eclipse,
+      _ => IrisDuoEffect.fusion,
+    };
+    if (previewMaxSide <= 0) {
+      return _runEdit(firstPath, (cmd) => cmd.duoEffect(secondPath, id, angleDeg: angle, softness: softness));
+    }
+    const group = 'duo-effect-preview';
+    return _keepLatestPreview(
+      group,
+      _runEdit(
+        firstPath,
+        (cmd) => cmd.duoEffect(secondPath, id, angleDeg: angle, softness: softness, maxSide: previewMaxSide),
+        group: group,
+      ),
+    );
   }
 }
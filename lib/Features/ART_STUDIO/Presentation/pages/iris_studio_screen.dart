@@ -1,5 +1,6 @@
 import 'dart:convert';
 import 'dart:io';
+import 'package:file_picker/file_picker.dart';
 import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
 import 'package:flutter_gap/flutter_gap.dart';
@@ -10,6 +11,7 @@ import 'package:google_fonts/google_fonts.dart';
 import 'package:flutter_inappwebview/flutter_inappwebview.dart'; 
 
 import 'package:iris_designer/Core/Config/Theme.dart';
+import 'package:iris_designer/Core/Services/iris_engine_service.dart';
 import 'package:iris_designer/Core/Shared/Widgets/global_custom_navbar.dart';
 import 'package:iris_designer/Core/Shared/Widgets/global_submit_button_widget.dart';
 import 'package:iris_designer/Core/Utils/toast_service.dart';
@@ -78,9 +80,12 @@ class _ArtStudioScreenState extends State<ArtStudioScreen> {
                   onGenerateRequest: _switchToPhotopea,
                 ),
                 // TAB 2: UNIFIED PREVIEW (Windows/Mac/Linux)
-                _generationConfig != null
-                    ? PhotopeaPreviewTab(config: _generationConfig!, onReset: _backToEditor)
-                    : const Center(child: CircularProgressIndicator()),
+                // Composed natively when the engine has the compositor, else in Photopea.
+                _generationConfig == null
+                    ? const Center(child: CircularProgressIndicator())
+                    : _generationConfig!['composedPath'] != null
+                        ? ComposedPreviewTab(config: _generationConfig!, onReset: _backToEditor)
+                        : PhotopeaPreviewTab(config: _generationConfig!, onReset: _backToEditor),
               ],
             ),
           ),
@@ -170,6 +175,75 @@ class StudioEditorTab extends StatefulWidget {
 class _StudioEditorTabState extends State<StudioEditorTab> {
   String selectedEffect = 'Pure';
   String? selectedSize;
+
+  // Native solo-effect preview (single iris); the seed keeps Dust/Sun stable while scrubbing.
+  static const int _effectPreviewSide = 640;
+  final int _effectSeed = DateTime.now().millisecondsSinceEpoch & 0x7fffffff;
+  double _effectIntensity = 1.0;
+  double _effectSize = 0.35;
+  String? _effectPreviewPath;
+
+  bool get _canPreviewSoloEffect =>
+      widget.irisImages.length == 1 && IrisEngineService.isArtEffectsAvailable;
+
+  // Native duo-effect preview (two irises); small enough to re-render on every slider step.
+  static const int _duoPreviewSide = 512;
+  double _duoAngle = 0;
+
+  bool get _canPreviewDuoEffect =>
+      widget.irisImages.length == 2 && IrisEngineService.isDuoEffectsAvailable;
+
+  bool get _isDuoEffectSelected => duoEffects.any((e) => e['name'] == selectedEffect);
+
+  Future<String?> _renderDuoEffect({int previewMaxSide = 0}) => IrisEngineService.processDuoEffect(
+        widget.irisImages[0],
+        widget.irisImages[1],
+        selectedEffect,
+        angle: _duoAngle,
+        previewMaxSide: previewMaxSide,
+      );
+
+  Future<void> _refreshEffectPreview() async {
+    if (_canPreviewDuoEffect) {
+      if (!_isDuoEffectSelected) return;
+      final path = await _renderDuoEffect(previewMaxSide: _duoPreviewSide);
+      if (path != null && mounted) setState(() => _effectPreviewPath = path);
+      return;
+    }
+    if (!_canPreviewSoloEffect) return;
+    if (selectedEffect == 'Pure') {
+      setState(() => _effectPreviewPath = null);
+      return;
+    }
+    final path = await IrisEngineService.processSoloEffect(
+      widget.irisImages[0],
+      selectedEffect,
+      seed: _effectSeed,
+      intensity: _effectIntensity,
+      size: _effectSize,
+      previewMaxSide: _effectPreviewSide,
+    );
+    // Null when a newer preview superseded this one.
+    if (path != null && mounted) setState(() => _effectPreviewPath = path);
+  }
+
+  /// The images to lay out: a single iris goes through its solo effect at full size first,
+  /// and a pair with a duo effect becomes the one joined image.
+  Future<List<String>> _layoutImages() async {
+    if (_canPreviewDuoEffect && _isDuoEffectSelected) {
+      final path = await _renderDuoEffect();
+      return path != null ? [path] : widget.irisImages;
+    }
+    if (!_canPreviewSoloEffect || selectedEffect == 'Pure') return widget.irisImages;
+    final path = await IrisEngineService.processSoloEffect(
+      widget.irisImages[0],
+      selectedEffect,
+      seed: _effectSeed,
+      intensity: _effectIntensity,
+      size: _effectSize,
+    );
+    return path != null ? [path] : widget.irisImages;
+  }
   
   final List<Map<String, dynamic>> soloEffects = [
     {'name': 'Pure', 'color': Colors.blue}, {'name': 'Halo', 'color': Colors.amber},
@@ -201,7 +275,40 @@ class _StudioEditorTabState extends State<StudioEditorTab> {
     return 'Square'; 
   }
 
+  // Long side of the on-screen composition. Download / Print composes again at print DPI
+  // (ComposedPreviewTab).
+  static const double _previewLongSidePx = 2048;
+
   void _handleShowPressed() async {
+    String safeEffect = selectedEffect.replaceAll(" ", "");
+    String safeSize = selectedSize!;
+    String alignment = _determineAlignment(safeSize);
+    String filename = "${safeEffect}_${safeSize}_$alignment".toLowerCase();
+
+    // Native only when the engine can also write the print file; else Photopea does both.
+    if (IrisEngineService.isLayoutPrintAvailable) {
+      // Sizes are "WxH" in cm, or one diameter for round canvases.
+      final cm = safeSize.split('x').map(double.parse).toList();
+      final longSide = cm.reduce((a, b) => a > b ? a : b);
+      final dpi = (_previewLongSidePx * 2.54 / longSide).clamp(30, 300).round();
+      final layers = await _layoutImages();
+      final widthCm = cm[0];
+      final heightCm = cm.length > 1 ? cm[1] : 0.0;
+      final composed = await IrisEngineService.composeLayout(layers, alignment, widthCm, heightCm, dpi: dpi);
+      if (composed != null) {
+        widget.onGenerateRequest({
+          "composedPath": composed,
+          "layers": layers,
+          "alignment": alignment,
+          "widthCm": widthCm,
+          "heightCm": heightCm,
+          "templateName": filename,
+          "effect": selectedEffect,
+        });
+        return;
+      }
+    }
+
     List<String> base64Images = [];
     for (String path in widget.irisImages) {
       File file = File(path);
@@ -211,11 +318,6 @@ class _StudioEditorTabState extends State<StudioEditorTab> {
       }
     }
 
-    String safeEffect = selectedEffect.replaceAll(" ", "");
-    String safeSize = selectedSize!;
-    String alignment = _determineAlignment(safeSize);
-    String filename = "${safeEffect}_${safeSize}_$alignment".toLowerCase();
-
     widget.onGenerateRequest({
       "images": base64Images,
       "templateName": filename,
@@ -298,7 +400,10 @@ class _StudioEditorTabState extends State<StudioEditorTab> {
                     final effect = soloEffects[index];
                     final bool isSelected = selectedEffect == effect['name'];
                     return GestureDetector(
-                      onTap: () => setState(() => selectedEffect = effect['name']),
+                      onTap: () {
+                        setState(() => selectedEffect = effect['name']);
+                        _refreshEffectPreview();
+                      },
                       child: Column(
                         children: [
                           Container(
@@ -318,6 +423,15 @@ class _StudioEditorTabState extends State<StudioEditorTab> {
                   },
                 ),
               ),
+              if (_canPreviewSoloEffect && selectedEffect != 'Pure') ...[
+                _buildEffectSlider("Intensity", _effectIntensity, 0.1, 2.0, (v) => _effectIntensity = v),
+                _buildEffectSlider("Size", _effectSize, 0.05, 0.9, (v) => _effectSize = v),
+                const Gap(12),
+              ],
+              if (_canPreviewDuoEffect && _isDuoEffectSelected) ...[
+                _buildEffectSlider("Angle", _duoAngle, 0, 360, (v) => _duoAngle = v),
+                const Gap(12),
+              ],
             ],
           ),
         ),
@@ -377,20 +491,131 @@ class _StudioEditorTabState extends State<StudioEditorTab> {
     );
   }
 
+  Widget _buildEffectSlider(String label, double value, double min, double max, void Function(double) assign) {
+    return Padding(
+      padding: const EdgeInsets.symmetric(horizontal: 12),
+      child: Column(
+        crossAxisAlignment: CrossAxisAlignment.start,
+        children: [
+          Text(label.toUpperCase(), style: GoogleFonts.poppins(color: Colors.white54, fontSize: 11, letterSpacing: 1.2)),
+          Slider(
+            value: value,
+            min: min,
+            max: max,
+            onChanged: (v) {
+              setState(() => assign(v));
+              _refreshEffectPreview();
+            },
+          ),
+        ],
+      ),
+    );
+  }
+
   Widget _buildCorrectLayoutView() {
     switch (widget.irisImages.length) {
-      case 1: return Case1View(effect: selectedEffect, images: widget.irisImages);
+      case 1: return Case1View(
+        effect: selectedEffect,
+        images: _effectPreviewPath != null && selectedEffect != 'Pure' ? [_effectPreviewPath!] : widget.irisImages,
+      );
       case 2: return Case2View(
         effect: selectedEffect, 
         images: widget.irisImages, 
         duoEffects: duoEffects, 
-        onEffectSelected: (v) => setState(() => selectedEffect = v)
+        previewPath: _isDuoEffectSelected ? _effectPreviewPath : null,
+        onEffectSelected: (v) {
+          setState(() => selectedEffect = v);
+          _refreshEffectPreview();
+        },
       );
+      case 3: return Case3View(effect: selectedEffect, images: widget.irisImages);
+      case 4: return Case4View(effect: selectedEffect, images: widget.irisImages);
+      case 5: return Case5View(effect: selectedEffect, images: widget.irisImages);
+      case 6: return Case6View(effect: selectedEffect, images: widget.irisImages);
       default: return const Text("Select Layout", style: TextStyle(color: Colors.white));
     }
   }
 }
 
+// ============================================================================
+// TAB 2: NATIVE PREVIEW (composed by the Iris Engine)
+// ============================================================================
+class ComposedPreviewTab extends StatefulWidget {
+  final Map<String, dynamic> config;
+  final VoidCallback onReset;
+
+  const ComposedPreviewTab({super.key, required this.config, required this.onReset});
+
+  @override
+  State<ComposedPreviewTab> createState() => _ComposedPreviewTabState();
+}
+
+class _ComposedPreviewTabState extends State<ComposedPreviewTab> {
+  // Print resolution of the saved file; the preview above is at most 2048 px.
+  static const int _printDpi = 300;
+  bool _isExporting = false;
+
+  /// Composes the layout again at [_printDpi] and writes it where the user chooses.
+  Future<void> _downloadForPrint() async {
+    final config = widget.config;
+    final outPath = await FilePicker.platform.saveFile(
+      dialogTitle: 'Save print file',
+      fileName: '${config['templateName']}.tif',
+      type: FileType.custom,
+      allowedExtensions: ['tif', 'tiff', 'png'],
+    );
+    if (outPath == null || !mounted) return;
+    setState(() => _isExporting = true);
+    final written = await IrisEngineService.exportLayoutForPrint(
+      List<String>.from(config['layers'] as List),
+      config['alignment'] as String,
+      config['widthCm'] as double,
+      config['heightCm'] as double,
+      outPath,
+      dpi: _printDpi,
+    );
+    if (!mounted) return;
+    setState(() => _isExporting = false);
+    if (written != null) {
+      ToastService.showSuccess(context, title: "Saved", message: "Print file written to $written");
+    } else {
+      ToastService.showError(context, title: "Export failed", message: "Could not write the print file.");
+    }
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return Column(
+      children: [
+        Expanded(
+          child: InteractiveViewer(
+            maxScale: 8,
+            child: Center(child: Image.file(File(widget.config['composedPath'] as String), fit: BoxFit.contain)),
+          ),
+        ),
+        Padding(
+          padding: const EdgeInsets.all(16),
+          child: Row(
+            mainAxisAlignment: MainAxisAlignment.center,
+            children: [
+              TextButton(onPressed: widget.onReset, child: const Text("Back to Settings", style: TextStyle(color: Colors.grey))),
+              const Gap(16),
+              ElevatedButton.icon(
+                onPressed: _isExporting ? null : _downloadForPrint,
+                style: ElevatedButton.styleFrom(backgroundColor: Colors.blueAccent, foregroundColor: Colors.white),
+                icon: _isExporting
+                    ? const SizedBox(width: 16, height: 16, child: CircularProgressIndicator(strokeWidth: 2, color: Colors.white))
+                    : const Icon(Icons.print_outlined, size: 18),
+                label: Text(_isExporting ? "Exporting..." : "Download / Print"),
+              ),
+            ],
+          ),
+        ),
+      ],
+    );
+  }
+}
+
 
 // ============================================================================
 // TAB 2: PREVIEW (Unchanged)
@@ -1,3 +1,5 @@
+import 'dart:io';
+
 import 'package:flutter/material.dart';
 import 'package:flutter_gap/flutter_gap.dart';
 import 'package:google_fonts/google_fonts.dart';
@@ -8,6 +10,8 @@ class Case2View extends StatelessWidget {
   final List<String> images;
   final List<Map<String, dynamic>> duoEffects;
   final Function(String) onEffectSelected;
+  /// Native duo-effect render of the two irises; replaces the pair on the canvas.
+  final String? previewPath;
 
   const Case2View({
     super.key,
@@ -15,6 +19,7 @@ class Case2View extends StatelessWidget {
     required this.images,
     required this.duoEffects,
     required this.onEffectSelected,
+    this.previewPath,
   });
 
   @override
@@ -35,7 +40,9 @@ class Case2View extends StatelessWidget {
                 borderRadius: BorderRadius.circular(4),
                 border: Border.all(color: Colors.white10),
               ),
-              child: Stack(
+              child: previewPath != null
+                  ? Image.file(File(previewPath!), fit: BoxFit.contain, gaplessPlayback: true)
+                  : Stack(
                 fit: StackFit.expand, // ✅ Fix: Make stack fill the container
                 children: [
                   // Top Right Image
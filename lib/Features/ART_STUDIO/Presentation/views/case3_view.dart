@@ -19,15 +19,15 @@ class Case3View extends StatelessWidget {
         mainAxisAlignment: MainAxisAlignment.center,
         children: [
           // Top
-          const IrisPlaceholder(size: 120, label: "+"),
+          IrisPlaceholder(size: 120, imagePath: images.isNotEmpty ? images[0] : null),
           const SizedBox(height: 30),
           // Bottom Row
           Row(
             mainAxisAlignment: MainAxisAlignment.center,
-            children: const [
-              IrisPlaceholder(size: 120, label: "+"),
-              SizedBox(width: 30),
-              IrisPlaceholder(size: 120, label: "+"),
+            children: [
+              IrisPlaceholder(size: 120, imagePath: images.length > 1 ? images[1] : null),
+              const SizedBox(width: 30),
+              IrisPlaceholder(size: 120, imagePath: images.length > 2 ? images[2] : null),
             ],
           ),
         ],
@@ -21,20 +21,20 @@ class Case4View extends StatelessWidget {
           // Row 1
           Row(
             mainAxisAlignment: MainAxisAlignment.center,
-            children: const [
-              IrisPlaceholder(size: 110, label: "+", color: Colors.blue),
-              SizedBox(width: 30),
-              IrisPlaceholder(size: 110, label: "+", color: Colors.green),
+            children: [
+              IrisPlaceholder(size: 110, color: Colors.blue, imagePath: images.isNotEmpty ? images[0] : null),
+              const SizedBox(width: 30),
+              IrisPlaceholder(size: 110, color: Colors.green, imagePath: images.length > 1 ? images[1] : null),
             ],
           ),
           const SizedBox(height: 30),
           // Row 2
           Row(
             mainAxisAlignment: MainAxisAlignment.center,
-            children: const [
-              IrisPlaceholder(size: 110, label: "+", color: Colors.red),
-              SizedBox(width: 30),
-              IrisPlaceholder(size: 110, label: "+", color: Colors.purple),
+            children: [
+              IrisPlaceholder(size: 110, color: Colors.red, imagePath: images.length > 2 ? images[2] : null),
+              const SizedBox(width: 30),
+              IrisPlaceholder(size: 110, color: Colors.purple, imagePath: images.length > 3 ? images[3] : null),
             ],
           ),
           const SizedBox(height: 20),
@@ -22,10 +22,10 @@ class Case5View extends StatelessWidget {
           // Top Row (2)
           Row(
             mainAxisAlignment: MainAxisAlignment.center,
-            children: const [
-              IrisPlaceholder(size: 100),
-              SizedBox(width: 40),
-              IrisPlaceholder(size: 100),
+            children: [
+              IrisPlaceholder(size: 100, imagePath: images.isNotEmpty ? images[0] : null),
+              const SizedBox(width: 40),
+              IrisPlaceholder(size: 100, imagePath: images.length > 1 ? images[1] : null),
             ],
           ),
           const SizedBox(height: 20),
@@ -34,12 +34,12 @@ class Case5View extends StatelessWidget {
           // Bottom Row (3)
           Row(
             mainAxisAlignment: MainAxisAlignment.center,
-            children: const [
-              IrisPlaceholder(size: 100),
-              SizedBox(width: 40),
-              IrisPlaceholder(size: 100),
-              SizedBox(width: 40),
-              IrisPlaceholder(size: 100),
+            children: [
+              IrisPlaceholder(size: 100, imagePath: images.length > 2 ? images[2] : null),
+              const SizedBox(width: 40),
+              IrisPlaceholder(size: 100, imagePath: images.length > 3 ? images[3] : null),
+              const SizedBox(width: 40),
+              IrisPlaceholder(size: 100, imagePath: images.length > 4 ? images[4] : null),
             ],
           ),
         ],
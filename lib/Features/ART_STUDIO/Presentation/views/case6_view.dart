@@ -35,24 +35,24 @@ class Case6View extends StatelessWidget {
               // Row 1
               Row(
                 mainAxisAlignment: MainAxisAlignment.center,
-                children: const [
-                  IrisPlaceholder(size: 110, label: "+"),
-                  SizedBox(width: 20),
-                  IrisPlaceholder(size: 110, label: "+"),
-                  SizedBox(width: 20),
-                  IrisPlaceholder(size: 110, label: "+"),
+                children: [
+                  IrisPlaceholder(size: 110, imagePath: images.isNotEmpty ? images[0] : null),
+                  const SizedBox(width: 20),
+                  IrisPlaceholder(size: 110, imagePath: images.length > 1 ? images[1] : null),
+                  const SizedBox(width: 20),
+                  IrisPlaceholder(size: 110, imagePath: images.length > 2 ? images[2] : null),
                 ],
               ),
               const SizedBox(height: 20),
               // Row 2
               Row(
                 mainAxisAlignment: MainAxisAlignment.center,
-                children: const [
-                  IrisPlaceholder(size: 110, label: "+"),
-                  SizedBox(width: 20),
-                  IrisPlaceholder(size: 110, label: "+"),
-                  SizedBox(width: 20),
-                  IrisPlaceholder(size: 110, label: "+"),
+                children: [
+                  IrisPlaceholder(size: 110, imagePath: images.length > 3 ? images[3] : null),
+                  const SizedBox(width: 20),
+                  IrisPlaceholder(size: 110, imagePath: images.length > 4 ? images[4] : null),
+                  const SizedBox(width: 20),
+                  IrisPlaceholder(size: 110, imagePath: images.length > 5 ? images[5] : null),
                 ],
               ),
             ],
@@ -1,3 +1,6 @@
+import 'dart:async';
+import 'dart:ui' as ui;
+
 import 'package:dotted_border/dotted_border.dart';
 import 'package:file_picker/file_picker.dart';
 import 'package:flutter/material.dart';
@@ -10,6 +13,7 @@ import 'package:uuid/uuid.dart';
 
 // Core Imports
 import 'package:iris_designer/Core/Config/dependecy_injection.dart';
+import 'package:iris_designer/Core/Native/native_iris_bridge.dart' show IrisCutResult;
 import 'package:iris_designer/Core/Services/hive_service.dart';
 import 'package:iris_designer/Core/Services/iris_engine_service.dart';
 import 'package:iris_designer/Core/Shared/Widgets/global_custom_navbar.dart';
@@ -53,6 +57,13 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
   Offset _innerCircleOffset = Offset.zero;
   Size? _circlingViewSize;
 
+  /// Live cut of the current circles: preview resolution while dragging, full on release.
+  ui.Image? _cutPreview;
+  int _cutPreviewSeq = 0;
+
+  /// Latest color render; an older one returning null was superseded, not failed.
+  int _colorRenderSeq = 0;
+
   double _brightness = 0.0;
   double _contrast = 0.0;
   double _saturation = 0.0;
@@ -80,6 +91,14 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
     }).toList();
   }
 
+  @override
+  void dispose() {
+    _cutPreviewSeq++;
+    _cutPreview?.dispose();
+    IrisEngineService.closeEditSession();
+    super.dispose();
+  }
+
   IrisImage get _activeImage => _projectImages[_selectedImageIndex];
   bool get _allImagesDone => _projectImages.every((img) => img.isFullyEdited);
 
@@ -121,6 +140,7 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
   }
 
   void _resetTools() {
+    _clearCutPreview();
     _outerRadiusVal = 0.5;
     _innerRadiusVal = 0.2;
     _ovalRatio = 1.0;
@@ -157,7 +177,10 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
       _isProcessing = false;
       if (wasFlashStep) _pathAfterFlash[_selectedImageIndex] = newPath;
       IrisImage updated = _activeImage.copyWith(imagePath: newPath);
-      if (_currentStep == 0) updated = updated.copyWith(isCirclingDone: true);
+      if (_currentStep == 0) {
+        updated = updated.copyWith(isCirclingDone: true);
+        _clearCutPreview();
+      }
       if (_currentStep == 1) updated = updated.copyWith(isFlashDone: true);
       if (_currentStep == 2) updated = updated.copyWith(isColorDone: true);
       _projectImages[_selectedImageIndex] = updated;
@@ -173,6 +196,72 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
     );
   }
 
+  /// Circle radii as the engine accepts them (pupil strictly inside the iris).
+  ({double outerR, double innerR}) get _safeRadii {
+    final outerR = _outerRadiusVal.clamp(0.0, 1.0);
+    final maxInner = outerR > 0.01 ? outerR - 0.01 : outerR;
+    return (outerR: outerR, innerR: _innerRadiusVal.clamp(0.0, maxInner));
+  }
+
+  void _clearCutPreview() {
+    _cutPreviewSeq++;
+    _cutPreview?.dispose();
+    _cutPreview = null;
+  }
+
+  /// Renders the cut for the current circles into [_cutPreview]. Drag updates pass
+  /// [fullResolution] = false (superseding engine previews); the drag end renders full size.
+  Future<void> _updateCutPreview({required bool fullResolution}) async {
+    final sz = _circlingViewSize;
+    if (sz == null || !IrisEngineService.isCutPreviewAvailable) return;
+    final seq = ++_cutPreviewSeq;
+    final radii = _safeRadii;
+    final path = _activeImage.imagePath;
+    final IrisCutResult? result = fullResolution
+        ? await IrisEngineService.renderCircling(
+            path,
+            viewW: sz.width,
+            viewH: sz.height,
+            outerR: radii.outerR,
+            innerR: radii.innerR,
+            outerDx: _outerCircleOffset.dx,
+            outerDy: _outerCircleOffset.dy,
+            innerDx: _innerCircleOffset.dx,
+            innerDy: _innerCircleOffset.dy,
+          )
+        : await IrisEngineService.previewCircling(
+            path,
+            viewW: sz.width,
+            viewH: sz.height,
+            outerR: radii.outerR,
+            innerR: radii.innerR,
+            outerDx: _outerCircleOffset.dx,
+            outerDy: _outerCircleOffset.dy,
+            innerDx: _innerCircleOffset.dx,
+            innerDy: _innerCircleOffset.dy,
+            pixelRatio: MediaQuery.devicePixelRatioOf(context),
+          );
+    // Null = superseded by a newer drag position (or unavailable): keep the last image.
+    if (result == null || !mounted || seq != _cutPreviewSeq) return;
+    final decoded = Completer<ui.Image>();
+    ui.decodeImageFromPixels(
+      result.rgba,
+      result.width,
+      result.height,
+      ui.PixelFormat.rgba8888,
+      decoded.complete,
+    );
+    final image = await decoded.future;
+    if (!mounted || seq != _cutPreviewSeq) {
+      image.dispose();
+      return;
+    }
+    setState(() {
+      _cutPreview?.dispose();
+      _cutPreview = image;
+    });
+  }
+
   Future<void> _applyCurrentStep() async {
     setState(() => _isProcessing = true);
     try {
@@ -180,15 +269,13 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
         String? newPath;
         if (IrisEngineService.isCutAndWarpAvailable && _circlingViewSize != null) {
           final sz = _circlingViewSize!;
-          final safeOuterR = _outerRadiusVal.clamp(0.0, 1.0);
-          final maxInner = safeOuterR > 0.01 ? safeOuterR - 0.01 : safeOuterR;
-          final safeInnerR = _innerRadiusVal.clamp(0.0, maxInner);
+          final radii = _safeRadii;
           newPath = await IrisEngineService.processCirclingWithViewParams(
             _activeImage.imagePath,
             viewW: sz.width,
             viewH: sz.height,
-            outerR: safeOuterR,
-            innerR: safeInnerR,
+            outerR: radii.outerR,
+            innerR: radii.innerR,
             outerDx: _outerCircleOffset.dx,
             outerDy: _outerCircleOffset.dy,
             innerDx: _innerCircleOffset.dx,
@@ -249,14 +336,30 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
       }
 
       if (_currentStep == 2) {
-        _pathAfterFlash[_selectedImageIndex] ??= _activeImage.imagePath;
-        final newPath = await IrisEngineService.processColorEffects(
-          _activeImage.imagePath,
-          brightness: _brightness,
-          contrast: _contrast,
-          saturation: _saturation,
-          vibrance: _vibrance,
-        );
+        // Presets and sliders both render from the pre-color image, so a new preset or
+        // slider value replaces the previous grade instead of stacking on it.
+        final source = _pathAfterFlash[_selectedImageIndex] ??= _activeImage.imagePath;
+        final seq = ++_colorRenderSeq;
+        final preset = _selectedPreset;
+        final newPath = preset != null && IrisEngineService.isLutAvailable
+            ? await IrisEngineService.processColorPreset(
+                source,
+                brightness: _brightness,
+                contrast: _contrast,
+                saturation: _saturation,
+                vibrance: _vibrance,
+                hueDeg: preset.hueDeg,
+                grayscale: preset == ColorPreset.grey,
+              )
+            : await IrisEngineService.processColorEffects(
+                source,
+                brightness: _brightness,
+                contrast: _contrast,
+                saturation: _saturation,
+                vibrance: _vibrance,
+              );
+        // A newer color render is on its way and reports for both.
+        if (seq != _colorRenderSeq) return;
         setState(() => _isProcessing = false);
         if (newPath != null && mounted) {
           _handleEditingResult(newPath);
@@ -279,6 +382,62 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
     }
   }
 
+  /// Runs every unfinished image through its remaining steps in one native batch:
+  /// auto circling, flash removal, then the current color settings.
+  Future<void> _processQueue() async {
+    final pending = [
+      for (var i = 0; i < _projectImages.length; i++)
+        if (!_projectImages[i].isFullyEdited) i,
+    ];
+    if (pending.isEmpty) return;
+    setState(() => _isProcessing = true);
+    final outcomes = await IrisEngineService.processBatch([
+      for (final i in pending)
+        (
+          inputPath: _projectImages[i].imagePath,
+          record: IrisEngineService.recordPendingSteps(
+            circling: !_projectImages[i].isCirclingDone,
+            flash: !_projectImages[i].isFlashDone,
+            color: !_projectImages[i].isColorDone,
+            brightness: _brightness,
+            contrast: _contrast,
+            saturation: _saturation,
+            vibrance: _vibrance,
+          ),
+        ),
+    ]);
+    if (!mounted) return;
+    var failed = pending.length;
+    setState(() {
+      _isProcessing = false;
+      if (outcomes == null) return;
+      for (var k = 0; k < pending.length; k++) {
+        final path = outcomes[k].outputPath;
+        if (path == null) continue;
+        failed--;
+        _projectImages[pending[k]] = _projectImages[pending[k]].copyWith(
+          imagePath: path,
+          isCirclingDone: true,
+          isFlashDone: true,
+          isColorDone: true,
+        );
+      }
+    });
+    if (failed == 0) {
+      ToastService.showSuccess(
+        context,
+        title: "Queue processed",
+        message: "${pending.length} images edited.",
+      );
+    } else {
+      ToastService.showError(
+        context,
+        title: "Queue processing",
+        message: "$failed of ${pending.length} images could not be edited.",
+      );
+    }
+  }
+
   Future<void> _navigateBack() async {
     final bool shouldLeave =
         await showDialog<bool>(
@@ -372,6 +531,34 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
     });
   }
 
+  /// Places both circles from the engine's iris/pupil detection.
+  Future<void> _autoDetectCircles() async {
+    final sz = _circlingViewSize;
+    if (sz == null) return;
+    final circles = await IrisEngineService.detectCirclesForView(
+      _activeImage.imagePath,
+      viewW: sz.width,
+      viewH: sz.height,
+    );
+    if (!mounted) return;
+    if (circles == null) {
+      ToastService.showError(
+        context,
+        title: "Auto detect",
+        message: "No iris found. Place the circles manually.",
+      );
+      return;
+    }
+    setState(() {
+      _outerRadiusVal = circles.outerR.clamp(0.0, 1.0);
+      _innerRadiusVal = circles.innerR.clamp(0.0, _outerRadiusVal);
+      _ovalRatio = 1.0;
+      _outerCircleOffset = Offset(circles.outerDx, circles.outerDy);
+      _innerCircleOffset = Offset(circles.innerDx, circles.innerDy);
+    });
+    _updateCutPreview(fullResolution: true);
+  }
+
   void _resetSelection() {
     setState(() {
       _resetTools();
@@ -489,14 +676,25 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
           ovalRatio: _ovalRatio,
           outerCenterOffset: _outerCircleOffset,
           innerCenterOffset: _innerCircleOffset,
-          onOuterPan: (dx, dy) =>
-              setState(() => _outerCircleOffset += Offset(dx, dy)),
-          onInnerPan: (dx, dy) =>
-              setState(() => _innerCircleOffset += Offset(dx, dy)),
-          onOuterRadiusChange: (v) => setState(() => _outerRadiusVal = v),
-          onInnerRadiusChange: (v) =>
-              setState(() => _innerRadiusVal = v.clamp(0.0, _outerRadiusVal)),
+          cutPreview: _cutPreview,
+          onOuterPan: (dx, dy) {
+            setState(() => _outerCircleOffset += Offset(dx, dy));
+            _updateCutPreview(fullResolution: false);
+          },
+          onInnerPan: (dx, dy) {
+            setState(() => _innerCircleOffset += Offset(dx, dy));
+            _updateCutPreview(fullResolution: false);
+          },
+          onOuterRadiusChange: (v) {
+            setState(() => _outerRadiusVal = v);
+            _updateCutPreview(fullResolution: false);
+          },
+          onInnerRadiusChange: (v) {
+            setState(() => _innerRadiusVal = v.clamp(0.0, _outerRadiusVal));
+            _updateCutPreview(fullResolution: false);
+          },
           onOvalRatioChange: (ratio) => setState(() => _ovalRatio = ratio),
+          onDragEnd: () => _updateCutPreview(fullResolution: true),
           onLayoutSize: (s) => WidgetsBinding.instance.addPostFrameCallback((_) {
             if (mounted) setState(() => _circlingViewSize = s);
           }),
@@ -554,9 +752,19 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
                   letterSpacing: 1.2,
                 ),
               ),
-              Text(
-                "${_projectImages.where((i) => i.isFullyEdited).length}/${_projectImages.length} done",
-                style: const TextStyle(color: Colors.grey, fontSize: 12),
+              Row(
+                children: [
+                  if (IrisEngineService.isBatchAvailable && !_allImagesDone)
+                    IconButton(
+                      tooltip: "Process all pending images",
+                      icon: const Icon(Icons.playlist_play, color: Colors.grey, size: 20),
+                      onPressed: _isProcessing ? null : _processQueue,
+                    ),
+                  Text(
+                    "${_projectImages.where((i) => i.isFullyEdited).length}/${_projectImages.length} done",
+                    style: const TextStyle(color: Colors.grey, fontSize: 12),
+                  ),
+                ],
               ),
             ],
           ),
@@ -728,6 +936,14 @@ class _IrisEditingScreenState extends State<IrisEditingScreen> {
                 onChanged: (val) => setState(() => _ovalRatio = 0.5 + val),
               ),
             ),
+            if (IrisEngineService.isCircleDetectionAvailable) ...[
+              const Gap(16),
+              TextButton.icon(
+                onPressed: _circlingViewSize == null ? null : _autoDetectCircles,
+                icon: const Icon(Icons.center_focus_strong, color: Colors.grey, size: 20),
+                label: const Text("Auto", style: TextStyle(color: Colors.grey)),
+              ),
+            ],
             const Gap(16),
             TextButton.icon(
               onPressed: _resetSelection,
@@ -1,4 +1,5 @@
 import 'dart:io';
+import 'dart:ui' as ui;
 import 'package:flutter/material.dart';
 import 'package:iris_designer/Features/EDITOR/Domain/entities/iris_image.dart';
 
@@ -17,6 +18,10 @@ class CirclingView extends StatefulWidget {
   final void Function(double r) onInnerRadiusChange;
   final void Function(double ratio) onOvalRatioChange;
   final void Function(Size size)? onLayoutSize;
+  /// Live cut of the current circles, shown as an inset while placing them.
+  final ui.Image? cutPreview;
+  /// Called when a circle move or resize ends.
+  final VoidCallback? onDragEnd;
 
   const CirclingView({
     super.key,
@@ -32,6 +37,8 @@ class CirclingView extends StatefulWidget {
     required this.onInnerRadiusChange,
     required this.onOvalRatioChange,
     this.onLayoutSize,
+    this.cutPreview,
+    this.onDragEnd,
   });
 
   @override
@@ -119,7 +126,11 @@ class _CirclingViewState extends State<CirclingView> {
               }
             }
           },
-          onPanEnd: (_) => _mode = _DragMode.none,
+          onPanEnd: (_) {
+            final wasDragging = _mode != _DragMode.none;
+            _mode = _DragMode.none;
+            if (wasDragging) widget.onDragEnd?.call();
+          },
           behavior: HitTestBehavior.opaque,
           child: Stack(
             children: [
@@ -134,6 +145,26 @@ class _CirclingViewState extends State<CirclingView> {
                 size: Size.infinite,
                 painter: _OverlayPainter(outerCenter, innerCenter, or, ir, widget.ovalRatio),
               ),
+              if (widget.cutPreview != null)
+                Positioned(
+                  top: 12,
+                  right: 12,
+                  width: shortestSide * 0.3,
+                  height: shortestSide * 0.3,
+                  child: IgnorePointer(
+                    child: DecoratedBox(
+                      decoration: BoxDecoration(
+                        color: Colors.black54,
+                        border: Border.all(color: Colors.white24),
+                        borderRadius: BorderRadius.circular(8),
+                      ),
+                      child: Padding(
+                        padding: const EdgeInsets.all(6),
+                        child: RawImage(image: widget.cutPreview, fit: BoxFit.contain),
+                      ),
+                    ),
+                  ),
+                ),
             ],
           ),
         );
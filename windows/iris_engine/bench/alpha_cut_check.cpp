@@ -0,0 +1,118 @@
+/**
+ * Iris Engine — Span alpha cut equivalence check (2026).
+ *
+ * Cuts randomized annuli (centres on and off the image, pupils on and off, hard and
+ * anti-aliased edges) into random RGBA images three ways: a full span pass, a re-cut
+ * from a previous annulus, and a brute-force per-pixel reference. All three must match
+ * bit for bit, and RGB must be untouched. Exit status 0 = all equal, 1 = a mismatch.
+ *
+ *   iris_alpha_cut_check [iterations=2000] [seed=1]
+ */
+
+#include "iris_alpha_cut.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+/** The cut's definition, one pixel at a time (see apply_annulus_alpha). */
+void reference_cut(std::vector<uint8_t>& rgba, int width, int height, const std::vector<uint8_t>& base,
+                   const iris::AlphaAnnulus& a) {
+  const double ramp = a.antialias ? 0.5 : 0.0;
+  auto inside = [](double dx, double dy, double r) { return r > 0 && dx * dx + dy * dy <= r * r; };
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const double dx = x - a.cx, dy = y - a.cy;
+      const double pdx = x - a.pupil_cx, pdy = y - a.pupil_cy;
+      const bool has_pupil = a.pupil_r > 0;
+      const size_t i = static_cast<size_t>(y) * width + x;
+      uint8_t& out = rgba[i * 4 + 3];
+      if (!inside(dx, dy, a.r + ramp) || (has_pupil && inside(pdx, pdy, a.pupil_r - ramp))) {
+        out = 0;
+      } else if (inside(dx, dy, a.r - ramp) && !(has_pupil && inside(pdx, pdy, a.pupil_r + ramp))) {
+        out = base[i];
+      } else {
+        const double outer = std::clamp(a.r + 0.5 - std::sqrt(dx * dx + dy * dy), 0.0, 1.0);
+        const double hole =
+            has_pupil ? std::clamp(a.pupil_r + 0.5 - std::sqrt(pdx * pdx + pdy * pdy), 0.0, 1.0) : 0.0;
+        out = static_cast<uint8_t>(std::lround(base[i] * outer * (1.0 - hole)));
+      }
+    }
+  }
+}
+
+iris::AlphaAnnulus random_annulus(std::mt19937& rng, int width, int height, bool antialias) {
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  const double extent = std::max(width, height);
+  iris::AlphaAnnulus a;
+  a.cx = (unit(rng) * 1.4 - 0.2) * width;
+  a.cy = (unit(rng) * 1.4 - 0.2) * height;
+  // Some radii land on whole and half pixels, where the edge predicates are tightest.
+  a.r = unit(rng) < 0.2 ? std::round(unit(rng) * extent * 2.0) * 0.5 : unit(rng) * extent * 0.8;
+  if (unit(rng) < 0.8) {
+    a.pupil_cx = a.cx + (unit(rng) - 0.5) * a.r * 0.3;
+    a.pupil_cy = a.cy + (unit(rng) - 0.5) * a.r * 0.3;
+    a.pupil_r = unit(rng) * a.r * 0.7;
+  }
+  a.antialias = antialias;
+  return a;
+}
+
+bool same(const std::vector<uint8_t>& got, const std::vector<uint8_t>& want, int width, const char* what,
+          int iteration) {
+  for (size_t i = 0; i < got.size(); ++i) {
+    if (got[i] != want[i]) {
+      const size_t px = i / 4;
+      std::fprintf(stderr, "iteration %d: %s differs at (%zu, %zu) channel %zu: %d != %d\n", iteration, what,
+                   px % width, px / width, i % 4, got[i], want[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+  const unsigned seed = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1u;
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> size(1, 160);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  int failures = 0;
+  for (int it = 0; it < iterations; ++it) {
+    const int width = size(rng), height = size(rng);
+    const size_t count = static_cast<size_t>(width) * height;
+    std::vector<uint8_t> source(count * 4);
+    for (uint8_t& v : source) v = static_cast<uint8_t>(byte(rng));
+    std::vector<uint8_t> base(count);
+    iris::extract_alpha(source.data(), static_cast<size_t>(width) * 4, width, height, base.data(), 1);
+
+    const bool antialias = (it & 1) != 0;
+    const iris::AlphaAnnulus previous = random_annulus(rng, width, height, antialias);
+    const iris::AlphaAnnulus next = random_annulus(rng, width, height, antialias);
+    const int threads = 1 + it % 4;
+    const size_t stride = static_cast<size_t>(width) * 4;
+
+    std::vector<uint8_t> want = source;
+    reference_cut(want, width, height, base, next);
+
+    std::vector<uint8_t> full = source;
+    iris::apply_annulus_alpha(full.data(), stride, width, height, base.data(), next, nullptr, threads);
+
+    std::vector<uint8_t> recut = source;
+    iris::apply_annulus_alpha(recut.data(), stride, width, height, base.data(), previous, nullptr, threads);
+    iris::apply_annulus_alpha(recut.data(), stride, width, height, base.data(), next, &previous, threads);
+
+    if (!same(full, want, width, "full pass", it) || !same(recut, want, width, "re-cut", it)) ++failures;
+  }
+  std::printf("%d iterations, %d mismatches (seed %u)\n", iterations, failures, seed);
+  return failures == 0 ? 0 : 1;
+}
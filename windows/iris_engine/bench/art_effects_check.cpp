@@ -0,0 +1,119 @@
+/**
+ * Iris Engine — Solo effect determinism check (2026).
+ *
+ * Renders every solo effect around randomized synthetic cut irises (sizes, off-centre
+ * discs, intensities 0..2, full size and preview canvases) at 1 thread, again at several
+ * thread counts, and again with the same seed. All renders must match bit for bit, and
+ * the seeded effects (Dust, Sun) must change with the seed. Exit status 0 = all equal,
+ * 1 = a mismatch.
+ *
+ *   iris_art_effects_check [iterations=40] [seed=1]
+ */
+
+#include "iris_art_effects.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+/** A noisy opaque disc on a transparent background, with an anti-aliased edge. */
+std::vector<uint8_t> synthetic_iris(std::mt19937& rng, int width, int height) {
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::uniform_int_distribution<int> byte(0, 255);
+  const double r = std::min(width, height) * (0.25 + 0.2 * unit(rng));
+  const double cx = r + (width - 2 * r) * unit(rng), cy = r + (height - 2 * r) * unit(rng);
+  std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4, 0);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      uint8_t* px = rgba.data() + (static_cast<size_t>(y) * width + x) * 4;
+      const double coverage = std::clamp(r + 0.5 - std::hypot(x + 0.5 - cx, y + 0.5 - cy), 0.0, 1.0);
+      for (int c = 0; c < 3; ++c) px[c] = static_cast<uint8_t>(byte(rng));
+      px[3] = static_cast<uint8_t>(std::lround(255 * coverage));
+    }
+  }
+  return rgba;
+}
+
+bool render(const std::vector<uint8_t>& rgba, int width, int height, const iris::SoloEffectParams& params,
+            std::vector<uint8_t>& out) {
+  iris::SoloEffectCanvas canvas;
+  return iris::solo_effect_canvas(rgba.data(), width, height, params, &canvas) &&
+         iris::apply_solo_effect(rgba.data(), width, height, params, canvas, out);
+}
+
+bool same(const std::vector<uint8_t>& got, const std::vector<uint8_t>& want, const char* what, int iteration,
+          int effect) {
+  if (got.size() != want.size()) {
+    std::fprintf(stderr, "iteration %d effect %d: %s size %zu != %zu\n", iteration, effect, what, got.size(),
+                 want.size());
+    return false;
+  }
+  for (size_t i = 0; i < got.size(); ++i) {
+    if (got[i] != want[i]) {
+      std::fprintf(stderr, "iteration %d effect %d: %s differs at byte %zu: %d != %d\n", iteration, effect, what, i,
+                   got[i], want[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 40;
+  const unsigned seed = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1u;
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> size(24, 200);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  int failures = 0;
+  for (int it = 0; it < iterations; ++it) {
+    const int width = size(rng), height = size(rng);
+    const std::vector<uint8_t> source = synthetic_iris(rng, width, height);
+    for (int e = 0; e <= static_cast<int>(iris::SoloEffect::kExplosion); ++e) {
+      iris::SoloEffectParams params;
+      params.effect = static_cast<iris::SoloEffect>(e);
+      params.seed = static_cast<uint32_t>(rng());
+      params.extent = 1 + unit(rng);
+      params.intensity = 2 * unit(rng);
+      params.size = 0.05 + 0.6 * unit(rng);
+      params.max_side = (it & 1) ? 64 + static_cast<int>(unit(rng) * 128) : 0;
+      params.num_threads = 1;
+
+      std::vector<uint8_t> want;
+      if (!render(source, width, height, params, want)) {
+        std::fprintf(stderr, "iteration %d effect %d: render failed\n", it, e);
+        ++failures;
+        continue;
+      }
+      bool ok = true;
+      for (int threads : {2, 3, 8}) {
+        params.num_threads = threads;
+        std::vector<uint8_t> got;
+        ok = ok && render(source, width, height, params, got) && same(got, want, "threaded render", it, e);
+      }
+      std::vector<uint8_t> repeat;
+      ok = ok && render(source, width, height, params, repeat) && same(repeat, want, "repeat", it, e);
+
+      if (ok && params.intensity > 0.25 &&
+          (params.effect == iris::SoloEffect::kDust || params.effect == iris::SoloEffect::kSun)) {
+        params.seed ^= 0x5bd1e995u;
+        std::vector<uint8_t> reseeded;
+        if (!render(source, width, height, params, reseeded) || reseeded == want) {
+          std::fprintf(stderr, "iteration %d effect %d: a new seed gave the same image\n", it, e);
+          ok = false;
+        }
+      }
+      if (!ok) ++failures;
+    }
+  }
+  std::printf("%d iterations, %d mismatches (seed %u)\n", iterations, failures, seed);
+  return failures == 0 ? 0 : 1;
+}
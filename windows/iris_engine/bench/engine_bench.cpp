@@ -0,0 +1,356 @@
+/**
+ * Iris Engine — Phase benchmark over the public C API (2026).
+ *
+ * Renders a synthetic eye photo with a known iris and pupil circle and a scatter of
+ * flash highlights at each size. It then times every engine phase through the same FFI
+ * entry points the app calls: RGBA load and read-back, grayscale, circle detection,
+ * flash removal, effects, and the file cut (cold, right after a cache purge, and warm).
+ * For each phase and size it records the best and the median of N runs.
+ *
+ * Results are written as JSON (stdout, or --out). With --baseline, every result is
+ * compared with the same phase and size in an earlier run. The exit status is 2 when any
+ * median is slower than the baseline by more than the tolerance, when detection error
+ * grows by more than --error-tolerance px, or when a baseline phase and size is missing
+ * from this run (it failed or was not measured). It is 1 when the baseline cannot be read.
+ *
+ *   iris_engine_bench [--sizes 2,12,24,48] [--repeats 5] [--threads 0]
+ *                     [--out results.json] [--baseline base.json] [--tolerance 0.15]
+ *                     [--error-tolerance 0.5]
+ */
+
+#include "iris_engine_ffi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+struct Options {
+  std::vector<double> megapixels = {2, 12, 24, 48};
+  int repeats = 5;
+  int threads = 0;
+  std::string out_path;
+  std::string baseline_path;
+  double tolerance = 0.15;
+  double error_tolerance = 0.5;  // px of detection error
+};
+
+/** A synthetic photo and the circles it was drawn with. */
+struct EyePhoto {
+  int width = 0, height = 0;
+  std::vector<uint8_t> rgba;
+  double cx = 0, cy = 0, iris_r = 0, pupil_r = 0;
+  std::string path;  // PNG copy for the file-based cut
+};
+
+/**
+ * Skin-toned surround, white sclera, a fibred iris with a dark limbal ring, a dark pupil
+ * and ~40 flash specks plus one bloom over the iris. The iris sits off centre, as in a
+ * hand-held macro shot, so detection cannot win by guessing the middle.
+ */
+EyePhoto render_eye(double megapixels) {
+  EyePhoto e;
+  e.width = std::max(64, static_cast<int>(std::lround(std::sqrt(megapixels * 1e6 * 4.0 / 3.0))));
+  e.height = std::max(48, static_cast<int>(std::lround(e.width * 3.0 / 4.0)));
+  const int short_side = std::min(e.width, e.height);
+  e.cx = e.width * 0.53;
+  e.cy = e.height * 0.48;
+  e.iris_r = short_side * 0.3;
+  e.pupil_r = e.iris_r * 0.34;
+  const double sclera_rx = e.iris_r * 2.4, sclera_ry = e.iris_r * 1.25;
+
+  e.rgba.resize(static_cast<size_t>(e.width) * static_cast<size_t>(e.height) * 4);
+  for (int y = 0; y < e.height; ++y) {
+    uint8_t* p = e.rgba.data() + static_cast<size_t>(y) * static_cast<size_t>(e.width) * 4;
+    for (int x = 0; x < e.width; ++x, p += 4) {
+      const double dx = x + 0.5 - e.cx, dy = y + 0.5 - e.cy;
+      const double d = std::sqrt(dx * dx + dy * dy);
+      double r = 0, g = 0, b = 0;
+      if (d < e.pupil_r) {
+        r = g = b = 0.05;
+      } else if (d < e.iris_r) {
+        const double t = (d - e.pupil_r) / (e.iris_r - e.pupil_r);
+        const double a = std::atan2(dy, dx);
+        const double fibres = 0.5 + 0.25 * std::sin(a * 90.0) + 0.15 * std::sin(a * 37.0 + t * 9.0);
+        const double shade = (0.3 + 0.45 * fibres) * (1.0 - 0.6 * std::pow(t, 8.0));
+        r = shade * 0.45, g = shade * 0.7, b = shade * 0.9;
+      } else if ((dx * dx) / (sclera_rx * sclera_rx) + (dy * dy) / (sclera_ry * sclera_ry) < 1) {
+        r = 0.92, g = 0.9, b = 0.88;
+      } else {
+        r = 0.78, g = 0.6, b = 0.5;
+      }
+      p[0] = cv::saturate_cast<uint8_t>(255.0 * r);
+      p[1] = cv::saturate_cast<uint8_t>(255.0 * g);
+      p[2] = cv::saturate_cast<uint8_t>(255.0 * b);
+      p[3] = 255;
+    }
+  }
+
+  cv::Mat view(e.height, e.width, CV_8UC4, e.rgba.data());
+  cv::RNG rng(0x1A15);
+  const int speck_r = std::max(2, short_side / 300);
+  for (int i = 0; i < 40; ++i) {
+    const double a = rng.uniform(0.0, 2.0 * kPi), r = rng.uniform(0.4, 0.9) * e.iris_r;
+    cv::circle(view, cv::Point(static_cast<int>(e.cx + r * std::cos(a)), static_cast<int>(e.cy + r * std::sin(a))),
+               speck_r, cv::Scalar(252, 252, 252, 255), cv::FILLED);
+  }
+  cv::circle(view, cv::Point(static_cast<int>(e.cx + e.iris_r * 0.45), static_cast<int>(e.cy - e.iris_r * 0.4)),
+             std::max(3, short_side / 60), cv::Scalar(255, 255, 255, 255), cv::FILLED);
+  return e;
+}
+
+bool write_png(EyePhoto& e, const std::filesystem::path& dir) {
+  cv::Mat bgr;
+  cv::cvtColor(cv::Mat(e.height, e.width, CV_8UC4, e.rgba.data()), bgr, cv::COLOR_RGBA2BGR);
+  char name[64];
+  std::snprintf(name, sizeof(name), "iris_bench_%dx%d.png", e.width, e.height);
+  e.path = (dir / name).string();
+  return cv::imwrite(e.path, bgr, {cv::IMWRITE_PNG_COMPRESSION, 1});
+}
+
+struct Result {
+  std::string phase;
+  double megapixels = 0;
+  int width = 0, height = 0;
+  double best_ms = 0, median_ms = 0;
+  double error_px = -1;      // detect only: worst centre / radius error
+  double vs_baseline = 0;    // median / baseline median; 0 = no baseline entry
+};
+
+/**
+ * Runs [prepare] (untimed) then [body] (timed) [repeats] times. A failing body ends the
+ * phase; the result is then skipped so a broken phase never reads as a fast one.
+ */
+bool time_phase(int repeats, const std::function<bool()>& prepare, const std::function<bool()>& body,
+                Result& result) {
+  std::vector<double> ms;
+  for (int i = 0; i < repeats; ++i) {
+    if (prepare && !prepare()) return false;
+    const auto t0 = std::chrono::steady_clock::now();
+    const bool ok = body();
+    const auto t1 = std::chrono::steady_clock::now();
+    if (!ok) return false;
+    ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+  }
+  std::sort(ms.begin(), ms.end());
+  result.best_ms = ms.front();
+  result.median_ms = ms[ms.size() / 2];
+  return true;
+}
+
+void bench_size(const Options& opt, double megapixels, const std::filesystem::path& dir,
+                std::vector<Result>& results) {
+  EyePhoto e = render_eye(megapixels);
+  const bool have_file = write_png(e, dir);
+  const size_t bytes = e.rgba.size();
+  std::vector<uint8_t> buffer(bytes);
+  IrisEngineHandle handle = iris_engine_create();
+  if (opt.threads > 0) iris_engine_set_threads(handle, opt.threads);
+
+  auto run = [&](const char* phase, const std::function<bool()>& prepare, const std::function<bool()>& body,
+                 double error_px = -1) {
+    Result r;
+    r.phase = phase;
+    r.megapixels = megapixels;
+    r.width = e.width;
+    r.height = e.height;
+    if (!time_phase(opt.repeats, prepare, body, r)) {
+      std::fprintf(stderr, "%-12s %5.1f MP  failed\n", phase, megapixels);
+      return;
+    }
+    r.error_px = error_px;
+    std::fprintf(stderr, "%-12s %5.1f MP  %dx%d  best %10.2f ms  median %10.2f ms\n", phase, megapixels, e.width,
+                 e.height, r.best_ms, r.median_ms);
+    results.push_back(r);
+  };
+  auto load = [&] { return iris_engine_load_rgba(handle, e.rgba.data(), e.width, e.height) != 0; };
+
+  run("load_rgba", nullptr, load);
+  run("get_rgba", load, [&] { return iris_engine_get_rgba(handle, buffer.data(), e.width, e.height) != 0; });
+  run("grayscale", [&] { std::memcpy(buffer.data(), e.rgba.data(), bytes); return true; },
+      [&] { return iris_engine_grayscale_mt(buffer.data(), e.width, e.height, opt.threads) != 0; });
+
+  IrisCircle iris{}, pupil{};
+  auto detect = [&] { return iris_engine_detect_circles(handle, &iris, &pupil) != 0; };
+  if (load() && detect()) {
+    const double error = std::max({std::hypot(iris.center_x - e.cx, iris.center_y - e.cy),
+                                   std::abs(iris.radius - e.iris_r), std::abs(pupil.radius - e.pupil_r)});
+    run("detect", load, detect, error);
+  } else {
+    std::fprintf(stderr, "%-12s %5.1f MP  failed\n", "detect", megapixels);
+  }
+
+  run("remove_flash", load, [&] { return iris_engine_remove_flash(handle, 0.95f, 3) != 0; });
+  run("effects", load, [&] { return iris_engine_apply_effects(handle, 1.2f, 1.1f, 1.5f, 1.0f) != 0; });
+
+  if (have_file) {
+    auto cut = [&] {
+      uint8_t* out = nullptr;
+      int32_t w = 0, h = 0;
+      const int ok = iris_engine_process_iris_cut(e.path.c_str(), e.cx, e.cy, e.iris_r, e.cx, e.cy, e.pupil_r,
+                                                  &out, &w, &h);
+      iris_engine_free(out);
+      return ok != 0;
+    };
+    run("cut_cold", [&] { iris_engine_cache_purge(e.path.c_str()); return true; }, cut);
+    run("cut", nullptr, cut);
+    iris_engine_cache_purge(e.path.c_str());
+    std::error_code ec;
+    std::filesystem::remove(e.path, ec);
+  } else {
+    std::fprintf(stderr, "cut          %5.1f MP  skipped: could not write %s\n", megapixels, e.path.c_str());
+  }
+  iris_engine_destroy(handle);
+}
+
+/**
+ * Fills vs_baseline from [path]; returns the number of regressions: medians slower than
+ * the tolerance, detection error worse by more than [error_tolerance] px, and baseline
+ * (phase, size) entries this run did not produce. -1 when the baseline cannot be read.
+ */
+int compare_with_baseline(const std::string& path, double tolerance, double error_tolerance,
+                          std::vector<Result>& results) {
+  cv::FileStorage fs(path, cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+  const cv::FileNode base = fs.isOpened() ? fs["results"] : cv::FileNode();
+  if (!fs.isOpened() || !base.isSeq()) {
+    std::fprintf(stderr, "baseline: cannot read %s\n", path.c_str());
+    return -1;
+  }
+  int regressions = 0;
+  for (size_t i = 0; i < base.size(); ++i) {
+    const cv::FileNode b = base[static_cast<int>(i)];
+    const std::string phase = b["phase"].string();
+    const double megapixels = static_cast<double>(b["megapixels"]);
+    auto it = std::find_if(results.begin(), results.end(), [&](const Result& r) {
+      return r.phase == phase && std::abs(megapixels - r.megapixels) <= 1e-6;
+    });
+    if (it == results.end()) {
+      ++regressions;
+      std::fprintf(stderr, "%-12s %5.1f MP  missing from this run  REGRESSION\n", phase.c_str(), megapixels);
+      continue;
+    }
+    Result& r = *it;
+    const double base_ms = static_cast<double>(b["median_ms"]);
+    if (base_ms > 0) {
+      r.vs_baseline = r.median_ms / base_ms;
+      const bool slow = r.vs_baseline > 1 + tolerance;
+      regressions += slow ? 1 : 0;
+      std::fprintf(stderr, "%-12s %5.1f MP  %10.2f -> %10.2f ms  x%.2f%s\n", r.phase.c_str(), r.megapixels,
+                   base_ms, r.median_ms, r.vs_baseline, slow ? "  REGRESSION" : "");
+    }
+    if (!b["error_px"].empty() && r.error_px >= 0) {
+      const double base_error = static_cast<double>(b["error_px"]);
+      if (r.error_px > base_error + error_tolerance) {
+        ++regressions;
+        std::fprintf(stderr, "%-12s %5.1f MP  error %.2f -> %.2f px  REGRESSION\n", r.phase.c_str(),
+                     r.megapixels, base_error, r.error_px);
+      }
+    }
+  }
+  return regressions;
+}
+
+void write_json(FILE* f, const Options& opt, const std::vector<Result>& results, int regressions) {
+  std::fprintf(f, "{\n  \"bench\": \"iris_engine_bench\",\n  \"repeats\": %d,\n  \"threads\": %d,\n", opt.repeats,
+               opt.threads);
+  if (!opt.baseline_path.empty()) {
+    std::fprintf(f, "  \"tolerance\": %.3f,\n  \"regressions\": %d,\n", opt.tolerance, regressions);
+  }
+  std::fprintf(f, "  \"results\": [");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    std::fprintf(f,
+                 "%s\n    {\"phase\": \"%s\", \"megapixels\": %g, \"width\": %d, \"height\": %d, "
+                 "\"best_ms\": %.3f, \"median_ms\": %.3f",
+                 i ? "," : "", r.phase.c_str(), r.megapixels, r.width, r.height, r.best_ms, r.median_ms);
+    if (r.error_px >= 0) std::fprintf(f, ", \"error_px\": %.3f", r.error_px);
+    if (r.vs_baseline > 0) std::fprintf(f, ", \"vs_baseline\": %.3f", r.vs_baseline);
+    std::fprintf(f, "}");
+  }
+  std::fprintf(f, "\n  ]\n}\n");
+}
+
+bool parse_options(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) return false;
+    const char* value = argv[++i];
+    if (arg == "--sizes") {
+      opt.megapixels.clear();
+      for (const char* p = value; *p;) {
+        char* end = nullptr;
+        const double mp = std::strtod(p, &end);
+        if (end == p || mp <= 0) return false;
+        opt.megapixels.push_back(mp);
+        p = *end == ',' ? end + 1 : end;
+      }
+    } else if (arg == "--repeats") {
+      opt.repeats = std::max(1, std::atoi(value));
+    } else if (arg == "--threads") {
+      opt.threads = std::max(0, std::atoi(value));
+    } else if (arg == "--out") {
+      opt.out_path = value;
+    } else if (arg == "--baseline") {
+      opt.baseline_path = value;
+    } else if (arg == "--tolerance") {
+      opt.tolerance = std::max(0.0, std::atof(value));
+    } else if (arg == "--error-tolerance") {
+      opt.error_tolerance = std::max(0.0, std::atof(value));
+    } else {
+      return false;
+    }
+  }
+  return !opt.megapixels.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parse_options(argc, argv, opt)) {
+    std::fprintf(stderr,
+                 "usage: iris_engine_bench [--sizes 2,12,24,48] [--repeats 5] [--threads 0]\n"
+                 "                         [--out results.json] [--baseline base.json] [--tolerance 0.15]\n"
+                 "                         [--error-tolerance 0.5]\n");
+    return 1;
+  }
+  if (iris_engine_init() != 0) {
+    std::fprintf(stderr, "iris_engine_init failed\n");
+    return 1;
+  }
+  if (opt.threads > 0) iris_engine_set_default_threads(opt.threads);
+
+  std::error_code ec;
+  std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+  if (ec) dir = ".";
+  std::vector<Result> results;
+  for (double mp : opt.megapixels) bench_size(opt, mp, dir, results);
+
+  const int regressions = opt.baseline_path.empty()
+                              ? 0
+                              : compare_with_baseline(opt.baseline_path, opt.tolerance, opt.error_tolerance, results);
+
+  FILE* out = opt.out_path.empty() ? stdout : std::fopen(opt.out_path.c_str(), "w");
+  if (!out) {
+    std::fprintf(stderr, "cannot write %s\n", opt.out_path.c_str());
+    return 1;
+  }
+  write_json(out, opt, results, std::max(0, regressions));
+  if (out != stdout) std::fclose(out);
+  if (regressions < 0) return 1;
+  return regressions > 0 ? 2 : 0;
+}
@@ -0,0 +1,523 @@
+/**
+ * Iris Engine — Headless batch driver (2026).
+ *
+ * Runs a JSON job file through the batch runner (iris_batch.h): every image is recorded
+ * as one command buffer (load → cut → flash → effects → export or print export), and the
+ * images run side by side under the RAM budget, as with the app's "Process all".
+ *
+ *   iris_cli job.json [--jobs N] [--threads N] [--budget-mb N] [--report out.json]
+ *                     [--trace trace.json] [--check]
+ *
+ * Job file (paths are relative to the job file; settings in "defaults" apply to every
+ * image that does not set them; a key set to 0 or omitted keeps the engine default):
+ *
+ *   {
+ *     "output_dir": "renders",
+ *     "defaults": {
+ *       "cut": "auto",
+ *       "flash": { "threshold": 0.95, "dilate": 3, "method": "push_pull" },
+ *       "effects": { "vibrance": 1.1, "gamma": 1.0, "sharpness": 0.2, "clarity": 1.2 },
+ *       "print": { "dpi": 600, "width_cm": 60, "interpolation": "lanczos3",
+ *                  "cmyk_profile": "coated_fogra39.icc", "intent": "relative" }
+ *     },
+ *     "images": [
+ *       { "input": "eye_001.jpg" },
+ *       { "input": "eye_002.jpg", "output": "eye_002_poster.tif",
+ *         "circles": { "iris_cx": 2011, "iris_cy": 1498, "iris_r": 870, "pupil_r": 260 } }
+ *     ]
+ *   }
+ *
+ * "cut" is "auto" (Hough detection, then the alpha cut; "iris_radius_scale" scales the
+ * circle) or "none". "circles" gives the circles in image pixels and runs the radial
+ * warp instead. Without "print", the image is written by "export" ("format", "quality"),
+ * PNG by default. The default output is <output_dir or input dir>/<input name>_iris with
+ * the extension of the chosen format: export.format (.png when unset), or print.format
+ * (.tif unless it is "png"). When two images would get the same default output (inputs
+ * with the same name from different folders, or eye.jpg next to eye.png), the later one
+ * gets a _2, _3, ... suffix. Two images naming the same "output" is an error.
+ *
+ * Exit status: 0 when every image succeeded, 1 when some failed, 2 for a bad command
+ * line or job file. The report (stdout, or --report) lists each image's status and times.
+ */
+
+#include "iris_batch.h"
+#include "iris_codec.h"
+#include "iris_color_management.h"
+#include "iris_command_buffer.h"
+#include "iris_inpaint.h"
+#include "iris_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct Options {
+  std::string job_path;
+  std::string report_path;
+  std::string trace_path;
+  iris::BatchOptions batch;
+  bool check_only = false;
+};
+
+/** One image of the job: where it comes from, where it goes, and its recorded edit. */
+struct JobImage {
+  std::string input;
+  std::string output;
+  iris::CommandBuffer edit;
+};
+
+fs::path to_path(const std::string& utf8) {
+  return fs::path(reinterpret_cast<const char8_t*>(utf8.c_str()));
+}
+
+std::string from_path(const fs::path& path) {
+  const std::u8string s = path.u8string();
+  return std::string(s.begin(), s.end());
+}
+
+/** [key] of the image entry, else of "defaults" (an empty node when neither sets it). */
+cv::FileNode setting(const cv::FileNode& image, const cv::FileNode& defaults, const char* key) {
+  const cv::FileNode own = image[key];
+  if (!own.empty() && !own.isNone()) return own;
+  if (defaults.empty() || defaults.isNone()) return own;
+  return defaults[key];
+}
+
+bool has(const cv::FileNode& node) { return !node.empty() && !node.isNone(); }
+
+double number(const cv::FileNode& map, const char* key, double fallback) {
+  const cv::FileNode n = map[key];
+  return (n.isInt() || n.isReal()) ? static_cast<double>(n) : fallback;
+}
+
+std::string text(const cv::FileNode& map, const char* key) {
+  const cv::FileNode n = map[key];
+  return n.isString() ? n.string() : std::string();
+}
+
+/** Maps a name from the job file to a value; *ok is cleared for an unknown name. */
+int named(const std::string& name, std::initializer_list<std::pair<const char*, int>> table, int fallback,
+          bool* ok) {
+  if (name.empty()) return fallback;
+  for (const auto& [key, value] : table) {
+    if (name == key) return value;
+  }
+  *ok = false;
+  return fallback;
+}
+
+iris::Interpolation interpolation_named(const std::string& name, iris::Interpolation fallback, bool* ok) {
+  return static_cast<iris::Interpolation>(named(name,
+                                                {{"nearest", static_cast<int>(iris::Interpolation::kNearest)},
+                                                 {"bilinear", static_cast<int>(iris::Interpolation::kBilinear)},
+                                                 {"bicubic", static_cast<int>(iris::Interpolation::kBicubic)},
+                                                 {"lanczos3", static_cast<int>(iris::Interpolation::kLanczos3)}},
+                                                static_cast<int>(fallback), ok));
+}
+
+iris::ImageFormat format_named(const std::string& name, bool* ok) {
+  return iris::image_format_from_int(named(name,
+                                           {{"auto", 0}, {"png", 1}, {"jpeg", 2}, {"jpg", 2}, {"webp", 3},
+                                            {"tiff", 4}, {"tif", 4}, {"bmp", 5}},
+                                           0, ok));
+}
+
+/** Extension of a default output name; the print export writes TIFF unless told PNG. */
+const char* default_extension(iris::ImageFormat format, bool print) {
+  if (print) return format == iris::ImageFormat::kPng ? ".png" : ".tif";
+  switch (format) {
+    case iris::ImageFormat::kJpeg: return ".jpg";
+    case iris::ImageFormat::kWebp: return ".webp";
+    case iris::ImageFormat::kTiff: return ".tif";
+    case iris::ImageFormat::kBmp: return ".bmp";
+    default: return ".png";
+  }
+}
+
+/** Key under which two output paths name the same file (case-insensitive on Windows). */
+std::string output_key(const fs::path& path) {
+  std::string key = from_path(path.lexically_normal());
+#ifdef _WIN32
+  std::transform(key.begin(), key.end(), key.begin(),
+                 [](char ch) { return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch; });
+#endif
+  return key;
+}
+
+/**
+ * Records the edit of one "images" entry. [outputs] maps the output paths of the entries
+ * before it to their index; a default output that is taken gets a numbered suffix, a named
+ * one is an error. Returns false (with a message in *error) for a setting the engine
+ * cannot run.
+ */
+bool record_image(const cv::FileNode& image, const cv::FileNode& defaults, const fs::path& base_dir,
+                  const fs::path& output_dir, std::map<std::string, size_t>& outputs, size_t index,
+                  JobImage& job, std::string* error) {
+  if (!image.isMap()) {
+    *error = "not an object";
+    return false;
+  }
+  for (const char* key : {"circles", "flash", "effects", "print", "export"}) {
+    if (const cv::FileNode n = setting(image, defaults, key); has(n) && !n.isMap()) {
+      *error = std::string("\"") + key + "\" must be an object";
+      return false;
+    }
+  }
+  job.input = text(image, "input");
+  if (job.input.empty()) {
+    *error = "missing \"input\"";
+    return false;
+  }
+  const fs::path input = base_dir / to_path(job.input);
+  job.input = from_path(input);
+  bool ok = true;
+
+  iris::Command load;
+  load.op = iris::CommandOp::kLoadFile;
+  load.path = job.input;
+  job.edit.record(load);
+
+  // Cut: given circles (radial warp), else automatic detection unless "cut" is "none".
+  const cv::FileNode circles = setting(image, defaults, "circles");
+  const cv::FileNode cut = setting(image, defaults, "cut");
+  const std::string cut_mode = cut.isString() ? cut.string() : std::string("auto");
+  if (has(circles)) {
+    iris::Command c;
+    c.op = iris::CommandOp::kCutCircles;
+    c.geometry.iris_cx = number(circles, "iris_cx", 0);
+    c.geometry.iris_cy = number(circles, "iris_cy", 0);
+    c.geometry.iris_r = number(circles, "iris_r", 0);
+    c.geometry.pupil_r = number(circles, "pupil_r", 0);
+    c.cut_options.interpolation =
+        interpolation_named(text(circles, "interpolation"), iris::Interpolation::kBilinear, &ok);
+    if (!ok) {
+      *error = "unknown circles.interpolation";
+      return false;
+    }
+    job.edit.record(c);
+  } else if (cut_mode == "auto") {
+    iris::Command c;
+    c.op = iris::CommandOp::kCutAuto;
+    const double scale = number(image, "iris_radius_scale", number(defaults, "iris_radius_scale", 0));
+    c.iris_radius_scale = scale > 0 ? static_cast<float>(scale) : 1.0f;
+    job.edit.record(c);
+  } else if (cut_mode != "none") {
+    *error = "\"cut\" must be \"auto\" or \"none\"";
+    return false;
+  }
+
+  const cv::FileNode flash = setting(image, defaults, "flash");
+  if (has(flash)) {
+    iris::Command c;
+    c.op = iris::CommandOp::kRemoveFlash;
+    c.flash.brightness_threshold = static_cast<float>(number(flash, "threshold", 0.95));
+    c.flash.dilate_pixels = static_cast<int>(number(flash, "dilate", 3));
+    c.flash.inpaint_method = iris::inpaint_method_from_int(
+        named(text(flash, "method"), {{"telea", 0}, {"ns", 1}, {"push_pull", 2}}, 0, &ok));
+    const double radius = number(flash, "radius", 0);
+    c.flash.inpaint_radius = radius > 0 ? static_cast<float>(radius) : 3.0f;
+    if (!ok) {
+      *error = "unknown flash.method";
+      return false;
+    }
+    job.edit.record(c);
+  }
+
+  const cv::FileNode effects = setting(image, defaults, "effects");
+  if (has(effects)) {
+    iris::Command c;
+    c.op = iris::CommandOp::kApplyEffects;
+    c.effects.vibrance = static_cast<float>(number(effects, "vibrance", 1.0));
+    c.effects.gamma = static_cast<float>(number(effects, "gamma", 1.0));
+    c.effects.sharpness = static_cast<float>(number(effects, "sharpness", 0.0));
+    c.effects.clarity = static_cast<float>(number(effects, "clarity", 0.0));
+    job.edit.record(c);
+  }
+
+  const cv::FileNode print = setting(image, defaults, "print");
+  const cv::FileNode exporting = setting(image, defaults, "export");
+  iris::Command out;
+  if (has(print)) {
+    out.op = iris::CommandOp::kExportPrint;
+    const double dpi = number(print, "dpi", 0);
+    if (dpi > 0) out.print.dpi = static_cast<int>(dpi);
+    out.print.width_cm = number(print, "width_cm", 0);
+    out.print.format = format_named(text(print, "format"), &ok);
+    out.print.interpolation = interpolation_named(text(print, "interpolation"), out.print.interpolation, &ok);
+    out.print.keep_alpha = number(print, "keep_alpha", 1) != 0;
+    const std::string profile = text(print, "cmyk_profile");
+    if (!profile.empty()) {
+      out.print.cmyk.profile_path = from_path(base_dir / to_path(profile));
+      out.print.cmyk.intent = iris::rendering_intent_from_int(
+          named(text(print, "intent"), {{"perceptual", 0}, {"relative", 1}, {"saturation", 2}, {"absolute", 3}},
+                0, &ok));
+      out.print.cmyk.black_point_compensation = number(print, "black_point_compensation", 1) != 0;
+    }
+    if (!ok) {
+      *error = "unknown print format, interpolation or intent";
+      return false;
+    }
+  } else {
+    out.op = iris::CommandOp::kExportFile;
+    if (has(exporting)) {
+      out.format = static_cast<int>(format_named(text(exporting, "format"), &ok));
+      out.quality = static_cast<int>(number(exporting, "quality", -1));
+    }
+    if (!ok) {
+      *error = "unknown export.format";
+      return false;
+    }
+  }
+
+  const std::string output = text(image, "output");
+  fs::path output_path;
+  if (output.empty()) {
+    const fs::path dir = output_dir.empty() ? input.parent_path() : output_dir;
+    const char* extension =
+        default_extension(has(print) ? out.print.format : iris::image_format_from_int(out.format), has(print));
+    for (int n = 1;; ++n) {
+      fs::path name = input.stem();
+      name += "_iris";
+      if (n > 1) name += "_" + std::to_string(n);
+      name += extension;
+      output_path = dir / name;
+      if (outputs.find(output_key(output_path)) == outputs.end()) break;
+    }
+  } else {
+    output_path = (output_dir.empty() ? base_dir : output_dir) / to_path(output);
+    if (const auto taken = outputs.find(output_key(output_path)); taken != outputs.end()) {
+      *error = "\"output\" is also the output of images[" + std::to_string(taken->second) + "]";
+      return false;
+    }
+  }
+  outputs.emplace(output_key(output_path), index);
+  job.output = from_path(output_path);
+  out.path = job.output;
+  job.edit.record(out);
+
+  const int bad = job.edit.validate(false);
+  if (bad >= 0) {
+    *error = "step " + std::to_string(bad) + " has invalid parameters";
+    return false;
+  }
+  return true;
+}
+
+/** Reads the job file into [images]. Prints the problems and returns false on any. */
+bool read_job(const std::string& job_path, std::vector<JobImage>& images) {
+  const fs::path path = to_path(job_path);
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    std::fprintf(stderr, "iris_cli: cannot read %s\n", job_path.c_str());
+    return false;
+  }
+  const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  cv::FileStorage storage;
+  try {
+    storage = cv::FileStorage(json, cv::FileStorage::READ | cv::FileStorage::MEMORY | cv::FileStorage::FORMAT_JSON);
+  } catch (const cv::Exception& e) {
+    std::fprintf(stderr, "iris_cli: %s is not valid JSON: %s\n", job_path.c_str(), e.what());
+    return false;
+  }
+  if (!storage.isOpened()) {
+    std::fprintf(stderr, "iris_cli: %s is not valid JSON\n", job_path.c_str());
+    return false;
+  }
+
+  const fs::path base_dir = path.parent_path();
+  const cv::FileNode root = storage.root();
+  if (!root.isMap()) {
+    std::fprintf(stderr, "iris_cli: %s must hold one JSON object\n", job_path.c_str());
+    return false;
+  }
+  const std::string output_dir_text = text(root, "output_dir");
+  const fs::path output_dir = output_dir_text.empty() ? fs::path() : base_dir / to_path(output_dir_text);
+  const cv::FileNode defaults = root["defaults"];
+  const cv::FileNode list = root["images"];
+  if (has(defaults) && !defaults.isMap()) {
+    std::fprintf(stderr, "iris_cli: \"defaults\" must be an object\n");
+    return false;
+  }
+  if (!list.isSeq() || list.size() == 0) {
+    std::fprintf(stderr, "iris_cli: %s has no \"images\" list\n", job_path.c_str());
+    return false;
+  }
+
+  bool ok = true;
+  images.resize(list.size());
+  std::map<std::string, size_t> outputs;
+  for (size_t i = 0; i < list.size(); ++i) {
+    std::string error;
+    if (!record_image(list[static_cast<int>(i)], defaults, base_dir, output_dir, outputs, i, images[i], &error)) {
+      std::fprintf(stderr, "iris_cli: images[%zu]: %s\n", i, error.c_str());
+      ok = false;
+    }
+  }
+  if (ok && !output_dir.empty()) {
+    std::error_code ec;
+    fs::create_directories(output_dir, ec);
+    if (ec) {
+      std::fprintf(stderr, "iris_cli: cannot create %s\n", output_dir_text.c_str());
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+/** JSON string literal for [s] (UTF-8 passes through). */
+std::string quoted(const std::string& s) {
+  std::string out = "\"";
+  for (const char ch : s) {
+    if (ch == '"' || ch == '\\') {
+      out += '\\';
+      out += ch;
+    } else if (static_cast<unsigned char>(ch) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(ch));
+      out += buf;
+    } else {
+      out += ch;
+    }
+  }
+  return out + "\"";
+}
+
+bool write_report(const Options& opt, const std::vector<JobImage>& images,
+                  const std::vector<iris::BatchItemResult>& results, double wall_ms) {
+  FILE* f = stdout;
+  if (!opt.report_path.empty()) {
+    f = std::fopen(opt.report_path.c_str(), "wb");
+    if (!f) {
+      std::fprintf(stderr, "iris_cli: cannot write %s\n", opt.report_path.c_str());
+      return false;
+    }
+  }
+  size_t failed = 0;
+  for (const iris::BatchItemResult& r : results) failed += r.ok ? 0 : 1;
+  std::fprintf(f, "{\n  \"job\": %s,\n  \"images\": %zu,\n  \"failed\": %zu,\n  \"wall_ms\": %.1f,\n",
+               quoted(opt.job_path).c_str(), results.size(), failed, wall_ms);
+  std::fprintf(f, "  \"stats\": %s,\n  \"results\": [", iris::stats_to_json(iris::process_stats().snapshot()).c_str());
+  for (size_t i = 0; i < results.size(); ++i) {
+    const iris::BatchItemResult& r = results[i];
+    std::fprintf(f,
+                 "%s\n    {\"input\": %s, \"output\": %s, \"ok\": %s, \"failed_step\": %d, \"width\": %d, "
+                 "\"height\": %d, \"estimated_bytes\": %zu, \"wait_ms\": %.1f, \"load_ms\": %.1f, "
+                 "\"process_ms\": %.1f, \"export_ms\": %.1f, \"total_ms\": %.1f}",
+                 i ? "," : "", quoted(images[i].input).c_str(), quoted(images[i].output).c_str(),
+                 r.ok ? "true" : "false", r.failed_index, r.width, r.height, r.estimated_bytes, r.wait_ms,
+                 r.load_ms, r.process_ms, r.export_ms, r.total_ms);
+  }
+  std::fprintf(f, "\n  ]\n}\n");
+  const bool written = std::ferror(f) == 0;
+  if (f != stdout) std::fclose(f);
+  return written;
+}
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: iris_cli job.json [--jobs N] [--threads N] [--budget-mb N] [--report out.json]\n"
+               "                [--trace trace.json] [--check]\n"
+               "  --jobs       images in flight (default: hardware threads, within the budget)\n"
+               "  --threads    kernel threads per image (default: cores / images in flight)\n"
+               "  --budget-mb  RAM budget for images in flight (default: a quarter of RAM)\n"
+               "  --report     write the JSON report here instead of stdout\n"
+               "  --trace      write a Chrome trace of every engine stage\n"
+               "  --check      validate the job file and exit\n");
+}
+
+bool parse_args(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--check") {
+      opt.check_only = true;
+      continue;
+    }
+    if (arg.rfind("--", 0) != 0) {
+      if (!opt.job_path.empty()) return false;
+      opt.job_path = arg;
+      continue;
+    }
+    if (i + 1 >= argc) return false;
+    const char* value = argv[++i];
+    if (arg == "--jobs") {
+      opt.batch.max_concurrent = std::max(0, std::atoi(value));
+    } else if (arg == "--threads") {
+      opt.batch.threads_per_image = std::max(0, std::atoi(value));
+    } else if (arg == "--budget-mb") {
+      opt.batch.memory_budget_bytes = static_cast<size_t>(std::max(0.0, std::atof(value)) * 1024.0 * 1024.0);
+    } else if (arg == "--report") {
+      opt.report_path = value;
+    } else if (arg == "--trace") {
+      opt.trace_path = value;
+    } else {
+      return false;
+    }
+  }
+  return !opt.job_path.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parse_args(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  std::vector<JobImage> images;
+  if (!read_job(opt.job_path, images)) return 2;
+  if (opt.check_only) {
+    std::fprintf(stderr, "iris_cli: %zu images OK\n", images.size());
+    return 0;
+  }
+
+  std::vector<iris::CommandBuffer> edits;
+  edits.reserve(images.size());
+  for (const JobImage& image : images) edits.push_back(image.edit);
+
+  // Progress comes from the batch runner threads.
+  std::mutex progress_mutex;
+  iris::SubmitHooks hooks;
+  hooks.progress = [&](int done, int total) {
+    std::lock_guard<std::mutex> lock(progress_mutex);
+    std::fprintf(stderr, "\riris_cli: %d/%d images", done, total);
+    if (done == total) std::fprintf(stderr, "\n");
+  };
+
+  if (!opt.trace_path.empty()) iris::trace_start(0);
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<iris::BatchItemResult> results;
+  iris::run_batch(edits, opt.batch, results, hooks);
+  const double wall_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (!opt.trace_path.empty() && !iris::trace_stop(opt.trace_path.c_str())) {
+    std::fprintf(stderr, "iris_cli: cannot write %s\n", opt.trace_path.c_str());
+  }
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (!results[i].ok) {
+      std::fprintf(stderr, "iris_cli: failed %s (step %d)\n", images[i].input.c_str(), results[i].failed_index);
+    }
+  }
+  if (!write_report(opt, images, results, wall_ms)) return 2;
+  const bool all_ok = std::all_of(results.begin(), results.end(), [](const iris::BatchItemResult& r) { return r.ok; });
+  return all_ok ? 0 : 1;
+}
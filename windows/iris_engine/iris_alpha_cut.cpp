@@ -0,0 +1,259 @@
+/**
+ * Iris Engine — Span-based annulus alpha cut — implementation.
+ */
+
+#include "iris_alpha_cut.h"
+#include "iris_thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IRIS_ALPHA_CUT_SSE2 1
+#include <emmintrin.h>
+#else
+#define IRIS_ALPHA_CUT_SSE2 0
+#endif
+
+namespace iris {
+
+namespace {
+
+// Up to 8 edge pairs and 4 ramp zones per annulus, for the old and the new one.
+constexpr int kMaxRowRanges = 24;
+
+/** Pixels [x0, x1) of one row inside a circle. Empty spans sit at the centre column. */
+struct Span {
+  int x0 = 0, x1 = 0;
+  bool contains(int x) const { return x >= x0 && x < x1; }
+};
+
+/** Pixels with (x - cx)^2 + (y - cy)^2 <= r^2 in row y, exactly, clipped to [0, width]. */
+Span circle_span(double cx, double cy, double r, int y, int width) {
+  Span s;
+  const int centre = static_cast<int>(std::clamp(std::floor(cx), 0.0, static_cast<double>(width)));
+  s.x0 = s.x1 = centre;
+  if (r <= 0) return s;
+  const double dy = y - cy;
+  const double rem = r * r - dy * dy;
+  if (rem < 0) return s;
+  auto inside = [&](int x) {
+    const double dx = x - cx;
+    return dx * dx + dy * dy <= r * r;
+  };
+  const double half = std::sqrt(rem);
+  // The square root can be off by an ulp; settle both ends on the exact predicate.
+  int x0 = static_cast<int>(std::ceil(cx - half));
+  int x1 = static_cast<int>(std::floor(cx + half)) + 1;
+  while (inside(x0 - 1)) --x0;
+  while (x0 < x1 && !inside(x0)) ++x0;
+  while (inside(x1)) ++x1;
+  while (x1 > x0 && !inside(x1 - 1)) --x1;
+  if (x0 >= x1) return s;
+  s.x0 = std::clamp(x0, 0, width);
+  s.x1 = std::clamp(x1, 0, width);
+  if (s.x0 >= s.x1) s.x0 = s.x1 = centre;
+  return s;
+}
+
+/**
+ * The four spans of one annulus row. Coverage is 0 outside outer_any or inside
+ * pupil_full, and full inside outer_full but outside pupil_any. It is a ramp in between.
+ * With hard edges the _any and _full spans coincide, so there is no ramp.
+ */
+struct RowSpans {
+  Span outer_any, outer_full, pupil_any, pupil_full;
+
+  RowSpans(const AlphaAnnulus& a, int y, int width) {
+    const double ramp = a.antialias ? 0.5 : 0.0;
+    outer_any = circle_span(a.cx, a.cy, a.r + ramp, y, width);
+    outer_full = a.antialias ? circle_span(a.cx, a.cy, a.r - ramp, y, width) : outer_any;
+    if (a.pupil_r > 0) {
+      pupil_any = circle_span(a.pupil_cx, a.pupil_cy, a.pupil_r + ramp, y, width);
+      pupil_full = a.antialias ? circle_span(a.pupil_cx, a.pupil_cy, a.pupil_r - ramp, y, width) : pupil_any;
+    } else {
+      pupil_any = pupil_full = circle_span(a.pupil_cx, a.pupil_cy, 0.0, y, width);
+    }
+  }
+
+  int edges(int* out) const {
+    const Span* spans[4] = {&outer_any, &outer_full, &pupil_any, &pupil_full};
+    for (int i = 0; i < 4; ++i) {
+      out[2 * i] = spans[i]->x0;
+      out[2 * i + 1] = spans[i]->x1;
+    }
+    return 8;
+  }
+
+  enum Class { kClear, kKeep, kRamp };
+
+  Class classify(int x) const {
+    if (!outer_any.contains(x) || pupil_full.contains(x)) return kClear;
+    if (outer_full.contains(x) && !pupil_any.contains(x)) return kKeep;
+    return kRamp;
+  }
+};
+
+struct Range {
+  int x0, x1;
+};
+
+inline void push_range(Range* ranges, int& n, int a, int b) {
+  if (a > b) std::swap(a, b);
+  if (a < b) ranges[n++] = Range{a, b};
+}
+
+/** Columns of row y whose coverage may differ between [prev] and [next]; returns the count. */
+int changed_ranges(const RowSpans& prev, const RowSpans& next, bool antialias, Range* out) {
+  int n = 0;
+  int pe[8], ne[8];
+  prev.edges(pe);
+  next.edges(ne);
+  for (int k = 0; k < 8; ++k) push_range(out, n, pe[k], ne[k]);
+  if (antialias) {
+    // Ramp values depend on the exact circles, so both ramps are rewritten.
+    for (const RowSpans* s : {&prev, &next}) {
+      push_range(out, n, s->outer_any.x0, s->outer_full.x0);
+      push_range(out, n, s->outer_full.x1, s->outer_any.x1);
+      push_range(out, n, s->pupil_any.x0, s->pupil_full.x0);
+      push_range(out, n, s->pupil_full.x1, s->pupil_any.x1);
+    }
+  }
+  std::sort(out, out + n, [](const Range& a, const Range& b) { return a.x0 < b.x0; });
+  int merged = 0;
+  for (int i = 0; i < n; ++i) {
+    if (merged > 0 && out[i].x0 <= out[merged - 1].x1) {
+      out[merged - 1].x1 = std::max(out[merged - 1].x1, out[i].x1);
+    } else {
+      out[merged++] = out[i];
+    }
+  }
+  return merged;
+}
+
+void clear_alpha(uint8_t* px, int count) {
+  int i = 0;
+#if IRIS_ALPHA_CUT_SSE2
+  const __m128i keep_rgb = _mm_set1_epi32(0x00FFFFFF);
+  for (; i + 4 <= count; i += 4) {
+    __m128i* p = reinterpret_cast<__m128i*>(px + static_cast<size_t>(i) * 4);
+    _mm_storeu_si128(p, _mm_and_si128(_mm_loadu_si128(p), keep_rgb));
+  }
+#endif
+  for (; i < count; ++i) px[static_cast<size_t>(i) * 4 + 3] = 0;
+}
+
+void copy_alpha(uint8_t* px, const uint8_t* alpha, int count) {
+  int i = 0;
+#if IRIS_ALPHA_CUT_SSE2
+  const __m128i keep_rgb = _mm_set1_epi32(0x00FFFFFF);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= count; i += 4) {
+    int32_t a4;
+    std::memcpy(&a4, alpha + i, sizeof(a4));
+    __m128i a = _mm_cvtsi32_si128(a4);
+    a = _mm_unpacklo_epi16(_mm_unpacklo_epi8(a, zero), zero);
+    __m128i* p = reinterpret_cast<__m128i*>(px + static_cast<size_t>(i) * 4);
+    const __m128i rgb = _mm_and_si128(_mm_loadu_si128(p), keep_rgb);
+    _mm_storeu_si128(p, _mm_or_si128(rgb, _mm_slli_epi32(a, 24)));
+  }
+#endif
+  for (; i < count; ++i) px[static_cast<size_t>(i) * 4 + 3] = alpha[i];
+}
+
+/** Ramp pixels: linear coverage over one pixel across each circle, at the pixel centre. */
+void ramp_alpha(uint8_t* px, const uint8_t* alpha, const AlphaAnnulus& a, int y, int x0, int x1) {
+  const double dy = y - a.cy;
+  const double pdy = y - a.pupil_cy;
+  for (int x = x0; x < x1; ++x) {
+    const double dx = x - a.cx;
+    const double pdx = x - a.pupil_cx;
+    const double outer = std::clamp(a.r + 0.5 - std::sqrt(dx * dx + dy * dy), 0.0, 1.0);
+    const double hole =
+        a.pupil_r > 0 ? std::clamp(a.pupil_r + 0.5 - std::sqrt(pdx * pdx + pdy * pdy), 0.0, 1.0) : 0.0;
+    px[static_cast<size_t>(x) * 4 + 3] =
+        static_cast<uint8_t>(std::lround(alpha[x] * outer * (1.0 - hole)));
+  }
+}
+
+/** Writes columns [x0, x1) of one row, span by span between the row's edges. */
+void write_row(uint8_t* row, const uint8_t* alpha, const AlphaAnnulus& a, const RowSpans& spans, int y,
+               int x0, int x1) {
+  int cuts[10];
+  spans.edges(cuts);
+  cuts[8] = x0;
+  cuts[9] = x1;
+  std::sort(cuts, cuts + 10);
+  int x = x0;
+  for (int i = 0; i < 10 && x < x1; ++i) {
+    const int end = std::min(cuts[i], x1);
+    if (end <= x) continue;
+    // No edge lies inside (x, end), so one class covers the whole span.
+    switch (spans.classify(x)) {
+      case RowSpans::kClear:
+        clear_alpha(row + static_cast<size_t>(x) * 4, end - x);
+        break;
+      case RowSpans::kKeep:
+        copy_alpha(row + static_cast<size_t>(x) * 4, alpha + x, end - x);
+        break;
+      case RowSpans::kRamp:
+        ramp_alpha(row, alpha, a, y, x, end);
+        break;
+    }
+    x = end;
+  }
+}
+
+/** Rows whose coverage can be non-zero, clipped to the image. */
+void row_bounds(const AlphaAnnulus& a, int height, int& y0, int& y1) {
+  const double reach = a.r + (a.antialias ? 0.5 : 0.0);
+  y0 = static_cast<int>(std::clamp(std::floor(a.cy - reach), 0.0, static_cast<double>(height)));
+  y1 = static_cast<int>(std::clamp(std::ceil(a.cy + reach) + 1.0, 0.0, static_cast<double>(height)));
+}
+
+}  // namespace
+
+void extract_alpha(const uint8_t* rgba, size_t stride, int width, int height, uint8_t* out,
+                   int num_threads) {
+  parallel_for_rows(height, num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) {
+      const uint8_t* s = rgba + static_cast<size_t>(y) * stride + 3;
+      uint8_t* d = out + static_cast<size_t>(y) * static_cast<size_t>(width);
+      for (int x = 0; x < width; ++x, s += 4) d[x] = *s;
+    }
+  });
+}
+
+void apply_annulus_alpha(uint8_t* rgba, size_t stride, int width, int height, const uint8_t* base_alpha,
+                         const AlphaAnnulus& annulus, const AlphaAnnulus* previous, int num_threads) {
+  if (!rgba || !base_alpha || width <= 0 || height <= 0) return;
+  const bool incremental = previous && previous->antialias == annulus.antialias;
+  if (incremental && *previous == annulus) return;
+
+  // A full pass covers every row. A re-cut covers only the rows that either iris reaches,
+  // since both cuts leave every other row fully cleared.
+  int y_begin = 0, y_end = height;
+  if (incremental) {
+    int a0, a1, b0, b1;
+    row_bounds(annulus, height, a0, a1);
+    row_bounds(*previous, height, b0, b1);
+    y_begin = std::min(a0, b0);
+    y_end = std::max(a1, b1);
+  }
+  parallel_for_rows(y_end - y_begin, num_threads, [&](int r0, int r1) {
+    Range ranges[kMaxRowRanges];
+    for (int y = y_begin + r0; y < y_begin + r1; ++y) {
+      uint8_t* row = rgba + static_cast<size_t>(y) * stride;
+      const uint8_t* alpha = base_alpha + static_cast<size_t>(y) * static_cast<size_t>(width);
+      const RowSpans spans(annulus, y, width);
+      if (!incremental) {
+        write_row(row, alpha, annulus, spans, y, 0, width);
+        continue;
+      }
+      const int n = changed_ranges(RowSpans(*previous, y, width), spans, annulus.antialias, ranges);
+      for (int i = 0; i < n; ++i) write_row(row, alpha, annulus, spans, y, ranges[i].x0, ranges[i].x1);
+    }
+  });
+}
+
+}  // namespace iris
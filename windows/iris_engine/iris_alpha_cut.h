@@ -0,0 +1,43 @@
+/**
+ * Iris Engine — Span-based annulus alpha cut (2026).
+ *
+ * The iris cut keeps the pixels inside the iris circle and outside the pupil. Instead
+ * of testing two distances per pixel, each row's inside/outside x-intervals are solved
+ * analytically. Whole spans are then written with SSE2 stores on the interleaved alpha
+ * channel: zero outside, the saved alpha inside. Only the thin edge spans are evaluated
+ * per pixel, and only with anti-aliasing on.
+ *
+ * Alpha is written from a snapshot of the pre-cut alpha, so a re-cut with other circles
+ * restores what an earlier cut removed. A re-cut touches only the columns where the old
+ * and new edges differ, so its cost follows the iris boundary, not the image area.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_ALPHA_CUT_H
+#define IRIS_ENGINE_IRIS_ALPHA_CUT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "iris_engine.h"
+
+namespace iris {
+
+/** Copies the alpha channel of [rgba] into [out] (width * height bytes). */
+void extract_alpha(const uint8_t* rgba, size_t stride, int width, int height, uint8_t* out,
+                   int num_threads = 0);
+
+/**
+ * Sets alpha = base_alpha * coverage(annulus) on [rgba]. Pixel centres sit on integer
+ * coordinates. Hard edges keep the pixels with d(iris) <= r and d(pupil) > pupil_r.
+ * Anti-aliased edges use a one-pixel linear ramp across each circle.
+ *
+ * [previous] is the annulus the current alpha was cut with (from the same [base_alpha]),
+ * or null for a full pass. With it, only the pixels whose coverage can differ are
+ * rewritten. Output is identical either way.
+ */
+void apply_annulus_alpha(uint8_t* rgba, size_t stride, int width, int height, const uint8_t* base_alpha,
+                         const AlphaAnnulus& annulus, const AlphaAnnulus* previous, int num_threads = 0);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_ALPHA_CUT_H
@@ -0,0 +1,606 @@
+/**
+ * Iris Engine — Art Studio effects — implementation.
+ */
+
+#include "iris_art_effects.h"
+#include "iris_premultiplied.h"
+#include "iris_thread_pool.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IRIS_ART_SSE2 1
+#include <emmintrin.h>
+#else
+#define IRIS_ART_SSE2 0
+#endif
+
+namespace iris {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kMaxCanvasSide = 1 << 15;
+constexpr int kSunBins = 4096;
+constexpr int kExplosionTaps = 20;
+
+/** PCG32 (O'Neill): the serial generator for ray and particle tables. */
+class Pcg32 {
+ public:
+  explicit Pcg32(uint32_t seed) {
+    next();
+    state_ += seed;
+    next();
+  }
+  uint32_t next() {
+    const uint64_t old = state_;
+    state_ = old * 6364136223846793005ULL + 1442695040888963407ULL;
+    const uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+    const uint32_t rot = static_cast<uint32_t>(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+  }
+  /** Uniform in [0, 1). */
+  double uniform() { return next() * (1.0 / 4294967296.0); }
+
+ private:
+  uint64_t state_ = 0;
+};
+
+/** Integer hash without multiplies (Wang), so four lanes fit plain SSE2. */
+inline uint32_t hash32(uint32_t key) {
+  key = ~key + (key << 15);
+  key ^= key >> 12;
+  key += key << 2;
+  key ^= key >> 4;
+  key += (key << 3) + (key << 11);
+  key ^= key >> 16;
+  return key;
+}
+
+/** out[i] = hash32(xs[i] ^ row_key): the per-pixel noise of one row. */
+void hash_row(const uint32_t* xs, uint32_t row_key, uint32_t* out, int count) {
+  int i = 0;
+#if IRIS_ART_SSE2
+  const __m128i ones = _mm_set1_epi32(-1);
+  const __m128i rk = _mm_set1_epi32(static_cast<int>(row_key));
+  for (; i + 4 <= count; i += 4) {
+    __m128i k = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i)), rk);
+    k = _mm_add_epi32(_mm_xor_si128(k, ones), _mm_slli_epi32(k, 15));
+    k = _mm_xor_si128(k, _mm_srli_epi32(k, 12));
+    k = _mm_add_epi32(k, _mm_slli_epi32(k, 2));
+    k = _mm_xor_si128(k, _mm_srli_epi32(k, 4));
+    k = _mm_add_epi32(k, _mm_add_epi32(_mm_slli_epi32(k, 3), _mm_slli_epi32(k, 11)));
+    k = _mm_xor_si128(k, _mm_srli_epi32(k, 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), k);
+  }
+#endif
+  for (; i < count; ++i) out[i] = hash32(xs[i] ^ row_key);
+}
+
+/** Writes light [v] (0..1) of [color] as a premultiplied pixel. */
+inline void put_light(uint8_t* px, double v, const uint8_t* color) {
+  v = std::clamp(v, 0.0, 1.0);
+  for (int c = 0; c < 3; ++c) px[c] = static_cast<uint8_t>(std::lround(color[c] * v));
+  px[3] = static_cast<uint8_t>(std::lround(255 * v));
+}
+
+void default_color(SoloEffect effect, uint8_t* color) {
+  static const uint8_t kDefaults[][3] = {
+      {255, 255, 255},  // Pure (unused)
+      {255, 236, 196},  // Halo
+      {255, 250, 240},  // Dust
+      {255, 196, 96},   // Sun
+      {255, 150, 60},   // Explosion flash
+  };
+  std::memcpy(color, kDefaults[static_cast<int>(effect)], 3);
+}
+
+/** Everything a row of the effect pass reads; built once, shared by the bands. */
+struct EffectContext {
+  SoloEffectParams params;
+  uint8_t color[3];
+  int side = 0;
+  double cx = 0, cy = 0, r = 0;  // iris disc, output space
+  double scale = 1;
+  cv::Mat iris;                  // premultiplied iris at output scale
+  int ox = 0, oy = 0;            // iris top-left on the canvas
+  // Sun
+  std::vector<float> ray_strength, ray_length;
+  // Dust
+  std::vector<uint32_t> grain_x;  // source-space column of each output column
+  struct Particle {
+    double x, y, radius, brightness;
+  };
+  std::vector<Particle> particles;
+};
+
+void build_sun_rays(EffectContext& ctx) {
+  Pcg32 rng(ctx.params.seed);
+  const int rays = ctx.params.count > 0 ? ctx.params.count : 36;
+  ctx.ray_strength.assign(kSunBins, 0.0f);
+  ctx.ray_length.assign(kSunBins, 1.0f);
+  for (int k = 0; k < rays; ++k) {
+    const double theta = rng.uniform() * 2 * kPi;
+    const double half_width = (0.15 + 0.85 * rng.uniform()) * kPi / rays;
+    const double strength = 0.35 + 0.65 * rng.uniform();
+    const double length = std::max(0.02, ctx.params.size) * (0.5 + rng.uniform());
+    const int reach = static_cast<int>(std::ceil(3 * half_width / (2 * kPi) * kSunBins));
+    const int centre = static_cast<int>(theta / (2 * kPi) * kSunBins);
+    for (int d = -reach; d <= reach; ++d) {
+      const double dtheta = d * 2 * kPi / kSunBins;
+      const double v = strength * std::exp(-(dtheta * dtheta) / (half_width * half_width));
+      const int bin = ((centre + d) % kSunBins + kSunBins) % kSunBins;
+      if (v > ctx.ray_strength[bin]) {
+        ctx.ray_strength[bin] = static_cast<float>(v);
+        ctx.ray_length[bin] = static_cast<float>(length);
+      }
+    }
+  }
+}
+
+void build_dust(EffectContext& ctx) {
+  ctx.grain_x.resize(static_cast<size_t>(ctx.side));
+  for (int x = 0; x < ctx.side; ++x) {
+    ctx.grain_x[static_cast<size_t>(x)] =
+        static_cast<uint32_t>(static_cast<int32_t>(std::floor((x + 0.5 - ctx.cx) / ctx.scale)));
+  }
+  Pcg32 rng(ctx.params.seed);
+  const int count = ctx.params.count > 0 ? ctx.params.count : 90;
+  const double extent = std::max(1.0, ctx.params.extent);
+  const double scale = std::max(0.02, ctx.params.size);
+  for (int k = 0; k < count; ++k) {
+    const double theta = rng.uniform() * 2 * kPi;
+    const double dist = ctx.r * (0.85 + (extent - 0.9) * rng.uniform());
+    const double radius = std::max(0.75, ctx.r * scale * (0.04 + 0.1 * rng.uniform()));
+    const double brightness = 0.25 + 0.6 * rng.uniform();
+    ctx.particles.push_back({ctx.cx + dist * std::cos(theta), ctx.cy + dist * std::sin(theta), radius, brightness});
+  }
+}
+
+/** Bilinear sample of the premultiplied iris at canvas position (x, y), into acc. */
+void sample_iris(const EffectContext& ctx, double x, double y, double* acc) {
+  const double fx = x - ctx.ox - 0.5, fy = y - ctx.oy - 0.5;
+  const int x0 = static_cast<int>(std::floor(fx)), y0 = static_cast<int>(std::floor(fy));
+  const double ax = fx - x0, ay = fy - y0;
+  const double w[4] = {(1 - ax) * (1 - ay), ax * (1 - ay), (1 - ax) * ay, ax * ay};
+  for (int k = 0; k < 4; ++k) {
+    const int sx = x0 + (k & 1), sy = y0 + (k >> 1);
+    if (sx < 0 || sy < 0 || sx >= ctx.iris.cols || sy >= ctx.iris.rows) continue;
+    const uint8_t* p = ctx.iris.ptr<uint8_t>(sy) + 4 * sx;
+    for (int c = 0; c < 4; ++c) acc[c] += w[k] * p[c];
+  }
+}
+
+// ---- Per-row effect layers (premultiplied, behind or over the iris) ----
+
+void halo_row(const EffectContext& ctx, int y, uint8_t* layer) {
+  const double sigma = std::max(1.0, ctx.params.size * ctx.r);
+  const double reach = ctx.r + 3 * sigma;
+  const double dy = y + 0.5 - ctx.cy;
+  if (std::abs(dy) >= reach) return;
+  // Above 1 the glow saturates further out (put_light caps it at opaque).
+  const double intensity = ctx.params.intensity;
+  for (int x = 0; x < ctx.side; ++x) {
+    const double dist = std::hypot(x + 0.5 - ctx.cx, dy) - ctx.r;
+    if (dist >= 3 * sigma) continue;
+    const double v = dist <= 0 ? 1.0 : std::exp(-(dist * dist) / (sigma * sigma));
+    put_light(layer + 4 * x, intensity * v, ctx.color);
+  }
+}
+
+void sun_row(const EffectContext& ctx, int y, uint8_t* layer) {
+  const double dy = y + 0.5 - ctx.cy;
+  const double corona_len = 0.12 * ctx.r;
+  for (int x = 0; x < ctx.side; ++x) {
+    const double dx = x + 0.5 - ctx.cx;
+    const double out = std::max(0.0, std::hypot(dx, dy) - ctx.r);
+    const int bin = std::min(kSunBins - 1,
+                             static_cast<int>((std::atan2(dy, dx) + kPi) / (2 * kPi) * kSunBins));
+    const double ray = ctx.ray_strength[bin] * std::exp(-out / (ctx.ray_length[bin] * ctx.r));
+    const double corona = 0.6 * std::exp(-out / corona_len);
+    put_light(layer + 4 * x, ctx.params.intensity * std::min(1.0, ray + corona), ctx.color);
+  }
+}
+
+void explosion_row(const EffectContext& ctx, int y, uint8_t* layer) {
+  const double k = std::clamp(ctx.params.size, 0.05, 0.9);
+  const double dy = y + 0.5 - ctx.cy;
+  const double flash_len = 0.08 * ctx.r;
+  const uint32_t row_key = hash32(static_cast<uint32_t>(y) ^ (ctx.params.seed * 0x9E3779B9u));
+  for (int x = 0; x < ctx.side; ++x) {
+    const double dx = x + 0.5 - ctx.cx;
+    const double dist = std::hypot(dx, dy);
+    if (dist < ctx.r - 2) continue;  // under the opaque iris
+    uint8_t* px = layer + 4 * x;
+    put_light(px, 0.5 * std::min(1.0, ctx.params.intensity) * std::exp(-(dist - ctx.r) / flash_len), ctx.color);
+    if (dist * (1 - k) > ctx.r + 1) continue;  // no iris along the streak
+    // Samples from here towards the centre, jittered per pixel against banding.
+    const double jitter = (hash32(static_cast<uint32_t>(x) ^ row_key) >> 8) * (1.0 / 16777216.0);
+    double acc[4] = {0, 0, 0, 0};
+    for (int i = 0; i < kExplosionTaps; ++i) {
+      const double t = 1 - k * (i + jitter) / kExplosionTaps;
+      sample_iris(ctx, ctx.cx + dx * t, ctx.cy + dy * t, acc);
+    }
+    // Averaged streak; intensity above 1 brightens it (colour capped by alpha).
+    const double a = std::min(255.0, acc[3] / kExplosionTaps * std::min(1.0, ctx.params.intensity));
+    uint8_t streak[4];
+    for (int c = 0; c < 3; ++c) {
+      streak[c] = static_cast<uint8_t>(std::lround(std::min(a, acc[c] / kExplosionTaps * ctx.params.intensity)));
+    }
+    streak[3] = static_cast<uint8_t>(std::lround(a));
+    blend_over_row(px, streak, 1);
+  }
+}
+
+/** Dust goes over the iris: screen-combined particles and hashed grain. */
+void dust_row(const EffectContext& ctx, int y, uint8_t* layer, std::vector<uint32_t>& noise,
+              std::vector<double>& light) {
+  const double dy = y + 0.5 - ctx.cy;
+  const double intensity = ctx.params.intensity;  // above 1: denser grain, brighter specks
+  const double falloff_len = std::max(0.02, ctx.params.size) * 2 * ctx.r;
+  std::fill(light.begin(), light.end(), 0.0);
+  const uint32_t gy = static_cast<uint32_t>(static_cast<int32_t>(std::floor(dy / ctx.scale)));
+  hash_row(ctx.grain_x.data(), hash32(gy ^ (ctx.params.seed * 0x9E3779B9u)), noise.data(), ctx.side);
+  for (int x = 0; x < ctx.side; ++x) {
+    const double dist = std::hypot(x + 0.5 - ctx.cx, dy);
+    const double falloff = dist <= ctx.r ? 0.3 : std::exp(-(dist - ctx.r) / falloff_len);
+    const uint32_t h = noise[static_cast<size_t>(x)];
+    if ((h & 0xFFFF) < 0.004 * ctx.params.intensity * falloff * 65536) {
+      light[static_cast<size_t>(x)] = 0.35 + 0.65 * ((h >> 16) & 0xFF) / 255.0;
+    }
+  }
+  for (const auto& p : ctx.particles) {
+    if (std::abs(y + 0.5 - p.y) >= p.radius) continue;
+    const int x0 = std::max(0, static_cast<int>(std::floor(p.x - p.radius)));
+    const int x1 = std::min(ctx.side, static_cast<int>(std::ceil(p.x + p.radius)));
+    for (int x = x0; x < x1; ++x) {
+      const double d = std::hypot(x + 0.5 - p.x, y + 0.5 - p.y) / p.radius;
+      if (d >= 1) continue;
+      const double v = p.brightness * (1 - d) * (1 - d);
+      double& l = light[static_cast<size_t>(x)];
+      l = 1 - (1 - l) * (1 - v);  // screen: order-independent
+    }
+  }
+  for (int x = 0; x < ctx.side; ++x) {
+    if (light[static_cast<size_t>(x)] > 0) put_light(layer + 4 * x, intensity * light[static_cast<size_t>(x)], ctx.color);
+  }
+}
+
+}  // namespace
+
+SoloEffect solo_effect_from_int(int value) {
+  switch (value) {
+    case static_cast<int>(SoloEffect::kHalo): return SoloEffect::kHalo;
+    case static_cast<int>(SoloEffect::kDust): return SoloEffect::kDust;
+    case static_cast<int>(SoloEffect::kSun): return SoloEffect::kSun;
+    case static_cast<int>(SoloEffect::kExplosion): return SoloEffect::kExplosion;
+    default: return SoloEffect::kPure;
+  }
+}
+
+bool find_iris_disc(const uint8_t* rgba, int width, int height, int num_threads, IrisDisc* disc) {
+  if (!rgba || width <= 0 || height <= 0 || !disc) return false;
+  std::mutex mutex;
+  int min_x = width, max_x = -1, min_y = height, max_y = -1;
+  parallel_for_rows(height, num_threads, [&](int y0, int y1) {
+    int bx0 = width, bx1 = -1, by0 = height, by1 = -1;
+    for (int y = y0; y < y1; ++y) {
+      const uint8_t* row = rgba + static_cast<size_t>(y) * width * 4;
+      int first = -1, last = -1;
+      for (int x = 0; x < width; ++x) {
+        if (row[4 * x + 3] < 128) continue;
+        if (first < 0) first = x;
+        last = x;
+      }
+      if (first < 0) continue;
+      bx0 = std::min(bx0, first);
+      bx1 = std::max(bx1, last);
+      by0 = std::min(by0, y);
+      by1 = y;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    min_x = std::min(min_x, bx0);
+    max_x = std::max(max_x, bx1);
+    min_y = std::min(min_y, by0);
+    max_y = std::max(max_y, by1);
+  });
+  if (max_x < 0) return false;
+  disc->cx = (min_x + max_x + 1) / 2.0;
+  disc->cy = (min_y + max_y + 1) / 2.0;
+  disc->r = std::min(max_x + 1 - min_x, max_y + 1 - min_y) / 2.0;
+  return disc->r > 0;
+}
+
+bool solo_effect_canvas(const uint8_t* rgba, int width, int height, const SoloEffectParams& params,
+                        SoloEffectCanvas* canvas) {
+  if (!canvas || !find_iris_disc(rgba, width, height, params.num_threads, &canvas->disc)) return false;
+  const double extent = std::max(1.0, params.extent);
+  const double full = std::ceil(2 * canvas->disc.r * extent);
+  if (full < 1 || full > kMaxCanvasSide) return false;
+  canvas->scale = params.max_side > 0 && full > params.max_side ? params.max_side / full : 1.0;
+  canvas->side = std::max(1, static_cast<int>(std::lround(full * canvas->scale)));
+  return true;
+}
+
+bool apply_solo_effect(const uint8_t* rgba, int width, int height, const SoloEffectParams& params,
+                       const SoloEffectCanvas& canvas, std::vector<uint8_t>& out) {
+  if (!rgba || width <= 0 || height <= 0 || canvas.side <= 0 || canvas.disc.r <= 0) return false;
+
+  EffectContext ctx;
+  ctx.params = params;
+  ctx.params.intensity = std::clamp(params.intensity, 0.0, 2.0);
+  if (params.color[0] == 0 && params.color[1] == 0 && params.color[2] == 0) {
+    default_color(params.effect, ctx.color);
+  } else {
+    std::memcpy(ctx.color, params.color, 3);
+  }
+  ctx.side = canvas.side;
+  ctx.scale = canvas.scale;
+
+  cv::Mat pm = cv::Mat(height, width, CV_8UC4, const_cast<uint8_t*>(rgba)).clone();
+  parallel_for_rows(height, params.num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) premultiply_row(pm.ptr<uint8_t>(y), width);
+  });
+  if (canvas.scale < 1) {
+    const int w = std::max(1, static_cast<int>(std::lround(width * canvas.scale)));
+    const int h = std::max(1, static_cast<int>(std::lround(height * canvas.scale)));
+    cv::resize(pm, ctx.iris, cv::Size(w, h), 0, 0, cv::INTER_AREA);
+  } else {
+    ctx.iris = pm;
+  }
+  ctx.ox = static_cast<int>(std::lround(canvas.side / 2.0 - canvas.disc.cx * canvas.scale));
+  ctx.oy = static_cast<int>(std::lround(canvas.side / 2.0 - canvas.disc.cy * canvas.scale));
+  ctx.cx = ctx.ox + canvas.disc.cx * canvas.scale;
+  ctx.cy = ctx.oy + canvas.disc.cy * canvas.scale;
+  ctx.r = canvas.disc.r * canvas.scale;
+  if (params.effect == SoloEffect::kSun) build_sun_rays(ctx);
+  if (params.effect == SoloEffect::kDust) build_dust(ctx);
+
+  const int side = ctx.side;
+  const size_t stride = static_cast<size_t>(side) * 4;
+  out.assign(stride * static_cast<size_t>(side), 0);
+  parallel_for_rows(side, params.num_threads, [&](int y0, int y1) {
+    std::vector<uint8_t> over(stride);
+    std::vector<uint32_t> noise(static_cast<size_t>(side));
+    std::vector<double> light(static_cast<size_t>(side));
+    for (int y = y0; y < y1; ++y) {
+      uint8_t* row = out.data() + stride * static_cast<size_t>(y);
+      if (ctx.params.intensity > 0) {
+        switch (params.effect) {
+          case SoloEffect::kHalo: halo_row(ctx, y, row); break;
+          case SoloEffect::kSun: sun_row(ctx, y, row); break;
+          case SoloEffect::kExplosion: explosion_row(ctx, y, row); break;
+          default: break;
+        }
+      }
+      const int iy = y - ctx.oy;
+      if (iy >= 0 && iy < ctx.iris.rows) {
+        const int x0 = std::max(0, ctx.ox), x1 = std::min(side, ctx.ox + ctx.iris.cols);
+        if (x0 < x1) blend_over_row(row + 4 * x0, ctx.iris.ptr<uint8_t>(iy) + 4 * (x0 - ctx.ox), x1 - x0);
+      }
+      if (params.effect == SoloEffect::kDust && ctx.params.intensity > 0) {
+        std::fill(over.begin(), over.end(), 0);
+        dust_row(ctx, y, over.data(), noise, light);
+        blend_over_row(row, over.data(), side);
+      }
+      unpremultiply_row(row, side);
+    }
+  }, 8);
+  return true;
+}
+
+namespace {
+
+constexpr uint8_t kSeamColor[3] = {255, 244, 220};
+constexpr uint8_t kCoronaColor[3] = {255, 236, 200};
+
+DuoEffectParams resolve_duo(const DuoEffectParams& params) {
+  struct Defaults {
+    double softness, offset, extent;
+  };
+  static const Defaults kDefaults[] = {
+      {0.8, 0, 1.05},     // Fusion
+      {0.04, 0.7, 1.75},  // Collision
+      {0.02, 0, 1.05},    // Balance
+      {0.015, 0, 1.05},   // Binary
+      {0.03, 0.5, 1.5},   // Eclipse
+  };
+  const Defaults& d = kDefaults[static_cast<int>(params.effect)];
+  DuoEffectParams p = params;
+  if (p.softness <= 0) p.softness = d.softness;
+  if (p.offset <= 0) p.offset = d.offset;
+  if (p.extent <= 0) p.extent = d.extent;
+  p.softness = std::clamp(p.softness, 0.002, 1.0);
+  p.extent = std::max(1.0, p.extent);
+  return p;
+}
+
+struct DuoPlan {
+  int side = 0;
+  double scale = 1;    // output pixels per pixel of the common radius
+  double radius = 0;   // common radius, source pixels
+  IrisDisc first, second;
+};
+
+bool plan_duo(const uint8_t* a, int aw, int ah, const uint8_t* b, int bw, int bh, const DuoEffectParams& p,
+              DuoPlan& plan) {
+  if (!find_iris_disc(a, aw, ah, p.num_threads, &plan.first) ||
+      !find_iris_disc(b, bw, bh, p.num_threads, &plan.second)) {
+    return false;
+  }
+  plan.radius = std::max(plan.first.r, plan.second.r);
+  const double full = std::ceil(2 * plan.radius * p.extent);
+  if (full < 1 || full > kMaxCanvasSide) return false;
+  plan.scale = p.max_side > 0 && full > p.max_side ? p.max_side / full : 1.0;
+  plan.side = std::max(1, static_cast<int>(std::lround(full * plan.scale)));
+  return true;
+}
+
+/** A cut iris scaled to the common radius and placed on the canvas, premultiplied. */
+struct DuoLayer {
+  cv::Mat pixels;
+  int ox = 0, oy = 0;
+};
+
+void place_duo_layer(const uint8_t* rgba, int width, int height, const IrisDisc& disc, double radius, double cx,
+                     double cy, int num_threads, DuoLayer& out) {
+  cv::Mat pm = cv::Mat(height, width, CV_8UC4, const_cast<uint8_t*>(rgba)).clone();
+  parallel_for_rows(height, num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) premultiply_row(pm.ptr<uint8_t>(y), width);
+  });
+  const double k = radius / disc.r;
+  if (std::abs(k - 1) < 1e-9) {
+    out.pixels = pm;
+  } else {
+    const int w = std::max(1, static_cast<int>(std::lround(width * k)));
+    const int h = std::max(1, static_cast<int>(std::lround(height * k)));
+    // Linear when enlarging: no overshoot past the alpha for the mix to clamp.
+    cv::resize(pm, out.pixels, cv::Size(w, h), 0, 0, k < 1 ? cv::INTER_AREA : cv::INTER_LINEAR);
+  }
+  out.ox = static_cast<int>(std::lround(cx - disc.cx * k));
+  out.oy = static_cast<int>(std::lround(cy - disc.cy * k));
+}
+
+/** Canvas row [y] of [layer] into [row] ([side] pixels, transparent outside the layer). */
+void duo_layer_row(const DuoLayer& layer, int y, int side, uint8_t* row) {
+  std::memset(row, 0, static_cast<size_t>(side) * 4);
+  const int ly = y - layer.oy;
+  if (ly < 0 || ly >= layer.pixels.rows) return;
+  const int x0 = std::max(0, layer.ox), x1 = std::min(side, layer.ox + layer.pixels.cols);
+  if (x0 < x1) {
+    std::memcpy(row + 4 * x0, layer.pixels.ptr<uint8_t>(ly) + 4 * (x0 - layer.ox), static_cast<size_t>(x1 - x0) * 4);
+  }
+}
+
+/** Mix weight of the second iris for signed distance [sd] (radii) into its side. */
+inline uint8_t split_weight(double sd, double softness) {
+  return static_cast<uint8_t>(std::lround(255 * std::clamp(0.5 + sd / (2 * softness), 0.0, 1.0)));
+}
+
+}  // namespace
+
+DuoEffect duo_effect_from_int(int value) {
+  switch (value) {
+    case static_cast<int>(DuoEffect::kCollision): return DuoEffect::kCollision;
+    case static_cast<int>(DuoEffect::kBalance): return DuoEffect::kBalance;
+    case static_cast<int>(DuoEffect::kBinary): return DuoEffect::kBinary;
+    case static_cast<int>(DuoEffect::kEclipse): return DuoEffect::kEclipse;
+    default: return DuoEffect::kFusion;
+  }
+}
+
+bool duo_effect_canvas(const uint8_t* first, int first_width, int first_height, const uint8_t* second,
+                       int second_width, int second_height, const DuoEffectParams& params, int* out_width,
+                       int* out_height) {
+  DuoPlan plan;
+  if (!out_width || !out_height ||
+      !plan_duo(first, first_width, first_height, second, second_width, second_height, resolve_duo(params), plan)) {
+    return false;
+  }
+  *out_width = *out_height = plan.side;
+  return true;
+}
+
+bool apply_duo_effect(const uint8_t* first, int first_width, int first_height, const uint8_t* second,
+                      int second_width, int second_height, const DuoEffectParams& params,
+                      std::vector<uint8_t>& out, int* out_width, int* out_height) {
+  const DuoEffectParams p = resolve_duo(params);
+  DuoPlan plan;
+  if (!out_width || !out_height ||
+      !plan_duo(first, first_width, first_height, second, second_width, second_height, p, plan)) {
+    return false;
+  }
+  const int side = plan.side;
+  const double r = plan.radius * plan.scale;  // output pixels
+  const double c = side / 2.0;
+  const double angle = p.angle_deg * kPi / 180;
+  const double ax = std::cos(angle), ay = std::sin(angle);
+  // Centres along the axis: Collision at +-offset, Eclipse at +-offset / 2, else shared.
+  double shift = 0;
+  if (p.effect == DuoEffect::kCollision) shift = p.offset * r;
+  if (p.effect == DuoEffect::kEclipse) shift = p.offset * r / 2;
+  DuoLayer la, lb;
+  place_duo_layer(first, first_width, first_height, plan.first, r, c - shift * ax, c - shift * ay, p.num_threads, la);
+  place_duo_layer(second, second_width, second_height, plan.second, r, c + shift * ax, c + shift * ay,
+                  p.num_threads, lb);
+  const double bx = c + shift * ax, by = c + shift * ay;  // second centre (Eclipse)
+
+  const size_t stride = static_cast<size_t>(side) * 4;
+  out.assign(stride * static_cast<size_t>(side), 0);
+  parallel_for_rows(side, p.num_threads, [&](int y0, int y1) {
+    std::vector<uint8_t> ra(stride), rb(stride), zero(stride, 0), weight(static_cast<size_t>(side));
+    for (int y = y0; y < y1; ++y) {
+      uint8_t* row = out.data() + stride * static_cast<size_t>(y);
+      duo_layer_row(la, y, side, ra.data());
+      duo_layer_row(lb, y, side, rb.data());
+      const double dy = y + 0.5 - c;
+      for (int x = 0; x < side; ++x) {
+        const double dx = x + 0.5 - c;
+        // Frame of the axis, in radii: u towards the second iris, v across.
+        const double u = (dx * ax + dy * ay) / r, v = (dy * ax - dx * ay) / r;
+        double sd = 0;
+        switch (p.effect) {
+          case DuoEffect::kFusion: {
+            // A spiral: the split turns half a revolution from the centre to the edge.
+            const double s = std::sin(std::atan2(v, u) + kPi * std::hypot(u, v) - kPi / 2);
+            weight[static_cast<size_t>(x)] =
+                static_cast<uint8_t>(std::lround(255 * std::clamp(0.5 - 0.5 * s / p.softness, 0.0, 1.0)));
+            continue;
+          }
+          case DuoEffect::kBalance:
+            // Second iris: the top lobe plus its half without the bottom lobe.
+            sd = std::max(0.5 - std::hypot(u, v + 0.5), std::min(u, std::hypot(u, v - 0.5) - 0.5));
+            break;
+          case DuoEffect::kEclipse:
+            sd = 1 - std::hypot(x + 0.5 - bx, y + 0.5 - by) / r;  // inside the second disc
+            break;
+          default:
+            sd = u;
+            break;
+        }
+        weight[static_cast<size_t>(x)] = split_weight(sd, p.softness);
+      }
+      if (p.effect != DuoEffect::kEclipse) {
+        mix_row(row, ra.data(), rb.data(), weight.data(), side);
+      } else {
+        // Penumbra on the first iris just outside the second's edge, then the second over it.
+        for (int x = 0; x < side; ++x) {
+          const double out_by = std::hypot(x + 0.5 - bx, y + 0.5 - by) / r - 1;
+          if (out_by > 0.4) continue;
+          const int k = static_cast<int>(std::lround(256 * (1 - 0.55 * std::exp(-std::max(0.0, out_by) / 0.06))));
+          uint8_t* px = ra.data() + 4 * static_cast<size_t>(x);
+          for (int ch = 0; ch < 3; ++ch) px[ch] = static_cast<uint8_t>((px[ch] * k) >> 8);
+        }
+        mix_row(rb.data(), zero.data(), rb.data(), weight.data(), side);
+        std::memcpy(row, ra.data(), stride);
+        blend_over_row(row, rb.data(), side);
+      }
+      // Light over the join: the impact seam, or the eclipse corona.
+      if (p.effect == DuoEffect::kCollision || p.effect == DuoEffect::kEclipse) {
+        for (int x = 0; x < side; ++x) {
+          double light = 0;
+          if (p.effect == DuoEffect::kCollision) {
+            const double u = ((x + 0.5 - c) * ax + dy * ay) / r;
+            if (std::abs(u) < 0.12) light = 0.85 * std::exp(-(u * u) / (0.035 * 0.035)) * row[4 * x + 3] / 255.0;
+          } else {
+            const double e = std::hypot(x + 0.5 - bx, y + 0.5 - by) / r - 1;
+            if (e > -0.03 && e < 0.15) light = 0.6 * std::exp(-(e * e) / (0.03 * 0.03));
+          }
+          if (light <= 0) continue;
+          uint8_t px[4];
+          put_light(px, light, p.effect == DuoEffect::kCollision ? kSeamColor : kCoronaColor);
+          blend_over_row(row + 4 * x, px, 1);
+        }
+      }
+      unpremultiply_row(row, side);
+    }
+  }, 8);
+  *out_width = *out_height = side;
+  return true;
+}
+
+}  // namespace iris
@@ -0,0 +1,131 @@
+/**
+ * Iris Engine — Art Studio effects (2026).
+ *
+ * Solo effects are procedural effects around a cut iris (RGBA, transparent outside the iris):
+ *
+ *   Pure       the iris alone, centred on the effect canvas
+ *   Halo       a soft glow ring behind the iris edge
+ *   Dust       seeded speck grain (SSE2 integer hash) and soft particles over the image
+ *   Sun        seeded radial rays and a corona behind the iris
+ *   Explosion  a radial (zoom) blur of the iris streaking outwards behind it
+ *
+ * The iris disc is found from the alpha, and the output is a square canvas of
+ * [extent] iris radii around it, so the effect has room outside a tightly cut iris.
+ * Every pixel depends only on its position, the parameters and the seed (random ray and
+ * particle tables are drawn serially before the parallel pass), so the output is
+ * identical at any thread count and for any repeat of the same seed. [max_side] renders
+ * a smaller canvas with the same look, for scrubbing parameters in a preview.
+ *
+ * Duo effects join two cut irises. Both are scaled to a common radius (the larger one)
+ * and placed in one polar frame, then mixed by a per-pixel weight mask with an SSE2
+ * premultiplied mix:
+ *
+ *   Fusion     a soft spiral crossfade of the two irises on one disc
+ *   Collision  the two side by side, pressed together along a split line with an impact seam
+ *   Balance    a yin-yang split of one disc
+ *   Binary     one disc split in half along a straight line
+ *   Eclipse    the second iris over the first, offset, with a soft edge, penumbra and corona
+ */
+
+#ifndef IRIS_ENGINE_IRIS_ART_EFFECTS_H
+#define IRIS_ENGINE_IRIS_ART_EFFECTS_H
+
+#include <cstdint>
+#include <vector>
+
+namespace iris {
+
+enum class SoloEffect : int {
+  kPure = 0,
+  kHalo = 1,
+  kDust = 2,
+  kSun = 3,
+  kExplosion = 4,
+};
+
+/** Maps an FFI value to an effect; unknown values give kPure. */
+SoloEffect solo_effect_from_int(int value);
+
+struct SoloEffectParams {
+  SoloEffect effect = SoloEffect::kPure;
+  uint32_t seed = 1;
+  double extent = 1.5;     // canvas half-side, in iris radii (>= 1)
+  double intensity = 1.0;  // 0 = no effect, 1 = default, up to 2 (light saturates at opaque)
+  double size = 0.35;      // glow width, particle scale, ray length or blur length, x the radius
+  int count = 0;           // Dust particles or Sun rays; 0 = the effect's default
+  uint8_t color[3] = {0, 0, 0};  // effect light; all 0 = the effect's default
+  int max_side = 0;        // longest output side; 0 = full resolution
+  int num_threads = 0;
+};
+
+/** Iris disc in pixel coordinates. */
+struct IrisDisc {
+  double cx = 0, cy = 0, r = 0;
+};
+
+/**
+ * The iris disc of [rgba]: the bounds of its mostly opaque pixels, or the inscribed
+ * circle when the image has no transparency.
+ */
+bool find_iris_disc(const uint8_t* rgba, int width, int height, int num_threads, IrisDisc* disc);
+
+/** Where the effect canvas sits over the source. */
+struct SoloEffectCanvas {
+  int side = 0;      // output width = height
+  double scale = 1;  // output pixels per source pixel
+  IrisDisc disc;     // source space
+};
+
+/**
+ * Finds the iris of a width x height source and places the effect canvas around it.
+ * Returns false when there is no iris or the canvas would be too large.
+ */
+bool solo_effect_canvas(const uint8_t* rgba, int width, int height, const SoloEffectParams& params,
+                        SoloEffectCanvas* canvas);
+
+/**
+ * Renders [params] around the iris of [rgba] (straight alpha) into [out] (RGBA, straight
+ * alpha, canvas.side square). [canvas] comes from solo_effect_canvas with the same source
+ * and params. Returns false on invalid input.
+ */
+bool apply_solo_effect(const uint8_t* rgba, int width, int height, const SoloEffectParams& params,
+                       const SoloEffectCanvas& canvas, std::vector<uint8_t>& out);
+
+enum class DuoEffect : int {
+  kFusion = 0,
+  kCollision = 1,
+  kBalance = 2,
+  kBinary = 3,
+  kEclipse = 4,
+};
+
+/** Maps an FFI value to an effect; unknown values give kFusion. */
+DuoEffect duo_effect_from_int(int value);
+
+/** 0 in softness, offset or extent selects the effect's own default. */
+struct DuoEffectParams {
+  DuoEffect effect = DuoEffect::kFusion;
+  double angle_deg = 0;  // split / collision / eclipse axis; 0 = first iris on the left
+  double softness = 0;   // edge feather, x the radius (Fusion: crossfade width, 0..1)
+  double offset = 0;     // Collision: centre distance from the split; Eclipse: between centres; x radius
+  double extent = 0;     // canvas half-side, in radii (>= 1)
+  int max_side = 0;      // longest output side; 0 = full resolution
+  int num_threads = 0;
+};
+
+/** Output size of apply_duo_effect. */
+bool duo_effect_canvas(const uint8_t* first, int first_width, int first_height, const uint8_t* second,
+                       int second_width, int second_height, const DuoEffectParams& params, int* out_width,
+                       int* out_height);
+
+/**
+ * Renders [params] from two cut irises (RGBA, straight alpha) into [out] (square canvas,
+ * RGBA, straight alpha). Returns false when either image has no opaque iris.
+ */
+bool apply_duo_effect(const uint8_t* first, int first_width, int first_height, const uint8_t* second,
+                      int second_width, int second_height, const DuoEffectParams& params,
+                      std::vector<uint8_t>& out, int* out_width, int* out_height);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_ART_EFFECTS_H
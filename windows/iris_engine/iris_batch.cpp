@@ -0,0 +1,201 @@
+/**
+ * Iris Engine — Batch processing — implementation.
+ */
+
+#include "iris_batch.h"
+#include "iris_codec.h"
+#include "iris_thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace iris {
+
+namespace {
+
+// Decode holds the encoded file, OpenCV's BGR(A) decode (up to 4 B/px), the RGBA
+// conversion and the handle's copy of it (4 + 4). After that the handle keeps its pixels,
+// one recycled scratch image and the 1-byte pre-cut alpha. 13 bytes per pixel covers
+// either phase.
+constexpr size_t kPeakBytesPerPixel = 13;
+constexpr size_t kFallbackBudget = size_t{2} << 30;
+// Waiting images re-check the cancel flag at this interval.
+constexpr auto kCancelPoll = std::chrono::milliseconds(20);
+
+using Clock = std::chrono::steady_clock;
+
+double ms_between(Clock::time_point a, Clock::time_point b) {
+  return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+/** Admits images strictly in list order while their estimates fit under the budget. */
+class MemoryGate {
+ public:
+  explicit MemoryGate(size_t budget) : budget_(budget) {}
+
+  /** Blocks until image [index] may start; false when cancelled while waiting. */
+  bool admit(size_t index, size_t bytes, const std::atomic<bool>* cancel) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      if (cancel && cancel->load()) return false;
+      // An image over the whole budget waits until nothing else is in flight.
+      if (next_ == index && (in_flight_ == 0 || in_flight_ + bytes <= budget_)) break;
+      changed_.wait_for(lock, kCancelPoll);
+    }
+    ++next_;
+    in_flight_ += bytes;
+    changed_.notify_all();
+    return true;
+  }
+
+  void release(size_t bytes) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      in_flight_ -= bytes;
+    }
+    changed_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  size_t budget_;
+  size_t in_flight_ = 0;
+  size_t next_ = 0;
+};
+
+/** Footprint of [edit]'s first load, or [budget] (run alone) when it cannot be sized. */
+size_t estimate_edit_bytes(const CommandBuffer& edit, size_t budget) {
+  for (const Command& c : edit.commands()) {
+    if (c.op != CommandOp::kLoadFile) continue;
+    int w = 0, h = 0;
+    if (!read_image_size(c.path.c_str(), &w, &h)) return budget;
+    std::error_code ec;
+    const auto encoded = std::filesystem::file_size(
+        std::filesystem::path(reinterpret_cast<const char8_t*>(c.path.c_str())), ec);
+    return estimate_image_bytes(w, h, ec ? 0 : static_cast<size_t>(encoded));
+  }
+  return 0;  // no load: fails validation without allocating
+}
+
+/** Splits per-step finish times into load / process / export. */
+void split_timings(const CommandBuffer& edit, const std::vector<double>& step_end_ms, BatchItemResult& r) {
+  const auto& cmds = edit.commands();
+  const size_t done = step_end_ms.size();
+  if (done == 0) return;
+  size_t first = 0, last = done;
+  if (cmds.front().op == CommandOp::kLoadFile) {
+    r.load_ms = step_end_ms[0];
+    first = 1;
+  }
+  if (done == cmds.size() && done > first &&
+      (cmds.back().op == CommandOp::kExportFile || cmds.back().op == CommandOp::kExportPrint)) {
+    r.export_ms = step_end_ms[done - 1] - step_end_ms[done - 2];
+    last = done - 1;
+  }
+  if (last > first) r.process_ms = step_end_ms[last - 1] - (first > 0 ? step_end_ms[first - 1] : 0.0);
+}
+
+}  // namespace
+
+size_t estimate_image_bytes(int width, int height, size_t encoded_bytes) {
+  if (width <= 0 || height <= 0) return encoded_bytes;
+  return static_cast<size_t>(width) * static_cast<size_t>(height) * kPeakBytesPerPixel + encoded_bytes;
+}
+
+size_t default_batch_memory_budget() {
+  size_t physical = 0;
+#ifdef _WIN32
+  MEMORYSTATUSEX status{};
+  status.dwLength = sizeof(status);
+  if (GlobalMemoryStatusEx(&status)) physical = static_cast<size_t>(status.ullTotalPhys);
+#else
+  const long pages = sysconf(_SC_PHYS_PAGES);
+  const long page_size = sysconf(_SC_PAGE_SIZE);
+  if (pages > 0 && page_size > 0) physical = static_cast<size_t>(pages) * static_cast<size_t>(page_size);
+#endif
+  return physical > 0 ? physical / 4 : kFallbackBudget;
+}
+
+bool run_batch(const std::vector<CommandBuffer>& edits, const BatchOptions& options,
+               std::vector<BatchItemResult>& results, const SubmitHooks& hooks) {
+  const size_t count = edits.size();
+  results.assign(count, BatchItemResult());
+  if (count == 0) return true;
+
+  const size_t budget = options.memory_budget_bytes > 0 ? options.memory_budget_bytes
+                                                        : default_batch_memory_budget();
+  const int cores = hardware_thread_count();
+  const int runners = static_cast<int>(std::min<size_t>(
+      count, static_cast<size_t>(options.max_concurrent > 0 ? options.max_concurrent : cores)));
+  const int kernel_threads =
+      options.threads_per_image > 0 ? options.threads_per_image : std::max(1, cores / runners);
+
+  MemoryGate gate(budget);
+  std::atomic<size_t> next{0};
+  std::atomic<int> finished{0};
+  std::atomic<bool> all_ok{true};
+  const Clock::time_point batch_start = Clock::now();
+
+  auto runner = [&] {
+    for (;;) {
+      const size_t i = next.fetch_add(1);
+      if (i >= count) return;
+      const CommandBuffer& edit = edits[i];
+      BatchItemResult& r = results[i];
+      r.failed_index = 0;
+      r.estimated_bytes = estimate_edit_bytes(edit, budget);
+      if (!gate.admit(i, r.estimated_bytes, hooks.cancel)) {
+        all_ok.store(false);
+        continue;  // cancelled: the remaining images are skipped the same way
+      }
+      const Clock::time_point start = Clock::now();
+      r.started = true;
+      r.wait_ms = ms_between(batch_start, start);
+      {
+        IrisObject target;
+        target.set_num_threads(kernel_threads);
+        std::vector<double> step_end_ms;
+        step_end_ms.reserve(edit.size());
+        SubmitHooks item_hooks;
+        item_hooks.cancel = hooks.cancel;
+        item_hooks.progress = [&](int, int) { step_end_ms.push_back(ms_between(start, Clock::now())); };
+        r.ok = edit.submit(target, &r.failed_index, item_hooks);
+        r.width = target.width();
+        r.height = target.height();
+        split_timings(edit, step_end_ms, r);
+      }  // pixels freed before the budget is returned
+      gate.release(r.estimated_bytes);
+      r.total_ms = ms_between(start, Clock::now());
+      if (!r.ok) all_ok.store(false);
+      const int done = finished.fetch_add(1) + 1;
+      if (hooks.progress) hooks.progress(done, static_cast<int>(count));
+    }
+  };
+
+  // Runner threads are local to the call and joined before it returns.
+  std::vector<std::thread> threads;
+  threads.reserve(static_cast<size_t>(runners - 1));
+  for (int t = 1; t < runners; ++t) threads.emplace_back(runner);
+  runner();
+  for (auto& t : threads) t.join();
+  return all_ok.load();
+}
+
+}  // namespace iris
@@ -0,0 +1,65 @@
+/**
+ * Iris Engine — Batch processing with memory-aware admission (2026).
+ *
+ * A batch is a list of recorded edits, one per image (load → circles/flash/effects →
+ * export). Images run concurrently on batch runner threads, each on its own IrisObject,
+ * and their kernels still share the engine pool. Decode and encode are single-threaded
+ * inside OpenCV, so running whole images side by side is what fills the cores.
+ *
+ * Admission is in list order and bounded by a RAM budget. Before an image is decoded,
+ * its size is read from the file header and its peak footprint is estimated. An image
+ * starts only when that estimate fits next to the images still in flight, and one
+ * image larger than the whole budget runs alone. The budget caps the full-resolution
+ * images in flight, not the total memory use.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_BATCH_H
+#define IRIS_ENGINE_IRIS_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "iris_command_buffer.h"
+
+namespace iris {
+
+struct BatchOptions {
+  size_t memory_budget_bytes = 0;  // 0 = a quarter of physical memory
+  int max_concurrent = 0;          // images in flight; 0 = hardware threads
+  int threads_per_image = 0;       // kernel threads per image; 0 = cores / images in flight
+};
+
+/** Outcome and timings of one image. Times are wall-clock milliseconds. */
+struct BatchItemResult {
+  bool ok = false;
+  bool started = false;            // false when cancelled before admission
+  int failed_index = -1;           // first failing command, as in CommandBuffer::submit
+  int width = 0;                   // final image size
+  int height = 0;
+  size_t estimated_bytes = 0;      // footprint charged against the budget
+  double wait_ms = 0;              // queued until admitted
+  double load_ms = 0;              // leading load step
+  double process_ms = 0;           // steps between load and export
+  double export_ms = 0;            // trailing export step
+  double total_ms = 0;             // admission to finish
+};
+
+/** Peak bytes an edit of a width x height image is charged; see iris_batch.cpp. */
+size_t estimate_image_bytes(int width, int height, size_t encoded_bytes);
+
+/** Budget used when BatchOptions::memory_budget_bytes is 0. */
+size_t default_batch_memory_budget();
+
+/**
+ * Runs every edit and fills [results] (same order). Blocks until all are done.
+ * hooks.progress receives (images finished, total). A set hooks.cancel stops admitting
+ * images and stops running ones before their next step. Returns true when every
+ * image succeeded.
+ */
+bool run_batch(const std::vector<CommandBuffer>& edits, const BatchOptions& options,
+               std::vector<BatchItemResult>& results, const SubmitHooks& hooks = SubmitHooks());
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_BATCH_H
@@ -0,0 +1,343 @@
+/**
+ * Iris Engine — File decode/encode — implementation.
+ */
+
+#include "iris_codec.h"
+#include "iris_stats.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace iris {
+
+namespace {
+
+constexpr uint16_t kOrientationTag = 0x0112;
+constexpr uint16_t kTiffShort = 3;
+constexpr int kDefaultJpegQuality = 95;
+constexpr int kDefaultPngLevel = 3;
+
+std::filesystem::path to_fs_path(const char* utf8) {
+  return std::filesystem::path(reinterpret_cast<const char8_t*>(utf8));
+}
+
+uint16_t read_u16(const uint8_t* p, bool le) {
+  return le ? static_cast<uint16_t>(p[0] | (p[1] << 8))
+            : static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t read_u32(const uint8_t* p, bool le) {
+  return le ? (uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24))
+            : ((uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]));
+}
+
+/** Orientation tag from IFD0 of a TIFF structure (bare TIFF or the body of a JPEG APP1). */
+int tiff_orientation(const uint8_t* p, size_t n) {
+  if (n < 8) return 1;
+  bool le;
+  if (p[0] == 'I' && p[1] == 'I') le = true;
+  else if (p[0] == 'M' && p[1] == 'M') le = false;
+  else return 1;
+  if (read_u16(p + 2, le) != 42) return 1;
+  const uint32_t ifd = read_u32(p + 4, le);
+  if (ifd > n - 2) return 1;
+  const uint16_t count = read_u16(p + ifd, le);
+  for (uint32_t i = 0; i < count; ++i) {
+    const size_t e = static_cast<size_t>(ifd) + 2 + static_cast<size_t>(i) * 12;
+    if (e + 12 > n) break;
+    if (read_u16(p + e, le) != kOrientationTag) continue;
+    if (read_u16(p + e + 2, le) != kTiffShort || read_u32(p + e + 4, le) < 1) return 1;
+    const int v = read_u16(p + e + 8, le);
+    return (v >= 1 && v <= 8) ? v : 1;
+  }
+  return 1;
+}
+
+/** Scans JPEG markers up to start-of-scan for an Exif APP1 segment. */
+int jpeg_orientation(const uint8_t* p, size_t n) {
+  size_t i = 2;
+  while (i + 4 <= n) {
+    if (p[i] != 0xFF) return 1;
+    const uint8_t marker = p[i + 1];
+    if (marker == 0xFF) {  // fill byte
+      ++i;
+      continue;
+    }
+    if (marker == 0xDA || marker == 0xD9) return 1;  // image data / end: no Exif before it
+    const size_t len = read_u16(p + i + 2, false);
+    if (len < 2 || i + 2 + len > n) return 1;
+    const uint8_t* seg = p + i + 4;
+    const size_t seg_len = len - 2;
+    if (marker == 0xE1 && seg_len > 6 && std::equal(seg, seg + 6, "Exif\0\0")) {
+      return tiff_orientation(seg + 6, seg_len - 6);
+    }
+    i += 2 + len;
+  }
+  return 1;
+}
+
+// Headers are parsed from a prefix of the file; JPEG metadata segments are at most 64 KiB
+// each, so this reaches the frame header of ordinary camera files.
+constexpr size_t kHeaderProbeBytes = 256 * 1024;
+constexpr uint16_t kTiffImageWidth = 256;
+constexpr uint16_t kTiffImageLength = 257;
+constexpr uint16_t kTiffLong = 4;
+constexpr uint8_t kPngSignature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+bool tiff_size(const uint8_t* p, size_t n, int* width, int* height) {
+  if (n < 8) return false;
+  bool le;
+  if (p[0] == 'I' && p[1] == 'I') le = true;
+  else if (p[0] == 'M' && p[1] == 'M') le = false;
+  else return false;
+  if (read_u16(p + 2, le) != 42) return false;
+  const uint32_t ifd = read_u32(p + 4, le);
+  if (ifd > n - 2) return false;
+  const uint16_t count = read_u16(p + ifd, le);
+  int w = 0, h = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    const size_t e = static_cast<size_t>(ifd) + 2 + static_cast<size_t>(i) * 12;
+    if (e + 12 > n) break;
+    const uint16_t tag = read_u16(p + e, le);
+    if (tag != kTiffImageWidth && tag != kTiffImageLength) continue;
+    const uint16_t type = read_u16(p + e + 2, le);
+    const uint32_t v = type == kTiffShort ? read_u16(p + e + 8, le)
+                       : type == kTiffLong ? read_u32(p + e + 8, le)
+                                           : 0;
+    (tag == kTiffImageWidth ? w : h) = static_cast<int>(std::min<uint32_t>(v, INT32_MAX));
+  }
+  if (w <= 0 || h <= 0) return false;
+  *width = w;
+  *height = h;
+  return true;
+}
+
+/** Frame size from the first SOFn marker. */
+bool jpeg_size(const uint8_t* p, size_t n, int* width, int* height) {
+  size_t i = 2;
+  while (i + 4 <= n) {
+    if (p[i] != 0xFF) return false;
+    const uint8_t marker = p[i + 1];
+    if (marker == 0xFF) {
+      ++i;
+      continue;
+    }
+    if (marker == 0xDA || marker == 0xD9) return false;
+    const size_t len = read_u16(p + i + 2, false);
+    if (len < 2) return false;
+    // SOF0..SOF15 except DHT (C4), JPG (C8) and DAC (CC).
+    const bool sof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+    if (sof) {
+      if (i + 9 > n) return false;
+      *height = read_u16(p + i + 5, false);
+      *width = read_u16(p + i + 7, false);
+      return *width > 0 && *height > 0;
+    }
+    i += 2 + len;
+  }
+  return false;
+}
+
+bool webp_size(const uint8_t* p, size_t n, int* width, int* height) {
+  if (n < 30 || !std::equal(p, p + 4, "RIFF") || !std::equal(p + 8, p + 12, "WEBP")) return false;
+  const uint8_t* c = p + 12;
+  if (std::equal(c, c + 4, "VP8X")) {
+    *width = 1 + int(c[12] | (c[13] << 8) | (c[14] << 16));
+    *height = 1 + int(c[15] | (c[16] << 8) | (c[17] << 16));
+    return true;
+  }
+  if (std::equal(c, c + 4, "VP8 ")) {
+    *width = read_u16(c + 14, true) & 0x3FFF;
+    *height = read_u16(c + 16, true) & 0x3FFF;
+    return *width > 0 && *height > 0;
+  }
+  if (std::equal(c, c + 4, "VP8L")) {
+    const uint32_t bits = read_u32(c + 9, true);
+    *width = 1 + static_cast<int>(bits & 0x3FFF);
+    *height = 1 + static_cast<int>((bits >> 14) & 0x3FFF);
+    return true;
+  }
+  return false;
+}
+
+/** Any 1-, 3- or 4-channel decode to upright 8-bit RGBA. */
+bool to_rgba8(cv::Mat& decoded, int orientation, cv::Mat& out_rgba) {
+  if (decoded.empty()) return false;
+  if (decoded.depth() == CV_16U) {
+    decoded.convertTo(decoded, CV_8U, 1.0 / 257.0);
+  } else if (decoded.depth() == CV_32F || decoded.depth() == CV_64F) {
+    decoded.convertTo(decoded, CV_8U, 255.0);
+  } else if (decoded.depth() != CV_8U) {
+    return false;
+  }
+  apply_exif_orientation(decoded, orientation);
+  StageTimer timer(Stage::kColorConvert);
+  switch (decoded.channels()) {
+    case 1: cv::cvtColor(decoded, out_rgba, cv::COLOR_GRAY2RGBA); break;
+    case 3: cv::cvtColor(decoded, out_rgba, cv::COLOR_BGR2RGBA); break;
+    case 4: cv::cvtColor(decoded, out_rgba, cv::COLOR_BGRA2RGBA); break;
+    default: return false;
+  }
+  return true;
+}
+
+ImageFormat format_from_extension(const std::filesystem::path& path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  if (ext == ".jpg" || ext == ".jpeg") return ImageFormat::kJpeg;
+  if (ext == ".webp") return ImageFormat::kWebp;
+  if (ext == ".tif" || ext == ".tiff") return ImageFormat::kTiff;
+  if (ext == ".bmp") return ImageFormat::kBmp;
+  return ImageFormat::kPng;
+}
+
+}  // namespace
+
+ImageFormat image_format_from_int(int value) {
+  switch (value) {
+    case static_cast<int>(ImageFormat::kPng): return ImageFormat::kPng;
+    case static_cast<int>(ImageFormat::kJpeg): return ImageFormat::kJpeg;
+    case static_cast<int>(ImageFormat::kWebp): return ImageFormat::kWebp;
+    case static_cast<int>(ImageFormat::kTiff): return ImageFormat::kTiff;
+    case static_cast<int>(ImageFormat::kBmp): return ImageFormat::kBmp;
+    default: return ImageFormat::kAuto;
+  }
+}
+
+int exif_orientation(const uint8_t* data, size_t size) {
+  if (!data || size < 4) return 1;
+  if (data[0] == 0xFF && data[1] == 0xD8) return jpeg_orientation(data, size);
+  return tiff_orientation(data, size);
+}
+
+void apply_exif_orientation(cv::Mat& image, int orientation) {
+  cv::Mat out;
+  switch (orientation) {
+    case 2: cv::flip(image, out, 1); break;
+    case 3: cv::rotate(image, out, cv::ROTATE_180); break;
+    case 4: cv::flip(image, out, 0); break;
+    case 5: cv::transpose(image, out); break;
+    case 6: cv::rotate(image, out, cv::ROTATE_90_CLOCKWISE); break;
+    case 7: cv::transpose(image, out); cv::flip(out, out, -1); break;
+    case 8: cv::rotate(image, out, cv::ROTATE_90_COUNTERCLOCKWISE); break;
+    default: return;
+  }
+  image = out;
+}
+
+bool decode_image_buffer(const uint8_t* data, size_t size, cv::Mat& out_rgba) {
+  if (!data || size == 0) return false;
+  const cv::Mat encoded(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+  // IMREAD_UNCHANGED keeps alpha and bit depth but also skips orientation; applied below.
+  cv::Mat decoded = cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+  return to_rgba8(decoded, exif_orientation(data, size), out_rgba);
+}
+
+bool decode_image_file(const char* path, cv::Mat& out_rgba) {
+  if (!path) return false;
+  StageTimer timer(Stage::kDecode);
+  std::error_code ec;
+  const std::filesystem::path p = to_fs_path(path);
+  const auto size = std::filesystem::file_size(p, ec);
+  if (ec || size == 0) return false;
+  std::vector<uint8_t> bytes(static_cast<size_t>(size));
+  std::ifstream in(p, std::ios::binary);
+  if (!in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+    return false;
+  return decode_image_buffer(bytes.data(), bytes.size(), out_rgba);
+}
+
+bool read_image_size(const char* path, int* width, int* height) {
+  if (!path || !width || !height) return false;
+  std::ifstream in(to_fs_path(path), std::ios::binary);
+  if (!in) return false;
+  std::vector<uint8_t> head(kHeaderProbeBytes);
+  in.read(reinterpret_cast<char*>(head.data()), static_cast<std::streamsize>(head.size()));
+  const size_t n = static_cast<size_t>(in.gcount());
+  const uint8_t* p = head.data();
+  if (n >= 24 && std::equal(p, p + 8, kPngSignature)) {
+    *width = static_cast<int>(std::min<uint32_t>(read_u32(p + 16, false), INT32_MAX));
+    *height = static_cast<int>(std::min<uint32_t>(read_u32(p + 20, false), INT32_MAX));
+    return *width > 0 && *height > 0;
+  }
+  if (n >= 4 && p[0] == 0xFF && p[1] == 0xD8) return jpeg_size(p, n, width, height);
+  if (n >= 26 && p[0] == 'B' && p[1] == 'M') {
+    *width = static_cast<int32_t>(read_u32(p + 18, true));
+    *height = std::abs(static_cast<int32_t>(read_u32(p + 22, true)));  // negative = top-down
+    return *width > 0 && *height > 0;
+  }
+  if (webp_size(p, n, width, height)) return true;
+  return tiff_size(p, n, width, height);
+}
+
+bool encode_image_file(const char* path, const cv::Mat& rgba, ImageFormat format, int quality) {
+  if (!path || rgba.empty() || rgba.type() != CV_8UC4) return false;
+  const std::filesystem::path p = to_fs_path(path);
+  if (format == ImageFormat::kAuto) format = format_from_extension(p);
+
+  const char* ext = ".png";
+  std::vector<int> params;
+  bool keep_alpha = true;
+  switch (format) {
+    case ImageFormat::kJpeg:
+      ext = ".jpg";
+      keep_alpha = false;
+      params = {cv::IMWRITE_JPEG_QUALITY, quality < 0 ? kDefaultJpegQuality : std::clamp(quality, 1, 100)};
+      break;
+    case ImageFormat::kWebp:
+      ext = ".webp";
+      params = {cv::IMWRITE_WEBP_QUALITY, quality < 0 ? kDefaultJpegQuality : std::clamp(quality, 1, 100)};
+      break;
+    case ImageFormat::kTiff:
+      ext = ".tiff";
+      break;
+    case ImageFormat::kBmp:
+      ext = ".bmp";
+      keep_alpha = false;
+      break;
+    case ImageFormat::kPng:
+    default:
+      params = {cv::IMWRITE_PNG_COMPRESSION, quality < 0 ? kDefaultPngLevel : std::clamp(quality, 0, 9)};
+      break;
+  }
+
+  cv::Mat bgr;
+  {
+    StageTimer timer(Stage::kColorConvert);
+    cv::cvtColor(rgba, bgr, keep_alpha ? cv::COLOR_RGBA2BGRA : cv::COLOR_RGBA2BGR);
+  }
+  std::vector<uchar> encoded;
+  if (!cv::imencode(ext, bgr, encoded, params) || encoded.empty()) return false;
+
+  std::filesystem::path tmp = p;
+  tmp += ".partial";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out.write(reinterpret_cast<const char*>(encoded.data()),
+                   static_cast<std::streamsize>(encoded.size()))) {
+      out.close();
+      std::error_code ignored;
+      std::filesystem::remove(tmp, ignored);
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, p, ec);
+  if (ec) {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace iris
@@ -0,0 +1,64 @@
+/**
+ * Iris Engine — File decode/encode on the OpenCV codecs (2026).
+ *
+ * Paths are UTF-8 and read/written through std::filesystem, so non-ASCII Windows paths
+ * work. Decoding keeps alpha and applies the EXIF orientation itself: OpenCV skips
+ * orientation whenever IMREAD_UNCHANGED is requested.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_CODEC_H
+#define IRIS_ENGINE_IRIS_CODEC_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include <opencv2/core.hpp>
+
+namespace iris {
+
+enum class ImageFormat : int {
+  kAuto = 0,  // from the file extension; PNG when unknown
+  kPng = 1,
+  kJpeg = 2,
+  kWebp = 3,
+  kTiff = 4,
+  kBmp = 5,
+};
+
+/** Maps FFI values to ImageFormat; unknown values become kAuto. */
+ImageFormat image_format_from_int(int value);
+
+/**
+ * EXIF orientation (1..8) from an encoded JPEG or TIFF; 1 when absent or unreadable.
+ * Only the first IFD is inspected.
+ */
+int exif_orientation(const uint8_t* data, size_t size);
+
+/** Rotates/flips [image] in place so EXIF [orientation] reads upright. */
+void apply_exif_orientation(cv::Mat& image, int orientation);
+
+/**
+ * Decodes [path] to 8-bit RGBA (CV_8UC4), upright. Gray and BGR sources get opaque
+ * alpha; 16-bit and float sources are scaled to 8 bits. False if unreadable.
+ */
+bool decode_image_file(const char* path, cv::Mat& out_rgba);
+
+/** Same as decode_image_file for an in-memory encoded image. */
+bool decode_image_buffer(const uint8_t* data, size_t size, cv::Mat& out_rgba);
+
+/**
+ * Pixel size of an encoded image read from its header alone (PNG, JPEG, BMP, WebP,
+ * TIFF), without decoding. False for other formats or a truncated header.
+ */
+bool read_image_size(const char* path, int* width, int* height);
+
+/**
+ * Encodes CV_8UC4 RGBA to [path]. quality: JPEG/WebP 1..100, PNG zlib level 0..9;
+ * < 0 selects the default (95 / 3). JPEG and BMP drop alpha. The file is written to a
+ * sibling temporary and renamed, so readers never see a partial image.
+ */
+bool encode_image_file(const char* path, const cv::Mat& rgba, ImageFormat format, int quality);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_CODEC_H
@@ -0,0 +1,335 @@
+/**
+ * Iris Engine — 3D color lookup tables — implementation.
+ * Lattice values carry 4 fractional bits; interpolation weights are 8-bit (sum 256).
+ */
+
+#include "iris_color_lut.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IRIS_COLOR_LUT_SSE2 1
+#include <emmintrin.h>
+#else
+#define IRIS_COLOR_LUT_SSE2 0
+#endif
+
+namespace iris {
+
+namespace {
+
+constexpr int kNodeBits = 4;            // lattice values are 8.4 fixed point
+constexpr int kNodeOne = 255 << kNodeBits;
+constexpr int kWeightBits = 8;
+constexpr int kWeightOne = 1 << kWeightBits;
+constexpr int kShift = kNodeBits + kWeightBits;
+
+/** Lattice cell and 8-bit fraction for each input byte; cell <= size - 2. */
+struct Axis {
+  int cell[256];
+  int frac[256];
+
+  explicit Axis(int size) {
+    for (int v = 0; v < 256; ++v) {
+      const double pos = v * (size - 1) / 255.0;
+      const int c = std::min(static_cast<int>(pos), size - 2);
+      cell[v] = c;
+      frac[v] = static_cast<int>(std::lround((pos - c) * kWeightOne));
+    }
+  }
+};
+
+/** Tetrahedral corner offsets (in int16 elements) and weights for one pixel. */
+inline void tetrahedron(int fr, int fg, int fb, int dr, int dg, int db,
+                        int off[3], int w[4]) {
+  // Walk from c000 to c111 along the axes in decreasing fraction order.
+  if (fr >= fg) {
+    if (fg >= fb) {         // r g b
+      off[0] = dr; off[1] = dr + dg;
+      w[0] = kWeightOne - fr; w[1] = fr - fg; w[2] = fg - fb; w[3] = fb;
+    } else if (fr >= fb) {  // r b g
+      off[0] = dr; off[1] = dr + db;
+      w[0] = kWeightOne - fr; w[1] = fr - fb; w[2] = fb - fg; w[3] = fg;
+    } else {                // b r g
+      off[0] = db; off[1] = db + dr;
+      w[0] = kWeightOne - fb; w[1] = fb - fr; w[2] = fr - fg; w[3] = fg;
+    }
+  } else {
+    if (fr >= fb) {         // g r b
+      off[0] = dg; off[1] = dg + dr;
+      w[0] = kWeightOne - fg; w[1] = fg - fr; w[2] = fr - fb; w[3] = fb;
+    } else if (fg >= fb) {  // g b r
+      off[0] = dg; off[1] = dg + db;
+      w[0] = kWeightOne - fg; w[1] = fg - fb; w[2] = fb - fr; w[3] = fr;
+    } else {                // b g r
+      off[0] = db; off[1] = db + dg;
+      w[0] = kWeightOne - fb; w[1] = fb - fg; w[2] = fg - fr; w[3] = fr;
+    }
+  }
+  off[2] = dr + dg + db;
+}
+
+/** Evenly spaced lattice inputs in [0, 1], red fastest (size^3 * 3 floats). */
+std::vector<float> identity_lattice(int size) {
+  std::vector<float> rgb(static_cast<size_t>(size) * size * size * 3);
+  const float step = 1.0f / static_cast<float>(size - 1);
+  size_t i = 0;
+  for (int b = 0; b < size; ++b)
+    for (int g = 0; g < size; ++g)
+      for (int r = 0; r < size; ++r, i += 3) {
+        rgb[i + 0] = r * step;
+        rgb[i + 1] = g * step;
+        rgb[i + 2] = b * step;
+      }
+  return rgb;
+}
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+  return s;
+}
+
+/** Parses up to [count] whitespace-separated floats; returns how many were read. */
+int parse_floats(std::string_view s, float* out, int count) {
+  int n = 0;
+  const char* p = s.data();
+  const char* end = p + s.size();
+  while (n < count) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    if (p >= end) break;
+    if (*p == '+') ++p;  // from_chars rejects a leading '+'
+    const auto res = std::from_chars(p, end, out[n]);
+    if (res.ec != std::errc()) break;
+    p = res.ptr;
+    ++n;
+  }
+  return n;
+}
+
+std::shared_ptr<const ColorLut3D> fail(std::string* error, int line, const char* what) {
+  if (error) *error = "line " + std::to_string(line) + ": " + what;
+  return nullptr;
+}
+
+inline uint8_t clamp_u8(int v) {
+  return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+}  // namespace
+
+std::shared_ptr<ColorLut3D> ColorLut3D::from_float(int size, const float* rgb) {
+  if (!rgb || size < COLOR_LUT_MIN_SIZE || size > COLOR_LUT_MAX_SIZE) return nullptr;
+  auto lut = std::make_shared<ColorLut3D>();
+  lut->size = size;
+  const size_t n = static_cast<size_t>(size) * size * size;
+  lut->nodes.resize(n * 4);
+  for (size_t i = 0; i < n; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      const float v = std::clamp(rgb[i * 3 + c], 0.0f, 1.0f);
+      lut->nodes[i * 4 + c] = static_cast<int16_t>(std::lround(v * kNodeOne));
+    }
+    lut->nodes[i * 4 + 3] = 0;
+  }
+  return lut;
+}
+
+std::shared_ptr<const ColorLut3D> build_vibrance_gamma_lut(float vib_scale, float gamma, int size) {
+  if (size < COLOR_LUT_MIN_SIZE || size > COLOR_LUT_MAX_SIZE || gamma <= 0) return nullptr;
+  const int n = size * size * size;
+  std::vector<float> grid = identity_lattice(size);
+  cv::Mat rgb(1, n, CV_32FC3, grid.data());
+  float* p = grid.data();
+
+  if (std::fabs(vib_scale - 1.0f) > 1e-6f) {
+    cv::Mat lab;
+    cv::cvtColor(rgb, lab, cv::COLOR_RGB2Lab);
+    float* q = lab.ptr<float>(0);
+    for (int i = 0; i < n; ++i) {
+      // 8-bit Lab stores a/b offset by 128; the original scaled those bytes.
+      for (int c = 1; c < 3; ++c)
+        q[i * 3 + c] = std::clamp((q[i * 3 + c] + 128.0f) * vib_scale, 0.0f, 255.0f) - 128.0f;
+    }
+    cv::cvtColor(lab, rgb, cv::COLOR_Lab2RGB);
+    p = rgb.ptr<float>(0);
+  }
+  if (std::fabs(gamma - 1.0f) > 1e-6f) {
+    const float inv = 1.0f / gamma;
+    for (int i = 0; i < n * 3; ++i) p[i] = std::pow(std::clamp(p[i], 0.0f, 1.0f), inv);
+  }
+  return ColorLut3D::from_float(size, p);
+}
+
+std::shared_ptr<const ColorLut3D> compile_color_preset(const ColorPresetParams& params, int size) {
+  if (size < COLOR_LUT_MIN_SIZE || size > COLOR_LUT_MAX_SIZE) return nullptr;
+  constexpr double kLumR = 0.2125, kLumG = 0.7154, kLumB = 0.0721;
+  const double bright = params.brightness;
+  const double sat = params.saturation;
+  const double contrast = params.contrast;
+  const bool use_hue = params.hue_deg != 0.0f;
+  double hr = 1, hg = 0, hb = 0;
+  if (use_hue) {
+    // Rotation about the gray axis, as in adjustColor.
+    const double h = params.hue_deg * 3.14159265358979323846 / 180.0;
+    const double sn = std::sin(h), cs = std::cos(h);
+    hr = (2.0 * cs + 1.0) / 3.0;
+    hg = (1.0 - cs - std::sqrt(3.0) * sn) / 3.0;
+    hb = (1.0 - cs + std::sqrt(3.0) * sn) / 3.0;
+  }
+  std::vector<float> rgb = identity_lattice(size);
+  for (size_t i = 0; i < rgb.size(); i += 3) {
+    double r = rgb[i], g = rgb[i + 1], b = rgb[i + 2];
+    if (bright != 1.0) {
+      r *= bright;
+      g *= bright;
+      b *= bright;
+    }
+    if (sat != 1.0) {
+      const double lum = r * kLumR + g * kLumG + b * kLumB;
+      r = lum + (r - lum) * sat;
+      g = lum + (g - lum) * sat;
+      b = lum + (b - lum) * sat;
+    }
+    if (contrast != 1.0) {
+      r = 0.5 + (r - 0.5) * contrast;
+      g = 0.5 + (g - 0.5) * contrast;
+      b = 0.5 + (b - 0.5) * contrast;
+    }
+    if (use_hue) {
+      const double nr = r * hr + g * hg + b * hb;
+      const double ng = r * hb + g * hr + b * hg;
+      const double nb = r * hg + g * hb + b * hr;
+      r = nr;
+      g = ng;
+      b = nb;
+    }
+    rgb[i] = static_cast<float>(r);
+    rgb[i + 1] = static_cast<float>(g);
+    rgb[i + 2] = static_cast<float>(b);
+  }
+  return ColorLut3D::from_float(size, rgb.data());
+}
+
+std::shared_ptr<const ColorLut3D> parse_cube_lut(const char* text, size_t length, std::string* error) {
+  if (!text) return nullptr;
+  int size = 0;
+  size_t expected = 0;
+  float domain_min[3] = {0, 0, 0}, domain_max[3] = {1, 1, 1};
+  std::vector<float> values;
+  std::string_view rest(text, length);
+  int line_no = 0;
+  while (!rest.empty()) {
+    const size_t nl = rest.find('\n');
+    std::string_view line = trim(rest.substr(0, nl));
+    rest.remove_prefix(nl == std::string_view::npos ? rest.size() : nl + 1);
+    ++line_no;
+    if (line.empty() || line.front() == '#') continue;
+
+    const char c = line.front();
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+      const size_t sp = line.find_first_of(" \t");
+      const std::string_view key = line.substr(0, sp);
+      const std::string_view arg = sp == std::string_view::npos ? std::string_view() : trim(line.substr(sp));
+      if (key == "LUT_3D_SIZE") {
+        if (!values.empty()) return fail(error, line_no, "LUT_3D_SIZE after data");
+        float v = 0;
+        if (parse_floats(arg, &v, 1) != 1) return fail(error, line_no, "bad LUT_3D_SIZE");
+        size = static_cast<int>(v);
+        if (size < COLOR_LUT_MIN_SIZE || size > COLOR_LUT_MAX_SIZE)
+          return fail(error, line_no, "LUT_3D_SIZE out of range 2..65");
+        expected = static_cast<size_t>(size) * size * size;
+        values.reserve(expected * 3);
+      } else if (key == "LUT_1D_SIZE") {
+        return fail(error, line_no, "1D LUTs are not supported");
+      } else if (key == "DOMAIN_MIN") {
+        if (parse_floats(arg, domain_min, 3) != 3) return fail(error, line_no, "bad DOMAIN_MIN");
+      } else if (key == "DOMAIN_MAX") {
+        if (parse_floats(arg, domain_max, 3) != 3) return fail(error, line_no, "bad DOMAIN_MAX");
+      } else if (key == "LUT_3D_INPUT_RANGE") {
+        float range[2];
+        if (parse_floats(arg, range, 2) != 2) return fail(error, line_no, "bad LUT_3D_INPUT_RANGE");
+        std::fill(domain_min, domain_min + 3, range[0]);
+        std::fill(domain_max, domain_max + 3, range[1]);
+      }
+      continue;  // TITLE and unknown keywords are ignored
+    }
+
+    float rgb[3];
+    if (size == 0) return fail(error, line_no, "data before LUT_3D_SIZE");
+    if (parse_floats(line, rgb, 3) != 3) return fail(error, line_no, "expected three values");
+    if (values.size() >= expected * 3) return fail(error, line_no, "too many entries");
+    values.insert(values.end(), rgb, rgb + 3);
+  }
+  if (size == 0) return fail(error, line_no, "missing LUT_3D_SIZE");
+  if (values.size() != expected * 3) return fail(error, line_no, "too few entries");
+  for (int c = 0; c < 3; ++c) {
+    if (domain_min[c] != 0.0f || domain_max[c] != 1.0f)
+      return fail(error, line_no, "only DOMAIN 0..1 is supported");
+  }
+  return ColorLut3D::from_float(size, values.data());
+}
+
+std::shared_ptr<const ColorLut3D> load_cube_file(const char* path, std::string* error) {
+  if (!path) return nullptr;
+  std::ifstream in(std::filesystem::path(reinterpret_cast<const char8_t*>(path)), std::ios::binary);
+  if (!in) {
+    if (error) *error = "cannot open file";
+    return nullptr;
+  }
+  const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  return parse_cube_lut(text.data(), text.size(), error);
+}
+
+void apply_color_lut_rows(const ColorLut3D& lut, uint8_t* rgba, size_t stride, int width,
+                          int y_begin, int y_end) {
+  if (!rgba || lut.size < COLOR_LUT_MIN_SIZE || lut.nodes.empty()) return;
+  const Axis axis(lut.size);
+  const int dr = 4, dg = lut.size * 4, db = lut.size * lut.size * 4;
+  const int16_t* nodes = lut.nodes.data();
+  for (int y = y_begin; y < y_end; ++y) {
+    uint8_t* px = rgba + static_cast<size_t>(y) * stride;
+    for (int x = 0; x < width; ++x, px += 4) {
+      const int r = px[0], g = px[1], b = px[2];
+      const int16_t* c0 = nodes + axis.cell[r] * dr + axis.cell[g] * dg + axis.cell[b] * db;
+      int off[3], w[4];
+      tetrahedron(axis.frac[r], axis.frac[g], axis.frac[b], dr, dg, db, off, w);
+      const int16_t* c1 = c0 + off[0];
+      const int16_t* c2 = c0 + off[1];
+      const int16_t* c3 = c0 + off[2];
+#if IRIS_COLOR_LUT_SSE2
+      // (c0,c1) and (c2,c3) interleaved as int16 pairs: two madds give r, g, b sums.
+      __m128i v0, v1, v2, v3;
+      v0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(c0));
+      v1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(c1));
+      v2 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(c2));
+      v3 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(c3));
+      const __m128i w01 = _mm_set1_epi32((w[1] << 16) | w[0]);
+      const __m128i w23 = _mm_set1_epi32((w[3] << 16) | w[2]);
+      __m128i acc = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(v0, v1), w01),
+                                  _mm_madd_epi16(_mm_unpacklo_epi16(v2, v3), w23));
+      acc = _mm_srai_epi32(_mm_add_epi32(acc, _mm_set1_epi32(1 << (kShift - 1))), kShift);
+      const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(acc, acc), acc);
+      const uint32_t out = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+      px[0] = static_cast<uint8_t>(out);
+      px[1] = static_cast<uint8_t>(out >> 8);
+      px[2] = static_cast<uint8_t>(out >> 16);
+#else
+      for (int c = 0; c < 3; ++c) {
+        const int v = c0[c] * w[0] + c1[c] * w[1] + c2[c] * w[2] + c3[c] * w[3];
+        px[c] = clamp_u8((v + (1 << (kShift - 1))) >> kShift);
+      }
+#endif
+    }
+  }
+}
+
+}  // namespace iris
@@ -0,0 +1,79 @@
+/**
+ * Iris Engine — 3D color lookup tables (2026).
+ *
+ * Pointwise color transforms are baked into an N x N x N RGB lattice when their
+ * parameters change. They are then applied in one pass over RGBA with fixed-point
+ * tetrahedral interpolation (SSE2 when available). Alpha is never touched.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_COLOR_LUT_H
+#define IRIS_ENGINE_IRIS_COLOR_LUT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace iris {
+
+constexpr int COLOR_LUT_MIN_SIZE = 2;
+constexpr int COLOR_LUT_MAX_SIZE = 65;
+constexpr int COLOR_LUT_DEFAULT_SIZE = 33;
+
+/**
+ * Lattice of output RGB for evenly spaced input RGB in [0, 255].
+ * nodes: size^3 entries of 4 x int16 (r, g, b, 0) in 0..255*16, red varying fastest.
+ */
+struct ColorLut3D {
+  int size = 0;
+  std::vector<int16_t> nodes;
+
+  /** Builds from float output colors in [0, 1] (size^3 * 3, red fastest). */
+  static std::shared_ptr<ColorLut3D> from_float(int size, const float* rgb);
+};
+
+/**
+ * Vibrance + gamma of IrisObject::apply_effect_params as a lattice. Matches the
+ * original 8-bit pipeline: the offset Lab a/b bytes are scaled by vib_scale (1 + vibrance)
+ * and saturated, then gamma 255 * (v / 255)^(1 / gamma) is applied per BGR channel.
+ */
+std::shared_ptr<const ColorLut3D> build_vibrance_gamma_lut(float vib_scale, float gamma,
+                                                           int size = COLOR_LUT_DEFAULT_SIZE);
+
+/**
+ * Color preset as the multipliers the editor feeds to the image package's adjustColor
+ * (1 = no change). The lattice reproduces that operator chain in the same order:
+ * brightness scale, saturation about Rec. 709 luma, contrast about 0.5, then the
+ * hue-rotation matrix.
+ */
+struct ColorPresetParams {
+  float brightness = 1.0f;
+  float contrast = 1.0f;
+  float saturation = 1.0f;
+  float hue_deg = 0.0f;
+};
+
+std::shared_ptr<const ColorLut3D> compile_color_preset(const ColorPresetParams& params,
+                                                       int size = COLOR_LUT_DEFAULT_SIZE);
+
+/**
+ * Parses Adobe/Resolve .cube text (LUT_3D_SIZE 2..65, DOMAIN 0..1, red fastest).
+ * On failure returns null and, if [error] is set, a short reason with the line number.
+ */
+std::shared_ptr<const ColorLut3D> parse_cube_lut(const char* text, size_t length,
+                                                 std::string* error = nullptr);
+
+/** Reads and parses a .cube file (UTF-8 path). */
+std::shared_ptr<const ColorLut3D> load_cube_file(const char* path, std::string* error = nullptr);
+
+/**
+ * Applies [lut] in place to RGBA rows [y_begin, y_end) of a width-wide image
+ * (stride in bytes). RGB are replaced, alpha is left as is. Safe to run per row band.
+ */
+void apply_color_lut_rows(const ColorLut3D& lut, uint8_t* rgba, size_t stride, int width,
+                          int y_begin, int y_end);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_COLOR_LUT_H
@@ -0,0 +1,303 @@
+/**
+ * Iris Engine — ICC color management — implementation.
+ */
+
+#include "iris_color_management.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <system_error>
+
+#if defined(IRIS_ENGINE_HAS_LCMS2) && IRIS_ENGINE_HAS_LCMS2
+#include <lcms2.h>
+#define IRIS_CMS_LCMS 1
+#else
+#define IRIS_CMS_LCMS 0
+#endif
+
+namespace iris {
+
+#if IRIS_CMS_LCMS
+class CmykTransform {
+ public:
+  CmykTransform(cmsHTRANSFORM transform, std::vector<uint8_t> profile)
+      : transform_(transform), profile_(std::move(profile)) {}
+  ~CmykTransform() { cmsDeleteTransform(transform_); }
+  CmykTransform(const CmykTransform&) = delete;
+  CmykTransform& operator=(const CmykTransform&) = delete;
+
+  // cmsDoTransform keeps its one-pixel cache on the caller's stack, so runs of a
+  // repeated color (flat backgrounds, the white around a cut) skip the pipeline and
+  // concurrent row bands do not contend.
+  cmsHTRANSFORM transform_;
+  std::vector<uint8_t> profile_;
+};
+#else
+class CmykTransform {
+ public:
+  std::vector<uint8_t> profile_;
+};
+#endif
+
+namespace {
+
+// Distinct profile setups in use are few (one printer, maybe a proof of another).
+constexpr size_t kMaxCachedTransforms = 16;
+constexpr int kProofLutSize = COLOR_LUT_DEFAULT_SIZE;
+
+struct CacheEntry {
+  std::string key;
+  std::shared_ptr<const CmykTransform> transform;
+  std::shared_ptr<const ColorLut3D> proof;
+};
+
+std::mutex g_mutex;
+std::list<CacheEntry> g_lru;  // front = most recently used
+
+void set_error(std::string* error, const char* message) {
+  if (error) *error = message;
+}
+
+#if IRIS_CMS_LCMS
+struct FileStamp {
+  uint64_t size = 0;
+  int64_t mtime = 0;
+};
+
+bool stat_file(const std::string& path, FileStamp& out) {
+  std::error_code ec;
+  const std::filesystem::path p(reinterpret_cast<const char8_t*>(path.c_str()));
+  const auto size = std::filesystem::file_size(p, ec);
+  if (ec) return false;
+  const auto mtime = std::filesystem::last_write_time(p, ec);
+  if (ec) return false;
+  out.size = static_cast<uint64_t>(size);
+  out.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+  return true;
+}
+
+/** Cache key for [profile] as used by [kind]; false when a profile file is missing. */
+bool make_key(char kind, const CmykProfile& profile, std::string& key) {
+  key.assign(1, kind);
+  key += std::to_string(static_cast<int>(profile.intent));
+  key += profile.black_point_compensation ? 'b' : '-';
+  key += profile.simulate_paper ? 'p' : '-';
+  for (const std::string* path : {&profile.profile_path, &profile.source_profile}) {
+    key += '|';
+    if (path->empty()) continue;
+    FileStamp stamp;
+    if (!stat_file(*path, stamp)) return false;
+    key += std::to_string(stamp.size) + ':' + std::to_string(stamp.mtime) + ':' + *path;
+  }
+  return true;
+}
+
+/** Caller holds g_mutex. Moves a hit to the front. */
+const CacheEntry* find_entry(const std::string& key) {
+  for (auto it = g_lru.begin(); it != g_lru.end(); ++it) {
+    if (it->key != key) continue;
+    g_lru.splice(g_lru.begin(), g_lru, it);
+    return &g_lru.front();
+  }
+  return nullptr;
+}
+
+void insert_entry(CacheEntry entry) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  for (auto it = g_lru.begin(); it != g_lru.end(); ++it) {
+    if (it->key == entry.key) {
+      g_lru.erase(it);  // a concurrent miss built it too
+      break;
+    }
+  }
+  g_lru.push_front(std::move(entry));
+  while (g_lru.size() > kMaxCachedTransforms) g_lru.pop_back();
+}
+
+bool read_file(const std::string& path, std::vector<uint8_t>& out) {
+  std::ifstream in(std::filesystem::path(reinterpret_cast<const char8_t*>(path.c_str())), std::ios::binary);
+  if (!in) return false;
+  out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  return !out.empty();
+}
+
+/** Owns the two profiles of a transform while it is built. */
+struct ProfilePair {
+  cmsHPROFILE source = nullptr;
+  cmsHPROFILE cmyk = nullptr;
+  std::vector<uint8_t> cmyk_bytes;
+
+  ~ProfilePair() {
+    if (source) cmsCloseProfile(source);
+    if (cmyk) cmsCloseProfile(cmyk);
+  }
+
+  bool open(const CmykProfile& profile, std::string* error) {
+    if (!read_file(profile.profile_path, cmyk_bytes)) {
+      set_error(error, "cannot read the CMYK profile");
+      return false;
+    }
+    cmyk = cmsOpenProfileFromMem(cmyk_bytes.data(), static_cast<cmsUInt32Number>(cmyk_bytes.size()));
+    if (!cmyk || cmsGetColorSpace(cmyk) != cmsSigCmykData) {
+      set_error(error, "not a CMYK ICC profile");
+      return false;
+    }
+    if (profile.source_profile.empty()) {
+      source = cmsCreate_sRGBProfile();
+    } else {
+      std::vector<uint8_t> bytes;
+      if (read_file(profile.source_profile, bytes)) {
+        source = cmsOpenProfileFromMem(bytes.data(), static_cast<cmsUInt32Number>(bytes.size()));
+      }
+    }
+    if (!source || cmsGetColorSpace(source) != cmsSigRgbData) {
+      set_error(error, "not an RGB source profile");
+      return false;
+    }
+    return true;
+  }
+};
+
+cmsUInt32Number transform_flags(const CmykProfile& profile) {
+  return profile.black_point_compensation ? cmsFLAGS_BLACKPOINTCOMPENSATION : 0;
+}
+
+std::shared_ptr<const CmykTransform> build_transform(const CmykProfile& profile, std::string* error) {
+  ProfilePair pair;
+  if (!pair.open(profile, error)) return nullptr;
+  cmsHTRANSFORM t = cmsCreateTransform(pair.source, TYPE_RGB_8, pair.cmyk, TYPE_CMYK_8,
+                                       static_cast<cmsUInt32Number>(profile.intent), transform_flags(profile));
+  if (!t) {
+    set_error(error, "the profiles do not support this intent");
+    return nullptr;
+  }
+  return std::make_shared<const CmykTransform>(t, std::move(pair.cmyk_bytes));
+}
+
+std::shared_ptr<const ColorLut3D> build_proof(const CmykProfile& profile, std::string* error) {
+  ProfilePair pair;
+  if (!pair.open(profile, error)) return nullptr;
+  // Source → printer with the print intent, then printer → source for display.
+  const cmsUInt32Number display_intent =
+      profile.simulate_paper ? INTENT_ABSOLUTE_COLORIMETRIC : INTENT_RELATIVE_COLORIMETRIC;
+  cmsHTRANSFORM t = cmsCreateProofingTransform(
+      pair.source, TYPE_RGB_16, pair.source, TYPE_RGB_16, pair.cmyk, static_cast<cmsUInt32Number>(profile.intent),
+      display_intent, cmsFLAGS_SOFTPROOFING | transform_flags(profile));
+  if (!t) {
+    set_error(error, "the profiles do not support this intent");
+    return nullptr;
+  }
+  const int n = kProofLutSize;
+  const size_t count = static_cast<size_t>(n) * n * n;
+  std::vector<uint16_t> in(count * 3), out(count * 3);
+  size_t i = 0;
+  for (int b = 0; b < n; ++b) {
+    for (int g = 0; g < n; ++g) {
+      for (int r = 0; r < n; ++r) {  // red fastest, as ColorLut3D
+        in[i++] = static_cast<uint16_t>((r * 65535 + (n - 1) / 2) / (n - 1));
+        in[i++] = static_cast<uint16_t>((g * 65535 + (n - 1) / 2) / (n - 1));
+        in[i++] = static_cast<uint16_t>((b * 65535 + (n - 1) / 2) / (n - 1));
+      }
+    }
+  }
+  cmsDoTransform(t, in.data(), out.data(), static_cast<cmsUInt32Number>(count));
+  cmsDeleteTransform(t);
+  std::vector<float> rgb(count * 3);
+  for (size_t k = 0; k < rgb.size(); ++k) rgb[k] = out[k] / 65535.0f;
+  return ColorLut3D::from_float(n, rgb.data());
+}
+#endif
+
+}  // namespace
+
+RenderingIntent rendering_intent_from_int(int value) {
+  switch (value) {
+    case static_cast<int>(RenderingIntent::kRelativeColorimetric): return RenderingIntent::kRelativeColorimetric;
+    case static_cast<int>(RenderingIntent::kSaturation): return RenderingIntent::kSaturation;
+    case static_cast<int>(RenderingIntent::kAbsoluteColorimetric): return RenderingIntent::kAbsoluteColorimetric;
+    default: return RenderingIntent::kPerceptual;
+  }
+}
+
+bool color_management_available() {
+  return IRIS_CMS_LCMS != 0;
+}
+
+std::shared_ptr<const CmykTransform> acquire_cmyk_transform(const CmykProfile& profile, std::string* error) {
+#if IRIS_CMS_LCMS
+  std::string key;
+  if (profile.empty() || !make_key('t', profile, key)) {
+    set_error(error, "profile file not found");
+    return nullptr;
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (const CacheEntry* hit = find_entry(key)) return hit->transform;
+  }
+  // Built outside the lock; concurrent misses on one profile may build twice.
+  auto transform = build_transform(profile, error);
+  if (transform) insert_entry(CacheEntry{key, transform, nullptr});
+  return transform;
+#else
+  (void)profile;
+  set_error(error, "built without LittleCMS");
+  return nullptr;
+#endif
+}
+
+void cmyk_transform_rows(const CmykTransform& transform, const uint8_t* rgba, size_t rgba_stride,
+                         uint8_t* cmyk, size_t cmyk_stride, int width, int y_begin, int y_end) {
+#if IRIS_CMS_LCMS
+  std::vector<uint8_t> rgb(static_cast<size_t>(width) * 3);
+  for (int y = y_begin; y < y_end; ++y) {
+    const uint8_t* src = rgba + rgba_stride * static_cast<size_t>(y);
+    for (int x = 0; x < width; ++x) {
+      const int a = src[4 * x + 3];
+      for (int c = 0; c < 3; ++c) {
+        // c * a + 255 * (255 - a), divided by 255 with rounding
+        const int v = src[4 * x + c] * a + 255 * (255 - a) + 128;
+        rgb[3 * static_cast<size_t>(x) + c] = static_cast<uint8_t>((v + (v >> 8)) >> 8);
+      }
+    }
+    cmsDoTransform(transform.transform_, rgb.data(), cmyk + cmyk_stride * static_cast<size_t>(y),
+                   static_cast<cmsUInt32Number>(width));
+  }
+#else
+  (void)transform, (void)rgba, (void)rgba_stride, (void)cmyk, (void)cmyk_stride, (void)width, (void)y_begin,
+      (void)y_end;
+#endif
+}
+
+const std::vector<uint8_t>& cmyk_profile_bytes(const CmykTransform& transform) {
+  return transform.profile_;
+}
+
+std::shared_ptr<const ColorLut3D> acquire_soft_proof_lut(const CmykProfile& profile, std::string* error) {
+#if IRIS_CMS_LCMS
+  std::string key;
+  if (profile.empty() || !make_key('p', profile, key)) {
+    set_error(error, "profile file not found");
+    return nullptr;
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (const CacheEntry* hit = find_entry(key)) return hit->proof;
+  }
+  auto proof = build_proof(profile, error);
+  if (proof) insert_entry(CacheEntry{key, nullptr, proof});
+  return proof;
+#else
+  (void)profile;
+  set_error(error, "built without LittleCMS");
+  return nullptr;
+#endif
+}
+
+void purge_color_transforms() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_lru.clear();
+}
+
+}  // namespace iris
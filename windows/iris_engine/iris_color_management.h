@@ -0,0 +1,88 @@
+/**
+ * Iris Engine — ICC color management (2026).
+ *
+ * sRGB → printer CMYK conversion and soft proofing through LittleCMS, when the engine is
+ * built with it (IRIS_ENGINE_HAS_LCMS2). Building an ICC transform parses both profiles
+ * and precalculates an optimized 8-bit pipeline, which costs far more than running it on
+ * a photo, so transforms are built once per profile pair, intent and flags and cached
+ * process-wide. Profiles are keyed by path and revalidated against the file's size and
+ * modification time.
+ *
+ * A soft proof (sRGB → CMYK → sRGB) is baked from the proofing transform into a
+ * ColorLut3D and cached as well, so proofing the same profile again is one LUT pass
+ * (iris_color_lut.h). Without LittleCMS every call fails and
+ * color_management_available() is false.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_COLOR_MANAGEMENT_H
+#define IRIS_ENGINE_IRIS_COLOR_MANAGEMENT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "iris_color_lut.h"
+
+namespace iris {
+
+/** ICC rendering intents, in ICC numbering. */
+enum class RenderingIntent : int {
+  kPerceptual = 0,
+  kRelativeColorimetric = 1,
+  kSaturation = 2,
+  kAbsoluteColorimetric = 3,
+};
+
+/** Maps an FFI value to an intent; unknown values give perceptual. */
+RenderingIntent rendering_intent_from_int(int value);
+
+/** Printer profile and how to reach it; also the transform cache key. */
+struct CmykProfile {
+  std::string profile_path;    // printer CMYK ICC profile (UTF-8); empty = no conversion
+  std::string source_profile;  // RGB profile of the pixels; empty = built-in sRGB
+  RenderingIntent intent = RenderingIntent::kPerceptual;
+  bool black_point_compensation = true;
+  bool simulate_paper = false;  // soft proof shows the paper white (absolute colorimetric)
+
+  bool empty() const { return profile_path.empty(); }
+};
+
+/** True when the engine was built with LittleCMS. */
+bool color_management_available();
+
+/** Cached RGB → CMYK transform (defined in iris_color_management.cpp). Thread-safe. */
+class CmykTransform;
+
+/**
+ * Transform for [profile], from cache when the profile files are unchanged. On failure
+ * returns null and, if [error] is set, a short reason.
+ */
+std::shared_ptr<const CmykTransform> acquire_cmyk_transform(const CmykProfile& profile,
+                                                            std::string* error = nullptr);
+
+/**
+ * Converts RGBA rows [y_begin, y_end) of a width-wide image to 4-byte CMYK (0 = no ink).
+ * Pixels are composited over paper white first, since a print has no alpha. Safe to run
+ * per row band.
+ */
+void cmyk_transform_rows(const CmykTransform& transform, const uint8_t* rgba, size_t rgba_stride,
+                         uint8_t* cmyk, size_t cmyk_stride, int width, int y_begin, int y_end);
+
+/** The printer profile's bytes, for embedding in the output file. */
+const std::vector<uint8_t>& cmyk_profile_bytes(const CmykTransform& transform);
+
+/**
+ * Soft proof of [profile] as a lattice: source RGB through the printer CMYK and back to
+ * the source space. Cached like the transforms. Null on failure, as above.
+ */
+std::shared_ptr<const ColorLut3D> acquire_soft_proof_lut(const CmykProfile& profile,
+                                                         std::string* error = nullptr);
+
+/** Drops every cached transform and proof (held ones stay valid). */
+void purge_color_transforms();
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_COLOR_MANAGEMENT_H
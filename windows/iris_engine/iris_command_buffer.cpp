@@ -0,0 +1,254 @@
+/**
+ * Iris Engine — Recorded command buffers — implementation.
+ */
+
+#include "iris_command_buffer.h"
+#include "iris_image_cache.h"
+#include "iris_thread_pool.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace iris {
+
+namespace {
+
+bool valid_geometry(const CutGeometry& g) {
+  return g.iris_r > 0 && g.pupil_r >= 0 && g.pupil_r < g.iris_r;
+}
+
+bool valid_command(const Command& c) {
+  switch (c.op) {
+    case CommandOp::kLoadFile:
+    case CommandOp::kExportFile:
+      return !c.path.empty();
+    case CommandOp::kCutAuto:
+      return c.iris_radius_scale > 0;
+    case CommandOp::kCutCircles:
+      return valid_geometry(c.geometry);
+    case CommandOp::kCutFromView:
+      return c.view_w > 0 && c.view_h > 0 && c.outer_r > 0 &&
+             c.inner_r >= 0 && c.inner_r < c.outer_r;
+    case CommandOp::kRemoveFlash:
+      return c.flash.brightness_threshold >= 0 && c.flash.brightness_threshold <= 1 &&
+             c.flash.dilate_pixels >= 0 &&
+             (c.flash.search_outer_r <= 0 || c.flash.search_inner_r < c.flash.search_outer_r);
+    case CommandOp::kApplyEffects:
+      return c.effects.gamma > 0;
+    case CommandOp::kCrop:
+      return c.crop_w > 0 && c.crop_h > 0;
+    case CommandOp::kApplyLut:
+      return !c.lut_name.empty();
+    case CommandOp::kExportPrint:
+      return !c.path.empty() && c.print.dpi > 0 && c.print.width_cm >= 0;
+    case CommandOp::kSoloEffect:
+      return c.solo.extent >= 1 && c.solo.intensity >= 0 && c.solo.size > 0 && c.solo.count >= 0 &&
+             c.solo.max_side >= 0;
+    case CommandOp::kDuoEffect:
+      return !c.path.empty() && c.duo.softness >= 0 && c.duo.offset >= 0 && c.duo.extent >= 0 &&
+             c.duo.max_side >= 0;
+    case CommandOp::kEditRender:
+      return valid_edit_params(c.edit);
+    case CommandOp::kCompose: {
+      int w = 0, h = 0;
+      return !c.layers.empty() && c.layers.size() <= static_cast<size_t>(COMPOSE_MAX_LAYERS) &&
+             std::none_of(c.layers.begin(), c.layers.end(), [](const std::string& p) { return p.empty(); }) &&
+             compose_canvas_size(c.compose, &w, &h);
+    }
+  }
+  return false;
+}
+
+/** Runs one submission; owns the scratch buffer recycled between size-changing steps. */
+class Executor {
+ public:
+  explicit Executor(IrisObject& target) : target_(target) {}
+
+  bool run(const Command& c) {
+    switch (c.op) {
+      case CommandOp::kLoadFile:
+        return target_.load_from_file(c.path.c_str());
+      case CommandOp::kCutAuto:
+        return target_.cut_iris_to_alpha(c.iris_radius_scale);
+      case CommandOp::kCutCircles:
+        return warp(c.geometry, c.cut_options);
+      case CommandOp::kCutFromView:
+        return warp(cut_geometry_from_view(target_.width(), target_.height(), c.view_w, c.view_h,
+                                           c.outer_r, c.inner_r, c.outer_dx, c.outer_dy),
+                    c.cut_options);
+      case CommandOp::kRemoveFlash:
+        return target_.remove_flash(c.flash);
+      case CommandOp::kApplyEffects:
+        return target_.apply_effect_params(c.effects);
+      case CommandOp::kCrop:
+        return crop(c.crop_x, c.crop_y, c.crop_w, c.crop_h);
+      case CommandOp::kExportFile:
+        return target_.save_to_file(c.path.c_str(), c.format, c.quality);
+      case CommandOp::kApplyLut:
+        return target_.apply_lut(c.lut_name);
+      case CommandOp::kExportPrint:
+        return target_.export_print(c.path.c_str(), c.print);
+      case CommandOp::kSoloEffect:
+        return solo_effect(c.solo);
+      case CommandOp::kDuoEffect:
+        return duo_effect(c.path, c.duo);
+      case CommandOp::kEditRender:
+        return target_.edit_render(c.edit);
+      case CommandOp::kCompose:
+        return compose(c.layers, c.compose);
+    }
+    return false;
+  }
+
+ private:
+  IrisObject& target_;
+  std::shared_ptr<PixelBuffer> scratch_;
+
+  /** Scratch of [bytes]; the first call reserves the current image size, an upper bound
+   *  for every later cut/crop output, so the list allocates at most once. */
+  uint8_t* scratch(size_t bytes) {
+    if (!scratch_) {
+      scratch_ = std::make_shared<PixelBuffer>();
+      scratch_->reserve(std::max(bytes, static_cast<size_t>(target_.width()) *
+                                        static_cast<size_t>(target_.height()) * 4));
+      count_allocation(scratch_->capacity());
+    }
+    scratch_->resize(bytes);
+    return scratch_->data();
+  }
+
+  /** Makes the scratch the image; the old pixels become the next scratch. */
+  bool commit(int w, int h) { return target_.swap_rgba(scratch_, w, h); }
+
+  bool warp(const CutGeometry& g, const CutOptions& options) {
+    CutOptions opts = options;
+    opts.preview = false;
+    if (opts.num_threads <= 0) opts.num_threads = target_.num_threads();
+    int w = 0, h = 0;
+    {
+      std::shared_ptr<const PixelBuffer> src = target_.borrow_rgba();
+      if (!src) return false;
+      const cv::Mat view(target_.height(), target_.width(), CV_8UC4,
+                         const_cast<uint8_t*>(src->data()));
+      warp_iris_cut(view, g, nullptr, 0, &w, &h, opts);  // size query
+      if (w <= 0 || h <= 0) return false;
+      const size_t bytes = static_cast<size_t>(w) * static_cast<size_t>(h) * 4;
+      if (!warp_iris_cut(view, g, scratch(bytes), bytes, &w, &h, opts)) return false;
+    }  // drop the borrow so the old pixels can be recycled
+    return commit(w, h);
+  }
+
+  bool crop(int x, int y, int cw, int ch) {
+    const int iw = target_.width(), ih = target_.height();
+    const int x0 = std::clamp(x, 0, iw), y0 = std::clamp(y, 0, ih);
+    const int x1 = std::clamp(x + cw, 0, iw), y1 = std::clamp(y + ch, 0, ih);
+    const int w = x1 - x0, h = y1 - y0;
+    if (w <= 0 || h <= 0) return false;
+    if (w == iw && h == ih) return true;
+    {
+      std::shared_ptr<const PixelBuffer> src = target_.borrow_rgba();
+      if (!src) return false;
+      const size_t row_bytes = static_cast<size_t>(w) * 4;
+      const size_t src_step = static_cast<size_t>(iw) * 4;
+      uint8_t* dst = scratch(row_bytes * static_cast<size_t>(h));
+      const uint8_t* base = src->data() + static_cast<size_t>(y0) * src_step + static_cast<size_t>(x0) * 4;
+      parallel_for_rows(h, target_.num_threads(), [&](int r0, int r1) {
+        for (int r = r0; r < r1; ++r)
+          std::memcpy(dst + static_cast<size_t>(r) * row_bytes, base + static_cast<size_t>(r) * src_step, row_bytes);
+      });
+    }
+    return commit(w, h);
+  }
+
+  bool solo_effect(const SoloEffectParams& params) {
+    SoloEffectParams p = params;
+    if (p.num_threads <= 0) p.num_threads = target_.num_threads();
+    SoloEffectCanvas canvas;
+    {
+      std::shared_ptr<const PixelBuffer> src = target_.borrow_rgba();
+      if (!src || !solo_effect_canvas(src->data(), target_.width(), target_.height(), p, &canvas)) return false;
+      scratch(static_cast<size_t>(canvas.side) * static_cast<size_t>(canvas.side) * 4);
+      if (!apply_solo_effect(src->data(), target_.width(), target_.height(), p, canvas, *scratch_)) return false;
+    }
+    return commit(canvas.side, canvas.side);
+  }
+
+  /** Replaces the image with the layout; layers are decoded through the image cache. */
+  bool compose(const std::vector<std::string>& paths, const ComposeSpec& spec) {
+    ComposeSpec s = spec;
+    if (s.num_threads <= 0) s.num_threads = target_.num_threads();
+    std::vector<std::shared_ptr<const cv::Mat>> sources;  // keeps the decoded layers alive
+    std::vector<ComposeLayer> layers;
+    for (const std::string& path : paths) {
+      std::shared_ptr<const cv::Mat> rgba = load_rgba_cached(path.c_str());
+      if (!rgba || rgba->empty() || !rgba->isContinuous()) return false;
+      layers.push_back({rgba->ptr<uint8_t>(), rgba->cols, rgba->rows});
+      sources.push_back(std::move(rgba));
+    }
+    int w = 0, h = 0;
+    scratch(0);  // compose_irises sizes it
+    if (!compose_irises(layers, s, *scratch_, &w, &h)) return false;
+    return commit(w, h);
+  }
+
+  /** The image is the first iris; [second_path] is decoded through the image cache. */
+  bool duo_effect(const std::string& second_path, const DuoEffectParams& params) {
+    std::shared_ptr<const cv::Mat> second = load_rgba_cached(second_path.c_str());
+    if (!second || second->empty() || !second->isContinuous()) return false;
+    DuoEffectParams p = params;
+    if (p.num_threads <= 0) p.num_threads = target_.num_threads();
+    int w = 0, h = 0;
+    {
+      std::shared_ptr<const PixelBuffer> src = target_.borrow_rgba();
+      if (!src) return false;
+      scratch(0);  // apply_duo_effect sizes it
+      if (!apply_duo_effect(src->data(), target_.width(), target_.height(), second->ptr<uint8_t>(), second->cols,
+                            second->rows, p, *scratch_, &w, &h)) {
+        return false;
+      }
+    }
+    return commit(w, h);
+  }
+};
+
+}  // namespace
+
+int CommandBuffer::validate(bool target_has_image) const {
+  bool has_image = target_has_image;
+  for (size_t i = 0; i < commands_.size(); ++i) {
+    const Command& c = commands_[i];
+    if (!valid_command(c)) return static_cast<int>(i);
+    if (c.op == CommandOp::kLoadFile || c.op == CommandOp::kCompose) {
+      has_image = true;
+    } else if (!has_image) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool CommandBuffer::submit(IrisObject& target, int* failed_index) const {
+  return submit(target, failed_index, SubmitHooks());
+}
+
+bool CommandBuffer::submit(IrisObject& target, int* failed_index, const SubmitHooks& hooks) const {
+  int bad = validate(target.width() > 0 && target.height() > 0);
+  if (bad < 0) {
+    StatsScope scope(&target.stats());  // steps count toward the handle on any thread
+    Executor exec(target);
+    const int total = static_cast<int>(commands_.size());
+    for (int i = 0; i < total; ++i) {
+      if ((hooks.cancel && hooks.cancel->load(std::memory_order_relaxed)) ||
+          !exec.run(commands_[static_cast<size_t>(i)])) {
+        bad = i;
+        break;
+      }
+      if (hooks.progress) hooks.progress(i + 1, total);
+    }
+  }
+  if (failed_index) *failed_index = bad;
+  return bad < 0;
+}
+
+}  // namespace iris
@@ -0,0 +1,110 @@
+/**
+ * Iris Engine — Recorded command buffers (2026).
+ *
+ * An edit is recorded as an ordered list of operations (load or compose, cut, flash,
+ * effects, LUT, Art Studio effect, edit-stack render, crop, export) and submitted against an IrisObject in one call. Submission validates
+ * the whole list first. Steps then run back to back on the handle's pixels. Steps that
+ * change the image size write into one scratch buffer that is recycled through
+ * IrisObject::swap_rgba, so a list allocates at most one extra image.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_COMMAND_BUFFER_H
+#define IRIS_ENGINE_IRIS_COMMAND_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "iris_art_effects.h"
+#include "iris_compose.h"
+#include "iris_cut.h"
+#include "iris_edit_stack.h"
+#include "iris_engine.h"
+#include "iris_print_export.h"
+
+namespace iris {
+
+enum class CommandOp : int {
+  kLoadFile = 1,
+  kCutAuto,       // Hough detection + alpha cut (IrisObject::cut_iris_to_alpha)
+  kCutCircles,    // radial warp with given circles, image space
+  kCutFromView,   // radial warp with circling-UI params (see cut_geometry_from_view)
+  kRemoveFlash,
+  kApplyEffects,
+  kCrop,
+  kExportFile,
+  kApplyLut,      // named LUT stored on the target (IrisObject::set_lut)
+  kExportPrint,   // streamed print export at a physical size (iris_print_export.h)
+  kSoloEffect,    // Art Studio effect around the cut iris (iris_art_effects.h)
+  kDuoEffect,     // Art Studio effect joining the image with a second cut iris
+  kEditRender,    // memoized cut → flash → effects over the handle's edit source (iris_edit_stack.h)
+  kCompose,       // Art Studio layout of cut irises (iris_compose.h); loads the canvas like kLoadFile
+};
+
+/** One recorded step; only the fields of its op are meaningful. */
+struct Command {
+  CommandOp op = CommandOp::kLoadFile;
+  std::string path;                  // kLoadFile, kExportFile, kExportPrint, kDuoEffect (second iris)
+  int format = 0;                    // kExportFile: ImageFormat value
+  int quality = -1;                  // kExportFile
+  float iris_radius_scale = 1.0f;    // kCutAuto
+  CutGeometry geometry{};            // kCutCircles
+  double view_w = 0, view_h = 0;     // kCutFromView
+  double outer_r = 0, inner_r = 0;
+  double outer_dx = 0, outer_dy = 0;
+  CutOptions cut_options;            // kCutCircles, kCutFromView (preview ignored)
+  FlashRemovalParams flash{};        // kRemoveFlash
+  EffectParams effects{};            // kApplyEffects
+  std::string lut_name;              // kApplyLut
+  int crop_x = 0, crop_y = 0;        // kCrop, clamped to the image at run time
+  int crop_w = 0, crop_h = 0;
+  PrintExportOptions print;          // kExportPrint
+  SoloEffectParams solo;             // kSoloEffect
+  DuoEffectParams duo;               // kDuoEffect
+  EditStackParams edit;              // kEditRender
+  std::vector<std::string> layers;   // kCompose: cut iris paths, drawn in order
+  ComposeSpec compose;               // kCompose (num_threads 0 = the target's)
+};
+
+/** Optional hooks for asynchronous submits (iris_jobs.h). */
+struct SubmitHooks {
+  const std::atomic<bool>* cancel = nullptr;     // polled before each step
+  std::function<void(int done, int total)> progress;  // after each step
+};
+
+class CommandBuffer {
+ public:
+  void record(const Command& command) { commands_.push_back(command); }
+  void clear() { commands_.clear(); }
+  size_t size() const { return commands_.size(); }
+  const std::vector<Command>& commands() const { return commands_; }
+
+  /**
+   * Checks every parameter, and that something loads (or composes) an image before the first step
+   * that needs one (target_has_image covers a handle that is already loaded).
+   * Returns the index of the first bad command, or -1 when the list is valid.
+   */
+  int validate(bool target_has_image) const;
+
+  /**
+   * Validates, then runs the list on [target]. On failure *failed_index (optional)
+   * receives the offending command; steps before it have already been applied.
+   * Returns true when every step succeeded (*failed_index = -1).
+   */
+  bool submit(IrisObject& target, int* failed_index = nullptr) const;
+
+  /**
+   * Same, with [hooks]. A set cancel flag stops before the next step, which is then
+   * reported as failed; the caller tells cancellation apart by its own flag.
+   */
+  bool submit(IrisObject& target, int* failed_index, const SubmitHooks& hooks) const;
+
+ private:
+  std::vector<Command> commands_;
+};
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_COMMAND_BUFFER_H
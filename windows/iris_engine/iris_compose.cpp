@@ -0,0 +1,255 @@
+/**
+ * Iris Engine — Multi-iris compositor — implementation.
+ */
+
+#include "iris_compose.h"
+#include "iris_premultiplied.h"
+#include "iris_thread_pool.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace iris {
+
+namespace {
+
+constexpr double kCmPerInch = 2.54;
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kMaxCanvasSide = 1 << 16;
+constexpr size_t kMaxCanvasPixels = size_t{1} << 29;  // 2 GiB of RGBA
+
+/** x / 255, rounded, for x in [0, 255 * 255]. */
+inline int div255(int x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+/** Cell centres of the Art Studio arrangements, in grid units (x, y). */
+struct Arrangement {
+  int cols = 1, rows = 1;
+  std::array<std::array<double, 2>, COMPOSE_MAX_LAYERS> cells{};
+};
+
+Arrangement studio_arrangement(int count) {
+  Arrangement a;
+  switch (count) {
+    case 1: a = {1, 1, {{{0.5, 0.5}}}}; break;
+    case 2: a = {2, 2, {{{1.5, 0.5}, {0.5, 1.5}}}}; break;  // top right, bottom left
+    case 3: a = {2, 2, {{{1.0, 0.5}, {0.5, 1.5}, {1.5, 1.5}}}}; break;
+    case 4: a = {2, 2, {{{0.5, 0.5}, {1.5, 0.5}, {0.5, 1.5}, {1.5, 1.5}}}}; break;
+    case 5: a = {3, 2, {{{1.0, 0.5}, {2.0, 0.5}, {0.5, 1.5}, {1.5, 1.5}, {2.5, 1.5}}}}; break;
+    default: a = {3, 2, {{{0.5, 0.5}, {1.5, 0.5}, {2.5, 0.5}, {0.5, 1.5}, {1.5, 1.5}, {2.5, 1.5}}}}; break;
+  }
+  return a;
+}
+
+Arrangement line_arrangement(int count, bool vertical) {
+  Arrangement a;
+  a.cols = vertical ? 1 : count;
+  a.rows = vertical ? count : 1;
+  for (int i = 0; i < count; ++i) {
+    a.cells[static_cast<size_t>(i)] = vertical ? std::array<double, 2>{0.5, i + 0.5}
+                                               : std::array<double, 2>{i + 0.5, 0.5};
+  }
+  return a;
+}
+
+Arrangement transposed(Arrangement a) {
+  std::swap(a.cols, a.rows);
+  for (auto& c : a.cells) std::swap(c[0], c[1]);
+  return a;
+}
+
+/** Largest iris diameter that fits [a] inside the margins, with [gap] between cells. */
+double grid_diameter(const Arrangement& a, double avail_w, double avail_h, double gap) {
+  return std::min(avail_w / (a.cols + (a.cols - 1) * gap), avail_h / (a.rows + (a.rows - 1) * gap));
+}
+
+void place_grid(const Arrangement& a, int count, double d, double gap, int width, int height,
+                std::vector<ComposeSlot>& slots) {
+  const double pitch = d * (1 + gap);
+  const double left = (width - (a.cols * pitch - gap * d)) / 2;
+  const double top = (height - (a.rows * pitch - gap * d)) / 2;
+  for (int i = 0; i < count; ++i) {
+    const auto& c = a.cells[static_cast<size_t>(i)];
+    slots.push_back({left + c[0] * pitch - gap * d / 2, top + c[1] * pitch - gap * d / 2, d});
+  }
+}
+
+/** Clears row [y] outside the canvas disc, with a one-pixel coverage ramp on the edge. */
+void clip_row_to_disc(uint8_t* row, int y, int width, double cx, double cy, double r) {
+  const double dy = y + 0.5 - cy;
+  const double outer2 = (r + 0.5) * (r + 0.5) - dy * dy;
+  if (outer2 <= 0) {
+    std::memset(row, 0, static_cast<size_t>(width) * 4);
+    return;
+  }
+  const double ho = std::sqrt(outer2);
+  const int x0 = std::clamp(static_cast<int>(std::floor(cx - ho)), 0, width);
+  const int x1 = std::clamp(static_cast<int>(std::ceil(cx + ho)), x0, width);
+  std::memset(row, 0, static_cast<size_t>(x0) * 4);
+  std::memset(row + static_cast<size_t>(x1) * 4, 0, static_cast<size_t>(width - x1) * 4);
+  const double inner2 = (r - 0.5) * (r - 0.5) - dy * dy;
+  const double hi = inner2 > 0 ? std::sqrt(inner2) : -1.0;
+  for (int x = x0; x < x1; ++x) {
+    const double dx = x + 0.5 - cx;
+    if (std::abs(dx) <= hi) {
+      x = std::max(x, static_cast<int>(std::floor(cx + hi)) - 1);  // skip the fully covered run
+      continue;
+    }
+    const double cover = std::clamp(r + 0.5 - std::sqrt(dx * dx + dy * dy), 0.0, 1.0);
+    const int k = static_cast<int>(std::lround(cover * 255));
+    uint8_t* q = row + static_cast<size_t>(x) * 4;
+    for (int c = 0; c < 4; ++c) q[c] = static_cast<uint8_t>(div255(q[c] * k));
+  }
+}
+
+/** A layer resampled to its place on the canvas, premultiplied. */
+struct PlacedLayer {
+  cv::Mat pixels;  // CV_8UC4
+  int x = 0, y = 0;
+};
+
+int cv_interpolation(Interpolation mode) {
+  switch (mode) {
+    case Interpolation::kNearest: return cv::INTER_NEAREST;
+    case Interpolation::kBilinear: return cv::INTER_LINEAR;
+    case Interpolation::kLanczos3: return cv::INTER_LANCZOS4;
+    default: return cv::INTER_CUBIC;
+  }
+}
+
+bool place_layer(const ComposeLayer& layer, const ComposeSlot& slot, const ComposeSpec& spec, PlacedLayer& out) {
+  if (!layer.rgba || layer.width <= 0 || layer.height <= 0) return false;
+  const double scale = slot.size / std::max(layer.width, layer.height);
+  const int w = std::max(1, static_cast<int>(std::lround(layer.width * scale)));
+  const int h = std::max(1, static_cast<int>(std::lround(layer.height * scale)));
+  cv::Mat src(layer.height, layer.width, CV_8UC4, const_cast<uint8_t*>(layer.rgba));
+  // Premultiplied first, so the filter never pulls the colour of transparent pixels in.
+  cv::Mat pm = src.clone();
+  parallel_for_rows(pm.rows, spec.num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) premultiply_row(pm.ptr<uint8_t>(y), pm.cols);
+  });
+  if (w == layer.width && h == layer.height) {
+    out.pixels = pm;
+  } else {
+    const bool shrink = w < layer.width && h < layer.height;
+    cv::resize(pm, out.pixels, cv::Size(w, h), 0, 0, shrink ? cv::INTER_AREA : cv_interpolation(spec.interpolation));
+  }
+  out.x = static_cast<int>(std::lround(slot.cx - w / 2.0));
+  out.y = static_cast<int>(std::lround(slot.cy - h / 2.0));
+  return true;
+}
+
+}  // namespace
+
+ComposeLayout compose_layout_from_int(int value) {
+  switch (value) {
+    case static_cast<int>(ComposeLayout::kRow): return ComposeLayout::kRow;
+    case static_cast<int>(ComposeLayout::kColumn): return ComposeLayout::kColumn;
+    case static_cast<int>(ComposeLayout::kRound): return ComposeLayout::kRound;
+    case static_cast<int>(ComposeLayout::kRectangle): return ComposeLayout::kRectangle;
+    default: return ComposeLayout::kSquare;
+  }
+}
+
+bool compose_canvas_size(const ComposeSpec& spec, int* width, int* height) {
+  if (!width || !height || spec.dpi <= 0 || spec.width_cm <= 0 || spec.height_cm < 0) return false;
+  const double h_cm = spec.layout == ComposeLayout::kRound || spec.height_cm <= 0 ? spec.width_cm : spec.height_cm;
+  const double w = std::round(spec.width_cm / kCmPerInch * spec.dpi);
+  const double h = std::round(h_cm / kCmPerInch * spec.dpi);
+  if (w < 1 || h < 1 || w > kMaxCanvasSide || h > kMaxCanvasSide || w * h > static_cast<double>(kMaxCanvasPixels)) {
+    return false;
+  }
+  *width = static_cast<int>(w);
+  *height = static_cast<int>(h);
+  return true;
+}
+
+bool compose_slots(const ComposeSpec& spec, int count, int width, int height, std::vector<ComposeSlot>& slots) {
+  slots.clear();
+  if (count < 1 || count > COMPOSE_MAX_LAYERS || width <= 0 || height <= 0) return false;
+  const double gap = std::max(0.0, spec.gap);
+  const double margin = std::clamp(spec.margin, 0.0, 0.45) * std::min(width, height);
+  const double avail_w = width - 2 * margin;
+  const double avail_h = height - 2 * margin;
+
+  if (spec.layout == ComposeLayout::kRound) {
+    const double cx = width / 2.0, cy = height / 2.0;
+    const double room = std::min(avail_w, avail_h) / 2;
+    if (count == 1) {
+      slots.push_back({cx, cy, 2 * room});
+      return true;
+    }
+    // A ring touching the margin, neighbours [gap] apart; odd counts put one on top.
+    const double s = std::sin(kPi / count);
+    const double d = 2 * room * s / (1 + gap + s);
+    const double ring = room - d / 2;
+    const double start = -kPi / 2 + (count % 2 == 0 ? kPi / count : 0.0);
+    for (int i = 0; i < count; ++i) {
+      const double t = start + 2 * kPi * i / count;
+      slots.push_back({cx + ring * std::cos(t), cy + ring * std::sin(t), d});
+    }
+    return true;
+  }
+
+  Arrangement a;
+  if (spec.layout == ComposeLayout::kRow || spec.layout == ComposeLayout::kColumn) {
+    a = line_arrangement(count, spec.layout == ComposeLayout::kColumn);
+  } else {
+    a = studio_arrangement(count);
+    const Arrangement turned = transposed(a);
+    if (grid_diameter(turned, avail_w, avail_h, gap) > grid_diameter(a, avail_w, avail_h, gap)) a = turned;
+  }
+  const double d = grid_diameter(a, avail_w, avail_h, gap);
+  if (d <= 0) return false;
+  place_grid(a, count, d, gap, width, height, slots);
+  return true;
+}
+
+bool compose_irises(const std::vector<ComposeLayer>& layers, const ComposeSpec& spec,
+                    std::vector<uint8_t>& out, int* width, int* height) {
+  const int count = static_cast<int>(layers.size());
+  int w = 0, h = 0;
+  std::vector<ComposeSlot> slots;
+  if (!width || !height || !compose_canvas_size(spec, &w, &h) || !compose_slots(spec, count, w, h, slots)) {
+    return false;
+  }
+  std::vector<PlacedLayer> placed(layers.size());
+  for (size_t i = 0; i < layers.size(); ++i) {
+    if (!place_layer(layers[i], slots[i], spec, placed[i])) return false;
+  }
+
+  uint8_t bg[4];
+  std::memcpy(bg, spec.background, 4);
+  premultiply_row(bg, 1);
+  const size_t stride = static_cast<size_t>(w) * 4;
+  out.resize(stride * static_cast<size_t>(h));
+  const bool round = spec.layout == ComposeLayout::kRound;
+
+  // Each band is filled, blended, clipped and converted back while it is still in cache.
+  parallel_for_rows(h, spec.num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) {
+      uint8_t* row = out.data() + stride * static_cast<size_t>(y);
+      for (int x = 0; x < w; ++x) std::memcpy(row + 4 * x, bg, 4);
+      for (const PlacedLayer& layer : placed) {
+        const int ly = y - layer.y;
+        if (ly < 0 || ly >= layer.pixels.rows) continue;
+        const int x0 = std::max(0, layer.x);
+        const int x1 = std::min(w, layer.x + layer.pixels.cols);
+        if (x0 >= x1) continue;
+        blend_over_row(row + 4 * x0, layer.pixels.ptr<uint8_t>(ly) + 4 * (x0 - layer.x), x1 - x0);
+      }
+      if (round) clip_row_to_disc(row, y, w, w / 2.0, h / 2.0, w / 2.0);
+      unpremultiply_row(row, w);
+    }
+  }, 8);
+  *width = w;
+  *height = h;
+  return true;
+}
+
+}  // namespace iris
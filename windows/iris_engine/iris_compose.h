@@ -0,0 +1,82 @@
+/**
+ * Iris Engine — Multi-iris compositor for Art Studio layouts (2026).
+ *
+ * Places 1–6 cut irises (RGBA, transparent outside the iris) on a print canvas given in
+ * centimetres at a DPI. The layout decides where each iris goes:
+ *
+ *   Row / Column   one line of equal irises along the long side
+ *   Square / Rect  the Art Studio arrangements: 1, diagonal 2, 1 over 2, 2 x 2, 2 over 3,
+ *                  3 x 2; turned a quarter on a canvas that is taller than wide if the
+ *                  irises then come out larger
+ *   Round          a round canvas (width = diameter): one iris centred, or a ring of
+ *                  them, with everything outside the disc transparent
+ *
+ * Each layer is premultiplied, resampled once to its slot (area reduction when
+ * shrinking, the chosen filter when enlarging) and blended premultiplied-over onto the
+ * canvas with SSE2, in parallel row bands. Layers are drawn in order, so the result is
+ * identical at any thread count.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_COMPOSE_H
+#define IRIS_ENGINE_IRIS_COMPOSE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "iris_sampler.h"
+
+namespace iris {
+
+constexpr int COMPOSE_MAX_LAYERS = 6;
+
+enum class ComposeLayout : int {
+  kSquare = 0,
+  kRow = 1,
+  kColumn = 2,
+  kRound = 3,
+  kRectangle = 4,
+};
+
+/** Maps an FFI value to a layout; unknown values give square. */
+ComposeLayout compose_layout_from_int(int value);
+
+/** One iris: tightly packed RGBA with straight (unassociated) alpha. */
+struct ComposeLayer {
+  const uint8_t* rgba = nullptr;
+  int width = 0;
+  int height = 0;
+};
+
+struct ComposeSpec {
+  ComposeLayout layout = ComposeLayout::kSquare;
+  double width_cm = 20;
+  double height_cm = 0;          // 0 = square; ignored by kRound
+  int dpi = 300;
+  double gap = 0.1;              // between irises, as a fraction of their diameter
+  double margin = 0.05;          // around them, as a fraction of the canvas's short side
+  uint8_t background[4] = {0, 0, 0, 0};  // RGBA, straight alpha
+  Interpolation interpolation = Interpolation::kBicubic;
+  int num_threads = 0;
+};
+
+/** Where one iris goes: a square of [size] pixels centred on (cx, cy). */
+struct ComposeSlot {
+  double cx = 0, cy = 0, size = 0;
+};
+
+/** Canvas pixel size of [spec]; false when invalid or too large to compose. */
+bool compose_canvas_size(const ComposeSpec& spec, int* width, int* height);
+
+/** Slots for [count] irises on a width x height canvas, in layer order. */
+bool compose_slots(const ComposeSpec& spec, int count, int width, int height, std::vector<ComposeSlot>& slots);
+
+/**
+ * Composes [layers] (1..COMPOSE_MAX_LAYERS) into [out] (RGBA, straight alpha, resized to
+ * the canvas). A layer that is not square is fitted inside its slot, aspect kept.
+ */
+bool compose_irises(const std::vector<ComposeLayer>& layers, const ComposeSpec& spec,
+                    std::vector<uint8_t>& out, int* width, int* height);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_COMPOSE_H
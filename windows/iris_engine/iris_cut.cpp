@@ -1,60 +1,59 @@
 /**
  * Phase 1: Circling & Cutting — implementation.
  * Radial stretch maps [pupil_r, iris_r] -> [0.5*pupil_r, iris_r]; circular alpha mask; crop to iris box.
+ * The per-pixel mapping comes from cached remap tables (iris_warp_map.h).
  */
 
 #include "iris_cut.h"
+#include "iris_image_cache.h"
+#include "iris_stats.h"
+#include "iris_thread_pool.h"
+#include "iris_warp_map.h"
 #include <opencv2/core.hpp>
-#include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include <cmath>
 #include <cstdlib>
 #include <algorithm>
+#include <memory>
 
 namespace iris {
 
 namespace {
 
-constexpr double PUPIL_SHRINK = 0.5;  // final pupil = 50% of original
-
 inline double clamp0(double v) { return v < 0 ? 0 : v; }
 
-/** Bilinear sample RGBA at (x,y); (x,y) in [0,w), [0,h). Returns (r,g,b,a). */
-void sample_rgba(const cv::Mat& m, double x, double y, uint8_t* out) {
-  const int w = m.cols, h = m.rows;
-  if (w <= 0 || h <= 0) { out[0]=out[1]=out[2]=0; out[3]=0; return; }
-  int x0 = static_cast<int>(std::floor(x)), y0 = static_cast<int>(std::floor(y));
-  double fx = x - x0, fy = y - y0;
-  int x1 = std::min(x0 + 1, w - 1), y1 = std::min(y0 + 1, h - 1);
-  x0 = std::max(0, x0); y0 = std::max(0, y0);
-  auto at = [&m, w](int ix, int iy, int c) -> double {
-    return static_cast<double>(m.at<cv::Vec4b>(iy, ix)[c]);
-  };
-  for (int c = 0; c < 4; ++c) {
-    double v00 = at(x0, y0, c), v10 = at(x1, y0, c);
-    double v01 = at(x0, y1, c), v11 = at(x1, y1, c);
-    double v = (1 - fx) * (1 - fy) * v00 + fx * (1 - fy) * v10
-             + (1 - fx) * fy * v01 + fx * fy * v11;
-    int iv = static_cast<int>(std::round(v));
-    out[c] = static_cast<uint8_t>(std::clamp(iv, 0, 255));
+/** Deepest mip level whose resolution still covers [view_scale] (view px per image px). */
+int preview_level(double view_scale) {
+  int level = 0;
+  double s = 1.0;
+  while (s * 0.5 >= view_scale && level < 16) {
+    s *= 0.5;
+    ++level;
   }
+  return level;
 }
 
 }  // namespace
 
+/** Where the warp writes: a caller buffer, or a malloc'd one handed back via *allocated. */
+struct CutTarget {
+  uint8_t* buffer = nullptr;
+  size_t capacity = 0;
+  uint8_t** allocated = nullptr;
+};
+
 /** Internal: work on preloaded RGBA. */
 static bool process_iris_cut_impl(
   const cv::Mat& rgba,
-  double iris_cx, double iris_cy, double iris_r,
-  double pupil_r,
-  uint8_t** out_data, int* out_width, int* out_height
+  const CutGeometry& g,
+  const CutTarget& target, int* out_width, int* out_height,
+  const CutOptions& options
 ) {
+  StageTimer timer(Stage::kWarp);
   const int iw = rgba.cols, ih = rgba.rows;
-  const double icx = iris_cx, icy = iris_cy, ir = iris_r;
-  const double pr = pupil_r;
-  const double pr_half = PUPIL_SHRINK * pr;
-  const double annulus_src = ir - pr;   // source radial span
-  const double annulus_dst = ir - pr_half;  // destination radial span
+  const double icx = g.iris_cx, icy = g.iris_cy, ir = g.iris_r;
+  const double pr = g.pupil_r;
+  const double annulus_dst = ir - PUPIL_SHRINK * pr;  // destination radial span
   if (annulus_dst <= 0) return false;
 
   // Crop to square bounding box of iris (clamped to image)
@@ -68,106 +67,211 @@ static bool process_iris_cut_impl(
   if (crop_w <= 0 || crop_h <= 0) return false;
   side = std::min(crop_w, crop_h);
 
+  // Report the size first so callers with a short (or no) buffer can size one.
+  *out_width = side;
+  *out_height = side;
   size_t buf_len = static_cast<size_t>(side) * static_cast<size_t>(side) * 4;
-  uint8_t* buf = static_cast<uint8_t*>(std::malloc(buf_len));
-  if (!buf) return false;
-
-  // For each output pixel: r_dst from iris center; map to r_src; sample; set alpha by mask.
-  for (int dy = 0; dy < side; ++dy) {
-    for (int dx = 0; dx < side; ++dx) {
-      double gx = crop_x + dx + 0.5;
-      double gy = crop_y + dy + 0.5;
-      double dx_c = gx - icx, dy_c = gy - icy;
-      double r_dst = std::sqrt(dx_c * dx_c + dy_c * dy_c);
-      double theta = std::atan2(dy_c, dx_c);
-
-      if (r_dst > ir || r_dst < pr_half) {
-        buf[(dy * side + dx) * 4 + 0] = 0;
-        buf[(dy * side + dx) * 4 + 1] = 0;
-        buf[(dy * side + dx) * 4 + 2] = 0;
-        buf[(dy * side + dx) * 4 + 3] = 0;
-        continue;
-      }
-
-      // Map r_dst in [pr_half, ir] -> r_src in [pr, ir]
-      double t = (r_dst - pr_half) / annulus_dst;
-      t = std::clamp(t, 0.0, 1.0);
-      double r_src = pr + t * annulus_src;
-      double sx = icx + r_src * std::cos(theta);
-      double sy = icy + r_src * std::sin(theta);
-
-      uint8_t px[4];
-      sample_rgba(rgba, sx, sy, px);
-      buf[(dy * side + dx) * 4 + 0] = px[0];
-      buf[(dy * side + dx) * 4 + 1] = px[1];
-      buf[(dy * side + dx) * 4 + 2] = px[2];
-      buf[(dy * side + dx) * 4 + 3] = px[3];
-    }
+  uint8_t* buf = target.buffer;
+  if (buf) {
+    if (target.capacity < buf_len) return false;
+  } else if (target.allocated) {
+    buf = static_cast<uint8_t*>(std::malloc(buf_len));
+    if (!buf) return false;
+  } else {
+    return false;
   }
 
-  *out_data = buf;
-  *out_width = side;
-  *out_height = side;
+  // Source ROI covers every sample of the annulus plus the widest filter footprint
+  // (Lanczos-3 reaches 2 px left/up and 3 px right/down of the integer position).
+  constexpr int kFilterMargin = 4;
+  const int roi_x0 = std::max(0, crop_x - kFilterMargin);
+  const int roi_y0 = std::max(0, crop_y - kFilterMargin);
+  const int roi_x1 = std::min(iw, static_cast<int>(std::ceil(icx + ir)) + kFilterMargin);
+  const int roi_y1 = std::min(ih, static_cast<int>(std::ceil(icy + ir)) + kFilterMargin);
+  const int roi_w = std::max(1, roi_x1 - roi_x0);
+  const int roi_h = std::max(1, roi_y1 - roi_y0);
+
+  // The map only depends on the radii; the center (integer and sub-pixel) is applied
+  // per row, so dragging a circle reuses it.
+  std::shared_ptr<const WarpMap> map = acquire_warp_map(make_warp_map_key(ir, pr));
+  const WarpPlacement at = place_warp_map(*map, icx - crop_x, icy - crop_y,
+                                          icx - roi_x0, icy - roi_y0, roi_w, roi_h);
+
+  // One gather per row with the requested kernel; outside-annulus pixels map off the
+  // ROI and come out transparent.
+  cv::Mat src_roi = rgba(cv::Rect(roi_x0, roi_y0, roi_w, roi_h));
+  cv::Mat dst(side, side, CV_8UC4, buf);
+  parallel_for_rows(side, options.num_threads, [&](int y0, int y1) {
+    cv::Mat row_xy(1, side, CV_16SC2);
+    cv::Mat row_frac(1, side, CV_16UC1);
+    for (int y = y0; y < y1; ++y) {
+      warp_map_row(*map, at, y, side, row_xy.ptr<int16_t>(), row_frac.ptr<uint16_t>());
+      cv::Mat dst_row = dst.row(y);
+      remap_rows(src_roi, row_xy, row_frac, dst_row, 0, 1, options.interpolation);
+    }
+  });
+
+  if (!target.buffer) *target.allocated = buf;
   return true;
 }
 
-bool process_iris_cut(
+/** Image-space entry: validates, loads the (cached) source and warps. */
+static bool cut_from_path(
   const char* image_path,
-  double iris_cx, double iris_cy, double iris_r,
-  double pupil_cx, double pupil_cy, double pupil_r,
-  uint8_t** out_data, int* out_width, int* out_height
+  double iris_cx, double iris_cy, double iris_r, double pupil_r,
+  const CutTarget& target, int* out_width, int* out_height,
+  const CutOptions& options
 ) {
-  if (!image_path || !out_data || !out_width || !out_height ||
+  if (!image_path || !out_width || !out_height ||
       iris_r <= 0 || pupil_r < 0 || pupil_r >= iris_r) {
     return false;
   }
-  *out_data = nullptr;
   *out_width = 0;
   *out_height = 0;
-  cv::Mat src = cv::imread(image_path);
-  if (src.empty()) return false;
-  cv::Mat rgba;
-  if (src.channels() == 3)
-    cv::cvtColor(src, rgba, cv::COLOR_BGR2RGBA);
-  else if (src.channels() == 4)
-    rgba = src.clone();
-  else
-    return false;
-  return process_iris_cut_impl(rgba, iris_cx, iris_cy, iris_r, pupil_r,
-                               out_data, out_width, out_height);
+  std::shared_ptr<const cv::Mat> rgba = load_rgba_cached(image_path);
+  if (!rgba) return false;
+  const CutGeometry g{iris_cx, iris_cy, iris_r, pupil_r};
+  return process_iris_cut_impl(*rgba, g, target, out_width, out_height, options);
 }
 
-bool process_iris_cut_from_view(
+/** View-space entry: converts to image space and picks the preview mip level if asked. */
+static bool cut_from_view(
   const char* image_path,
   double view_w, double view_h,
   double outer_r, double inner_r,
   double outer_dx, double outer_dy,
-  double inner_dx, double inner_dy,
-  uint8_t** out_data, int* out_width, int* out_height
+  const CutTarget& target, int* out_width, int* out_height,
+  const CutOptions& options
 ) {
-  if (!image_path || view_w <= 0 || view_h <= 0) return false;
+  if (!image_path || !out_width || !out_height || view_w <= 0 || view_h <= 0) return false;
+  *out_width = 0;
+  *out_height = 0;
 
-  cv::Mat src = cv::imread(image_path);
-  if (src.empty()) return false;
-  const int w = src.cols, h = src.rows;
+  std::shared_ptr<const cv::Mat> rgba = load_rgba_cached(image_path);
+  if (!rgba) return false;
+  const int w = rgba->cols, h = rgba->rows;
   if (w <= 0 || h <= 0) return false;
 
+  CutGeometry g = cut_geometry_from_view(w, h, view_w, view_h, outer_r, inner_r,
+                                         outer_dx, outer_dy);
+  if (options.preview) {
+    const int level = preview_level(std::min(view_w / w, view_h / h) *
+                                    (options.preview_pixel_ratio > 0 ? options.preview_pixel_ratio : 1.0));
+    int got = 0;
+    std::shared_ptr<const cv::Mat> mip = level > 0 ? load_rgba_level_cached(image_path, level, &got) : nullptr;
+    if (mip && got > 0) {
+      // Levels are exact 2x box reductions, so the same geometry just scales.
+      const double s = std::ldexp(1.0, -got);
+      const CutGeometry gs{g.iris_cx * s, g.iris_cy * s, g.iris_r * s, g.pupil_r * s};
+      return process_iris_cut_impl(*mip, gs, target, out_width, out_height, options);
+    }
+  }
+  return process_iris_cut_impl(*rgba, g, target, out_width, out_height, options);
+}
+
+CutGeometry cut_geometry_from_view(
+  int image_w, int image_h,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy
+) {
+  const double w = image_w, h = image_h;
   double scale = std::min(view_w / w, view_h / h);
   double shortest = std::min(view_w, view_h);
 
-  double iris_cx = w / 2.0 + (view_w * outer_dx) / scale;
-  double iris_cy = h / 2.0 + (view_h * outer_dy) / scale;
-  double iris_r = (outer_r * shortest / 2.0) / scale;
-  double pupil_cx = w / 2.0 + (view_w * inner_dx) / scale;
-  double pupil_cy = h / 2.0 + (view_h * inner_dy) / scale;
-  double pupil_r = (inner_r * shortest / 2.0) / scale;
-  cv::Mat rgba;
-  if (src.channels() == 3)
-    cv::cvtColor(src, rgba, cv::COLOR_BGR2RGBA);
-  else
-    rgba = src.clone();
-  return process_iris_cut_impl(rgba, iris_cx, iris_cy, iris_r, pupil_r,
-                               out_data, out_width, out_height);
+  CutGeometry g;
+  g.iris_cx = w / 2.0 + (view_w * outer_dx) / scale;
+  g.iris_cy = h / 2.0 + (view_h * outer_dy) / scale;
+  g.iris_r = (outer_r * shortest / 2.0) / scale;
+  g.pupil_r = (inner_r * shortest / 2.0) / scale;
+  return g;
+}
+
+bool warp_iris_cut(
+  const cv::Mat& rgba, const CutGeometry& geometry,
+  uint8_t* out_buffer, size_t out_capacity, int* out_width, int* out_height,
+  const CutOptions& options
+) {
+  if (!out_width || !out_height || rgba.empty() || rgba.type() != CV_8UC4 ||
+      geometry.iris_r <= 0 || geometry.pupil_r < 0 || geometry.pupil_r >= geometry.iris_r) {
+    return false;
+  }
+  *out_width = 0;
+  *out_height = 0;
+  CutTarget target;
+  target.buffer = out_buffer;
+  target.capacity = out_capacity;
+  return process_iris_cut_impl(rgba, geometry, target, out_width, out_height, options);
+}
+
+bool process_iris_cut(
+  const char* image_path,
+  double iris_cx, double iris_cy, double iris_r,
+  double pupil_cx, double pupil_cy, double pupil_r,
+  uint8_t** out_data, int* out_width, int* out_height,
+  const CutOptions& options
+) {
+  (void)pupil_cx;  // the warp is centered on the iris circle
+  (void)pupil_cy;
+  if (!out_data) return false;
+  *out_data = nullptr;
+  CutTarget target;
+  target.allocated = out_data;
+  return cut_from_path(image_path, iris_cx, iris_cy, iris_r, pupil_r,
+                       target, out_width, out_height, options);
+}
+
+bool process_iris_cut_into(
+  const char* image_path,
+  double iris_cx, double iris_cy, double iris_r,
+  double pupil_cx, double pupil_cy, double pupil_r,
+  uint8_t* out_buffer, size_t out_capacity, int* out_width, int* out_height,
+  const CutOptions& options
+) {
+  (void)pupil_cx;
+  (void)pupil_cy;
+  CutTarget target;
+  target.buffer = out_buffer;
+  target.capacity = out_capacity;
+  return cut_from_path(image_path, iris_cx, iris_cy, iris_r, pupil_r,
+                       target, out_width, out_height, options);
+}
+
+bool process_iris_cut_from_view(
+  const char* image_path,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  uint8_t** out_data, int* out_width, int* out_height,
+  const CutOptions& options
+) {
+  (void)inner_dx;  // the warp is centered on the iris circle
+  (void)inner_dy;
+  if (!out_data) return false;
+  *out_data = nullptr;
+  CutTarget target;
+  target.allocated = out_data;
+  return cut_from_view(image_path, view_w, view_h, outer_r, inner_r, outer_dx, outer_dy,
+                       target, out_width, out_height, options);
+}
+
+bool process_iris_cut_from_view_into(
+  const char* image_path,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  uint8_t* out_buffer, size_t out_capacity, int* out_width, int* out_height,
+  const CutOptions& options
+) {
+  (void)inner_dx;
+  (void)inner_dy;
+  CutTarget target;
+  target.buffer = out_buffer;
+  target.capacity = out_capacity;
+  return cut_from_view(image_path, view_w, view_h, outer_r, inner_r, outer_dx, outer_dy,
+                       target, out_width, out_height, options);
 }
 
 }  // namespace iris
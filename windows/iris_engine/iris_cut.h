@@ -10,8 +10,51 @@
 #include <cstdint>
 #include <cstddef>
 
+#include <opencv2/core.hpp>
+
+#include "iris_sampler.h"
+
 namespace iris {
 
+/** Per-call options for the cut-and-warp. */
+struct CutOptions {
+  int num_threads = 0;  // Row-band threads; 0 = engine default (iris_thread_pool.h)
+  Interpolation interpolation = Interpolation::kBilinear;
+  // Interactive preview (from_view only): warp from the source mip level that matches the
+  // view instead of full resolution. Output is then roughly view-sized, same geometry.
+  bool preview = false;
+  double preview_pixel_ratio = 1.0;  // device pixels per view unit (HiDPI)
+};
+
+/** Cut geometry in image pixel space. The warp is centered on the iris circle. */
+struct CutGeometry {
+  double iris_cx;
+  double iris_cy;
+  double iris_r;
+  double pupil_r;
+};
+
+/**
+ * View-space circling params (see process_iris_cut_from_view) → image-space geometry
+ * for an image_w x image_h source. Shared by the preview and full-resolution paths.
+ */
+CutGeometry cut_geometry_from_view(
+  int image_w, int image_h,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy
+);
+
+/**
+ * Warps an in-memory CV_8UC4 RGBA source (no file, no cache) into a caller-owned buffer.
+ * Size reporting as in process_iris_cut_into; options.preview is ignored.
+ */
+bool warp_iris_cut(
+  const cv::Mat& rgba, const CutGeometry& geometry,
+  uint8_t* out_buffer, size_t out_capacity, int* out_width, int* out_height,
+  const CutOptions& options = CutOptions()
+);
+
 /**
  * Process iris cut with radial warp (pupil 50% smaller).
  * All coordinates and radii in image pixel space.
@@ -22,13 +65,29 @@ bool process_iris_cut(
   const char* image_path,
   double iris_cx, double iris_cy, double iris_r,
   double pupil_cx, double pupil_cy, double pupil_r,
-  uint8_t** out_data, int* out_width, int* out_height
+  uint8_t** out_data, int* out_width, int* out_height,
+  const CutOptions& options = CutOptions()
+);
+
+/**
+ * Same as process_iris_cut but writes into a caller-owned buffer (no allocation).
+ * out_width/out_height are set whenever the geometry is valid, so a call with a null
+ * or short buffer returns false yet reports the size to allocate (side * side * 4).
+ */
+bool process_iris_cut_into(
+  const char* image_path,
+  double iris_cx, double iris_cy, double iris_r,
+  double pupil_cx, double pupil_cy, double pupil_r,
+  uint8_t* out_buffer, size_t out_capacity, int* out_width, int* out_height,
+  const CutOptions& options = CutOptions()
 );
 
 /**
  * Same as process_iris_cut but takes view-space params; converts to image space
  * using loaded image dimensions. view_w/h = layout size; outer_r/inner_r in [0,1];
  * outer_dx/dy, inner_dx/dy = normalized center offsets (fraction of view).
+ * With options.preview the result comes from a mip level (smaller output); commit
+ * with preview off for the full-resolution cut.
  */
 bool process_iris_cut_from_view(
   const char* image_path,
@@ -36,7 +95,19 @@ bool process_iris_cut_from_view(
   double outer_r, double inner_r,
   double outer_dx, double outer_dy,
   double inner_dx, double inner_dy,
-  uint8_t** out_data, int* out_width, int* out_height
+  uint8_t** out_data, int* out_width, int* out_height,
+  const CutOptions& options = CutOptions()
+);
+
+/** process_iris_cut_from_view into a caller-owned buffer; see process_iris_cut_into. */
+bool process_iris_cut_from_view_into(
+  const char* image_path,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  uint8_t* out_buffer, size_t out_capacity, int* out_width, int* out_height,
+  const CutOptions& options = CutOptions()
 );
 
 }  // namespace iris
@@ -0,0 +1,336 @@
+/**
+ * Iris Engine — Coarse-to-fine iris/pupil detection — implementation.
+ */
+
+#include "iris_detect.h"
+#include "iris_image_cache.h"
+#include "iris_stats.h"
+#include "iris_thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <opencv2/imgproc.hpp>
+
+namespace iris {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kMaxRaySamples = 512;
+constexpr int kMinFitPoints = 8;
+constexpr int kMinHoughSide = 64;
+constexpr float kMinEdgeContrast = 4.0f;   // gray levels across an edge to count it
+constexpr float kFullEdgeContrast = 24.0f;  // contrast that earns full confidence
+constexpr float kWeakEdgeRatio = 0.4f;      // of the median contrast, below which an edge is ignored
+
+/** Rec. 601 luma of [rgba] at continuous (x, y), bilinear; -1 outside the image. */
+inline float luma_at(const cv::Mat& rgba, double x, double y) {
+  if (x < 0 || y < 0 || x > rgba.cols - 1 || y > rgba.rows - 1) return -1.0f;
+  const int x0 = std::max(0, std::min(static_cast<int>(x), rgba.cols - 2));
+  const int y0 = std::max(0, std::min(static_cast<int>(y), rgba.rows - 2));
+  const int x1 = std::min(x0 + 1, rgba.cols - 1), y1 = std::min(y0 + 1, rgba.rows - 1);
+  const float fx = static_cast<float>(x - x0), fy = static_cast<float>(y - y0);
+  auto luma = [&](int px, int py) {
+    const uint8_t* p = rgba.ptr<uint8_t>(py) + static_cast<size_t>(px) * 4;
+    return (77.0f * p[0] + 150.0f * p[1] + 29.0f * p[2]) * (1.0f / 256.0f);
+  };
+  const float top = luma(x0, y0) + (luma(x1, y0) - luma(x0, y0)) * fx;
+  const float bottom = luma(x0, y1) + (luma(x1, y1) - luma(x0, y1)) * fx;
+  return top + (bottom - top) * fy;
+}
+
+struct EdgePoint {
+  double x = 0, y = 0;
+  float contrast = 0;
+  bool found = false;
+};
+
+struct CircleFit {
+  double cx = 0, cy = 0, r = 0;
+  float confidence = 0;
+  bool ok = false;
+};
+
+/** Strongest dark-to-light edge along one ray in [r_lo, r_hi], to sub-sample precision. */
+EdgePoint ray_edge(const cv::Mat& rgba, double cx, double cy, double dx, double dy, double r_lo, double r_hi) {
+  EdgePoint e;
+  const int n = std::clamp(static_cast<int>(std::ceil((r_hi - r_lo) / 0.5)) + 1, 8, kMaxRaySamples);
+  const double step = (r_hi - r_lo) / (n - 1);
+  float profile[kMaxRaySamples];
+  int valid = 0;
+  for (; valid < n; ++valid) {
+    const double r = r_lo + valid * step;
+    const float v = luma_at(rgba, cx + dx * r, cy + dy * r);
+    if (v < 0) break;
+    profile[valid] = v;
+  }
+  // Contrast = mean of the k samples outside minus the k inside. Box means (rather than
+  // two single samples) make the response a triangle that peaks exactly on a step.
+  const int k = std::max(1, static_cast<int>(std::lround(std::max(1.5, 0.02 * r_hi) / step)));
+  if (valid < 2 * k + 3) return e;
+  float prefix[kMaxRaySamples + 1];
+  prefix[0] = 0.0f;
+  for (int i = 0; i < valid; ++i) prefix[i + 1] = prefix[i] + profile[i];
+  const float inv_k = 1.0f / static_cast<float>(k);
+  auto response = [&](int i) {
+    return (prefix[i + k + 1] - prefix[i + 1] - (prefix[i] - prefix[i - k])) * inv_k;
+  };
+  int best = -1;
+  float best_d = kMinEdgeContrast;
+  for (int i = k; i < valid - k; ++i) {
+    const float d = response(i);
+    if (d > best_d) {
+      best_d = d;
+      best = i;
+    }
+  }
+  if (best < 0) return e;
+  double offset = 0;
+  if (best > k && best < valid - k - 1) {
+    const float a = response(best - 1);
+    const float c = response(best + 1);
+    const float denom = a - 2.0f * best_d + c;
+    if (denom < 0) offset = std::clamp(0.5 * (a - c) / denom, -0.5, 0.5);
+  }
+  const double r = r_lo + (best + offset) * step;
+  e.x = cx + dx * r;
+  e.y = cy + dy * r;
+  e.contrast = best_d;
+  e.found = true;
+  return e;
+}
+
+/** Algebraic (Kasa) circle fit around (ox, oy); false when degenerate. */
+bool fit_circle(const std::vector<EdgePoint>& pts, const std::vector<char>& use, double ox, double oy,
+                double& cx, double& cy, double& r) {
+  double sxx = 0, sxy = 0, syy = 0, sx = 0, sy = 0, n = 0, sxz = 0, syz = 0, sz = 0;
+  for (size_t i = 0; i < pts.size(); ++i) {
+    if (!use[i]) continue;
+    const double x = pts[i].x - ox, y = pts[i].y - oy, z = x * x + y * y;
+    sxx += x * x; sxy += x * y; syy += y * y;
+    sx += x; sy += y; n += 1;
+    sxz += x * z; syz += y * z; sz += z;
+  }
+  if (n < kMinFitPoints) return false;
+  // Normal equations for x^2 + y^2 + D x + E y + F = 0.
+  const double m[3][3] = {{sxx, sxy, sx}, {sxy, syy, sy}, {sx, sy, n}};
+  const double b[3] = {-sxz, -syz, -sz};
+  const double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                     m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                     m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+  if (std::fabs(det) < 1e-9) return false;
+  auto solve = [&](int col) {
+    double a[3][3];
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j) a[i][j] = j == col ? b[i] : m[i][j];
+    return (a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+            a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+            a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0])) / det;
+  };
+  const double d = solve(0), e = solve(1), f = solve(2);
+  const double lx = -0.5 * d, ly = -0.5 * e, r2 = lx * lx + ly * ly - f;
+  if (r2 <= 0) return false;
+  cx = ox + lx;
+  cy = oy + ly;
+  r = std::sqrt(r2);
+  return true;
+}
+
+/**
+ * Refines a circle hypothesis at full resolution: ray edges in [r_lo, r_hi] around
+ * (cx, cy), then a fit with two rounds of median-based outlier rejection.
+ */
+CircleFit refine_circle(const cv::Mat& rgba, double cx, double cy, double r_lo, double r_hi,
+                        const DetectOptions& options) {
+  CircleFit fit;
+  const int rays = std::max(kMinFitPoints, options.rays);
+  r_lo = std::max(1.0, r_lo);
+  if (r_hi <= r_lo + 2) return fit;
+  std::vector<EdgePoint> pts(static_cast<size_t>(rays));
+  parallel_for_rows(rays, options.num_threads, [&](int i0, int i1) {
+    for (int i = i0; i < i1; ++i) {
+      const double a = 2.0 * kPi * i / rays;
+      pts[static_cast<size_t>(i)] = ray_edge(rgba, cx, cy, std::cos(a), std::sin(a), r_lo, r_hi);
+    }
+  }, 16);
+
+  // Weak edges (noise, eyelid skin, lashes) are dropped relative to the typical edge.
+  std::vector<float> found_contrast;
+  for (const EdgePoint& p : pts) {
+    if (p.found) found_contrast.push_back(p.contrast);
+  }
+  if (static_cast<int>(found_contrast.size()) < kMinFitPoints) return fit;
+  std::nth_element(found_contrast.begin(), found_contrast.begin() + found_contrast.size() / 2,
+                   found_contrast.end());
+  const float min_contrast = kWeakEdgeRatio * found_contrast[found_contrast.size() / 2];
+  std::vector<char> use(pts.size());
+  for (size_t i = 0; i < pts.size(); ++i) use[i] = pts[i].found && pts[i].contrast >= min_contrast;
+
+  // Start from the hypothesis centre and the median edge distance, then alternate
+  // median-based rejection with refits so that outliers never steer the first fit.
+  double fx = cx, fy = cy, fr = 0;
+  std::vector<double> distances;
+  for (size_t i = 0; i < pts.size(); ++i) {
+    if (use[i]) distances.push_back(std::hypot(pts[i].x - cx, pts[i].y - cy));
+  }
+  std::nth_element(distances.begin(), distances.begin() + distances.size() / 2, distances.end());
+  fr = distances[distances.size() / 2];
+  const std::vector<char> candidates = use;
+  std::vector<double> residuals;
+  for (int round = 0; round < 3; ++round) {
+    residuals.clear();
+    for (size_t i = 0; i < pts.size(); ++i) {
+      if (candidates[i]) residuals.push_back(std::fabs(std::hypot(pts[i].x - fx, pts[i].y - fy) - fr));
+    }
+    std::nth_element(residuals.begin(), residuals.begin() + residuals.size() / 2, residuals.end());
+    const double limit = std::max(1.0, 3.0 * 1.4826 * residuals[residuals.size() / 2]);
+    for (size_t i = 0; i < pts.size(); ++i) {
+      use[i] = candidates[i] && std::fabs(std::hypot(pts[i].x - fx, pts[i].y - fy) - fr) <= limit;
+    }
+    if (!fit_circle(pts, use, fx, fy, fx, fy, fr)) return fit;
+  }
+  // The fit must stay within the band it searched.
+  const double band = r_hi - r_lo;
+  if (fr < r_lo - 0.25 * band || fr > r_hi + 0.25 * band || std::hypot(fx - cx, fy - cy) > band) return fit;
+
+  std::vector<float> contrasts;
+  for (size_t i = 0; i < pts.size(); ++i) {
+    if (use[i]) contrasts.push_back(pts[i].contrast);
+  }
+  std::nth_element(contrasts.begin(), contrasts.begin() + contrasts.size() / 2, contrasts.end());
+  const float contrast = std::min(1.0f, contrasts[contrasts.size() / 2] / kFullEdgeContrast);
+  fit.cx = fx;
+  fit.cy = fy;
+  fit.r = fr;
+  fit.confidence = static_cast<float>(contrasts.size()) / static_cast<float>(rays) * contrast;
+  fit.ok = true;
+  return fit;
+}
+
+CircleResult to_result(double cx, double cy, double r, float confidence) {
+  CircleResult c;
+  c.center_x = static_cast<float>(cx);
+  c.center_y = static_cast<float>(cy);
+  c.radius = static_cast<float>(r);
+  c.valid = true;
+  c.confidence = confidence;
+  return c;
+}
+
+/** Narrow band around a hypothesis: 8% of the radius, at least 3 Hough-level pixels. */
+CircleResult refine_hypothesis(const cv::Mat& rgba, double cx, double cy, double r, double coarse_scale,
+                               const DetectOptions& options) {
+  const double band = std::max(3.0 / coarse_scale, 0.08 * r);
+  const CircleFit fit = refine_circle(rgba, cx, cy, r - band, r + band, options);
+  return fit.ok ? to_result(fit.cx, fit.cy, fit.r, fit.confidence) : to_result(cx, cy, r, 0.0f);
+}
+
+/**
+ * Area-resizes [src] (the full image scaled by [src_scale]) to the Hough level, or
+ * shares it when already small enough. [scale] receives the level's scale to full
+ * resolution; the realized width ratio keeps pixel centres mapping back exactly in x.
+ */
+void shrink_to_hough_level(const cv::Mat& src, double src_scale, const DetectOptions& options,
+                           cv::Mat& coarse, double& scale) {
+  const int long_side = std::max(src.cols, src.rows);
+  const int target = std::max(kMinHoughSide, options.coarse_max_side);
+  if (long_side <= target) {
+    coarse = src;
+    scale = src_scale;
+    return;
+  }
+  const double f = static_cast<double>(target) / long_side;
+  cv::resize(src, coarse, cv::Size(), f, f, cv::INTER_AREA);
+  scale = src_scale * static_cast<double>(coarse.cols) / src.cols;
+}
+
+}  // namespace
+
+bool detect_iris_circles(const cv::Mat& rgba, const cv::Mat& coarse, double coarse_scale,
+                         CircleResult& iris, CircleResult& pupil, const DetectOptions& options) {
+  if (rgba.empty() || rgba.type() != CV_8UC4 || coarse.empty() || coarse.type() != CV_8UC4 ||
+      coarse_scale <= 0 || coarse_scale > 1) {
+    return false;
+  }
+  cv::Mat gray;
+  {
+    StageTimer timer(Stage::kColorConvert);
+    cv::cvtColor(coarse, gray, cv::COLOR_RGBA2GRAY);
+  }
+  cv::GaussianBlur(gray, gray, cv::Size(5, 5), 1.0, 1.0);
+  // Same relative search as the original full-resolution Hough.
+  const int short_side = std::min(gray.cols, gray.rows);
+  const int min_r = std::max(2, short_side / 20);
+  const int max_r = std::max(min_r + 1, short_side / 2);
+  std::vector<cv::Vec3f> circles;
+  {
+    StageTimer timer(Stage::kHough);
+    cv::HoughCircles(gray, circles, cv::HOUGH_GRADIENT, 1.0,
+                     static_cast<double>(std::max(gray.cols, gray.rows)) / 4.0, 100, 30, min_r, max_r);
+  }
+  if (circles.empty()) return false;
+
+  auto to_full = [&](float v) { return (static_cast<double>(v) + 0.5) / coarse_scale - 0.5; };
+  if (circles.size() >= 2) {
+    std::sort(circles.begin(), circles.end(),
+              [](const cv::Vec3f& a, const cv::Vec3f& b) { return a[2] < b[2]; });
+    pupil = refine_hypothesis(rgba, to_full(circles[0][0]), to_full(circles[0][1]),
+                              circles[0][2] / coarse_scale, coarse_scale, options);
+    iris = refine_hypothesis(rgba, to_full(circles[1][0]), to_full(circles[1][1]),
+                             circles[1][2] / coarse_scale, coarse_scale, options);
+    return true;
+  }
+
+  iris = refine_hypothesis(rgba, to_full(circles[0][0]), to_full(circles[0][1]),
+                           circles[0][2] / coarse_scale, coarse_scale, options);
+  // One circle: search the pupil edge inside the iris, then tighten around it.
+  const double r = iris.radius;
+  const CircleFit wide = refine_circle(rgba, iris.center_x, iris.center_y, 0.1 * r, 0.75 * r, options);
+  if (wide.ok) {
+    pupil = refine_hypothesis(rgba, wide.cx, wide.cy, wide.r, coarse_scale, options);
+    if (pupil.confidence <= 0) pupil.confidence = wide.confidence;
+  } else {
+    pupil = to_result(iris.center_x, iris.center_y, r * 0.3, 0.0f);
+  }
+  return true;
+}
+
+bool detect_iris_circles(const cv::Mat& rgba, CircleResult& iris, CircleResult& pupil,
+                         const DetectOptions& options) {
+  if (rgba.empty() || rgba.type() != CV_8UC4) return false;
+  cv::Mat coarse;
+  double scale = 1.0;
+  shrink_to_hough_level(rgba, 1.0, options, coarse, scale);
+  return detect_iris_circles(rgba, coarse, scale, iris, pupil, options);
+}
+
+bool detect_iris_circles_file(const char* path, CircleResult& iris, CircleResult& pupil,
+                              int* out_width, int* out_height, const DetectOptions& options) {
+  if (!path || !out_width || !out_height) return false;
+  *out_width = 0;
+  *out_height = 0;
+  std::shared_ptr<const cv::Mat> rgba = load_rgba_cached(path);
+  if (!rgba || rgba->empty()) return false;
+  *out_width = rgba->cols;
+  *out_height = rgba->rows;
+  // Deepest cached mip whose long side still covers the Hough level; it is cheaper to
+  // keep than a fresh full-frame area resize, and the cache reuses it for previews.
+  const int long_side = std::max(rgba->cols, rgba->rows);
+  const int target = std::max(kMinHoughSide, options.coarse_max_side);
+  int level = 0;
+  while ((long_side >> (level + 1)) >= target) ++level;
+  int got = 0;
+  std::shared_ptr<const cv::Mat> mip = level > 0 ? load_rgba_level_cached(path, level, &got) : nullptr;
+  cv::Mat coarse;
+  double scale = 1.0;
+  if (mip && got > 0) {
+    shrink_to_hough_level(*mip, std::ldexp(1.0, -got), options, coarse, scale);
+  } else {
+    shrink_to_hough_level(*rgba, 1.0, options, coarse, scale);
+  }
+  return detect_iris_circles(*rgba, coarse, scale, iris, pupil, options);
+}
+
+}  // namespace iris
@@ -0,0 +1,53 @@
+/**
+ * Iris Engine — Coarse-to-fine iris/pupil detection (2026).
+ *
+ * Hypotheses come from cv::HoughCircles on a small pyramid level, where it is cheap.
+ * Each circle is then refined at full resolution. Rays are cast from the hypothesis
+ * centre, and each ray records the sub-pixel position of its strongest dark-to-light
+ * edge inside a narrow radius band. A robust least-squares circle fit through those
+ * points gives the final circle. The full-resolution work is proportional to the
+ * circumference, not the image area. No full-frame grayscale conversion or blur runs.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_DETECT_H
+#define IRIS_ENGINE_IRIS_DETECT_H
+
+#include <opencv2/core.hpp>
+
+#include "iris_engine.h"
+
+namespace iris {
+
+struct DetectOptions {
+  int coarse_max_side = 640;  // long side of the Hough level, in pixels
+  int rays = 180;             // rays per circle for the full-resolution refinement
+  int num_threads = 0;        // 0 = engine default
+};
+
+/**
+ * Detects iris and pupil in [rgba] (CV_8UC4, full resolution). The Hough level is
+ * made by an area resize. On success both results are valid. Their confidence in
+ * 0..1 is the share of rays whose edge agrees with the fitted circle, weighted by the
+ * edge contrast. A pupil guessed from the iris (no edge found) gets confidence 0.
+ */
+bool detect_iris_circles(const cv::Mat& rgba, CircleResult& iris, CircleResult& pupil,
+                         const DetectOptions& options = {});
+
+/**
+ * Same, with a precomputed Hough level [coarse] that is [rgba] scaled by [coarse_scale]
+ * (< 1, e.g. a cached mip level, pixel centres mapping as (x + 0.5) / scale - 0.5).
+ */
+bool detect_iris_circles(const cv::Mat& rgba, const cv::Mat& coarse, double coarse_scale,
+                         CircleResult& iris, CircleResult& pupil, const DetectOptions& options = {});
+
+/**
+ * Detects on the decoded file [path] (UTF-8) through the image cache. The Hough level
+ * comes from a cached mip, so repeated calls and later previews share it. Circles are
+ * in full-resolution pixels; *out_width / *out_height receive the image size.
+ */
+bool detect_iris_circles_file(const char* path, CircleResult& iris, CircleResult& pupil,
+                              int* out_width, int* out_height, const DetectOptions& options = {});
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_DETECT_H
@@ -0,0 +1,208 @@
+/**
+ * Iris Engine — Non-destructive edit stack — implementation.
+ */
+
+#include "iris_edit_stack.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+namespace iris {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t kFnvOffset = 1469598037103934665ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+/** FNV-1a step over the bytes of one scalar (fields one by one, so padding never counts). */
+template <typename T>
+uint64_t mix(uint64_t h, T value) {
+  static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "hash scalars only");
+  unsigned char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  for (unsigned char b : bytes) h = (h ^ b) * kFnvPrime;
+  return h;
+}
+
+uint64_t mix_circle(uint64_t h, const CircleResult& c) {
+  return mix(mix(mix(h, c.center_x), c.center_y), c.radius);
+}
+
+bool given_circles(const EditStackParams& p) { return p.iris.valid && p.pupil.valid; }
+
+/** Key of each stage's output; a disabled stage passes its upstream key through. */
+void stage_keys(uint64_t source_key, const EditStackParams& p, uint64_t keys[kEditStageCount]) {
+  uint64_t h = source_key;
+  if (p.cut) {
+    h = mix(mix(mix(h, static_cast<int>(EditStage::kCut)), p.iris_radius_scale), p.antialias);
+    // Detected circles follow from the source, so only given ones enter the key.
+    if (given_circles(p)) h = mix_circle(mix_circle(h, p.iris), p.pupil);
+  }
+  keys[static_cast<int>(EditStage::kCut)] = h;
+  if (p.flash) {
+    const FlashRemovalParams& f = p.flash_params;
+    h = mix(mix(mix(h, static_cast<int>(EditStage::kFlash)), f.brightness_threshold), f.dilate_pixels);
+    h = mix(mix(mix(mix(h, f.search_cx), f.search_cy), f.search_outer_r), f.search_inner_r);
+    h = mix(mix(h, f.inpaint_method), f.inpaint_radius);
+  }
+  keys[static_cast<int>(EditStage::kFlash)] = h;
+  if (p.effects) {
+    const EffectParams& e = p.effect_params;
+    h = mix(mix(mix(mix(mix(h, static_cast<int>(EditStage::kEffects)), e.vibrance), e.gamma), e.sharpness),
+            e.clarity);
+  }
+  keys[static_cast<int>(EditStage::kEffects)] = h;
+}
+
+bool stage_enabled(const EditStackParams& p, int stage) {
+  switch (static_cast<EditStage>(stage)) {
+    case EditStage::kCut: return p.cut;
+    case EditStage::kFlash: return p.flash;
+    case EditStage::kEffects: return p.effects;
+  }
+  return false;
+}
+
+/** Distinct buffers among [memos] other than [skip_a] and [skip_b]. */
+template <size_t N, typename MemoT>
+size_t distinct_bytes(const MemoT (&memos)[N], const PixelBuffer* skip_a, const PixelBuffer* skip_b) {
+  size_t total = 0;
+  for (size_t i = 0; i < N; ++i) {
+    const PixelBuffer* b = memos[i].pixels.get();
+    if (!b || b == skip_a || b == skip_b) continue;
+    bool seen = false;
+    for (size_t j = 0; j < i && !seen; ++j) seen = memos[j].pixels.get() == b;
+    if (!seen) total += b->size();
+  }
+  return total;
+}
+
+}  // namespace
+
+bool valid_edit_params(const EditStackParams& p) {
+  if (p.cut && !(p.iris_radius_scale > 0)) return false;
+  if (p.cut && (p.iris.valid != p.pupil.valid || (given_circles(p) && !(p.iris.radius > p.pupil.radius)))) {
+    return false;
+  }
+  const FlashRemovalParams& f = p.flash_params;
+  if (p.flash && (f.brightness_threshold < 0 || f.brightness_threshold > 1 || f.dilate_pixels < 0 ||
+                  (f.search_outer_r > 0 && f.search_inner_r >= f.search_outer_r))) {
+    return false;
+  }
+  return !p.effects || p.effect_params.gamma > 0;
+}
+
+void EditStack::set_source(std::shared_ptr<const PixelBuffer> pixels, int width, int height) {
+  static std::atomic<uint64_t> next_key{1};
+  clear();
+  source_ = std::move(pixels);
+  source_w_ = width;
+  source_h_ = height;
+  source_key_ = mix(kFnvOffset, next_key.fetch_add(1, std::memory_order_relaxed));
+}
+
+void EditStack::clear() {
+  source_.reset();
+  source_w_ = source_h_ = 0;
+  detected_iris_.valid = false;
+  detected_pupil_.valid = false;
+  for (Memo& m : memos_) m = Memo();
+}
+
+void EditStack::set_budget(size_t bytes) {
+  budget_ = bytes > 0 ? bytes : kDefaultEditCacheBytes;
+  evict();
+}
+
+size_t EditStack::cached_bytes() const { return distinct_bytes(memos_, source_.get(), nullptr); }
+
+size_t EditStack::held_bytes(const PixelBuffer* exclude) const {
+  const size_t source = source_ && source_.get() != exclude ? source_->size() : 0;
+  return source + distinct_bytes(memos_, source_.get(), exclude);
+}
+
+void EditStack::evict() {
+  // Cheapest to recompute first; each stage reruns from the output above it.
+  while (cached_bytes() > budget_) {
+    Memo* cheapest = nullptr;
+    for (Memo& m : memos_) {
+      if (m.pixels && (!cheapest || m.cost_ms < cheapest->cost_ms)) cheapest = &m;
+    }
+    if (!cheapest) break;
+    *cheapest = Memo();
+  }
+}
+
+bool EditStack::render(IrisObject& target, const EditStackParams& p, EditRenderResult* result) {
+  const auto start = Clock::now();
+  if (!source_ || !valid_edit_params(p)) return false;
+  uint64_t keys[kEditStageCount];
+  stage_keys(source_key_, p, keys);
+
+  // Deepest enabled stage whose output is still cached; keys chain, so all above match.
+  int reused = -1;
+  for (int i = kEditStageCount - 1; i >= 0 && reused < 0; --i) {
+    if (stage_enabled(p, i) && memos_[i].pixels && memos_[i].key == keys[i]) reused = i;
+  }
+  const bool from_source = reused < 0;
+  if (!target.share_rgba(from_source ? source_ : memos_[reused].pixels,
+                         from_source ? source_w_ : memos_[reused].width,
+                         from_source ? source_h_ : memos_[reused].height)) {
+    return false;
+  }
+
+  int computed = 0;
+  for (int i = reused + 1; i < kEditStageCount; ++i) {
+    if (!stage_enabled(p, i)) continue;
+    const auto t0 = Clock::now();
+    bool ok = false;
+    switch (static_cast<EditStage>(i)) {
+      case EditStage::kCut: {
+        CircleResult iris = p.iris, pupil = p.pupil;
+        if (!given_circles(p)) {
+          // The cut is the first stage, so the target holds the source here.
+          if (!detected_iris_.valid || !detected_pupil_.valid) {
+            if (!target.detect_iris_and_pupil(detected_iris_, detected_pupil_)) {
+              detected_iris_.valid = detected_pupil_.valid = false;
+              return false;
+            }
+          }
+          iris = detected_iris_;
+          pupil = detected_pupil_;
+        }
+        target.set_circles(iris, pupil);
+        ok = target.cut_iris_to_alpha(p.iris_radius_scale, p.antialias);
+        break;
+      }
+      case EditStage::kFlash:
+        ok = target.remove_flash(p.flash_params);
+        break;
+      case EditStage::kEffects:
+        ok = target.apply_effect_params(p.effect_params);
+        break;
+    }
+    if (!ok) return false;
+    Memo& m = memos_[i];
+    m.key = keys[i];
+    m.pixels = target.borrow_rgba();  // shared until the next stage writes
+    m.width = target.width();
+    m.height = target.height();
+    m.cost_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    ++computed;
+  }
+  evict();
+
+  if (result) {
+    result->reused_stage = reused;
+    result->computed_stages = computed;
+    result->cached_bytes = cached_bytes();
+    result->render_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+  return true;
+}
+
+}  // namespace iris
@@ -0,0 +1,114 @@
+/**
+ * Iris Engine — Non-destructive edit stack with memoized stages (2026).
+ *
+ * A handle's edit stack keeps the source pixels and re-renders an ordered list of stage
+ * parameters over them: cut → flash → effects. The output of each stage is memoized
+ * under a hash of its own parameters chained with every upstream key, so a render only
+ * runs the stages below the first one whose key changed. Moving a color slider reuses
+ * the post-flash buffer and runs the effects alone, with no decode.
+ *
+ * Cached outputs are shared copy-on-write with the handle's pixels (borrow_rgba): a
+ * stage output costs no copy until the next stage writes. Circles detected for the cut
+ * are kept per source. The outputs held are capped by a per-handle byte budget; over
+ * it, the stages that were cheapest to compute are dropped first. The source is never
+ * evicted and is not charged to the budget, so a handle holds up to the budget plus one
+ * full-resolution source.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_EDIT_STACK_H
+#define IRIS_ENGINE_IRIS_EDIT_STACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "iris_engine.h"
+
+namespace iris {
+
+enum class EditStage : int {
+  kCut = 0,
+  kFlash,
+  kEffects,
+};
+
+constexpr int kEditStageCount = 3;
+
+/** Stage parameters in application order; a disabled stage passes its input through. */
+struct EditStackParams {
+  bool cut = false;                  // alpha cut (IrisObject::cut_iris_to_alpha)
+  float iris_radius_scale = 1.0f;
+  bool antialias = false;
+  CircleResult iris{};               // both valid = cut with these; else detected once per source
+  CircleResult pupil{};
+  bool flash = false;
+  FlashRemovalParams flash_params{0.95f, 3};
+  bool effects = false;
+  EffectParams effect_params{1.0f, 1.0f, 0.0f, 0.0f};
+};
+
+/** What one render did. */
+struct EditRenderResult {
+  int reused_stage = -1;     // EditStage whose cached output was the starting point; -1 = the source
+  int computed_stages = 0;   // stages run by this render
+  size_t cached_bytes = 0;   // stage outputs held after eviction, the source not included
+  double render_ms = 0;
+};
+
+/** True when every enabled stage of [params] can run (the same checks as the single steps). */
+bool valid_edit_params(const EditStackParams& params);
+
+/** Default per-handle budget for cached stage outputs (the source is held on top of it). */
+constexpr size_t kDefaultEditCacheBytes = size_t{512} << 20;
+
+class EditStack {
+ public:
+  bool has_source() const { return source_ != nullptr; }
+
+  /** Takes [pixels] as the source and drops every cached stage and circle. */
+  void set_source(std::shared_ptr<const PixelBuffer> pixels, int width, int height);
+
+  /** Drops the source and the cache. */
+  void clear();
+
+  /**
+   * Caps the cached stage outputs at [bytes] (0 = kDefaultEditCacheBytes), evicting now.
+   * Outputs that share the source's buffer cost nothing, and the source itself is not counted.
+   */
+  void set_budget(size_t bytes);
+
+  /**
+   * Renders [params] over the source into [target]'s pixels, starting from the deepest
+   * stage whose cached output still matches. False when there is no source, the
+   * parameters are invalid or a stage fails (target then holds the partial result).
+   */
+  bool render(IrisObject& target, const EditStackParams& params, EditRenderResult* result);
+
+  /** Source plus cached outputs, buffers shared with [exclude] not counted. */
+  size_t held_bytes(const PixelBuffer* exclude) const;
+
+ private:
+  struct Memo {
+    uint64_t key = 0;
+    std::shared_ptr<const PixelBuffer> pixels;
+    int width = 0;
+    int height = 0;
+    double cost_ms = 0;  // time the stage took from its input
+  };
+
+  std::shared_ptr<const PixelBuffer> source_;
+  int source_w_ = 0;
+  int source_h_ = 0;
+  uint64_t source_key_ = 0;  // new per set_source
+  CircleResult detected_iris_{};
+  CircleResult detected_pupil_{};
+  Memo memos_[kEditStageCount];
+  size_t budget_ = kDefaultEditCacheBytes;
+
+  size_t cached_bytes() const;
+  void evict();
+};
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_EDIT_STACK_H
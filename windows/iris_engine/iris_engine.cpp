@@ -4,9 +4,18 @@
  */
 
 #include "iris_engine.h"
+#include "iris_alpha_cut.h"
+#include "iris_codec.h"
+#include "iris_color_lut.h"
+#include "iris_detect.h"
+#include "iris_edit_stack.h"
+#include "iris_flash.h"
+#include "iris_print_export.h"
+#include "iris_thread_pool.h"
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <utility>
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
@@ -22,161 +31,259 @@ inline uint8_t clamp(int v) {
   return static_cast<uint8_t>(v);
 }
 
+/** Writes BGR pixels into the RGB bytes of an RGBA buffer; alpha is left untouched. */
+void store_bgr_keep_alpha(const cv::Mat& bgr, uint8_t* rgba, int w, int h, int num_threads) {
+  parallel_for_rows(h, num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) {
+      const uint8_t* s = bgr.ptr<uint8_t>(y);
+      uint8_t* d = rgba + static_cast<size_t>(y) * static_cast<size_t>(w) * 4;
+      for (int x = 0; x < w; ++x, s += 3, d += 4) {
+        d[0] = s[2];
+        d[1] = s[1];
+        d[2] = s[0];
+      }
+    }
+  });
+}
+
 }  // namespace
 
 IrisObject::IrisObject() = default;
 
 IrisObject::~IrisObject() = default;
 
+cv::Mat IrisObject::rgba_view() const {
+  return cv::Mat(height_, width_, CV_8UC4, const_cast<uint8_t*>(rgba_->data()));
+}
+
+void IrisObject::reset_image_state() {
+  alpha_mask_.clear();
+  alpha_mask_.shrink_to_fit();
+  has_alpha_cut_ = false;
+  iris_circle_.valid = false;
+  pupil_circle_.valid = false;
+}
+
+uint8_t* IrisObject::mutable_pixels() {
+  if (rgba_.use_count() > 1) {
+    count_allocation(rgba_->size());
+    rgba_ = std::make_shared<PixelBuffer>(*rgba_);
+  }
+  return rgba_->data();
+}
+
+void IrisObject::update_held_bytes() {
+  const size_t edits = edit_stack_ ? edit_stack_->held_bytes(rgba_.get()) : 0;
+  stats_.set_held_bytes((rgba_ ? rgba_->size() : 0) + alpha_mask_.size() + edits);
+}
+
 bool IrisObject::load_from_rgba(const uint8_t* data, int w, int h) {
   if (!data || w <= 0 || h <= 0) return false;
+  StatsScope scope(&stats_);
   size_t n = static_cast<size_t>(w) * static_cast<size_t>(h) * 4;
-  rgba_.assign(data, data + n);
+  count_allocation(n);
+  rgba_ = std::make_shared<PixelBuffer>(data, data + n);
   width_ = w;
   height_ = h;
-  alpha_mask_.resize(static_cast<size_t>(w) * static_cast<size_t>(h), 255);
+  reset_image_state();
+  if (edit_stack_) edit_stack_->clear();
+  update_held_bytes();
   return true;
 }
 
+bool IrisObject::load_from_file(const char* path) {
+  StatsScope scope(&stats_);
+  cv::Mat decoded;
+  if (!decode_image_file(path, decoded) || !decoded.isContinuous()) return false;
+  count_allocation(decoded.total() * decoded.elemSize());
+  rgba_ = std::make_shared<PixelBuffer>(decoded.datastart, decoded.dataend);
+  width_ = decoded.cols;
+  height_ = decoded.rows;
+  reset_image_state();
+  if (edit_stack_) edit_stack_->clear();
+  update_held_bytes();
+  return true;
+}
+
+bool IrisObject::save_to_file(const char* path, int format, int quality) const {
+  if (!has_image()) return false;
+  StatsScope scope(&stats_);
+  return encode_image_file(path, rgba_view(), image_format_from_int(format), quality);
+}
+
 bool IrisObject::get_rgba(std::vector<uint8_t>& out) const {
-  out = rgba_;
-  return !rgba_.empty();
+  if (!has_image()) return false;
+  StatsScope scope(&stats_);
+  StageTimer timer(Stage::kCopyOut);
+  out = *rgba_;
+  return true;
 }
 
-bool IrisObject::detect_iris_and_pupil(CircleResult& iris, CircleResult& pupil) {
-  if (rgba_.empty() || width_ <= 0 || height_ <= 0) return false;
-  cv::Mat mat_rgba(height_, width_, CV_8UC4, rgba_.data());
-  cv::Mat gray;
-  cv::cvtColor(mat_rgba, gray, cv::COLOR_RGBA2GRAY);
-  cv::GaussianBlur(gray, gray, cv::Size(5, 5), 1.5, 1.5);
-  std::vector<cv::Vec3f> circles;
-  int minR = std::min(width_, height_) / 20;
-  int maxR = std::min(width_, height_) / 2;
-  cv::HoughCircles(gray, circles, cv::HOUGH_GRADIENT, 1.0,
-                   static_cast<double>(std::max(width_, height_)) / 4.0,
-                   100, 30, minR, maxR);
-  if (circles.size() < 2) {
-    if (circles.size() == 1) {
-      float r = circles[0][2];
-      iris.center_x = circles[0][0];
-      iris.center_y = circles[0][1];
-      iris.radius = r;
-      iris.valid = true;
-      pupil.center_x = circles[0][0];
-      pupil.center_y = circles[0][1];
-      pupil.radius = r * 0.3f;
-      pupil.valid = true;
-      return true;
-    }
+bool IrisObject::copy_rgba_to(uint8_t* out, size_t capacity) const {
+  if (!out || !has_image() || capacity < rgba_->size()) return false;
+  StatsScope scope(&stats_);
+  StageTimer timer(Stage::kCopyOut);
+  std::memcpy(out, rgba_->data(), rgba_->size());
+  return true;
+}
+
+std::shared_ptr<const PixelBuffer> IrisObject::borrow_rgba() const {
+  if (!has_image()) return nullptr;
+  return rgba_;
+}
+
+bool IrisObject::swap_rgba(std::shared_ptr<PixelBuffer>& buffer, int w, int h) {
+  if (!buffer || w <= 0 || h <= 0 ||
+      buffer->size() != static_cast<size_t>(w) * static_cast<size_t>(h) * 4) {
+    return false;
+  }
+  std::swap(rgba_, buffer);
+  if (buffer && buffer.use_count() > 1) buffer.reset();
+  width_ = w;
+  height_ = h;
+  reset_image_state();
+  update_held_bytes();
+  return true;
+}
+
+bool IrisObject::share_rgba(std::shared_ptr<const PixelBuffer> buffer, int w, int h) {
+  if (!buffer || w <= 0 || h <= 0 ||
+      buffer->size() != static_cast<size_t>(w) * static_cast<size_t>(h) * 4) {
     return false;
   }
-  std::sort(circles.begin(), circles.end(),
-            [](const cv::Vec3f& a, const cv::Vec3f& b) { return a[2] < b[2]; });
-  pupil.center_x = circles[0][0];
-  pupil.center_y = circles[0][1];
-  pupil.radius = circles[0][2];
-  pupil.valid = true;
-  iris.center_x = circles[1][0];
-  iris.center_y = circles[1][1];
-  iris.radius = circles[1][2];
-  iris.valid = true;
+  // Writable only once unshared: mutable_pixels() copies while anyone else holds it.
+  rgba_ = std::const_pointer_cast<PixelBuffer>(std::move(buffer));
+  width_ = w;
+  height_ = h;
+  reset_image_state();
+  update_held_bytes();
+  return true;
+}
+
+bool IrisObject::detect_iris_and_pupil(CircleResult& iris, CircleResult& pupil) {
+  if (!has_image()) return false;
+  StatsScope scope(&stats_);
+  DetectOptions options;
+  options.num_threads = num_threads_;
+  if (!detect_iris_circles(rgba_view(), iris, pupil, options)) return false;
   iris_circle_ = iris;
   pupil_circle_ = pupil;
   return true;
 }
 
-bool IrisObject::cut_iris_to_alpha(float iris_radius_scale) {
-  CircleResult ir, pu;
-  if (!detect_iris_and_pupil(ir, pu)) return false;
-  float cx = ir.center_x;
-  float cy = ir.center_y;
-  float R = ir.radius * iris_radius_scale;
-  float px = pu.center_x, py = pu.center_y, pr = pu.radius;
-  size_t idx = 0;
-  for (int y = 0; y < height_; ++y) {
-    for (int x = 0; x < width_; ++x) {
-      float dx = static_cast<float>(x) - cx;
-      float dy = static_cast<float>(y) - cy;
-      float r2 = dx * dx + dy * dy;
-      float inside_iris = (r2 <= R * R);
-      float inside_pupil = (static_cast<float>(x) - px) * (static_cast<float>(x) - px) +
-                            (static_cast<float>(y) - py) * (static_cast<float>(y) - py) <= pr * pr;
-      if (!inside_iris || inside_pupil)
-        rgba_[idx + 3] = 0;
-      idx += 4;
-    }
+void IrisObject::set_circles(const CircleResult& iris, const CircleResult& pupil) {
+  iris_circle_ = iris;
+  pupil_circle_ = pupil;
+}
+
+bool IrisObject::cut_iris_to_alpha(float iris_radius_scale, bool antialias) {
+  if (!has_image() || iris_radius_scale <= 0) return false;
+  if (!iris_circle_.valid || !pupil_circle_.valid) {
+    CircleResult ir, pu;
+    if (!detect_iris_and_pupil(ir, pu)) return false;
+  }
+  AlphaAnnulus annulus;
+  annulus.cx = iris_circle_.center_x;
+  annulus.cy = iris_circle_.center_y;
+  annulus.r = static_cast<double>(iris_circle_.radius) * iris_radius_scale;
+  annulus.pupil_cx = pupil_circle_.center_x;
+  annulus.pupil_cy = pupil_circle_.center_y;
+  annulus.pupil_r = pupil_circle_.radius;
+  annulus.antialias = antialias;
+  return cut_annulus_to_alpha(annulus);
+}
+
+bool IrisObject::cut_annulus_to_alpha(const AlphaAnnulus& annulus) {
+  if (!has_image() || annulus.r <= 0) return false;
+  const size_t stride = static_cast<size_t>(width_) * 4;
+  const size_t count = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+  const bool recut = has_alpha_cut_ && alpha_mask_.size() == count;
+  if (recut && last_cut_ == annulus) return true;
+  StatsScope scope(&stats_);
+  uint8_t* pixels = mutable_pixels();
+  if (!recut) {
+    count_allocation(count);
+    alpha_mask_.resize(count);
+    extract_alpha(pixels, stride, width_, height_, alpha_mask_.data(), num_threads_);
   }
+  apply_annulus_alpha(pixels, stride, width_, height_, alpha_mask_.data(), annulus,
+                      recut ? &last_cut_ : nullptr, num_threads_);
+  last_cut_ = annulus;
+  has_alpha_cut_ = true;
+  update_held_bytes();
   return true;
 }
 
 bool IrisObject::remove_flash(const FlashRemovalParams& params) {
-  if (rgba_.empty() || width_ <= 0 || height_ <= 0) return false;
-  cv::Mat mat_rgba(height_, width_, CV_8UC4, rgba_.data());
-  cv::Mat bgr;
-  cv::cvtColor(mat_rgba, bgr, cv::COLOR_RGBA2BGR);
-  cv::Mat lab;
-  cv::cvtColor(bgr, lab, cv::COLOR_BGR2Lab);
-  std::vector<cv::Mat> planes(3);
-  cv::split(lab, planes);
-  double thresh = params.brightness_threshold * 255.0;
-  if (thresh > 255) thresh = 255;
-  if (thresh < 0) thresh = 0;
-  cv::Mat mask;
-  cv::threshold(planes[0], mask, thresh, 255, cv::THRESH_BINARY);
-  if (params.dilate_pixels > 0) {
-    int k = (params.dilate_pixels * 2) | 1;
-    cv::dilate(mask, mask, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(k, k)));
-  }
-  cv::Mat bgr_inpainted;
-  cv::inpaint(bgr, mask, bgr_inpainted, 3.0, cv::INPAINT_TELEA);
-  cv::Mat out_rgba;
-  cv::cvtColor(bgr_inpainted, out_rgba, cv::COLOR_BGR2RGBA);
-  const size_t n = static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4;
-  std::vector<uint8_t> alpha_backup(width_ * height_);
-  for (size_t i = 0, j = 0; i < n; i += 4, ++j) alpha_backup[j] = rgba_[i + 3];
-  std::memcpy(rgba_.data(), out_rgba.data, n);
-  for (size_t i = 0, j = 0; i < n; i += 4, ++j) rgba_[i + 3] = alpha_backup[j];
+  if (!has_image()) return false;
+  StatsScope scope(&stats_);
+  FlashRegions regions;
+  if (!find_flash_regions(rgba_view(), params, regions, num_threads_)) return false;
+  if (regions.rois.empty()) return true;  // nothing to fix: keep the buffer shared
+  cv::Mat pixels(height_, width_, CV_8UC4, mutable_pixels());
+  StageTimer timer(Stage::kInpaint);  // regions fan out to the pool; timed here as a whole
+  inpaint_flash_regions(pixels, regions, params, num_threads_);
   return true;
 }
 
 bool IrisObject::apply_effect_params(const EffectParams& params) {
-  if (rgba_.empty() || width_ <= 0 || height_ <= 0) return false;
-  cv::Mat mat_rgba(height_, width_, CV_8UC4, rgba_.data());
-  cv::Mat bgr;
-  cv::cvtColor(mat_rgba, bgr, cv::COLOR_RGBA2BGR);
-  cv::Mat lab;
-  cv::cvtColor(bgr, lab, cv::COLOR_BGR2Lab);
-  std::vector<cv::Mat> planes(3);
-  cv::split(lab, planes);
+  if (!has_image()) return false;
+  StatsScope scope(&stats_);
+  const size_t pixel_count = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+  // Stage 1 (neighborhood): CLAHE on Lab L, as before.
   if (params.clarity > 0.1f) {
-    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(params.clarity, cv::Size(8, 8));
-    clahe->apply(planes[0], planes[0]);
-  }
-  if (std::fabs(params.vibrance) > 0.01f) {
-    float s = 1.0f + params.vibrance;
-    planes[1].convertTo(planes[1], -1, s, 0);
-    planes[2].convertTo(planes[2], -1, s, 0);
+    TransientBytes buffers(pixel_count * 7);  // BGR, Lab, L
+    cv::Mat bgr, lab, l_plane;
+    {
+      StageTimer timer(Stage::kColorConvert);
+      cv::cvtColor(rgba_view(), bgr, cv::COLOR_RGBA2BGR);
+      cv::cvtColor(bgr, lab, cv::COLOR_BGR2Lab);
+      cv::extractChannel(lab, l_plane, 0);
+    }
+    {
+      StageTimer timer(Stage::kClahe);
+      cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(params.clarity, cv::Size(8, 8));
+      clahe->apply(l_plane, l_plane);
+    }
+    {
+      StageTimer timer(Stage::kColorConvert);
+      cv::insertChannel(l_plane, lab, 0);
+      cv::cvtColor(lab, bgr, cv::COLOR_Lab2BGR);
+    }
+    store_bgr_keep_alpha(bgr, mutable_pixels(), width_, height_, num_threads_);
   }
-  cv::merge(planes, lab);
-  cv::cvtColor(lab, bgr, cv::COLOR_Lab2BGR);
-  if (std::fabs(params.gamma - 1.0f) > 0.01f) {
-    cv::Mat lut(1, 256, CV_8UC1);
-    for (int i = 0; i < 256; ++i)
-      lut.at<uchar>(i) = clamp(static_cast<int>(255.0 * std::pow(i / 255.0, 1.0 / params.gamma)));
-    cv::LUT(bgr, lut, bgr);
+  // Stage 2 (pointwise): vibrance + gamma baked into a 3D LUT, one pass over RGBA.
+  const bool vibrance = std::fabs(params.vibrance) > 0.01f;
+  const bool gamma = std::fabs(params.gamma - 1.0f) > 0.01f;
+  if (vibrance || gamma) {
+    const float vib_scale = vibrance ? 1.0f + params.vibrance : 1.0f;
+    const float g = gamma ? params.gamma : 1.0f;
+    if (!effect_lut_ || effect_lut_vib_ != vib_scale || effect_lut_gamma_ != g) {
+      effect_lut_ = build_vibrance_gamma_lut(vib_scale, g);
+      effect_lut_vib_ = vib_scale;
+      effect_lut_gamma_ = g;
+    }
+    if (!effect_lut_ || !apply_lut(*effect_lut_)) return false;
   }
+  // Stage 3 (neighborhood): unsharp mask fused into one pass; alpha untouched.
   if (params.sharpness > 0.01f) {
+    TransientBytes buffers(pixel_count * 4);
     cv::Mat blurred;
-    cv::GaussianBlur(bgr, blurred, cv::Size(0, 0), 1.0);
-    cv::addWeighted(bgr, 1.0 + params.sharpness, blurred, -params.sharpness, 0, bgr);
+    cv::GaussianBlur(rgba_view(), blurred, cv::Size(0, 0), 1.0);
+    const int k_src = static_cast<int>(std::lround((1.0 + params.sharpness) * 4096.0));
+    const int k_blur = static_cast<int>(std::lround(params.sharpness * 4096.0));
+    uint8_t* pixels = mutable_pixels();
+    parallel_for_rows(height_, num_threads_, [&](int y0, int y1) {
+      for (int y = y0; y < y1; ++y) {
+        const uint8_t* bl = blurred.ptr<uint8_t>(y);
+        uint8_t* d = pixels + static_cast<size_t>(y) * static_cast<size_t>(width_) * 4;
+        for (int x = 0; x < width_; ++x, bl += 4, d += 4) {
+          for (int c = 0; c < 3; ++c)
+            d[c] = clamp((d[c] * k_src - bl[c] * k_blur + 2048) >> 12);
+        }
+      }
+    });
   }
-  cv::Mat out_rgba;
-  cv::cvtColor(bgr, out_rgba, cv::COLOR_BGR2RGBA);
-  const size_t n = static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4;
-  std::vector<uint8_t> alpha_backup(width_ * height_);
-  for (size_t i = 0, j = 0; i < n; i += 4, ++j) alpha_backup[j] = rgba_[i + 3];
-  std::memcpy(rgba_.data(), out_rgba.data, n);
-  for (size_t i = 0, j = 0; i < n; i += 4, ++j) rgba_[i + 3] = alpha_backup[j];
   return true;
 }
 
@@ -189,8 +296,80 @@ bool IrisObject::apply_clarity(float clip_limit) {
   return apply_effect_params(p);
 }
 
-bool IrisObject::export_to_file(const char*, const ExportParams&) const {
-  return false;
+void IrisObject::set_lut(const std::string& name, std::shared_ptr<const ColorLut3D> lut) {
+  if (lut)
+    luts_[name] = std::move(lut);
+  else
+    luts_.erase(name);
+}
+
+bool IrisObject::has_lut(const std::string& name) const {
+  return luts_.count(name) != 0;
+}
+
+bool IrisObject::apply_lut(const std::string& name) {
+  auto found = luts_.find(name);
+  if (found == luts_.end()) return false;
+  // Hold a reference so the table outlives a concurrent set_lut on the same name.
+  const std::shared_ptr<const ColorLut3D> lut = found->second;
+  return apply_lut(*lut);
+}
+
+bool IrisObject::apply_lut(const ColorLut3D& lut) {
+  if (!has_image()) return false;
+  StatsScope scope(&stats_);
+  uint8_t* pixels = mutable_pixels();
+  const size_t stride = static_cast<size_t>(width_) * 4;
+  parallel_for_rows(height_, num_threads_, [&](int y0, int y1) {
+    apply_color_lut_rows(lut, pixels, stride, width_, y0, y1);
+  });
+  return true;
+}
+
+bool IrisObject::edit_render(const EditStackParams& params, EditRenderResult* result) {
+  if (!edit_stack_) {
+    edit_stack_ = std::make_unique<EditStack>();
+    edit_stack_->set_budget(edit_budget_);
+  }
+  if (!edit_stack_->has_source()) {
+    if (!has_image()) return false;
+    edit_stack_->set_source(rgba_, width_, height_);
+  }
+  StatsScope scope(&stats_);
+  const bool ok = edit_stack_->render(*this, params, result);
+  update_held_bytes();
+  return ok;
+}
+
+void IrisObject::edit_reset() {
+  if (edit_stack_) edit_stack_->clear();
+  update_held_bytes();
+}
+
+void IrisObject::set_edit_budget(size_t bytes) {
+  edit_budget_ = bytes;
+  if (edit_stack_) edit_stack_->set_budget(bytes);
+  update_held_bytes();
+}
+
+bool IrisObject::export_to_file(const char* path, const ExportParams& params) const {
+  PrintExportOptions options;
+  options.dpi = params.dpi;
+  options.width_cm = params.width_cm;
+  if (params.to_cmyk) {
+    if (params.cmyk_profile.empty()) return false;
+    options.format = ImageFormat::kTiff;
+    options.cmyk.profile_path = params.cmyk_profile;
+  }
+  return export_print(path, options);
+}
+
+bool IrisObject::export_print(const char* path, const PrintExportOptions& options) const {
+  if (!has_image()) return false;
+  StatsScope scope(&stats_);
+  PrintExportOptions opts = options;
+  if (opts.num_threads <= 0) opts.num_threads = num_threads_;
+  return export_print_file(path, rgba_->data(), width_, height_, opts);
 }
 
 IrisObject* iris_object_create() {
@@ -16,21 +16,41 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <memory>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/photo.hpp>
 
+#include "iris_stats.h"
+
 namespace iris {
 
+struct ColorLut3D;
+struct PrintExportOptions;
+struct EditStackParams;
+struct EditRenderResult;
+class EditStack;
+
 // ---- Circle detection result (pupil / iris) ----
 struct CircleResult {
   float center_x;
   float center_y;
   float radius;
   bool valid;
+  float confidence = 0.0f;  // 0..1 edge support (see iris_detect.h); 0 = guessed
+};
+
+// ---- Alpha cut: iris kept, pupil removed (see iris_alpha_cut.h) ----
+struct AlphaAnnulus {
+  double cx = 0, cy = 0, r = 0;                    // iris circle
+  double pupil_cx = 0, pupil_cy = 0, pupil_r = 0;  // pupil hole; pupil_r <= 0 = none
+  bool antialias = false;                          // one-pixel coverage ramp on both edges
+
+  bool operator==(const AlphaAnnulus&) const = default;
 };
 
 // ---- Effect preset (JSON-driven, Phase 4) ----
@@ -42,9 +62,23 @@ struct EffectParams {
 };
 
 // ---- Flash removal params (Phase 3) ----
+enum class InpaintMethod : int {
+  kTelea = 0,         // cv::INPAINT_TELEA (default, as before)
+  kNavierStokes = 1,  // cv::INPAINT_NS
+  kPushPull = 2,      // pyramid push-pull fill, linear in the pixel count (iris_inpaint.h)
+};
+
 struct FlashRemovalParams {
   float brightness_threshold;  // L-channel threshold (e.g. 0.95)
   int dilate_pixels;           // Mask dilation, e.g. 2–3
+  // Optional search annulus in image pixels (e.g. the detected iris and pupil);
+  // search_outer_r <= 0 searches the whole frame.
+  float search_cx = 0.0f;
+  float search_cy = 0.0f;
+  float search_outer_r = 0.0f;
+  float search_inner_r = 0.0f;
+  InpaintMethod inpaint_method = InpaintMethod::kTelea;
+  float inpaint_radius = 3.0f;  // Telea / Navier-Stokes neighborhood; unused by push-pull
 };
 
 // ---- Export params (Phase 5) ----
@@ -52,11 +86,18 @@ struct ExportParams {
   int dpi;           // 300 or 600
   float width_cm;    // Physical width in cm (e.g. 20.0)
   bool to_cmyk;      // Use LittleCMS for CMYK conversion
+  std::string cmyk_profile;  // printer ICC profile (UTF-8 path), required by to_cmyk
 };
 
+/** RGBA pixels, row-major, width * height * 4 bytes (stride = width * 4). */
+using PixelBuffer = std::vector<uint8_t>;
+
 /**
  * IrisObject holds the in-memory image, mask, and parameters.
  * Implement as a C++ class; FFI exposes it as an opaque handle.
+ *
+ * The pixel buffer is copy-on-write: borrow_rgba() hands out a read-only reference
+ * that stays valid until dropped, and the next mutation detaches into a fresh buffer.
  */
 class IrisObject {
  public:
@@ -66,10 +107,31 @@ class IrisObject {
   // Buffer layout: RGBA, row-major, width * height * 4 bytes
   bool load_from_rgba(const uint8_t* data, int width, int height);
   bool get_rgba(std::vector<uint8_t>& out) const;
+  // UTF-8 path; decoded natively (EXIF orientation applied, alpha kept). See iris_codec.h.
+  bool load_from_file(const char* path);
+  // format: ImageFormat value (0 = from extension); quality as in encode_image_file.
+  bool save_to_file(const char* path, int format, int quality) const;
+  // Single copy into a caller buffer of at least width * height * 4 bytes.
+  bool copy_rgba_to(uint8_t* out, size_t capacity) const;
+  // Zero-copy read-only view of the current buffer (null when empty).
+  std::shared_ptr<const PixelBuffer> borrow_rgba() const;
+  // Installs [buffer] (width * height * 4 bytes) as the pixels. On return [buffer] holds
+  // the previous pixels if nothing else references them (reusable scratch), else null.
+  bool swap_rgba(std::shared_ptr<PixelBuffer>& buffer, int width, int height);
+  // Installs a shared buffer as the pixels without copying. It is never written through
+  // while others hold it: the next mutation detaches.
+  bool share_rgba(std::shared_ptr<const PixelBuffer> buffer, int width, int height);
 
   // Phase 2: Iris & pupil circles (Hough + alpha cut)
+  // Coarse-to-fine Hough + sub-pixel refinement (iris_detect.h).
   bool detect_iris_and_pupil(CircleResult& iris, CircleResult& pupil);
-  bool cut_iris_to_alpha(float iris_radius_scale = 1.0f);
+  // Replaces the cached circles (e.g. adjusted by the user); cuts then skip detection.
+  void set_circles(const CircleResult& iris, const CircleResult& pupil);
+  // Cuts with the cached circles, detecting once if there are none. Every cut starts
+  // from the pre-cut alpha, so a re-cut replaces the previous one and only rewrites
+  // the pixels between the old and new edges.
+  bool cut_iris_to_alpha(float iris_radius_scale = 1.0f, bool antialias = false);
+  bool cut_annulus_to_alpha(const AlphaAnnulus& annulus);
 
   // Phase 3: Flash removal (damage mask + inpaint)
   bool remove_flash(const FlashRemovalParams& params);
@@ -77,21 +139,66 @@ class IrisObject {
   // Phase 4: Color / clarity / presets
   bool apply_effect_params(const EffectParams& params);
   bool apply_clarity(float clip_limit);
+  // Named 3D LUTs (compiled presets or .cube files) cached on the handle.
+  void set_lut(const std::string& name, std::shared_ptr<const ColorLut3D> lut);
+  bool has_lut(const std::string& name) const;
+  bool apply_lut(const std::string& name);
+  bool apply_lut(const ColorLut3D& lut);
+  void clear_luts() { luts_.clear(); }
+
+  // Non-destructive edits (iris_edit_stack.h). The first render after a load takes the
+  // current pixels as the source; later renders rerun only the stages whose parameters
+  // (or upstream parameters) changed, from cached stage outputs.
+  bool edit_render(const EditStackParams& params, EditRenderResult* result = nullptr);
+  // Drops the edit source and cache; the next render starts from the current pixels.
+  void edit_reset();
+  // Byte budget for cached stage outputs; 0 = kDefaultEditCacheBytes.
+  void set_edit_budget(size_t bytes);
 
   // Phase 5: Export
+  // Print export at params.dpi / width_cm, streamed strip by strip (iris_print_export.h);
+  // to_cmyk writes a CMYK TIFF through the cached ICC transform (iris_color_management.h).
   bool export_to_file(const char* path, const ExportParams& params) const;
+  bool export_print(const char* path, const PrintExportOptions& options) const;
 
   int width() const { return width_; }
   int height() const { return height_; }
 
+  // Row-band thread budget for this handle's kernels; 0 = engine default.
+  void set_num_threads(int n) { num_threads_ = n > 0 ? n : 0; }
+  int num_threads() const { return num_threads_; }
+
+  // Stage timings and memory of this handle's calls (iris_stats.h).
+  EngineStats& stats() const { return stats_; }
+
  private:
   int width_ = 0;
   int height_ = 0;
-  std::vector<uint8_t> rgba_;
-  std::vector<uint8_t> alpha_mask_;  // 1 channel, same size
-  CircleResult iris_circle_;
-  CircleResult pupil_circle_;
-
+  int num_threads_ = 0;
+  std::shared_ptr<PixelBuffer> rgba_;  // shared with outstanding borrows
+  std::vector<uint8_t> alpha_mask_;  // pre-cut alpha, 1 channel; empty until the first cut
+  AlphaAnnulus last_cut_;            // annulus the current alpha was cut with
+  bool has_alpha_cut_ = false;
+  CircleResult iris_circle_{};
+  CircleResult pupil_circle_{};
+  // Vibrance/gamma lattice of the last apply_effect_params, rebuilt when they change.
+  std::shared_ptr<const ColorLut3D> effect_lut_;
+  float effect_lut_vib_ = 1.0f;
+  float effect_lut_gamma_ = 1.0f;
+  std::unordered_map<std::string, std::shared_ptr<const ColorLut3D>> luts_;
+  std::unique_ptr<EditStack> edit_stack_;  // created by the first edit_render
+  size_t edit_budget_ = 0;
+  mutable EngineStats stats_;
+
+  bool has_image() const { return rgba_ && !rgba_->empty() && width_ > 0 && height_ > 0; }
+  // New pixels: drops the cached circles and the alpha cut state.
+  void reset_image_state();
+  // Read-only header over the pixels (must not be written through).
+  cv::Mat rgba_view() const;
+  // Writable pixels; detaches from borrowers first.
+  uint8_t* mutable_pixels();
+  // Reports the pixels and alpha held now to stats_.
+  void update_held_bytes();
 };
 
 /**
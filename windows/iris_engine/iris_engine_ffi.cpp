@@ -6,10 +6,27 @@
  */
 #include "iris_engine_ffi.h"
 #include "iris_engine.h"
+#include "iris_batch.h"
+#include "iris_color_lut.h"
+#include "iris_color_management.h"
+#include "iris_command_buffer.h"
+#include "iris_compose.h"
 #include "iris_cut.h"
+#include "iris_detect.h"
+#include "iris_edit_stack.h"
+#include "iris_image_cache.h"
+#include "iris_inpaint.h"
+#include "iris_jobs.h"
+#include "iris_print_export.h"
+#include "iris_stats.h"
+#include "iris_thread_pool.h"
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include <opencv2/core.hpp>
 
 static uint8_t grayscale_byte(uint8_t r, uint8_t g, uint8_t b) {
@@ -20,6 +37,135 @@ static uint8_t grayscale_byte(uint8_t r, uint8_t g, uint8_t b) {
   return static_cast<uint8_t>(y);
 }
 
+static IrisCircle toIrisCircle(const iris::CircleResult& c) {
+  IrisCircle out{};
+  out.center_x = c.center_x;
+  out.center_y = c.center_y;
+  out.radius = c.radius;
+  out.confidence = c.confidence;
+  out.valid = c.valid ? 1 : 0;
+  return out;
+}
+
+static iris::CircleResult fromIrisCircle(const IrisCircle& c) {
+  iris::CircleResult out{};
+  out.center_x = c.center_x;
+  out.center_y = c.center_y;
+  out.radius = c.radius;
+  out.confidence = c.confidence;
+  out.valid = true;
+  return out;
+}
+
+static iris::CutOptions toCutOptions(const IrisCutOptions* options) {
+  iris::CutOptions opts;
+  if (!options) return opts;
+  opts.num_threads = options->num_threads;
+  opts.interpolation = iris::interpolation_from_int(options->interpolation);
+  opts.preview = options->preview != 0;
+  opts.preview_pixel_ratio = options->preview_pixel_ratio > 0 ? options->preview_pixel_ratio : 1.0;
+  return opts;
+}
+
+static iris::FlashRemovalParams toFlashParams(float brightness_threshold, int dilate_pixels,
+                                              const IrisFlashOptions* options) {
+  iris::FlashRemovalParams params;
+  params.brightness_threshold = brightness_threshold;
+  params.dilate_pixels = dilate_pixels;
+  if (!options) return params;
+  params.inpaint_method = iris::inpaint_method_from_int(options->inpaint_method);
+  params.inpaint_radius = options->inpaint_radius > 0 ? options->inpaint_radius : 3.0f;
+  params.search_cx = options->search_cx;
+  params.search_cy = options->search_cy;
+  params.search_outer_r = options->search_outer_r;
+  params.search_inner_r = options->search_inner_r;
+  return params;
+}
+
+static iris::CmykProfile toCmykProfile(const IrisColorProfile* profile) {
+  iris::CmykProfile out;
+  if (!profile) return out;
+  if (profile->cmyk_profile_utf8) out.profile_path = profile->cmyk_profile_utf8;
+  if (profile->source_profile_utf8) out.source_profile = profile->source_profile_utf8;
+  out.intent = iris::rendering_intent_from_int(profile->intent);
+  out.black_point_compensation = profile->no_black_point_compensation == 0;
+  out.simulate_paper = profile->simulate_paper != 0;
+  return out;
+}
+
+static iris::PrintExportOptions toPrintOptions(int dpi, float width_cm, const IrisPrintOptions* options) {
+  iris::PrintExportOptions opts;
+  opts.dpi = dpi;
+  opts.width_cm = width_cm;
+  if (!options) return opts;
+  opts.format = iris::image_format_from_int(options->format);
+  if (options->interpolation != 0) opts.interpolation = iris::interpolation_from_int(options->interpolation);
+  opts.keep_alpha = options->drop_alpha == 0;
+  opts.strip_rows = options->strip_rows;
+  opts.num_threads = options->num_threads;
+  opts.cmyk = toCmykProfile(&options->cmyk);
+  return opts;
+}
+
+static iris::EditStackParams toEditParams(const IrisEditStack& s) {
+  iris::EditStackParams p;
+  p.cut = s.cut != 0;
+  p.iris_radius_scale = s.iris_radius_scale > 0 ? s.iris_radius_scale : 1.0f;
+  p.antialias = s.antialias != 0;
+  if (s.iris.valid && s.pupil.valid) {
+    p.iris = fromIrisCircle(s.iris);
+    p.pupil = fromIrisCircle(s.pupil);
+  }
+  p.flash = s.flash != 0;
+  p.flash_params = toFlashParams(s.flash_threshold, s.flash_dilate_pixels, &s.flash_options);
+  p.effects = s.effects != 0;
+  p.effect_params.vibrance = s.vibrance;
+  p.effect_params.gamma = s.gamma <= 0.01f ? 1.0f : s.gamma;
+  p.effect_params.sharpness = s.sharpness;
+  p.effect_params.clarity = s.clarity;
+  return p;
+}
+
+/** What an IrisBatchHandle points to: the recorded edits and the last run's results. */
+struct BatchState {
+  std::vector<iris::CommandBuffer> edits;
+  std::vector<iris::BatchItemResult> results;
+};
+
+static iris::BatchOptions toBatchOptions(const IrisBatchOptions* options) {
+  iris::BatchOptions opts;
+  if (!options) return opts;
+  opts.memory_budget_bytes = options->memory_budget_bytes > 0 ? static_cast<size_t>(options->memory_budget_bytes) : 0;
+  opts.max_concurrent = options->max_concurrent;
+  opts.threads_per_image = options->threads_per_image;
+  return opts;
+}
+
+/** kCompose step for [count] layer paths; a NULL path records an empty one (invalid at submit). */
+static iris::Command toComposeCommand(const char* const* layer_paths_utf8, int count, const IrisCompositeSpec& spec) {
+  iris::Command c;
+  c.op = iris::CommandOp::kCompose;
+  for (int i = 0; i < count; ++i) c.layers.emplace_back(layer_paths_utf8[i] ? layer_paths_utf8[i] : "");
+  iris::ComposeSpec& cs = c.compose;
+  cs.layout = iris::compose_layout_from_int(spec.layout);
+  cs.width_cm = spec.width_cm;
+  cs.height_cm = spec.height_cm;
+  if (spec.dpi != 0) cs.dpi = spec.dpi;
+  if (spec.gap != 0) cs.gap = spec.gap < 0 ? 0.0 : spec.gap;
+  if (spec.margin != 0) cs.margin = spec.margin < 0 ? 0.0 : spec.margin;
+  std::memcpy(cs.background, spec.background_rgba, 4);
+  if (spec.interpolation != 0) cs.interpolation = iris::interpolation_from_int(spec.interpolation);
+  cs.num_threads = spec.num_threads;
+  return c;
+}
+
+static bool recordCommand(IrisCommandBufferHandle cmd, const iris::Command& command) {
+  auto* buffer = static_cast<iris::CommandBuffer*>(cmd);
+  if (!buffer) return false;
+  buffer->record(command);
+  return true;
+}
+
 static bool checkOpenCV() {
   try {
     cv::Mat test(10, 10, CV_8UC1);
@@ -32,15 +178,27 @@ static bool checkOpenCV() {
 extern "C" {
 
 IRIS_FFI_API int iris_engine_grayscale(uint8_t* rgba, int width, int height) {
+  return iris_engine_grayscale_mt(rgba, width, height, 0);
+}
+
+IRIS_FFI_API int iris_engine_grayscale_mt(uint8_t* rgba, int width, int height, int num_threads) {
   if (!rgba || width <= 0 || height <= 0) return 0;
-  size_t n = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
-  for (size_t i = 0; i < n; i += 4) {
-    uint8_t g = grayscale_byte(rgba[i], rgba[i + 1], rgba[i + 2]);
-    rgba[i] = rgba[i + 1] = rgba[i + 2] = g;
-  }
+  const size_t row_bytes = static_cast<size_t>(width) * 4;
+  iris::parallel_for_rows(height, num_threads, [&](int y0, int y1) {
+    uint8_t* p = rgba + static_cast<size_t>(y0) * row_bytes;
+    uint8_t* end = rgba + static_cast<size_t>(y1) * row_bytes;
+    for (; p < end; p += 4) {
+      uint8_t g = grayscale_byte(p[0], p[1], p[2]);
+      p[0] = p[1] = p[2] = g;
+    }
+  });
   return 1;
 }
 
+IRIS_FFI_API void iris_engine_set_default_threads(int num_threads) {
+  iris::set_default_thread_count(num_threads);
+}
+
 IRIS_FFI_API IrisEngineHandle iris_engine_create(void) {
   return static_cast<IrisEngineHandle>(iris::iris_object_create());
 }
@@ -58,17 +216,81 @@ IRIS_FFI_API int iris_engine_load_rgba(IrisEngineHandle handle,
   return obj->load_from_rgba(rgba, width, height) ? 1 : 0;
 }
 
+IRIS_FFI_API int iris_engine_load_file(IrisEngineHandle handle, const char* image_path_utf8) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !image_path_utf8) return 0;
+  return obj->load_from_file(image_path_utf8) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_save_file(IrisEngineHandle handle,
+                                       const char* image_path_utf8,
+                                       int format,
+                                       int quality) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !image_path_utf8) return 0;
+  return obj->save_to_file(image_path_utf8, format, quality) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_export_print(IrisEngineHandle handle,
+                                          const char* image_path_utf8,
+                                          int dpi,
+                                          float width_cm,
+                                          const IrisPrintOptions* options) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !image_path_utf8) return 0;
+  return obj->export_print(image_path_utf8, toPrintOptions(dpi, width_cm, options)) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_compose(IrisEngineHandle target,
+                                     const char* const* layer_paths_utf8,
+                                     int count,
+                                     const IrisCompositeSpec* spec) {
+  auto* obj = static_cast<iris::IrisObject*>(target);
+  if (!obj || !layer_paths_utf8 || !spec || count < 1 || count > iris::COMPOSE_MAX_LAYERS) return 0;
+  iris::CommandBuffer buffer;  // the same step a recorded iris_engine_cmd_compose runs
+  buffer.record(toComposeCommand(layer_paths_utf8, count, *spec));
+  return buffer.submit(*obj) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_get_size(IrisEngineHandle handle, int32_t* out_width, int32_t* out_height) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !out_width || !out_height || obj->width() <= 0 || obj->height() <= 0) return 0;
+  *out_width = obj->width();
+  *out_height = obj->height();
+  return 1;
+}
+
 IRIS_FFI_API int iris_engine_get_rgba(IrisEngineHandle handle,
                                       uint8_t* out_rgba,
                                       int width,
                                       int height) {
   auto* obj = static_cast<iris::IrisObject*>(handle);
-  if (!obj || !out_rgba) return 0;
-  std::vector<uint8_t> vec;
-  if (!obj->get_rgba(vec)) return 0;
+  if (!obj || !out_rgba || width != obj->width() || height != obj->height()) return 0;
   size_t expect = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
-  if (vec.size() != expect) return 0;
-  std::memcpy(out_rgba, vec.data(), expect);
+  return obj->copy_rgba_to(out_rgba, expect) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_borrow_rgba(IrisEngineHandle handle, IrisBufferView* out_view) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !out_view) return 0;
+  std::shared_ptr<const iris::PixelBuffer> pixels = obj->borrow_rgba();
+  if (!pixels) return 0;
+  out_view->data = pixels->data();
+  out_view->width = obj->width();
+  out_view->height = obj->height();
+  out_view->stride = obj->width() * 4;
+  out_view->pin = new std::shared_ptr<const iris::PixelBuffer>(std::move(pixels));
+  return 1;
+}
+
+IRIS_FFI_API void iris_engine_release_buffer(void* pin) {
+  delete static_cast<std::shared_ptr<const iris::PixelBuffer>*>(pin);
+}
+
+IRIS_FFI_API int iris_engine_set_threads(IrisEngineHandle handle, int num_threads) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj) return 0;
+  obj->set_num_threads(num_threads);
   return 1;
 }
 
@@ -82,6 +304,48 @@ IRIS_FFI_API int iris_engine_cut_iris(IrisEngineHandle handle) {
   return obj->cut_iris_to_alpha(1.0f) ? 1 : 0;
 }
 
+IRIS_FFI_API int iris_engine_cut_iris_ex(IrisEngineHandle handle, float iris_radius_scale, int antialias) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj) return 0;
+  return obj->cut_iris_to_alpha(iris_radius_scale, antialias != 0) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_detect_circles(IrisEngineHandle handle, IrisCircle* out_iris, IrisCircle* out_pupil) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !out_iris || !out_pupil) return 0;
+  iris::CircleResult iris_c{}, pupil_c{};
+  if (!obj->detect_iris_and_pupil(iris_c, pupil_c)) return 0;
+  *out_iris = toIrisCircle(iris_c);
+  *out_pupil = toIrisCircle(pupil_c);
+  return 1;
+}
+
+IRIS_FFI_API int iris_engine_set_circles(IrisEngineHandle handle, const IrisCircle* iris, const IrisCircle* pupil) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !iris || !pupil || iris->radius <= 0 || pupil->radius < 0) return 0;
+  obj->set_circles(fromIrisCircle(*iris), fromIrisCircle(*pupil));
+  return 1;
+}
+
+IRIS_FFI_API int iris_engine_detect_circles_file(
+  const char* image_path_utf8,
+  IrisCircle* out_iris,
+  IrisCircle* out_pupil,
+  int32_t* out_width,
+  int32_t* out_height
+) {
+  if (!image_path_utf8 || !out_iris || !out_pupil || !out_width || !out_height) return 0;
+  iris::CircleResult iris_c{}, pupil_c{};
+  int w = 0, h = 0;
+  const bool ok = iris::detect_iris_circles_file(image_path_utf8, iris_c, pupil_c, &w, &h);
+  *out_width = w;
+  *out_height = h;
+  if (!ok) return 0;
+  *out_iris = toIrisCircle(iris_c);
+  *out_pupil = toIrisCircle(pupil_c);
+  return 1;
+}
+
 IRIS_FFI_API int iris_engine_remove_flash(IrisEngineHandle handle,
                                           float brightness_threshold,
                                           int dilate_pixels) {
@@ -93,6 +357,29 @@ IRIS_FFI_API int iris_engine_remove_flash(IrisEngineHandle handle,
   return obj->remove_flash(params) ? 1 : 0;
 }
 
+IRIS_FFI_API int iris_engine_remove_flash_in_annulus(IrisEngineHandle handle,
+                                                     float brightness_threshold,
+                                                     int dilate_pixels,
+                                                     float cx, float cy,
+                                                     float outer_r, float inner_r) {
+  IrisFlashOptions options{};
+  options.search_cx = cx;
+  options.search_cy = cy;
+  options.search_outer_r = outer_r;
+  options.search_inner_r = inner_r;
+  return iris_engine_remove_flash_ex(handle, brightness_threshold, dilate_pixels, &options);
+}
+
+IRIS_FFI_API int iris_engine_remove_flash_ex(IrisEngineHandle handle,
+                                             float brightness_threshold,
+                                             int dilate_pixels,
+                                             const IrisFlashOptions* options) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj) return 0;
+  if (options && options->search_outer_r > 0 && options->search_inner_r >= options->search_outer_r) return 0;
+  return obj->remove_flash(toFlashParams(brightness_threshold, dilate_pixels, options)) ? 1 : 0;
+}
+
 IRIS_FFI_API int iris_engine_apply_effects(IrisEngineHandle handle,
                                            float vibrance,
                                            float gamma,
@@ -108,6 +395,97 @@ IRIS_FFI_API int iris_engine_apply_effects(IrisEngineHandle handle,
   return obj->apply_effect_params(params) ? 1 : 0;
 }
 
+IRIS_FFI_API int iris_engine_edit_render(IrisEngineHandle handle, const IrisEditStack* stack,
+                                         IrisEditResult* out_result) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !stack) return 0;
+  iris::EditRenderResult result;
+  if (!obj->edit_render(toEditParams(*stack), &result)) return 0;
+  if (out_result) {
+    out_result->reused_stage = result.reused_stage;
+    out_result->computed_stages = result.computed_stages;
+    out_result->cached_bytes = static_cast<int64_t>(result.cached_bytes);
+    out_result->render_ms = result.render_ms;
+  }
+  return 1;
+}
+
+IRIS_FFI_API void iris_engine_edit_reset(IrisEngineHandle handle) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (obj) obj->edit_reset();
+}
+
+IRIS_FFI_API void iris_engine_edit_set_budget(IrisEngineHandle handle, int64_t bytes) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (obj) obj->set_edit_budget(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+}
+
+IRIS_FFI_API int iris_engine_define_preset_lut(IrisEngineHandle handle,
+                                               const char* name,
+                                               const IrisColorPreset* preset,
+                                               int lut_size) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !name || !preset) return 0;
+  if (lut_size == 0) lut_size = iris::COLOR_LUT_DEFAULT_SIZE;
+  if (lut_size < iris::COLOR_LUT_MIN_SIZE || lut_size > iris::COLOR_LUT_MAX_SIZE) return 0;
+  iris::ColorPresetParams params;
+  params.brightness = preset->brightness;
+  params.contrast = preset->contrast;
+  params.saturation = preset->saturation;
+  params.hue_deg = preset->hue_deg;
+  std::shared_ptr<const iris::ColorLut3D> lut = iris::compile_color_preset(params, lut_size);
+  if (!lut) return 0;
+  obj->set_lut(name, std::move(lut));
+  return 1;
+}
+
+IRIS_FFI_API int iris_engine_load_cube_lut(IrisEngineHandle handle,
+                                           const char* name,
+                                           const char* cube_path_utf8) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !name || !cube_path_utf8) return 0;
+  std::shared_ptr<const iris::ColorLut3D> lut = iris::load_cube_file(cube_path_utf8);
+  if (!lut) return 0;
+  obj->set_lut(name, std::move(lut));
+  return 1;
+}
+
+IRIS_FFI_API int iris_engine_color_management_available(void) {
+  return iris::color_management_available() ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_define_proof_lut(IrisEngineHandle handle,
+                                              const char* name,
+                                              const IrisColorProfile* profile) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !name || !profile) return 0;
+  std::shared_ptr<const iris::ColorLut3D> lut = iris::acquire_soft_proof_lut(toCmykProfile(profile));
+  if (!lut) return 0;
+  obj->set_lut(name, std::move(lut));
+  return 1;
+}
+
+IRIS_FFI_API void iris_engine_color_purge(void) {
+  iris::purge_color_transforms();
+}
+
+IRIS_FFI_API int iris_engine_apply_lut(IrisEngineHandle handle, const char* name) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !name) return 0;
+  return obj->apply_lut(std::string(name)) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_has_lut(IrisEngineHandle handle, const char* name) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!obj || !name) return 0;
+  return obj->has_lut(name) ? 1 : 0;
+}
+
+IRIS_FFI_API void iris_engine_clear_luts(IrisEngineHandle handle) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (obj) obj->clear_luts();
+}
+
 IRIS_FFI_API int iris_engine_has_opencv(void) {
   return 1;
 }
@@ -123,13 +501,32 @@ IRIS_FFI_API int iris_engine_process_iris_cut(
   uint8_t** out_rgba,
   int32_t* out_width,
   int32_t* out_height
+) {
+  return iris_engine_process_iris_cut_ex(
+    image_path_utf8,
+    iris_cx, iris_cy, iris_r,
+    pupil_cx, pupil_cy, pupil_r,
+    nullptr,
+    out_rgba, out_width, out_height
+  );
+}
+
+IRIS_FFI_API int iris_engine_process_iris_cut_ex(
+  const char* image_path_utf8,
+  double iris_cx, double iris_cy, double iris_r,
+  double pupil_cx, double pupil_cy, double pupil_r,
+  const IrisCutOptions* options,
+  uint8_t** out_rgba,
+  int32_t* out_width,
+  int32_t* out_height
 ) {
   if (!image_path_utf8 || !out_rgba || !out_width || !out_height) return 0;
   return iris::process_iris_cut(
     image_path_utf8,
     iris_cx, iris_cy, iris_r,
     pupil_cx, pupil_cy, pupil_r,
-    out_rgba, out_width, out_height
+    out_rgba, out_width, out_height,
+    toCutOptions(options)
   ) ? 1 : 0;
 }
 
@@ -142,6 +539,27 @@ IRIS_FFI_API int iris_engine_process_iris_cut_from_view(
   uint8_t** out_rgba,
   int32_t* out_width,
   int32_t* out_height
+) {
+  return iris_engine_process_iris_cut_from_view_ex(
+    image_path_utf8,
+    view_w, view_h,
+    outer_r, inner_r,
+    outer_dx, outer_dy, inner_dx, inner_dy,
+    nullptr,
+    out_rgba, out_width, out_height
+  );
+}
+
+IRIS_FFI_API int iris_engine_process_iris_cut_from_view_ex(
+  const char* image_path_utf8,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  const IrisCutOptions* options,
+  uint8_t** out_rgba,
+  int32_t* out_width,
+  int32_t* out_height
 ) {
   if (!image_path_utf8 || !out_rgba || !out_width || !out_height) return 0;
   return iris::process_iris_cut_from_view(
@@ -149,8 +567,489 @@ IRIS_FFI_API int iris_engine_process_iris_cut_from_view(
     view_w, view_h,
     outer_r, inner_r,
     outer_dx, outer_dy, inner_dx, inner_dy,
-    out_rgba, out_width, out_height
+    out_rgba, out_width, out_height,
+    toCutOptions(options)
   ) ? 1 : 0;
 }
 
+IRIS_FFI_API int iris_engine_process_iris_cut_into(
+  const char* image_path_utf8,
+  double iris_cx, double iris_cy, double iris_r,
+  double pupil_cx, double pupil_cy, double pupil_r,
+  const IrisCutOptions* options,
+  uint8_t* out_rgba,
+  int64_t out_capacity,
+  int32_t* out_width,
+  int32_t* out_height
+) {
+  if (!image_path_utf8 || !out_width || !out_height) return 0;
+  int w = 0, h = 0;
+  const bool ok = iris::process_iris_cut_into(
+    image_path_utf8,
+    iris_cx, iris_cy, iris_r,
+    pupil_cx, pupil_cy, pupil_r,
+    out_rgba, out_capacity > 0 ? static_cast<size_t>(out_capacity) : 0, &w, &h,
+    toCutOptions(options)
+  );
+  *out_width = w;
+  *out_height = h;
+  return ok ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_process_iris_cut_from_view_into(
+  const char* image_path_utf8,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  const IrisCutOptions* options,
+  uint8_t* out_rgba,
+  int64_t out_capacity,
+  int32_t* out_width,
+  int32_t* out_height
+) {
+  if (!image_path_utf8 || !out_width || !out_height) return 0;
+  int w = 0, h = 0;
+  const bool ok = iris::process_iris_cut_from_view_into(
+    image_path_utf8,
+    view_w, view_h,
+    outer_r, inner_r,
+    outer_dx, outer_dy, inner_dx, inner_dy,
+    out_rgba, out_capacity > 0 ? static_cast<size_t>(out_capacity) : 0, &w, &h,
+    toCutOptions(options)
+  );
+  *out_width = w;
+  *out_height = h;
+  return ok ? 1 : 0;
+}
+
+IRIS_FFI_API IrisCommandBufferHandle iris_engine_cmd_create(void) {
+  return static_cast<IrisCommandBufferHandle>(new iris::CommandBuffer());
+}
+
+IRIS_FFI_API void iris_engine_cmd_destroy(IrisCommandBufferHandle cmd) {
+  delete static_cast<iris::CommandBuffer*>(cmd);
+}
+
+IRIS_FFI_API void iris_engine_cmd_reset(IrisCommandBufferHandle cmd) {
+  auto* buffer = static_cast<iris::CommandBuffer*>(cmd);
+  if (buffer) buffer->clear();
+}
+
+IRIS_FFI_API int iris_engine_cmd_count(IrisCommandBufferHandle cmd) {
+  auto* buffer = static_cast<iris::CommandBuffer*>(cmd);
+  return buffer ? static_cast<int>(buffer->size()) : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_load_file(IrisCommandBufferHandle cmd, const char* image_path_utf8) {
+  iris::Command c;
+  c.op = iris::CommandOp::kLoadFile;
+  c.path = image_path_utf8 ? image_path_utf8 : "";
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_cut_auto(IrisCommandBufferHandle cmd, float iris_radius_scale) {
+  iris::Command c;
+  c.op = iris::CommandOp::kCutAuto;
+  c.iris_radius_scale = iris_radius_scale;
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_cut_circles(
+  IrisCommandBufferHandle cmd,
+  double iris_cx, double iris_cy, double iris_r, double pupil_r,
+  const IrisCutOptions* options
+) {
+  iris::Command c;
+  c.op = iris::CommandOp::kCutCircles;
+  c.geometry = iris::CutGeometry{iris_cx, iris_cy, iris_r, pupil_r};
+  c.cut_options = toCutOptions(options);
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_cut_from_view(
+  IrisCommandBufferHandle cmd,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  const IrisCutOptions* options
+) {
+  iris::Command c;
+  c.op = iris::CommandOp::kCutFromView;
+  c.view_w = view_w;
+  c.view_h = view_h;
+  c.outer_r = outer_r;
+  c.inner_r = inner_r;
+  c.outer_dx = outer_dx;
+  c.outer_dy = outer_dy;
+  c.cut_options = toCutOptions(options);
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_remove_flash(IrisCommandBufferHandle cmd,
+                                              float brightness_threshold,
+                                              int dilate_pixels) {
+  iris::Command c;
+  c.op = iris::CommandOp::kRemoveFlash;
+  c.flash.brightness_threshold = brightness_threshold;
+  c.flash.dilate_pixels = dilate_pixels;
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_remove_flash_ex(IrisCommandBufferHandle cmd,
+                                                 float brightness_threshold,
+                                                 int dilate_pixels,
+                                                 const IrisFlashOptions* options) {
+  iris::Command c;
+  c.op = iris::CommandOp::kRemoveFlash;
+  c.flash = toFlashParams(brightness_threshold, dilate_pixels, options);
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_apply_effects(IrisCommandBufferHandle cmd,
+                                               float vibrance,
+                                               float gamma,
+                                               float sharpness,
+                                               float clarity) {
+  iris::Command c;
+  c.op = iris::CommandOp::kApplyEffects;
+  c.effects.vibrance = vibrance;
+  c.effects.gamma = gamma <= 0.01f ? 1.0f : gamma;
+  c.effects.sharpness = sharpness;
+  c.effects.clarity = clarity;
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_apply_lut(IrisCommandBufferHandle cmd, const char* name) {
+  iris::Command c;
+  c.op = iris::CommandOp::kApplyLut;
+  c.lut_name = name ? name : "";
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_crop(IrisCommandBufferHandle cmd, int x, int y, int width, int height) {
+  iris::Command c;
+  c.op = iris::CommandOp::kCrop;
+  c.crop_x = x;
+  c.crop_y = y;
+  c.crop_w = width;
+  c.crop_h = height;
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_export(IrisCommandBufferHandle cmd,
+                                        const char* image_path_utf8,
+                                        int format,
+                                        int quality) {
+  iris::Command c;
+  c.op = iris::CommandOp::kExportFile;
+  c.path = image_path_utf8 ? image_path_utf8 : "";
+  c.format = format;
+  c.quality = quality;
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_export_print(IrisCommandBufferHandle cmd,
+                                              const char* image_path_utf8,
+                                              int dpi,
+                                              float width_cm,
+                                              const IrisPrintOptions* options) {
+  iris::Command c;
+  c.op = iris::CommandOp::kExportPrint;
+  c.path = image_path_utf8 ? image_path_utf8 : "";
+  c.print = toPrintOptions(dpi, width_cm, options);
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_solo_effect(IrisCommandBufferHandle cmd, const IrisSoloEffectParams* params) {
+  if (!params) return 0;
+  iris::Command c;
+  c.op = iris::CommandOp::kSoloEffect;
+  c.solo.effect = iris::solo_effect_from_int(params->effect);
+  c.solo.seed = params->seed;
+  if (params->extent != 0) c.solo.extent = params->extent;
+  if (params->intensity != 0) c.solo.intensity = params->intensity;
+  if (params->size != 0) c.solo.size = params->size;
+  c.solo.count = params->count;
+  std::memcpy(c.solo.color, params->color_rgb, 3);
+  c.solo.max_side = params->max_side;
+  c.solo.num_threads = params->num_threads;
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_duo_effect(IrisCommandBufferHandle cmd,
+                                            const char* second_path_utf8,
+                                            const IrisDuoEffectParams* params) {
+  if (!params) return 0;
+  iris::Command c;
+  c.op = iris::CommandOp::kDuoEffect;
+  c.path = second_path_utf8 ? second_path_utf8 : "";
+  c.duo.effect = iris::duo_effect_from_int(params->effect);
+  c.duo.angle_deg = params->angle_deg;
+  c.duo.softness = params->softness;
+  c.duo.offset = params->offset;
+  c.duo.extent = params->extent;
+  c.duo.max_side = params->max_side;
+  c.duo.num_threads = params->num_threads;
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_compose(IrisCommandBufferHandle cmd,
+                                         const char* const* layer_paths_utf8,
+                                         int count,
+                                         const IrisCompositeSpec* spec) {
+  if (!layer_paths_utf8 || !spec || count < 0) return 0;
+  return recordCommand(cmd, toComposeCommand(layer_paths_utf8, count, *spec)) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_edit_render(IrisCommandBufferHandle cmd, const IrisEditStack* stack) {
+  if (!stack) return 0;
+  iris::Command c;
+  c.op = iris::CommandOp::kEditRender;
+  c.edit = toEditParams(*stack);
+  return recordCommand(cmd, c) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_cmd_validate(IrisCommandBufferHandle cmd, IrisEngineHandle handle) {
+  auto* buffer = static_cast<iris::CommandBuffer*>(cmd);
+  if (!buffer) return IRIS_CMD_INVALID_BUFFER;
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  return buffer->validate(obj && obj->width() > 0 && obj->height() > 0);
+}
+
+IRIS_FFI_API int iris_engine_cmd_submit(IrisCommandBufferHandle cmd,
+                                        IrisEngineHandle handle,
+                                        int32_t* out_failed_index) {
+  auto* buffer = static_cast<iris::CommandBuffer*>(cmd);
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (out_failed_index) *out_failed_index = 0;
+  if (!buffer || !obj) return 0;
+  int failed = -1;
+  const bool ok = buffer->submit(*obj, &failed);
+  if (out_failed_index) *out_failed_index = failed;
+  return ok ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_jobs_init(void* post_cobject) {
+  iris::set_job_message_poster(post_cobject);
+  return 1;
+}
+
+IRIS_FFI_API IrisJobId iris_engine_submit(IrisCommandBufferHandle cmd,
+                                          IrisEngineHandle handle,
+                                          int64_t reply_port,
+                                          const char* group_utf8) {
+  auto* buffer = static_cast<iris::CommandBuffer*>(cmd);
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  if (!buffer || !obj) return 0;
+  iris::JobOptions options;
+  options.reply_port = reply_port;
+  if (group_utf8) options.group = group_utf8;
+  options.exclusive = obj;
+  auto list = std::make_shared<const iris::CommandBuffer>(*buffer);
+  return iris::submit_job([list, obj](const iris::JobContext& context, iris::JobResult& result) {
+    iris::SubmitHooks hooks;
+    hooks.cancel = &context.cancel_flag();
+    hooks.progress = [&context](int done, int total) { context.progress(done, total); };
+    int failed = -1;
+    result.ok = list->submit(*obj, &failed, hooks);
+    result.cancelled = !result.ok && context.cancelled();
+    result.detail = failed;
+  }, options);
+}
+
+IRIS_FFI_API IrisJobId iris_engine_submit_cut_from_view(
+  const char* image_path_utf8,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  const IrisCutOptions* options,
+  int64_t reply_port,
+  const char* group_utf8
+) {
+  if (!image_path_utf8) return 0;
+  iris::JobOptions job_options;
+  job_options.reply_port = reply_port;
+  if (group_utf8) job_options.group = group_utf8;
+  const std::string path = image_path_utf8;
+  const iris::CutOptions cut_options = toCutOptions(options);
+  return iris::submit_job([=](const iris::JobContext& context, iris::JobResult& result) {
+    int w = 0, h = 0;
+    result.ok = iris::process_iris_cut_from_view(
+      path.c_str(),
+      view_w, view_h,
+      outer_r, inner_r,
+      outer_dx, outer_dy, inner_dx, inner_dy,
+      &result.rgba, &w, &h,
+      cut_options
+    );
+    result.width = w;
+    result.height = h;
+    // No side effects: a preview overtaken while rendering is dropped.
+    result.cancelled = context.cancelled();
+  }, job_options);
+}
+
+IRIS_FFI_API int iris_engine_cancel(IrisJobId job) {
+  return iris::cancel_job(job) ? 1 : 0;
+}
+
+IRIS_FFI_API int iris_engine_job_status(IrisJobId job) {
+  return static_cast<int>(iris::job_status(job));
+}
+
+IRIS_FFI_API int iris_engine_job_wait(IrisJobId job, int32_t* out_failed_index) {
+  int detail = -1;
+  const iris::JobStatus status = iris::wait_job(job, &detail);
+  if (out_failed_index) *out_failed_index = detail;
+  return static_cast<int>(status);
+}
+
+IRIS_FFI_API int iris_engine_job_take_result(IrisJobId job,
+                                             uint8_t** out_rgba,
+                                             int32_t* out_width,
+                                             int32_t* out_height) {
+  if (!out_rgba || !out_width || !out_height) return 0;
+  uint8_t* rgba = nullptr;
+  int w = 0, h = 0;
+  if (!iris::take_job_result(job, &rgba, &w, &h)) return 0;
+  *out_rgba = rgba;
+  *out_width = w;
+  *out_height = h;
+  return 1;
+}
+
+IRIS_FFI_API IrisBatchHandle iris_engine_batch_create(void) {
+  return static_cast<IrisBatchHandle>(new BatchState());
+}
+
+IRIS_FFI_API void iris_engine_batch_destroy(IrisBatchHandle batch) {
+  delete static_cast<BatchState*>(batch);
+}
+
+IRIS_FFI_API int iris_engine_batch_add(IrisBatchHandle batch, IrisCommandBufferHandle cmd) {
+  auto* state = static_cast<BatchState*>(batch);
+  auto* buffer = static_cast<iris::CommandBuffer*>(cmd);
+  if (!state || !buffer) return -1;
+  state->edits.push_back(*buffer);
+  return static_cast<int>(state->edits.size()) - 1;
+}
+
+IRIS_FFI_API int iris_engine_batch_count(IrisBatchHandle batch) {
+  auto* state = static_cast<BatchState*>(batch);
+  return state ? static_cast<int>(state->edits.size()) : 0;
+}
+
+IRIS_FFI_API int iris_engine_batch_run(IrisBatchHandle batch, const IrisBatchOptions* options) {
+  auto* state = static_cast<BatchState*>(batch);
+  if (!state) return 0;
+  return iris::run_batch(state->edits, toBatchOptions(options), state->results) ? 1 : 0;
+}
+
+IRIS_FFI_API IrisJobId iris_engine_batch_submit(IrisBatchHandle batch,
+                                                const IrisBatchOptions* options,
+                                                int64_t reply_port,
+                                                const char* group_utf8) {
+  auto* state = static_cast<BatchState*>(batch);
+  if (!state) return 0;
+  iris::JobOptions job_options;
+  job_options.reply_port = reply_port;
+  if (group_utf8) job_options.group = group_utf8;
+  job_options.exclusive = state;
+  const iris::BatchOptions opts = toBatchOptions(options);
+  return iris::submit_job([state, opts](const iris::JobContext& context, iris::JobResult& result) {
+    iris::SubmitHooks hooks;
+    hooks.cancel = &context.cancel_flag();
+    hooks.progress = [&context](int done, int total) { context.progress(done, total); };
+    result.ok = iris::run_batch(state->edits, opts, state->results, hooks);
+    result.cancelled = !result.ok && context.cancelled();
+  }, job_options);
+}
+
+IRIS_FFI_API int iris_engine_batch_get_result(IrisBatchHandle batch, int index, IrisBatchItemResult* out_result) {
+  auto* state = static_cast<BatchState*>(batch);
+  if (!state || !out_result || index < 0 || static_cast<size_t>(index) >= state->results.size()) return 0;
+  const iris::BatchItemResult& r = state->results[static_cast<size_t>(index)];
+  IrisBatchItemResult out{};
+  out.estimated_bytes = static_cast<int64_t>(r.estimated_bytes);
+  out.wait_ms = r.wait_ms;
+  out.load_ms = r.load_ms;
+  out.process_ms = r.process_ms;
+  out.export_ms = r.export_ms;
+  out.total_ms = r.total_ms;
+  out.ok = r.ok ? 1 : 0;
+  out.started = r.started ? 1 : 0;
+  out.failed_index = r.ok ? -1 : r.failed_index;
+  out.width = r.width;
+  out.height = r.height;
+  *out_result = out;
+  return 1;
+}
+
+IRIS_FFI_API void iris_engine_cache_set_budget(int64_t bytes) {
+  iris::set_image_cache_budget(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+}
+
+IRIS_FFI_API int iris_engine_cache_get_stats(IrisCacheStats* out_stats) {
+  if (!out_stats) return 0;
+  const iris::ImageCacheStats s = iris::image_cache_stats();
+  out_stats->hits = s.hits;
+  out_stats->misses = s.misses;
+  out_stats->evictions = s.evictions;
+  out_stats->bytes_in_use = s.bytes_in_use;
+  out_stats->budget_bytes = s.budget_bytes;
+  out_stats->entries = static_cast<int32_t>(s.entries);
+  return 1;
+}
+
+IRIS_FFI_API void iris_engine_cache_purge(const char* image_path_utf8) {
+  iris::purge_image_cache(image_path_utf8);
+}
+
+static iris::EngineStats& statsOf(IrisEngineHandle handle) {
+  auto* obj = static_cast<iris::IrisObject*>(handle);
+  return obj ? obj->stats() : iris::process_stats();
+}
+
+IRIS_FFI_API int iris_engine_get_stats(IrisEngineHandle handle, IrisEngineStats* out_stats) {
+  if (!out_stats) return 0;
+  static_assert(IRIS_STAGE_COUNT == iris::kStageCount, "IRIS_STAGE_* out of sync with iris::Stage");
+  const iris::StatsSnapshot s = statsOf(handle).snapshot();
+  for (int i = 0; i < IRIS_STAGE_COUNT; ++i) {
+    out_stats->stages[i].calls = s.stages[i].calls;
+    out_stats->stages[i].total_ns = s.stages[i].total_ns;
+    out_stats->stages[i].max_ns = s.stages[i].max_ns;
+  }
+  out_stats->allocations = s.allocations;
+  out_stats->allocated_bytes = s.allocated_bytes;
+  out_stats->resident_bytes = s.resident_bytes;
+  out_stats->peak_bytes = s.peak_bytes;
+  iris::process_memory(&out_stats->process_working_set_bytes, &out_stats->process_peak_working_set_bytes);
+  return 1;
+}
+
+IRIS_FFI_API int iris_engine_get_stats_json(IrisEngineHandle handle, char** out_json) {
+  if (!out_json) return 0;
+  *out_json = nullptr;
+  const std::string json = iris::stats_to_json(statsOf(handle).snapshot());
+  char* buf = static_cast<char*>(std::malloc(json.size() + 1));
+  if (!buf) return 0;
+  std::memcpy(buf, json.c_str(), json.size() + 1);
+  *out_json = buf;
+  return 1;
+}
+
+IRIS_FFI_API void iris_engine_reset_stats(IrisEngineHandle handle) {
+  statsOf(handle).reset();
+}
+
+IRIS_FFI_API void iris_engine_trace_start(int max_events) {
+  iris::trace_start(max_events);
+}
+
+IRIS_FFI_API int iris_engine_trace_stop(const char* trace_path_utf8) {
+  return iris::trace_stop(trace_path_utf8) ? 1 : 0;
+}
+
 }  // extern "C"
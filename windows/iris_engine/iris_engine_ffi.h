@@ -7,6 +7,9 @@
  * Memory contract:
  * - Input buffers are read-only; ownership stays with Dart.
  * - Output buffers are allocated by the engine; caller must call iris_engine_free().
+ * - *_into variants write into caller-owned buffers and allocate nothing.
+ * - Borrowed views (iris_engine_borrow_rgba) pin the pixels until
+ *   iris_engine_release_buffer(); the engine never writes to a pinned buffer.
  */
 
 #ifndef IRIS_ENGINE_FFI_H
@@ -44,6 +47,23 @@ IRIS_FFI_API int iris_engine_grayscale(
   int height
 );
 
+/**
+ * Same as iris_engine_grayscale with an explicit row-band thread budget.
+ * num_threads <= 0 uses the engine default (iris_engine_set_default_threads).
+ */
+IRIS_FFI_API int iris_engine_grayscale_mt(
+  uint8_t* rgba,
+  int width,
+  int height,
+  int num_threads
+);
+
+/**
+ * Process-wide default thread budget for every kernel (handles and calls that pass 0).
+ * num_threads <= 0 resets to the hardware thread count. Output is identical at any budget.
+ */
+IRIS_FFI_API void iris_engine_set_default_threads(int num_threads);
+
 /**
  * Create/destroy engine object (for future Phase 2–5).
  */
@@ -60,6 +80,35 @@ IRIS_FFI_API int iris_engine_load_rgba(
   int height
 );
 
+/** Encoded file formats for iris_engine_save_file. AUTO picks from the extension. */
+#define IRIS_FORMAT_AUTO  0
+#define IRIS_FORMAT_PNG   1
+#define IRIS_FORMAT_JPEG  2
+#define IRIS_FORMAT_WEBP  3
+#define IRIS_FORMAT_TIFF  4
+#define IRIS_FORMAT_BMP   5
+
+/**
+ * Decode an image file (UTF-8 path) straight into the handle: EXIF orientation is
+ * applied, alpha kept, 16-bit sources scaled to 8 bits. Returns 1 on success, 0 on failure.
+ */
+IRIS_FFI_API int iris_engine_load_file(IrisEngineHandle handle, const char* image_path_utf8);
+
+/**
+ * Encode the current image to a file (UTF-8 path). format: IRIS_FORMAT_*.
+ * quality: JPEG/WebP 1..100, PNG compression 0..9; -1 = default. JPEG/BMP drop alpha.
+ * Written via a temporary file and renamed. Returns 1 on success, 0 on failure.
+ */
+IRIS_FFI_API int iris_engine_save_file(
+  IrisEngineHandle handle,
+  const char* image_path_utf8,
+  int format,
+  int quality
+);
+
+/** Current image size. Returns 1 on success, 0 if no image is loaded. */
+IRIS_FFI_API int iris_engine_get_size(IrisEngineHandle handle, int32_t* out_width, int32_t* out_height);
+
 /**
  * Write current image to preallocated RGBA buffer.
  * Buffer must be at least width*height*4 bytes.
@@ -72,6 +121,35 @@ IRIS_FFI_API int iris_engine_get_rgba(
   int height
 );
 
+/**
+ * Read-only view of engine-owned pixels. data stays valid until
+ * iris_engine_release_buffer(pin), even if the handle is edited or destroyed meanwhile
+ * (edits detach to a private copy). stride is in bytes.
+ */
+typedef struct IrisBufferView {
+  const uint8_t* data;
+  int32_t width;
+  int32_t height;
+  int32_t stride;
+  void* pin;
+} IrisBufferView;
+
+/**
+ * Lends the handle's current RGBA without copying. Fills *out_view on success; the
+ * caller must pass out_view->pin to iris_engine_release_buffer exactly once.
+ * Returns 1 on success, 0 if no image is loaded.
+ */
+IRIS_FFI_API int iris_engine_borrow_rgba(IrisEngineHandle handle, IrisBufferView* out_view);
+
+/** Releases a pin from iris_engine_borrow_rgba. NULL is a no-op. */
+IRIS_FFI_API void iris_engine_release_buffer(void* pin);
+
+/**
+ * Thread budget for this handle's kernels (cut, flash, effects). 0 = engine default.
+ * Returns 1 on success, 0 on invalid handle.
+ */
+IRIS_FFI_API int iris_engine_set_threads(IrisEngineHandle handle, int num_threads);
+
 /**
  * Free a buffer returned by the engine (for APIs that allocate).
  */
@@ -84,7 +162,46 @@ IRIS_FFI_API void iris_engine_free(void* ptr);
 IRIS_FFI_API int iris_engine_cut_iris(IrisEngineHandle handle);
 
 /**
- * Phase 3: Remove flash/specular (L>threshold mask, dilate, inpaint).
+ * Cut with the handle's circles (detected once, or set by iris_engine_set_circles), the
+ * iris radius scaled by iris_radius_scale. antialias != 0 ramps alpha over one pixel at
+ * both edges. Each cut starts from the alpha before the first cut, so calling it again
+ * replaces the previous cut; only pixels between the old and new edges are rewritten.
+ */
+IRIS_FFI_API int iris_engine_cut_iris_ex(IrisEngineHandle handle, float iris_radius_scale, int antialias);
+
+/** A detected circle in image pixels. confidence 0..1 (0 = guessed, not measured). */
+typedef struct IrisCircle {
+  float center_x;
+  float center_y;
+  float radius;
+  float confidence;
+  int32_t valid;
+} IrisCircle;
+
+/**
+ * Detect iris and pupil on the loaded image without cutting: Hough on a coarse level,
+ * then sub-pixel edge refinement at full resolution. Also becomes the handle's circles
+ * for iris_engine_cut_iris. Returns 1 on success, 0 if nothing was found.
+ */
+IRIS_FFI_API int iris_engine_detect_circles(IrisEngineHandle handle, IrisCircle* out_iris, IrisCircle* out_pupil);
+
+/** Replace the handle's circles (image pixels), e.g. after the user moved them. Returns 1 on success. */
+IRIS_FFI_API int iris_engine_set_circles(IrisEngineHandle handle, const IrisCircle* iris, const IrisCircle* pupil);
+
+/**
+ * Same for an image file (UTF-8 path), decoded through the image cache; the coarse level
+ * is a cached mip. out_width/out_height receive the image size. Returns 1 on success.
+ */
+IRIS_FFI_API int iris_engine_detect_circles_file(
+  const char* image_path_utf8,
+  IrisCircle* out_iris,
+  IrisCircle* out_pupil,
+  int32_t* out_width,
+  int32_t* out_height
+);
+
+/**
+ * Phase 3: Remove flash/specular (L>threshold mask, dilate, inpaint per highlight region).
  * threshold: 0..1 (e.g. 0.95). dilate_px: 2–3.
  */
 IRIS_FFI_API int iris_engine_remove_flash(
@@ -93,6 +210,48 @@ IRIS_FFI_API int iris_engine_remove_flash(
   int dilate_pixels
 );
 
+/** Inpainting backends (IrisFlashOptions.inpaint_method). */
+#define IRIS_INPAINT_TELEA      0
+#define IRIS_INPAINT_NS         1
+#define IRIS_INPAINT_PUSH_PULL  2
+
+/**
+ * Per-call options for iris_engine_remove_flash_ex. Zero-initialize, then set fields.
+ * inpaint_method: IRIS_INPAINT_*; push-pull is linear in the pixel count and suits
+ *   large blooms. inpaint_radius: Telea/NS neighborhood; <= 0 means 3.
+ * search_*: only highlights with search_inner_r <= |p - (search_cx, search_cy)| <=
+ *   search_outer_r (image pixels) are removed; search_outer_r <= 0 = whole frame.
+ */
+typedef struct IrisFlashOptions {
+  int32_t inpaint_method;
+  float inpaint_radius;
+  float search_cx;
+  float search_cy;
+  float search_outer_r;
+  float search_inner_r;
+} IrisFlashOptions;
+
+/** iris_engine_remove_flash with per-call options (options may be NULL). */
+IRIS_FFI_API int iris_engine_remove_flash_ex(
+  IrisEngineHandle handle,
+  float brightness_threshold,
+  int dilate_pixels,
+  const IrisFlashOptions* options
+);
+
+/**
+ * Same as iris_engine_remove_flash, but only highlights inside the annulus
+ * inner_r <= |p - (cx, cy)| <= outer_r (image pixels) are found and inpainted.
+ * outer_r <= 0 searches the whole frame.
+ */
+IRIS_FFI_API int iris_engine_remove_flash_in_annulus(
+  IrisEngineHandle handle,
+  float brightness_threshold,
+  int dilate_pixels,
+  float cx, float cy,
+  float outer_r, float inner_r
+);
+
 /**
  * Phase 4: Apply vibrance, gamma, sharpness, clarity.
  * Slider-style: vibrance/gamma in ~0..2 (1=no change); sharpness/clarity in 0..4.
@@ -105,6 +264,133 @@ IRIS_FFI_API int iris_engine_apply_effects(
   float clarity
 );
 
+/**
+ * Non-destructive edit stack: cut → flash → effects re-rendered over a kept source.
+ * Each stage's output is cached under a hash of its parameters and everything upstream,
+ * so a render reruns only the stages from the first change down (moving a color slider
+ * reruns the effects on the cached post-flash image). Zero-initialize, then set fields.
+ */
+#define IRIS_EDIT_STAGE_CUT      0
+#define IRIS_EDIT_STAGE_FLASH    1
+#define IRIS_EDIT_STAGE_EFFECTS  2
+
+typedef struct IrisEditStack {
+  int32_t cut;                     /* 1 = alpha cut, as iris_engine_cut_iris_ex */
+  float iris_radius_scale;         /* 0 = 1 */
+  int32_t antialias;
+  IrisCircle iris;                 /* both valid = cut with these; else detected once per source */
+  IrisCircle pupil;
+  int32_t flash;                   /* 1 = flash removal, as iris_engine_remove_flash_ex */
+  float flash_threshold;
+  int32_t flash_dilate_pixels;
+  IrisFlashOptions flash_options;
+  int32_t effects;                 /* 1 = color effects, as iris_engine_apply_effects */
+  float vibrance;
+  float gamma;
+  float sharpness;
+  float clarity;
+} IrisEditStack;
+
+typedef struct IrisEditResult {
+  int32_t reused_stage;            /* IRIS_EDIT_STAGE_* the render started from; -1 = the source */
+  int32_t computed_stages;         /* stages run by this render */
+  int64_t cached_bytes;            /* stage outputs kept after eviction, not the source */
+  double render_ms;
+} IrisEditResult;
+
+/**
+ * Renders [stack] into the handle's pixels. The first render after a load takes the
+ * current pixels as the source. out_result may be NULL. Returns 1 on success.
+ */
+IRIS_FFI_API int iris_engine_edit_render(IrisEngineHandle handle, const IrisEditStack* stack,
+                                         IrisEditResult* out_result);
+
+/** Drops the edit source and cached stages; the next render starts from the current pixels. */
+IRIS_FFI_API void iris_engine_edit_reset(IrisEngineHandle handle);
+
+/**
+ * Caps the cached stage outputs of [handle] at [bytes] (0 = 512 MB). Over the budget the
+ * stages that were cheapest to compute are dropped first. The kept source is not counted:
+ * a handle holds up to the budget plus one full-resolution source.
+ */
+IRIS_FFI_API void iris_engine_edit_set_budget(IrisEngineHandle handle, int64_t bytes);
+
+/**
+ * Color preset as adjustColor-style multipliers (1 = no change for the first three).
+ * Compiled once into a 3D LUT; see iris_engine_define_preset_lut.
+ */
+typedef struct IrisColorPreset {
+  float brightness;
+  float contrast;
+  float saturation;
+  float hue_deg;
+} IrisColorPreset;
+
+/**
+ * Compiles [preset] into a lut_size^3 lattice (0 = 33, else 2..65) and stores it on the
+ * handle under [name] (UTF-8), replacing any LUT of that name. Returns 1 on success.
+ */
+IRIS_FFI_API int iris_engine_define_preset_lut(
+  IrisEngineHandle handle,
+  const char* name,
+  const IrisColorPreset* preset,
+  int lut_size
+);
+
+/**
+ * Parses a .cube file (LUT_3D_SIZE 2..65, DOMAIN 0..1) and stores it under [name].
+ * Returns 1 on success, 0 on a missing or malformed file.
+ */
+IRIS_FFI_API int iris_engine_load_cube_lut(
+  IrisEngineHandle handle,
+  const char* name,
+  const char* cube_path_utf8
+);
+
+/** Applies the named LUT to the current image in one pass (alpha kept). Returns 1 on success. */
+IRIS_FFI_API int iris_engine_apply_lut(IrisEngineHandle handle, const char* name);
+
+/** Returns 1 if a LUT named [name] is stored on the handle. */
+IRIS_FFI_API int iris_engine_has_lut(IrisEngineHandle handle, const char* name);
+
+/** Drops every stored LUT. */
+IRIS_FFI_API void iris_engine_clear_luts(IrisEngineHandle handle);
+
+/**
+ * ICC color management, in engines built with LittleCMS. A printer profile for CMYK print
+ * export and soft proofing. Zero-initialize, then set fields.
+ */
+#define IRIS_INTENT_PERCEPTUAL             0
+#define IRIS_INTENT_RELATIVE_COLORIMETRIC  1
+#define IRIS_INTENT_SATURATION             2
+#define IRIS_INTENT_ABSOLUTE_COLORIMETRIC  3
+
+typedef struct IrisColorProfile {
+  const char* cmyk_profile_utf8;        /* printer CMYK profile (.icc / .icm) */
+  const char* source_profile_utf8;      /* RGB profile of the image; NULL = sRGB */
+  int32_t intent;                       /* IRIS_INTENT_* */
+  int32_t no_black_point_compensation;  /* 1 = off; on by default */
+  int32_t simulate_paper;               /* soft proof: 1 = show the paper white */
+} IrisColorProfile;
+
+/** Returns 1 when the engine was built with LittleCMS. */
+IRIS_FFI_API int iris_engine_color_management_available(void);
+
+/**
+ * Soft proof of [profile] (image → printer CMYK → image) as a LUT stored under [name];
+ * apply it with iris_engine_apply_lut or iris_engine_cmd_apply_lut. Transforms and proof
+ * lattices are cached process-wide by profile files, intent and flags, so a repeated
+ * proof skips LittleCMS entirely. Returns 0 without LittleCMS or on a bad profile.
+ */
+IRIS_FFI_API int iris_engine_define_proof_lut(
+  IrisEngineHandle handle,
+  const char* name,
+  const IrisColorProfile* profile
+);
+
+/** Drops the cached ICC transforms and proofs. */
+IRIS_FFI_API void iris_engine_color_purge(void);
+
 /**
  * Returns 1 when OpenCV is linked (always true for required builds).
  */
@@ -145,6 +431,502 @@ IRIS_FFI_API int iris_engine_process_iris_cut_from_view(
   int32_t* out_height
 );
 
+/** Warp sampler kernels (IrisCutOptions.interpolation). 0 = default (bilinear). */
+#define IRIS_INTERP_DEFAULT   0
+#define IRIS_INTERP_NEAREST   1
+#define IRIS_INTERP_BILINEAR  2
+#define IRIS_INTERP_BICUBIC   3
+#define IRIS_INTERP_LANCZOS3  4
+
+/**
+ * Per-call options for the *_ex cut-and-warp entry points. Zero-initialize, then set fields.
+ * num_threads: row-band threads for this call; 0 = engine default.
+ * interpolation: IRIS_INTERP_* (bicubic/Lanczos-3 for print-quality cuts).
+ * preview: non-zero = interactive preview (from_view only). The warp runs on the source
+ *   mip level matching view_w/view_h * preview_pixel_ratio, so the output is smaller
+ *   than a full cut but has identical geometry. Commit with preview = 0.
+ * preview_pixel_ratio: device pixels per view unit; <= 0 means 1.
+ */
+typedef struct IrisCutOptions {
+  int32_t num_threads;
+  int32_t interpolation;
+  int32_t preview;
+  float preview_pixel_ratio;
+} IrisCutOptions;
+
+/**
+ * iris_engine_process_iris_cut with per-call options (options may be NULL).
+ */
+IRIS_FFI_API int iris_engine_process_iris_cut_ex(
+  const char* image_path_utf8,
+  double iris_cx, double iris_cy, double iris_r,
+  double pupil_cx, double pupil_cy, double pupil_r,
+  const IrisCutOptions* options,
+  uint8_t** out_rgba,
+  int32_t* out_width,
+  int32_t* out_height
+);
+
+/**
+ * iris_engine_process_iris_cut_from_view with per-call options (options may be NULL).
+ */
+IRIS_FFI_API int iris_engine_process_iris_cut_from_view_ex(
+  const char* image_path_utf8,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  const IrisCutOptions* options,
+  uint8_t** out_rgba,
+  int32_t* out_width,
+  int32_t* out_height
+);
+
+/**
+ * Cut-and-warp into a caller-owned buffer of out_capacity bytes (no allocation, no free).
+ * out_width/out_height are set whenever the geometry is valid, so calling with
+ * out_rgba = NULL (or too small a buffer) returns 0 but reports the required
+ * size, width * height * 4. options may be NULL.
+ */
+IRIS_FFI_API int iris_engine_process_iris_cut_into(
+  const char* image_path_utf8,
+  double iris_cx, double iris_cy, double iris_r,
+  double pupil_cx, double pupil_cy, double pupil_r,
+  const IrisCutOptions* options,
+  uint8_t* out_rgba,
+  int64_t out_capacity,
+  int32_t* out_width,
+  int32_t* out_height
+);
+
+/** View-space variant of iris_engine_process_iris_cut_into. */
+IRIS_FFI_API int iris_engine_process_iris_cut_from_view_into(
+  const char* image_path_utf8,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  const IrisCutOptions* options,
+  uint8_t* out_rgba,
+  int64_t out_capacity,
+  int32_t* out_width,
+  int32_t* out_height
+);
+
+/**
+ * Print export: writes the image at [width_cm] (0 = keep the pixel width) and [dpi] as
+ * TIFF (resolution tags) or PNG (pHYs). Resampling and encoding are streamed in strips,
+ * so memory stays bounded by the strip size, not the print size. Returns 1 on success.
+ */
+typedef struct IrisPrintOptions {
+  int32_t format;         /* IRIS_FORMAT_TIFF or IRIS_FORMAT_PNG; 0 = from the extension */
+  int32_t interpolation;  /* IRIS_INTERP_*; 0 = bicubic */
+  int32_t drop_alpha;     /* 1 = RGB output; 0 = RGBA */
+  int32_t strip_rows;     /* output rows per strip; 0 = about 4 MB strips */
+  int32_t num_threads;    /* 0 = the handle's budget */
+  IrisColorProfile cmyk;  /* cmyk_profile_utf8 set = CMYK TIFF, composited over white */
+} IrisPrintOptions;
+
+IRIS_FFI_API int iris_engine_export_print(
+  IrisEngineHandle handle,
+  const char* image_path_utf8,
+  int dpi,
+  float width_cm,
+  const IrisPrintOptions* options
+);
+
+/**
+ * Art Studio compositor: places 1–6 cut irises (PNG/TIFF/… with transparency) on a
+ * print canvas of [width_cm] x [height_cm] at [dpi]. Zero-initialize, then set fields.
+ */
+#define IRIS_LAYOUT_SQUARE     0
+#define IRIS_LAYOUT_ROW        1
+#define IRIS_LAYOUT_COLUMN     2
+#define IRIS_LAYOUT_ROUND      3  /* round canvas, width_cm = diameter */
+#define IRIS_LAYOUT_RECTANGLE  4
+
+typedef struct IrisCompositeSpec {
+  int32_t layout;              /* IRIS_LAYOUT_* */
+  float width_cm;
+  float height_cm;             /* 0 = width_cm */
+  int32_t dpi;                 /* 0 = 300 */
+  float gap;                   /* between irises, x their diameter; 0 = 0.1, < 0 = none */
+  float margin;                /* around them, x the short side; 0 = 0.05, < 0 = none */
+  uint8_t background_rgba[4];  /* straight alpha; all 0 = transparent */
+  int32_t interpolation;       /* IRIS_INTERP_*; 0 = bicubic */
+  int32_t num_threads;         /* 0 = the handle's budget */
+} IrisCompositeSpec;
+
+/**
+ * Composes the images at [layer_paths_utf8] (decoded through the source cache, drawn in
+ * order) and loads the result into [target], ready for iris_engine_save_file or
+ * iris_engine_export_print at the same DPI. Returns 1 on success.
+ */
+IRIS_FFI_API int iris_engine_compose(
+  IrisEngineHandle target,
+  const char* const* layer_paths_utf8,
+  int count,
+  const IrisCompositeSpec* spec
+);
+
+/**
+ * Recorded command buffers: record an edit once, run it with one call.
+ * Record calls return 1 on success, 0 on an invalid buffer handle; parameters are
+ * checked at submit, which reports the index of the first failing command.
+ * A buffer can be submitted any number of times, to any handle.
+ */
+typedef void* IrisCommandBufferHandle;
+
+IRIS_FFI_API IrisCommandBufferHandle iris_engine_cmd_create(void);
+IRIS_FFI_API void iris_engine_cmd_destroy(IrisCommandBufferHandle cmd);
+/** Drops all recorded commands. */
+IRIS_FFI_API void iris_engine_cmd_reset(IrisCommandBufferHandle cmd);
+IRIS_FFI_API int iris_engine_cmd_count(IrisCommandBufferHandle cmd);
+
+IRIS_FFI_API int iris_engine_cmd_load_file(IrisCommandBufferHandle cmd, const char* image_path_utf8);
+/** Auto-detected circles (Hough) + alpha cut, as iris_engine_cut_iris. */
+IRIS_FFI_API int iris_engine_cmd_cut_auto(IrisCommandBufferHandle cmd, float iris_radius_scale);
+/** Radial cut-and-warp with image-space circles; the image becomes the cut. options may be NULL. */
+IRIS_FFI_API int iris_engine_cmd_cut_circles(
+  IrisCommandBufferHandle cmd,
+  double iris_cx, double iris_cy, double iris_r, double pupil_r,
+  const IrisCutOptions* options
+);
+/** Radial cut-and-warp with circling-UI params (see iris_engine_process_iris_cut_from_view). */
+IRIS_FFI_API int iris_engine_cmd_cut_from_view(
+  IrisCommandBufferHandle cmd,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  const IrisCutOptions* options
+);
+IRIS_FFI_API int iris_engine_cmd_remove_flash(
+  IrisCommandBufferHandle cmd,
+  float brightness_threshold,
+  int dilate_pixels
+);
+/** iris_engine_cmd_remove_flash with IrisFlashOptions (options may be NULL). */
+IRIS_FFI_API int iris_engine_cmd_remove_flash_ex(
+  IrisCommandBufferHandle cmd,
+  float brightness_threshold,
+  int dilate_pixels,
+  const IrisFlashOptions* options
+);
+IRIS_FFI_API int iris_engine_cmd_apply_effects(
+  IrisCommandBufferHandle cmd,
+  float vibrance,
+  float gamma,
+  float sharpness,
+  float clarity
+);
+/** Applies a LUT stored on the target handle at submit time (iris_engine_define_preset_lut). */
+IRIS_FFI_API int iris_engine_cmd_apply_lut(IrisCommandBufferHandle cmd, const char* name);
+/** Crop to a pixel rectangle (clamped to the image). */
+IRIS_FFI_API int iris_engine_cmd_crop(IrisCommandBufferHandle cmd, int x, int y, int width, int height);
+/** Encode the current image, as iris_engine_save_file. */
+IRIS_FFI_API int iris_engine_cmd_export(
+  IrisCommandBufferHandle cmd,
+  const char* image_path_utf8,
+  int format,
+  int quality
+);
+/** Print export, as iris_engine_export_print (options copied; may be NULL). */
+IRIS_FFI_API int iris_engine_cmd_export_print(
+  IrisCommandBufferHandle cmd,
+  const char* image_path_utf8,
+  int dpi,
+  float width_cm,
+  const IrisPrintOptions* options
+);
+
+/**
+ * Art Studio solo effect around the cut iris; the image becomes a square canvas of
+ * [extent] iris radii. Deterministic per seed. Zero-initialize, then set fields.
+ */
+#define IRIS_SOLO_PURE       0
+#define IRIS_SOLO_HALO       1
+#define IRIS_SOLO_DUST       2
+#define IRIS_SOLO_SUN        3
+#define IRIS_SOLO_EXPLOSION  4
+
+typedef struct IrisSoloEffectParams {
+  int32_t effect;       /* IRIS_SOLO_* */
+  uint32_t seed;        /* Dust particles, Sun rays, Explosion jitter */
+  float extent;         /* canvas half-side in iris radii; 0 = 1.5 */
+  float intensity;      /* 0..2; 0 = 1 */
+  float size;           /* glow width / particle scale / ray or blur length, x radius; 0 = 0.35 */
+  int32_t count;        /* Dust particles or Sun rays; 0 = default */
+  uint8_t color_rgb[3]; /* effect light; all 0 = the effect's default */
+  uint8_t reserved;
+  int32_t max_side;     /* preview: longest output side; 0 = full resolution */
+  int32_t num_threads;  /* 0 = the handle's budget */
+} IrisSoloEffectParams;
+
+IRIS_FFI_API int iris_engine_cmd_solo_effect(IrisCommandBufferHandle cmd, const IrisSoloEffectParams* params);
+
+/**
+ * Art Studio duo effect: the image (first iris) joined with the cut iris in
+ * [second_path_utf8] on a square canvas, both scaled to the larger radius.
+ * Zero-initialize, then set fields; 0 selects the effect's own default.
+ */
+#define IRIS_DUO_FUSION     0
+#define IRIS_DUO_COLLISION  1
+#define IRIS_DUO_BALANCE    2
+#define IRIS_DUO_BINARY     3
+#define IRIS_DUO_ECLIPSE    4
+
+typedef struct IrisDuoEffectParams {
+  int32_t effect;       /* IRIS_DUO_* */
+  float angle_deg;      /* split / collision / eclipse axis; 0 = first iris on the left */
+  float softness;       /* edge feather x radius (Fusion: crossfade width 0..1) */
+  float offset;         /* Collision: centre distance from the split; Eclipse: between centres; x radius */
+  float extent;         /* canvas half-side in radii */
+  int32_t max_side;     /* preview: longest output side; 0 = full resolution */
+  int32_t num_threads;  /* 0 = the handle's budget */
+} IrisDuoEffectParams;
+
+IRIS_FFI_API int iris_engine_cmd_duo_effect(
+  IrisCommandBufferHandle cmd,
+  const char* second_path_utf8,
+  const IrisDuoEffectParams* params
+);
+
+/** Records iris_engine_edit_render, so a kept handle re-renders its stack in a job. */
+IRIS_FFI_API int iris_engine_cmd_edit_render(IrisCommandBufferHandle cmd, const IrisEditStack* stack);
+
+/**
+ * Records iris_engine_compose. It loads the canvas like iris_engine_cmd_load_file, so a
+ * print-size layout is composed in the job rather than on the caller's thread, and an
+ * iris_engine_cmd_export_print after it streams it out. The paths are copied.
+ */
+IRIS_FFI_API int iris_engine_cmd_compose(
+  IrisCommandBufferHandle cmd,
+  const char* const* layer_paths_utf8,
+  int count,
+  const IrisCompositeSpec* spec
+);
+
+/** iris_engine_cmd_validate result for a NULL command buffer. */
+#define IRIS_CMD_INVALID_BUFFER (-2)
+
+/**
+ * Checks the recorded list without running it (handle may be NULL = no image loaded).
+ * Returns -1 when valid, the index of the first bad command (>= 0), or
+ * IRIS_CMD_INVALID_BUFFER when [cmd] is NULL.
+ */
+IRIS_FFI_API int iris_engine_cmd_validate(IrisCommandBufferHandle cmd, IrisEngineHandle handle);
+
+/**
+ * Runs the list on [handle]. Returns 1 when every step succeeded. On failure returns 0
+ * and *out_failed_index (optional) receives the failing command; earlier steps stay applied.
+ */
+IRIS_FFI_API int iris_engine_cmd_submit(
+  IrisCommandBufferHandle cmd,
+  IrisEngineHandle handle,
+  int32_t* out_failed_index
+);
+
+/**
+ * Asynchronous jobs: work runs on engine job threads and the call returns a job id
+ * (> 0; 0 = not submitted). Messages go to a Dart native port (ReceivePort.sendPort
+ * .nativePort) as [job, kind, a, b]: IRIS_JOB_MSG_PROGRESS with a = steps done, b = total,
+ * then one IRIS_JOB_MSG_DONE with a = IRIS_JOB_* status, b = failing command (or -1).
+ *
+ * group (UTF-8, may be NULL) names a supersede group. A new submit cancels the group's
+ * older jobs: queued ones finish at once as cancelled, running ones stop before their
+ * next step and finish as cancelled. A job that had already run its last step reports
+ * IRIS_JOB_SUCCEEDED, since its changes are on the handle; a superseded cut-from-view
+ * preview drops its pixels instead. Jobs on the same handle run one at a time in
+ * submission order. A handle must not be destroyed while one of its jobs is unfinished.
+ */
+typedef int64_t IrisJobId;
+
+#define IRIS_JOB_MSG_PROGRESS 0
+#define IRIS_JOB_MSG_DONE     1
+
+#define IRIS_JOB_UNKNOWN   0
+#define IRIS_JOB_PENDING   1
+#define IRIS_JOB_RUNNING   2
+#define IRIS_JOB_SUCCEEDED 3
+#define IRIS_JOB_FAILED    4
+#define IRIS_JOB_CANCELLED 5
+
+/** Installs Dart's NativeApi.postCObject (once per process). NULL stops messages. Returns 1. */
+IRIS_FFI_API int iris_engine_jobs_init(void* post_cobject);
+
+/** Submits a copy of the recorded list against [handle]; cmd may be reused or destroyed at once. */
+IRIS_FFI_API IrisJobId iris_engine_submit(
+  IrisCommandBufferHandle cmd,
+  IrisEngineHandle handle,
+  int64_t reply_port,
+  const char* group_utf8
+);
+
+/**
+ * Submits iris_engine_process_iris_cut_from_view_ex. Collect the pixels after
+ * IRIS_JOB_SUCCEEDED with iris_engine_job_take_result. options may be NULL.
+ */
+IRIS_FFI_API IrisJobId iris_engine_submit_cut_from_view(
+  const char* image_path_utf8,
+  double view_w, double view_h,
+  double outer_r, double inner_r,
+  double outer_dx, double outer_dy,
+  double inner_dx, double inner_dy,
+  const IrisCutOptions* options,
+  int64_t reply_port,
+  const char* group_utf8
+);
+
+/** Requests cancellation. Returns 1 if the job was queued or running, else 0. */
+IRIS_FFI_API int iris_engine_cancel(IrisJobId job);
+
+/** IRIS_JOB_* status without blocking. */
+IRIS_FFI_API int iris_engine_job_status(IrisJobId job);
+
+/** Blocks until the job is done (for callers without a port). Returns its IRIS_JOB_* status. */
+IRIS_FFI_API int iris_engine_job_wait(IrisJobId job, int32_t* out_failed_index);
+
+/**
+ * Moves a succeeded job's pixels to the caller (free with iris_engine_free).
+ * Returns 1 once per job; 0 if there is no result.
+ */
+IRIS_FFI_API int iris_engine_job_take_result(
+  IrisJobId job,
+  uint8_t** out_rgba,
+  int32_t* out_width,
+  int32_t* out_height
+);
+
+/**
+ * Batches: one recorded edit per image (load, cut/flash/effects, export), run
+ * concurrently. Images are admitted in order while their estimated peak footprint
+ * (from the file header, before decoding) fits a RAM budget. A batch must not be changed
+ * or destroyed while a submitted run is unfinished.
+ */
+typedef void* IrisBatchHandle;
+
+/** Zero-initialize, then set fields; 0 means "engine default" for each. */
+typedef struct IrisBatchOptions {
+  int64_t memory_budget_bytes;  /* 0 = a quarter of physical memory */
+  int32_t max_concurrent;       /* images in flight; 0 = hardware threads */
+  int32_t threads_per_image;    /* kernel threads per image; 0 = cores / images in flight */
+} IrisBatchOptions;
+
+/** Per-image outcome of the last run. Times are wall-clock milliseconds. */
+typedef struct IrisBatchItemResult {
+  int64_t estimated_bytes;  /* footprint charged against the budget */
+  double wait_ms;           /* from the start of the run until admitted */
+  double load_ms;
+  double process_ms;
+  double export_ms;
+  double total_ms;          /* admitted to finished */
+  int32_t ok;
+  int32_t started;          /* 0 when the run was cancelled first */
+  int32_t failed_index;     /* first failing command, or -1 */
+  int32_t width;            /* final image size */
+  int32_t height;
+} IrisBatchItemResult;
+
+IRIS_FFI_API IrisBatchHandle iris_engine_batch_create(void);
+IRIS_FFI_API void iris_engine_batch_destroy(IrisBatchHandle batch);
+
+/** Appends a copy of [cmd] as the next image's edit. Returns its index, or -1. */
+IRIS_FFI_API int iris_engine_batch_add(IrisBatchHandle batch, IrisCommandBufferHandle cmd);
+IRIS_FFI_API int iris_engine_batch_count(IrisBatchHandle batch);
+
+/** Runs every image and blocks until done. options may be NULL. Returns 1 when all succeeded. */
+IRIS_FFI_API int iris_engine_batch_run(IrisBatchHandle batch, const IrisBatchOptions* options);
+
+/**
+ * Runs the batch as a job (see iris_engine_submit). Progress messages count finished
+ * images; cancelling stops admission and the running images' remaining steps.
+ */
+IRIS_FFI_API IrisJobId iris_engine_batch_submit(
+  IrisBatchHandle batch,
+  const IrisBatchOptions* options,
+  int64_t reply_port,
+  const char* group_utf8
+);
+
+/** Copies image [index]'s result of the last finished run. Returns 1 on success. */
+IRIS_FFI_API int iris_engine_batch_get_result(IrisBatchHandle batch, int index, IrisBatchItemResult* out_result);
+
+/**
+ * Decoded-source cache used by the cut-and-warp entry points. Sources are keyed by
+ * path and revalidated against file size + mtime; LRU eviction within the budget.
+ */
+typedef struct IrisCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t bytes_in_use;
+  uint64_t budget_bytes;
+  int32_t entries;
+} IrisCacheStats;
+
+/** Sets the cache budget in bytes (default 512 MB) and evicts down to it. 0 disables caching. */
+IRIS_FFI_API void iris_engine_cache_set_budget(int64_t bytes);
+
+/** Fills *out_stats. Returns 1 on success, 0 if out_stats is NULL. */
+IRIS_FFI_API int iris_engine_cache_get_stats(IrisCacheStats* out_stats);
+
+/** Drops one source (UTF-8 path), or every entry when image_path_utf8 is NULL. */
+IRIS_FFI_API void iris_engine_cache_purge(const char* image_path_utf8);
+
+/**
+ * Instrumentation. Engine stages are timed into the handle they ran for (also through
+ * command buffers, jobs and batches) and into process-wide totals. Handles also count
+ * their image-sized allocations and the peak of the bytes they held.
+ */
+#define IRIS_STAGE_DECODE         0
+#define IRIS_STAGE_COLOR_CONVERT  1
+#define IRIS_STAGE_HOUGH          2
+#define IRIS_STAGE_INPAINT        3
+#define IRIS_STAGE_CLAHE          4
+#define IRIS_STAGE_WARP           5
+#define IRIS_STAGE_COPY_OUT       6
+#define IRIS_STAGE_COUNT          7
+
+typedef struct IrisStageStats {
+  uint64_t calls;
+  uint64_t total_ns;
+  uint64_t max_ns;
+} IrisStageStats;
+
+typedef struct IrisEngineStats {
+  IrisStageStats stages[IRIS_STAGE_COUNT];  /* indexed by IRIS_STAGE_* */
+  uint64_t allocations;                     /* image-sized buffers allocated */
+  uint64_t allocated_bytes;
+  uint64_t resident_bytes;                  /* pixels, alpha and stage buffers held now */
+  uint64_t peak_bytes;                      /* high-water mark of resident_bytes */
+  uint64_t process_working_set_bytes;       /* OS view of the whole process */
+  uint64_t process_peak_working_set_bytes;
+} IrisEngineStats;
+
+/** Stats of [handle], or the process totals when handle is NULL. Returns 1 on success. */
+IRIS_FFI_API int iris_engine_get_stats(IrisEngineHandle handle, IrisEngineStats* out_stats);
+
+/**
+ * The same stats as a JSON object (stage times in ms), NUL-terminated in *out_json;
+ * free it with iris_engine_free. Returns 1 on success.
+ */
+IRIS_FFI_API int iris_engine_get_stats_json(IrisEngineHandle handle, char** out_json);
+
+/** Zeroes the counters of [handle], or of the process when NULL; the peak restarts from now. */
+IRIS_FFI_API void iris_engine_reset_stats(IrisEngineHandle handle);
+
+/**
+ * Records every timed stage of every thread as a Chrome trace event until
+ * iris_engine_trace_stop. Restarting drops an unsaved session. max_events <= 0 = 1M.
+ */
+IRIS_FFI_API void iris_engine_trace_start(int max_events);
+
+/**
+ * Ends the session and writes it to [trace_path_utf8] as Chrome trace-event JSON
+ * (chrome://tracing, Perfetto); NULL discards it. Returns 1 on success.
+ */
+IRIS_FFI_API int iris_engine_trace_stop(const char* trace_path_utf8);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,207 @@
+/**
+ * Iris Engine — Specular flash removal — implementation.
+ */
+
+#include "iris_flash.h"
+#include "iris_inpaint.h"
+#include "iris_thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include <opencv2/imgproc.hpp>
+
+namespace iris {
+
+namespace {
+
+// Beyond this many components the merge pass is skipped for one bounding region.
+constexpr int kMaxRegions = 1024;
+// Fixed-point scale of the linear luminance sums.
+constexpr int kLumaShift = 20;
+
+/** Per-channel linear luminance (sRGB decode * Y weight) in Q20, as OpenCV's RGB2Lab. */
+struct LumaTables {
+  std::array<uint32_t, 256> r, g, b;
+  LumaTables() {
+    const double scale = static_cast<double>(1 << kLumaShift);
+    for (int i = 0; i < 256; ++i) {
+      const double v = i / 255.0;
+      const double lin = v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+      r[i] = static_cast<uint32_t>(std::lround(lin * 0.212671 * scale));
+      g[i] = static_cast<uint32_t>(std::lround(lin * 0.715160 * scale));
+      b[i] = static_cast<uint32_t>(std::lround(lin * 0.072169 * scale));
+    }
+  }
+};
+
+const LumaTables& luma_tables() {
+  static const LumaTables tables;
+  return tables;
+}
+
+/**
+ * Smallest Q20 luminance whose 8-bit L exceeds [threshold] (0..1 of the L range), i.e.
+ * the cut of cv::threshold(L8, threshold * 255, THRESH_BINARY). UINT32_MAX = nothing passes.
+ */
+uint32_t luma_cut(float threshold) {
+  const double t = std::clamp(static_cast<double>(threshold), 0.0, 1.0) * 255.0;
+  const double first_l8 = std::floor(t) + 1.0;  // first passing 8-bit L
+  if (first_l8 > 255.0) return UINT32_MAX;
+  // L8 = round(L * 255 / 100), so L8 >= n  <=>  L >= (n - 0.5) * 100 / 255.
+  const double l = std::max(0.0, (first_l8 - 0.5) * 100.0 / 255.0);
+  const double y = l > 8.0 ? std::pow((l + 16.0) / 116.0, 3.0) : l / 903.3;
+  return static_cast<uint32_t>(std::ceil(y * static_cast<double>(1 << kLumaShift)));
+}
+
+/** Area the threshold runs over: the annulus bounding box, or the whole frame. */
+cv::Rect search_rect(const cv::Mat& rgba, const FlashRemovalParams& params) {
+  const cv::Rect frame(0, 0, rgba.cols, rgba.rows);
+  if (params.search_outer_r <= 0) return frame;
+  const int x0 = static_cast<int>(std::floor(params.search_cx - params.search_outer_r));
+  const int y0 = static_cast<int>(std::floor(params.search_cy - params.search_outer_r));
+  const int x1 = static_cast<int>(std::ceil(params.search_cx + params.search_outer_r)) + 1;
+  const int y1 = static_cast<int>(std::ceil(params.search_cy + params.search_outer_r)) + 1;
+  return cv::Rect(x0, y0, x1 - x0, y1 - y0) & frame;
+}
+
+/** Merges boxes until none overlap (touching is fine: reads and writes stay disjoint). */
+void merge_overlapping(std::vector<cv::Rect>& boxes) {
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      for (size_t j = i + 1; j < boxes.size();) {
+        if ((boxes[i] & boxes[j]).area() > 0) {
+          boxes[i] |= boxes[j];
+          boxes[j] = boxes.back();
+          boxes.pop_back();
+          merged = true;
+        } else {
+          ++j;
+        }
+      }
+    }
+  }
+  // Stable order keeps the work split (and any tie-breaking) reproducible.
+  std::sort(boxes.begin(), boxes.end(), [](const cv::Rect& a, const cv::Rect& b) {
+    return a.y != b.y ? a.y < b.y : a.x < b.x;
+  });
+}
+
+}  // namespace
+
+int flash_threshold_mask(const cv::Mat& rgba, const cv::Rect& rect, const FlashRemovalParams& params,
+                         cv::Mat& mask, int num_threads) {
+  mask.create(rect.height, rect.width, CV_8U);
+  const uint32_t cut = luma_cut(params.brightness_threshold);
+  if (cut == UINT32_MAX || rect.area() <= 0) {
+    mask.setTo(cv::Scalar(0));
+    return 0;
+  }
+  const LumaTables& lt = luma_tables();
+  const bool ring = params.search_outer_r > 0;
+  const double outer2 = static_cast<double>(params.search_outer_r) * params.search_outer_r;
+  const double inner2 = static_cast<double>(std::max(0.0f, params.search_inner_r)) * params.search_inner_r;
+  std::vector<int> band_counts(static_cast<size_t>(rect.height), 0);
+  parallel_for_rows(rect.height, num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) {
+      const uint8_t* s = rgba.ptr<uint8_t>(rect.y + y) + static_cast<size_t>(rect.x) * 4;
+      uint8_t* m = mask.ptr<uint8_t>(y);
+      const double dy = rect.y + y - params.search_cy;
+      int count = 0;
+      for (int x = 0; x < rect.width; ++x, s += 4) {
+        bool hit = lt.r[s[0]] + lt.g[s[1]] + lt.b[s[2]] >= cut;
+        if (hit && ring) {
+          const double dx = rect.x + x - params.search_cx;
+          const double d2 = dx * dx + dy * dy;
+          hit = d2 <= outer2 && d2 >= inner2;
+        }
+        m[x] = hit ? 255 : 0;
+        count += hit;
+      }
+      band_counts[static_cast<size_t>(y)] = count;
+    }
+  });
+  int total = 0;
+  for (int c : band_counts) total += c;
+  return total;
+}
+
+bool find_flash_regions(const cv::Mat& rgba, const FlashRemovalParams& params, FlashRegions& out,
+                        int num_threads) {
+  out.rois.clear();
+  if (rgba.empty() || rgba.type() != CV_8UC4 || params.dilate_pixels < 0) return false;
+  out.search = search_rect(rgba, params);
+  if (flash_threshold_mask(rgba, out.search, params, out.mask, num_threads) == 0) return true;
+
+  cv::Mat labels, stats, centroids;
+  const int n = cv::connectedComponentsWithStats(out.mask, labels, stats, centroids, 8, CV_32S);
+  // Reach of one region: dilation plus the inpainting neighborhood around it.
+  const double radius = params.inpaint_radius > 0 ? params.inpaint_radius : 3.0;
+  const int pad = params.dilate_pixels + static_cast<int>(std::ceil(radius)) + 1;
+  const cv::Rect frame(0, 0, rgba.cols, rgba.rows);
+  std::vector<cv::Rect> boxes;
+  boxes.reserve(static_cast<size_t>(std::max(0, n - 1)));
+  for (int i = 1; i < n; ++i) {  // label 0 is the background
+    const cv::Rect box(out.search.x + stats.at<int>(i, cv::CC_STAT_LEFT) - pad,
+                       out.search.y + stats.at<int>(i, cv::CC_STAT_TOP) - pad,
+                       stats.at<int>(i, cv::CC_STAT_WIDTH) + 2 * pad,
+                       stats.at<int>(i, cv::CC_STAT_HEIGHT) + 2 * pad);
+    boxes.push_back(box & frame);
+  }
+  if (static_cast<int>(boxes.size()) > kMaxRegions) {
+    cv::Rect all = boxes.front();
+    for (const cv::Rect& b : boxes) all |= b;
+    boxes.assign(1, all);
+  }
+  merge_overlapping(boxes);
+  out.rois = std::move(boxes);
+  return true;
+}
+
+void inpaint_flash_regions(cv::Mat& rgba, const FlashRegions& regions, const FlashRemovalParams& params,
+                           int num_threads) {
+  if (regions.rois.empty()) return;
+  cv::Mat kernel;
+  if (params.dilate_pixels > 0) {
+    const int k = (params.dilate_pixels * 2) | 1;
+    kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(k, k));
+  }
+  const int count = static_cast<int>(regions.rois.size());
+  // Regions do not overlap: each reads only its own box and writes only its masked pixels.
+  parallel_for_rows(count, num_threads, [&](int i0, int i1) {
+    for (int i = i0; i < i1; ++i) {
+      const cv::Rect& roi = regions.rois[static_cast<size_t>(i)];
+      cv::Mat local_mask = cv::Mat::zeros(roi.size(), CV_8U);
+      const cv::Rect overlap = roi & regions.search;
+      if (overlap.area() > 0) {
+        cv::Mat dst = local_mask(overlap - roi.tl());
+        regions.mask(overlap - regions.search.tl()).copyTo(dst);
+      }
+      if (!kernel.empty()) cv::dilate(local_mask, local_mask, kernel);
+
+      cv::Mat tile = rgba(roi);
+      cv::Mat bgr, inpainted;
+      cv::cvtColor(tile, bgr, cv::COLOR_RGBA2BGR);
+      // Regions already run in parallel, so each backend gets one thread.
+      if (!inpaint_image(bgr, local_mask, inpainted, params.inpaint_method, params.inpaint_radius, 1)) {
+        continue;
+      }
+      for (int y = 0; y < roi.height; ++y) {
+        const uint8_t* m = local_mask.ptr<uint8_t>(y);
+        const uint8_t* s = inpainted.ptr<uint8_t>(y);
+        uint8_t* d = tile.ptr<uint8_t>(y);
+        for (int x = 0; x < roi.width; ++x) {
+          if (!m[x]) continue;
+          d[x * 4 + 0] = s[x * 3 + 2];
+          d[x * 4 + 1] = s[x * 3 + 1];
+          d[x * 4 + 2] = s[x * 3 + 0];
+        }
+      }
+    }
+  }, 1);
+}
+
+}  // namespace iris
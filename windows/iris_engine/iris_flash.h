@@ -0,0 +1,56 @@
+/**
+ * Iris Engine — Specular flash removal (2026).
+ *
+ * Highlights are found with a brightness threshold on CIE L* over the search area
+ * (the whole frame or the iris annulus). The thresholded mask is split into connected
+ * components. Each component is padded by the dilation and inpainting reach, and
+ * overlapping boxes are merged so that no two regions read each other's output. Each
+ * region is converted to BGR, dilated and inpainted on its own with the backend chosen
+ * in FlashRemovalParams (iris_inpaint.h), and the regions run in parallel. Pixels
+ * outside the dilated mask are never written.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_FLASH_H
+#define IRIS_ENGINE_IRIS_FLASH_H
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "iris_engine.h"
+
+namespace iris {
+
+/** Highlight regions found in one image; independent inpainting jobs. */
+struct FlashRegions {
+  cv::Rect search;              // area the threshold ran over (image coordinates)
+  cv::Mat mask;                 // CV_8U over [search], 255 = above threshold (undilated)
+  std::vector<cv::Rect> rois;   // padded, non-overlapping regions to inpaint
+};
+
+/**
+ * Highlight mask (CV_8U, 255 = above threshold) of [rect] in [rgba] (CV_8UC4).
+ * Matches cv::threshold on OpenCV's 8-bit Lab L without converting to Lab. Pixels
+ * outside the params' search annulus are 0. Returns the number of set pixels.
+ */
+int flash_threshold_mask(const cv::Mat& rgba, const cv::Rect& rect, const FlashRemovalParams& params,
+                         cv::Mat& mask, int num_threads);
+
+/**
+ * Thresholds [rgba] and groups the highlights into padded regions. Read-only, so a
+ * caller can skip detaching its pixels when out.rois comes back empty.
+ * Returns false on invalid input.
+ */
+bool find_flash_regions(const cv::Mat& rgba, const FlashRemovalParams& params, FlashRegions& out,
+                        int num_threads);
+
+/**
+ * Dilates and inpaints every region of [regions] in [rgba] (written in place, alpha
+ * untouched), regions in parallel. num_threads <= 0 uses the default budget.
+ */
+void inpaint_flash_regions(cv::Mat& rgba, const FlashRegions& regions, const FlashRemovalParams& params,
+                           int num_threads);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_FLASH_H
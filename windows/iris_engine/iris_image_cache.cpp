@@ -0,0 +1,197 @@
+/**
+ * Iris Engine — Decoded source cache — implementation.
+ */
+
+#include "iris_image_cache.h"
+#include "iris_codec.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <filesystem>
+#include <iterator>
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace iris {
+
+namespace {
+
+struct FileStamp {
+  uint64_t size = 0;
+  int64_t mtime = 0;
+
+  bool operator==(const FileStamp& o) const { return size == o.size && mtime == o.mtime; }
+};
+
+constexpr int kMinLevelSide = 64;  // stop halving below this
+
+/** Decoded source plus its mip levels; levels[0] is full resolution. */
+struct SourcePyramid {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<const cv::Mat>> levels;
+};
+
+struct CacheEntry {
+  std::string path;
+  FileStamp stamp;
+  std::shared_ptr<SourcePyramid> source;
+  size_t bytes = 0;
+};
+
+std::mutex g_mutex;
+std::list<CacheEntry> g_lru;  // front = most recently used
+std::unordered_map<std::string, std::list<CacheEntry>::iterator> g_index;
+size_t g_budget = DEFAULT_IMAGE_CACHE_BUDGET;
+size_t g_bytes = 0;
+uint64_t g_hits = 0, g_misses = 0, g_evictions = 0;
+
+bool stat_file(const char* path, FileStamp& out) {
+  std::error_code ec;
+  const std::filesystem::path p(reinterpret_cast<const char8_t*>(path));
+  const auto size = std::filesystem::file_size(p, ec);
+  if (ec) return false;
+  const auto mtime = std::filesystem::last_write_time(p, ec);
+  if (ec) return false;
+  out.size = static_cast<uint64_t>(size);
+  out.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+  return true;
+}
+
+size_t mat_bytes(const cv::Mat& m) {
+  return m.total() * m.elemSize();
+}
+
+std::shared_ptr<const cv::Mat> decode_rgba(const char* path) {
+  auto rgba = std::make_shared<cv::Mat>();
+  if (!decode_image_file(path, *rgba)) return nullptr;
+  return rgba;
+}
+
+/** Caller holds g_mutex. */
+void erase_entry(std::list<CacheEntry>::iterator it) {
+  g_bytes -= it->bytes;
+  g_index.erase(it->path);
+  g_lru.erase(it);
+}
+
+/** Caller holds g_mutex. */
+void evict_to(size_t budget) {
+  while (g_bytes > budget && !g_lru.empty()) {
+    erase_entry(std::prev(g_lru.end()));
+    ++g_evictions;
+  }
+}
+
+/** Cached (or, when uncacheable, private) pyramid holding level 0 of [path]. */
+std::shared_ptr<SourcePyramid> acquire_source(const char* path) {
+  FileStamp stamp;
+  const bool have_stamp = stat_file(path, stamp);
+  const std::string key(path);
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto found = g_index.find(key);
+    if (found != g_index.end()) {
+      if (have_stamp && found->second->stamp == stamp) {
+        ++g_hits;
+        g_lru.splice(g_lru.begin(), g_lru, found->second);
+        return found->second->source;
+      }
+      erase_entry(found->second);  // file changed on disk
+    }
+    ++g_misses;
+  }
+
+  // Decode outside the lock; concurrent misses on one path may decode twice.
+  std::shared_ptr<const cv::Mat> rgba = decode_rgba(path);
+  if (!rgba) return nullptr;
+  auto source = std::make_shared<SourcePyramid>();
+  source->levels.push_back(rgba);
+  if (!have_stamp) return source;
+
+  const size_t bytes = mat_bytes(*rgba);
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (bytes > g_budget) return source;
+  auto found = g_index.find(key);
+  if (found != g_index.end()) erase_entry(found->second);
+  g_lru.push_front(CacheEntry{key, stamp, source, bytes});
+  g_index[key] = g_lru.begin();
+  g_bytes += bytes;
+  evict_to(g_budget);
+  return source;
+}
+
+/** Charges a newly built level to the entry that owns [source], if still cached. */
+void account_level(const std::string& key, const SourcePyramid* source, size_t bytes) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  auto found = g_index.find(key);
+  if (found == g_index.end() || found->second->source.get() != source) return;
+  found->second->bytes += bytes;
+  g_bytes += bytes;
+  evict_to(g_budget);
+}
+
+}  // namespace
+
+std::shared_ptr<const cv::Mat> load_rgba_cached(const char* path) {
+  if (!path) return nullptr;
+  std::shared_ptr<SourcePyramid> source = acquire_source(path);
+  if (!source) return nullptr;
+  std::lock_guard<std::mutex> lock(source->mutex);
+  return source->levels.front();
+}
+
+std::shared_ptr<const cv::Mat> load_rgba_level_cached(const char* path, int level, int* out_level) {
+  if (!path) return nullptr;
+  std::shared_ptr<SourcePyramid> source = acquire_source(path);
+  if (!source) return nullptr;
+  std::lock_guard<std::mutex> lock(source->mutex);
+  auto& levels = source->levels;
+  while (static_cast<int>(levels.size()) <= level) {
+    const cv::Mat& prev = *levels.back();
+    if (prev.cols / 2 < kMinLevelSide || prev.rows / 2 < kMinLevelSide) break;
+    auto next = std::make_shared<cv::Mat>();
+    // fx = fy = 0.5 keeps OpenCV on the exact 2x2 box path.
+    cv::resize(prev, *next, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+    levels.push_back(next);
+    account_level(path, source.get(), mat_bytes(*next));
+  }
+  const int got = std::min(level, static_cast<int>(levels.size()) - 1);
+  if (out_level) *out_level = got;
+  return levels[got];
+}
+
+void set_image_cache_budget(size_t bytes) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_budget = bytes;
+  evict_to(g_budget);
+}
+
+ImageCacheStats image_cache_stats() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  ImageCacheStats s;
+  s.hits = g_hits;
+  s.misses = g_misses;
+  s.evictions = g_evictions;
+  s.bytes_in_use = g_bytes;
+  s.budget_bytes = g_budget;
+  s.entries = static_cast<uint32_t>(g_lru.size());
+  return s;
+}
+
+void purge_image_cache(const char* path) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (!path) {
+    g_lru.clear();
+    g_index.clear();
+    g_bytes = 0;
+    return;
+  }
+  auto found = g_index.find(path);
+  if (found != g_index.end()) erase_entry(found->second);
+}
+
+}  // namespace iris
@@ -0,0 +1,57 @@
+/**
+ * Iris Engine — Process-wide decoded source cache (2026).
+ *
+ * Keeps decoded RGBA sources in memory so repeated cuts on the same photo skip
+ * imread + color conversion. Entries are keyed by path and validated against the
+ * file's size and modification time; eviction is LRU within a byte budget.
+ * Each entry also holds a lazily built mip pyramid for interactive previews.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_IMAGE_CACHE_H
+#define IRIS_ENGINE_IRIS_IMAGE_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include <opencv2/core.hpp>
+
+namespace iris {
+
+constexpr size_t DEFAULT_IMAGE_CACHE_BUDGET = size_t(512) << 20;  // 512 MB
+
+struct ImageCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t bytes_in_use;
+  uint64_t budget_bytes;
+  uint32_t entries;
+};
+
+/**
+ * Decoded CV_8UC4 RGBA for [path] (UTF-8), from cache when the file is unchanged.
+ * The returned image is shared and must not be modified. nullptr if decode fails.
+ * Images larger than the budget are returned but not cached.
+ */
+std::shared_ptr<const cv::Mat> load_rgba_cached(const char* path);
+
+/**
+ * Mip level of [path]: level 0 is full resolution and each level halves both axes with
+ * an exact 2x box filter, so continuous coordinates scale by exactly 0.5 per level.
+ * Levels are built on demand, cached with the source and count toward the budget.
+ * Returns the deepest available level <= [level]; *out_level receives its index.
+ */
+std::shared_ptr<const cv::Mat> load_rgba_level_cached(const char* path, int level, int* out_level);
+
+/** Sets the byte budget and evicts down to it. 0 disables caching. */
+void set_image_cache_budget(size_t bytes);
+
+ImageCacheStats image_cache_stats();
+
+/** Drops [path] from the cache, or every entry when path is null. */
+void purge_image_cache(const char* path);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_IMAGE_CACHE_H
@@ -0,0 +1,224 @@
+/**
+ * Iris Engine — Inpainting backends — implementation.
+ */
+
+#include "iris_inpaint.h"
+#include "iris_thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <opencv2/photo.hpp>
+
+namespace iris {
+
+namespace {
+
+/** One pyramid level: per pixel [channels] premultiplied values, then the weight. */
+struct PyramidLevel {
+  int width = 0;
+  int height = 0;
+  int stride = 0;  // floats per pixel (channels + 1)
+  std::vector<float> data;
+
+  float* at(int x, int y) {
+    return data.data() + (static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x)) *
+                             static_cast<size_t>(stride);
+  }
+  const float* at(int x, int y) const { return const_cast<PyramidLevel*>(this)->at(x, y); }
+};
+
+/** Clamps a summed cell to weight <= 1, keeping its premultiplied color consistent. */
+inline bool clamp_cell(float* acc, int channels) {
+  const float w = acc[channels];
+  if (w > 1.0f) {
+    const float inv = 1.0f / w;
+    for (int k = 0; k < channels; ++k) acc[k] *= inv;
+    acc[channels] = 1.0f;
+  }
+  return acc[channels] >= 1.0f;
+}
+
+/** First coarse level, summed straight from the 8-bit source (known = mask is zero). */
+bool pull_from_source(const cv::Mat& src, const cv::Mat& mask, PyramidLevel& out, int num_threads) {
+  const int channels = src.channels();
+  out.width = (src.cols + 1) / 2;
+  out.height = (src.rows + 1) / 2;
+  out.stride = channels + 1;
+  out.data.assign(static_cast<size_t>(out.width) * static_cast<size_t>(out.height) * out.stride, 0.0f);
+  std::vector<char> full(static_cast<size_t>(out.height), 1);
+  parallel_for_rows(out.height, num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) {
+      bool row_full = true;
+      for (int x = 0; x < out.width; ++x) {
+        float* acc = out.at(x, y);
+        for (int sy = 2 * y; sy < std::min(2 * y + 2, src.rows); ++sy) {
+          const uint8_t* s = src.ptr<uint8_t>(sy);
+          const uint8_t* m = mask.ptr<uint8_t>(sy);
+          for (int sx = 2 * x; sx < std::min(2 * x + 2, src.cols); ++sx) {
+            if (m[sx]) continue;
+            for (int k = 0; k < channels; ++k) acc[k] += s[sx * channels + k];
+            acc[channels] += 1.0f;
+          }
+        }
+        row_full &= clamp_cell(acc, channels);
+      }
+      full[static_cast<size_t>(y)] = row_full;
+    }
+  });
+  return std::all_of(full.begin(), full.end(), [](char f) { return f != 0; });
+}
+
+/** Next coarser level by 2x2 sums of [fine]. Returns true when every cell is covered. */
+bool pull_level(const PyramidLevel& fine, PyramidLevel& out, int num_threads) {
+  const int channels = fine.stride - 1;
+  out.width = (fine.width + 1) / 2;
+  out.height = (fine.height + 1) / 2;
+  out.stride = fine.stride;
+  out.data.assign(static_cast<size_t>(out.width) * static_cast<size_t>(out.height) * out.stride, 0.0f);
+  std::vector<char> full(static_cast<size_t>(out.height), 1);
+  parallel_for_rows(out.height, num_threads, [&](int y0, int y1) {
+    for (int y = y0; y < y1; ++y) {
+      bool row_full = true;
+      for (int x = 0; x < out.width; ++x) {
+        float* acc = out.at(x, y);
+        for (int fy = 2 * y; fy < std::min(2 * y + 2, fine.height); ++fy) {
+          for (int fx = 2 * x; fx < std::min(2 * x + 2, fine.width); ++fx) {
+            const float* f = fine.at(fx, fy);
+            for (int k = 0; k <= channels; ++k) acc[k] += f[k];
+          }
+        }
+        row_full &= clamp_cell(acc, channels);
+      }
+      full[static_cast<size_t>(y)] = row_full;
+    }
+  });
+  return std::all_of(full.begin(), full.end(), [](char f) { return f != 0; });
+}
+
+/** Bilinear sample of a fully covered [coarse] level at fine pixel (x, y). */
+inline void sample_up(const PyramidLevel& coarse, int x, int y, float* out) {
+  const int channels = coarse.stride - 1;
+  const float u = std::clamp(0.5f * static_cast<float>(x) - 0.25f, 0.0f, static_cast<float>(coarse.width - 1));
+  const float v = std::clamp(0.5f * static_cast<float>(y) - 0.25f, 0.0f, static_cast<float>(coarse.height - 1));
+  const int u0 = static_cast<int>(u), v0 = static_cast<int>(v);
+  const int u1 = std::min(u0 + 1, coarse.width - 1), v1 = std::min(v0 + 1, coarse.height - 1);
+  const float fu = u - static_cast<float>(u0), fv = v - static_cast<float>(v0);
+  const float* p00 = coarse.at(u0, v0);
+  const float* p10 = coarse.at(u1, v0);
+  const float* p01 = coarse.at(u0, v1);
+  const float* p11 = coarse.at(u1, v1);
+  for (int k = 0; k < channels; ++k) {
+    const float top = p00[k] + (p10[k] - p00[k]) * fu;
+    const float bottom = p01[k] + (p11[k] - p01[k]) * fu;
+    out[k] = top + (bottom - top) * fv;
+  }
+}
+
+/** Fills the partly covered cells of [fine] from [coarse]; afterwards every weight is 1. */
+void push_level(const PyramidLevel& coarse, PyramidLevel& fine, int num_threads) {
+  const int channels = fine.stride - 1;
+  parallel_for_rows(fine.height, num_threads, [&](int y0, int y1) {
+    float up[4];
+    for (int y = y0; y < y1; ++y) {
+      for (int x = 0; x < fine.width; ++x) {
+        float* f = fine.at(x, y);
+        const float missing = 1.0f - f[channels];
+        if (missing <= 0.0f) continue;
+        sample_up(coarse, x, y, up);
+        for (int k = 0; k < channels; ++k) f[k] += missing * up[k];
+        f[channels] = 1.0f;
+      }
+    }
+  });
+}
+
+}  // namespace
+
+InpaintMethod inpaint_method_from_int(int value) {
+  switch (value) {
+    case static_cast<int>(InpaintMethod::kNavierStokes):
+      return InpaintMethod::kNavierStokes;
+    case static_cast<int>(InpaintMethod::kPushPull):
+      return InpaintMethod::kPushPull;
+    default:
+      return InpaintMethod::kTelea;
+  }
+}
+
+bool inpaint_push_pull(const cv::Mat& src, const cv::Mat& mask, cv::Mat& dst, int num_threads) {
+  if (src.empty() || src.depth() != CV_8U || src.channels() > 4 || mask.type() != CV_8U ||
+      mask.size() != src.size()) {
+    return false;
+  }
+  const int channels = src.channels();
+  // Pull: halve until a level is fully covered (or 1 x 1). Level i here is 2^(i+1) smaller.
+  std::vector<PyramidLevel> levels(1);
+  bool covered = pull_from_source(src, mask, levels[0], num_threads);
+  while (!covered && (levels.back().width > 1 || levels.back().height > 1)) {
+    PyramidLevel next;
+    covered = pull_level(levels.back(), next, num_threads);
+    levels.push_back(std::move(next));
+  }
+  // Normalize the top; an empty top means there is nothing to fill from.
+  PyramidLevel& top = levels.back();
+  for (int y = 0; y < top.height; ++y) {
+    for (int x = 0; x < top.width; ++x) {
+      float* c = top.at(x, y);
+      if (c[channels] <= 0.0f) return false;
+      const float inv = 1.0f / c[channels];
+      for (int k = 0; k < channels; ++k) c[k] *= inv;
+      c[channels] = 1.0f;
+    }
+  }
+  // Push back down to the first coarse level, then into the masked source pixels.
+  for (size_t i = levels.size() - 1; i > 0; --i) push_level(levels[i], levels[i - 1], num_threads);
+
+  src.copyTo(dst);
+  const PyramidLevel& base = levels[0];
+  parallel_for_rows(src.rows, num_threads, [&](int y0, int y1) {
+    float up[4];
+    for (int y = y0; y < y1; ++y) {
+      const uint8_t* m = mask.ptr<uint8_t>(y);
+      uint8_t* d = dst.ptr<uint8_t>(y);
+      for (int x = 0; x < src.cols; ++x) {
+        if (!m[x]) continue;
+        sample_up(base, x, y, up);
+        for (int k = 0; k < channels; ++k) d[x * channels + k] = cv::saturate_cast<uint8_t>(up[k]);
+      }
+    }
+  });
+  return true;
+}
+
+bool inpaint_image(const cv::Mat& src, const cv::Mat& mask, cv::Mat& dst, InpaintMethod method,
+                   double radius, int num_threads) {
+  if (src.empty() || src.depth() != CV_8U || mask.type() != CV_8U || mask.size() != src.size()) {
+    return false;
+  }
+  if (method == InpaintMethod::kPushPull) return inpaint_push_pull(src, mask, dst, num_threads);
+
+  // cv::inpaint takes 1 or 3 channels: a 4-channel source is filled as its first three
+  // channels, and its alpha is kept as is.
+  const int channels = src.channels();
+  if (channels != 1 && channels != 3 && channels != 4) return false;
+  const int flags = method == InpaintMethod::kNavierStokes ? cv::INPAINT_NS : cv::INPAINT_TELEA;
+  const double r = radius > 0 ? radius : 3.0;
+  if (channels != 4) {
+    cv::inpaint(src, mask, dst, r, flags);
+    return true;
+  }
+  cv::Mat color(src.size(), CV_8UC3);
+  cv::Mat alpha(src.size(), CV_8UC1);
+  cv::Mat split_out[] = {color, alpha};
+  const int split_from_to[] = {0, 0, 1, 1, 2, 2, 3, 3};
+  cv::mixChannels(&src, 1, split_out, 2, split_from_to, 4);
+  cv::Mat filled;
+  cv::inpaint(color, mask, filled, r, flags);
+  dst.create(src.size(), src.type());
+  const cv::Mat merge_in[] = {filled, alpha};
+  cv::mixChannels(merge_in, 2, &dst, 1, split_from_to, 4);
+  return true;
+}
+
+}  // namespace iris
@@ -0,0 +1,40 @@
+/**
+ * Iris Engine — Inpainting backends (2026).
+ *
+ * One entry point for the flash stage. Telea and Navier-Stokes are OpenCV's
+ * cv::inpaint. Push-pull is a pyramid fill. Known pixels are pulled down a 2x pyramid
+ * with normalized 2x2 sums until every level is covered. Holes are then pushed back up
+ * with bilinear interpolation. Its runtime is linear in the pixel count and independent
+ * of the hole size, so it stays fast and smooth on large flash blooms where Telea
+ * slows down and smears.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_INPAINT_H
+#define IRIS_ENGINE_IRIS_INPAINT_H
+
+#include <opencv2/core.hpp>
+
+#include "iris_engine.h"
+
+namespace iris {
+
+/** Maps FFI values to InpaintMethod; unknown values become kTelea. */
+InpaintMethod inpaint_method_from_int(int value);
+
+/**
+ * Fills the pixels of [src] where [mask] (CV_8U, same size) is non-zero. [dst] gets the
+ * size and type of [src]; unmasked pixels are copied as is. Push-pull takes CV_8UC1..
+ * CV_8UC4. Telea / Navier-Stokes take CV_8UC1, CV_8UC3 or CV_8UC4; for CV_8UC4 the
+ * first three channels are filled and alpha is passed through. [radius] is the
+ * neighborhood of Telea / Navier-Stokes. num_threads <= 0 uses the default budget
+ * (push-pull only). Returns false on invalid input (including CV_8UC2 for Telea / NS).
+ */
+bool inpaint_image(const cv::Mat& src, const cv::Mat& mask, cv::Mat& dst, InpaintMethod method,
+                   double radius, int num_threads = 0);
+
+/** Push-pull fill (see above); same contract as inpaint_image. */
+bool inpaint_push_pull(const cv::Mat& src, const cv::Mat& mask, cv::Mat& dst, int num_threads = 0);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_INPAINT_H
@@ -0,0 +1,304 @@
+/**
+ * Iris Engine — Asynchronous jobs — implementation.
+ */
+
+#include "iris_jobs.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace iris {
+
+namespace {
+
+// Jobs are coarse (a whole edit or a preview render) and parallelize internally, so a
+// couple of threads keep one long export from blocking an interactive preview.
+constexpr int kJobThreads = 2;
+// Finished jobs kept for status queries and result pickup; older untaken results are freed.
+constexpr size_t kMaxFinishedJobs = 256;
+
+/**
+ * Layout-compatible subset of Dart_CObject (dart_native_api.h). Only int64 and arrays of
+ * int64 are posted, and the VM copies the message before PostCObject returns. The union
+ * is padded to the size of the largest Dart member.
+ */
+struct DartCObject {
+  int32_t type;
+  union {
+    int64_t as_int64;
+    struct {
+      intptr_t length;
+      DartCObject** values;
+    } as_array;
+    uint8_t reserved[5 * sizeof(void*)];
+  } value;
+};
+constexpr int32_t kDartCObjectInt64 = 3;
+constexpr int32_t kDartCObjectArray = 6;
+using PostCObjectFn = bool (*)(int64_t port, DartCObject* message);
+
+std::atomic<PostCObjectFn> g_post{nullptr};
+
+void post_message(int64_t port, JobId id, int kind, int64_t a, int64_t b) {
+  const PostCObjectFn post = g_post.load();
+  if (!post || port == 0) return;
+  DartCObject items[4];
+  DartCObject* values[4];
+  const int64_t fields[4] = {id, kind, a, b};
+  for (int i = 0; i < 4; ++i) {
+    items[i].type = kDartCObjectInt64;
+    items[i].value.as_int64 = fields[i];
+    values[i] = &items[i];
+  }
+  DartCObject message;
+  message.type = kDartCObjectArray;
+  message.value.as_array.length = 4;
+  message.value.as_array.values = values;
+  post(port, &message);
+}
+
+struct Job {
+  JobId id = 0;
+  JobFn work;
+  JobOptions options;
+  std::atomic<bool> cancel{false};
+  JobStatus status = JobStatus::kPending;
+  JobResult result;
+};
+
+class JobSystem {
+ public:
+  JobId submit(JobFn work, const JobOptions& options) {
+    if (!work) return 0;
+    auto job = std::make_shared<Job>();
+    job->work = std::move(work);
+    job->options = options;
+    std::vector<std::shared_ptr<Job>> dropped;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      start_threads();
+      job->id = ++next_id_;
+      if (!options.group.empty()) supersede(options.group, dropped);
+      jobs_[job->id] = job;
+      pending_.push_back(job);
+    }
+    for (const auto& d : dropped) post_cancelled(*d);
+    wake_.notify_one();
+    return job->id;
+  }
+
+  bool cancel(JobId id) {
+    std::shared_ptr<Job> dropped;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = jobs_.find(id);
+      if (it == jobs_.end()) return false;
+      Job& job = *it->second;
+      if (job.status == JobStatus::kRunning) {
+        job.cancel.store(true);
+        return true;
+      }
+      if (job.status != JobStatus::kPending) return false;
+      dropped = it->second;
+      drop_pending(dropped);
+    }
+    post_cancelled(*dropped);
+    return true;
+  }
+
+  JobStatus status(JobId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    return it == jobs_.end() ? JobStatus::kUnknown : it->second->status;
+  }
+
+  JobStatus wait(JobId id, int* detail) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) return JobStatus::kUnknown;
+    const std::shared_ptr<Job> job = it->second;  // survives eviction while we wait
+    finished_cv_.wait(lock, [&] { return is_final(job->status); });
+    if (detail) *detail = job->result.detail;
+    return job->status;
+  }
+
+  bool take_result(JobId id, uint8_t** rgba, int* width, int* height) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) return false;
+    Job& job = *it->second;
+    if (job.status != JobStatus::kSucceeded || !job.result.rgba) return false;
+    *rgba = job.result.rgba;
+    *width = job.result.width;
+    *height = job.result.height;
+    job.result.rgba = nullptr;
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable finished_cv_;
+  std::vector<std::thread> threads_;
+  std::deque<std::shared_ptr<Job>> pending_;
+  std::unordered_map<JobId, std::shared_ptr<Job>> jobs_;
+  std::deque<JobId> finished_order_;
+  std::unordered_set<const void*> busy_;
+  JobId next_id_ = 0;
+
+  static void post_cancelled(const Job& job) {
+    post_message(job.options.reply_port, job.id, kJobMessageDone, static_cast<int>(JobStatus::kCancelled),
+                 -1);
+  }
+
+  static bool is_final(JobStatus s) {
+    return s == JobStatus::kSucceeded || s == JobStatus::kFailed || s == JobStatus::kCancelled;
+  }
+
+  void start_threads() {
+    if (!threads_.empty()) return;
+    // Detached like the engine pool: never joined from static destructors.
+    for (int i = 0; i < kJobThreads; ++i) {
+      threads_.emplace_back([this] { worker_loop(); });
+      threads_.back().detach();
+    }
+  }
+
+  /** Cancels the group's older jobs; queued ones are returned for their final message. */
+  void supersede(const std::string& group, std::vector<std::shared_ptr<Job>>& dropped) {
+    for (auto it = pending_.begin(); it != pending_.end();) {
+      if ((*it)->options.group == group) {
+        dropped.push_back(*it);
+        it = pending_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (const auto& d : dropped) finish_locked(*d, JobStatus::kCancelled);
+    for (auto& entry : jobs_) {
+      Job& job = *entry.second;
+      if (job.status == JobStatus::kRunning && job.options.group == group) job.cancel.store(true);
+    }
+  }
+
+  void drop_pending(const std::shared_ptr<Job>& job) {
+    pending_.erase(std::remove(pending_.begin(), pending_.end(), job), pending_.end());
+    finish_locked(*job, JobStatus::kCancelled);
+  }
+
+  void finish_locked(Job& job, JobStatus status) {
+    job.status = status;
+    job.work = nullptr;
+    if (status != JobStatus::kSucceeded && job.result.rgba) {
+      std::free(job.result.rgba);
+      job.result.rgba = nullptr;
+    }
+    finished_order_.push_back(job.id);
+    while (finished_order_.size() > kMaxFinishedJobs) {
+      auto old = jobs_.find(finished_order_.front());
+      finished_order_.pop_front();
+      if (old == jobs_.end()) continue;
+      std::free(old->second->result.rgba);
+      old->second->result.rgba = nullptr;
+      jobs_.erase(old);
+    }
+    finished_cv_.notify_all();
+  }
+
+  /** First queued job whose exclusive key is free, in submission order. */
+  std::shared_ptr<Job> next_runnable() {
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+      const void* key = (*it)->options.exclusive;
+      if (key && busy_.count(key)) continue;
+      std::shared_ptr<Job> job = *it;
+      pending_.erase(it);
+      if (key) busy_.insert(key);
+      job->status = JobStatus::kRunning;
+      return job;
+    }
+    return nullptr;
+  }
+
+  void worker_loop() {
+    for (;;) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&] { return (job = next_runnable()) != nullptr; });
+      }
+      const int64_t port = job->options.reply_port;
+      const JobId id = job->id;
+      JobResult result;
+      if (job->cancel.load()) {
+        result.cancelled = true;  // superseded before it started
+      } else {
+        const JobContext context(id, job->cancel, [port, id](int done, int total) {
+          post_message(port, id, kJobMessageProgress, done, total);
+        });
+        try {
+          job->work(context, result);
+        } catch (...) {
+          // A failed allocation or OpenCV error must not reach std::terminate on a job
+          // thread: the job fails, its key is released and the done message is posted.
+          result.ok = false;
+          result.cancelled = false;
+        }
+      }
+      // The status follows what the work did: a job superseded after its last step
+      // succeeded, and its changes stay.
+      const JobStatus status = result.cancelled ? JobStatus::kCancelled
+                               : result.ok      ? JobStatus::kSucceeded
+                                                : JobStatus::kFailed;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (job->options.exclusive) busy_.erase(job->options.exclusive);
+        job->result = result;
+        finish_locked(*job, status);
+      }
+      post_message(port, id, kJobMessageDone, static_cast<int>(status), result.detail);
+      // A freed exclusive key may unblock a queued job on another thread.
+      wake_.notify_all();
+    }
+  }
+};
+
+JobSystem& job_system() {
+  static JobSystem* system = new JobSystem();  // never destroyed, see start_threads
+  return *system;
+}
+
+}  // namespace
+
+void set_job_message_poster(void* post_cobject) {
+  g_post.store(reinterpret_cast<PostCObjectFn>(post_cobject));
+}
+
+JobId submit_job(JobFn work, const JobOptions& options) {
+  return job_system().submit(std::move(work), options);
+}
+
+bool cancel_job(JobId id) {
+  return job_system().cancel(id);
+}
+
+JobStatus job_status(JobId id) {
+  return job_system().status(id);
+}
+
+JobStatus wait_job(JobId id, int* detail) {
+  return job_system().wait(id, detail);
+}
+
+bool take_job_result(JobId id, uint8_t** rgba, int* width, int* height) {
+  if (!rgba || !width || !height) return false;
+  return job_system().take_result(id, rgba, width, height);
+}
+
+}  // namespace iris
@@ -0,0 +1,106 @@
+/**
+ * Iris Engine — Asynchronous jobs (2026).
+ *
+ * Long engine calls run as jobs on a few engine-owned job threads instead of the
+ * caller's thread. Their kernels still fan out on the engine pool. A submit returns a
+ * job id at once. Progress and completion are posted to a Dart native port as small
+ * integer arrays (Dart_PostCObject, passed in as NativeApi.postCObject), so the Flutter
+ * UI isolate never blocks on the engine.
+ *
+ * Jobs may name a group. Submitting into a group supersedes the group's older jobs:
+ * queued ones are dropped and running ones are cancelled. A burst of slider values
+ * therefore renders only the newest one. Cancellation is cooperative. Work polls the
+ * flag between steps and sets JobResult::cancelled when it stopped early. Work that
+ * completed every step reports its own outcome even if superseded meanwhile, because
+ * its effects (e.g. on a handle's pixels) are real. Work without side effects may drop
+ * a stale result by reporting cancelled.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_JOBS_H
+#define IRIS_ENGINE_IRIS_JOBS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace iris {
+
+using JobId = int64_t;
+
+enum class JobStatus : int {
+  kUnknown = 0,  // never submitted, or forgotten (finished long ago)
+  kPending,
+  kRunning,
+  kSucceeded,
+  kFailed,
+  kCancelled,
+};
+
+/** What a job hands back. [rgba] is malloc'd; the job owns it until it is taken. */
+struct JobResult {
+  bool ok = false;
+  bool cancelled = false;  // stopped early on the cancel flag (status kCancelled)
+  int detail = -1;         // job-defined, e.g. the index of the failing command
+  uint8_t* rgba = nullptr;
+  int width = 0;
+  int height = 0;
+};
+
+/** Passed to running work: the cancel flag to poll and a progress reporter. */
+class JobContext {
+ public:
+  JobContext(JobId id, const std::atomic<bool>& cancel, std::function<void(int, int)> progress)
+      : id_(id), cancel_(cancel), progress_(std::move(progress)) {}
+
+  JobId id() const { return id_; }
+  bool cancelled() const { return cancel_.load(std::memory_order_relaxed); }
+  const std::atomic<bool>& cancel_flag() const { return cancel_; }
+  /** Posts [done] of [total] steps to the job's port (if any). */
+  void progress(int done, int total) const {
+    if (progress_) progress_(done, total);
+  }
+
+ private:
+  JobId id_;
+  const std::atomic<bool>& cancel_;
+  std::function<void(int, int)> progress_;
+};
+
+/** Job work. An exception it throws (cv::Exception, std::bad_alloc) fails the job. */
+using JobFn = std::function<void(const JobContext& context, JobResult& result)>;
+
+struct JobOptions {
+  int64_t reply_port = 0;            // Dart native port for messages; 0 = none
+  std::string group;                 // supersede key; empty = none
+  const void* exclusive = nullptr;   // jobs with the same key run one at a time, in order
+};
+
+/** Message kinds posted as [job_id, kind, a, b] (all integers). */
+constexpr int kJobMessageProgress = 0;  // a = steps done, b = total steps
+constexpr int kJobMessageDone = 1;      // a = JobStatus, b = JobResult::detail
+
+/** Installs Dart's NativeApi.postCObject; null stops posting. */
+void set_job_message_poster(void* post_cobject);
+
+/** Queues [work]; returns its id (> 0), or 0 when [work] is empty. */
+JobId submit_job(JobFn work, const JobOptions& options);
+
+/** Requests cancellation; false when the job is unknown or already finished. */
+bool cancel_job(JobId id);
+
+/** Current status without blocking. */
+JobStatus job_status(JobId id);
+
+/** Blocks until the job finishes; *detail (optional) receives JobResult::detail. */
+JobStatus wait_job(JobId id, int* detail = nullptr);
+
+/**
+ * Moves a finished job's pixel result to the caller (who frees it with std::free).
+ * Returns false when there is none, it was taken already, or the job did not succeed.
+ */
+bool take_job_result(JobId id, uint8_t** rgba, int* width, int* height);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_JOBS_H
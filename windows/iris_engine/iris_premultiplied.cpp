@@ -0,0 +1,131 @@
+/**
+ * Iris Engine — Premultiplied RGBA row kernels — implementation.
+ */
+
+#include "iris_premultiplied.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IRIS_PREMUL_SSE2 1
+#include <emmintrin.h>
+#else
+#define IRIS_PREMUL_SSE2 0
+#endif
+
+namespace iris {
+
+namespace {
+
+/** x / 255, rounded, for x in [0, 255 * 255]. */
+inline int div255(int x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+}  // namespace
+
+void premultiply_row(uint8_t* p, int count) {
+  int i = 0;
+#if IRIS_PREMUL_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i keep_rgb = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+  const __m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+  const __m128i half = _mm_set1_epi16(128);
+  auto scale = [&](__m128i v) {
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+    a = _mm_or_si128(_mm_and_si128(a, keep_rgb), alpha_one);  // alpha itself is kept
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(v, a), half);
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    auto* q = reinterpret_cast<__m128i*>(p + 4 * i);
+    const __m128i v = _mm_loadu_si128(q);
+    _mm_storeu_si128(q, _mm_packus_epi16(scale(_mm_unpacklo_epi8(v, zero)), scale(_mm_unpackhi_epi8(v, zero))));
+  }
+#endif
+  for (; i < count; ++i) {
+    uint8_t* q = p + 4 * i;
+    const int a = q[3];
+    for (int c = 0; c < 3; ++c) q[c] = static_cast<uint8_t>(div255(q[c] * a));
+  }
+}
+
+void blend_over_row(uint8_t* dst, const uint8_t* src, int count) {
+  int i = 0;
+#if IRIS_PREMUL_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i full = _mm_set1_epi16(255);
+  const __m128i half = _mm_set1_epi16(128);
+  auto over = [&](__m128i s, __m128i d) {
+    const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+    s = _mm_min_epi16(s, a);  // filter overshoot: colour never exceeds alpha
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(full, a)), half);
+    t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    return _mm_add_epi16(s, t);
+  };
+  for (; i + 4 <= count; i += 4) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+    // Most of a layer's square is the transparent surround of the iris.
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)) == 0xFFFF) continue;
+    auto* q = reinterpret_cast<__m128i*>(dst + 4 * i);
+    const __m128i d = _mm_loadu_si128(q);
+    _mm_storeu_si128(q, _mm_packus_epi16(over(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero)),
+                                         over(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero))));
+  }
+#endif
+  for (; i < count; ++i) {
+    const uint8_t* s = src + 4 * i;
+    uint8_t* d = dst + 4 * i;
+    const int a = s[3];
+    if (a == 0 && (s[0] | s[1] | s[2]) == 0) continue;
+    for (int c = 0; c < 4; ++c) d[c] = static_cast<uint8_t>(std::min<int>(s[c], a) + div255(d[c] * (255 - a)));
+  }
+}
+
+void mix_row(uint8_t* dst, const uint8_t* a, const uint8_t* b, const uint8_t* weight, int count) {
+  int i = 0;
+#if IRIS_PREMUL_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i full = _mm_set1_epi16(255);
+  const __m128i half = _mm_set1_epi16(128);
+  auto mix = [&](__m128i va, __m128i vb, __m128i w) {
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(va, _mm_sub_epi16(full, w)), _mm_mullo_epi16(vb, w));
+    t = _mm_add_epi16(t, half);  // at most 255 * 255 + 128: no 16-bit overflow
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    int packed;
+    std::memcpy(&packed, weight + i, 4);
+    __m128i w = _mm_cvtsi32_si128(packed);
+    w = _mm_unpacklo_epi8(w, w);
+    w = _mm_unpacklo_epi16(w, w);  // each pixel's weight in its four bytes
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 4 * i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 4 * i));
+    const __m128i lo = mix(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero), _mm_unpacklo_epi8(w, zero));
+    const __m128i hi = mix(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero), _mm_unpackhi_epi8(w, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < count; ++i) {
+    const int w = weight[i];
+    for (int c = 0; c < 4; ++c) {
+      dst[4 * i + c] = static_cast<uint8_t>(div255(a[4 * i + c] * (255 - w) + b[4 * i + c] * w));
+    }
+  }
+}
+
+void unpremultiply_row(uint8_t* p, int count) {
+  for (int i = 0; i < count; ++i) {
+    uint8_t* q = p + 4 * i;
+    const int a = q[3];
+    if (a == 255) continue;
+    if (a == 0) {
+      q[0] = q[1] = q[2] = 0;
+      continue;
+    }
+    for (int c = 0; c < 3; ++c) q[c] = static_cast<uint8_t>(std::min(255, (q[c] * 255 + a / 2) / a));
+  }
+}
+
+}  // namespace iris
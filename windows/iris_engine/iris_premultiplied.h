@@ -0,0 +1,35 @@
+/**
+ * Iris Engine — Premultiplied RGBA row kernels (2026).
+ *
+ * Layering cut irises (the compositor, the Art Studio effects) is done in premultiplied
+ * alpha, so filtering and blending never pull in the colour of transparent pixels.
+ * These are the shared row kernels: RGBA8, SSE2 across four pixels when available,
+ * division by 255 with rounding.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_PREMULTIPLIED_H
+#define IRIS_ENGINE_IRIS_PREMULTIPLIED_H
+
+#include <cstdint>
+
+namespace iris {
+
+/** Straight → premultiplied alpha, in place. */
+void premultiply_row(uint8_t* rgba, int count);
+
+/** Premultiplied → straight alpha, in place; opaque pixels are left untouched. */
+void unpremultiply_row(uint8_t* rgba, int count);
+
+/**
+ * dst = src + dst * (255 - src_alpha) / 255 over [count] premultiplied pixels. Source
+ * colour is clamped to its alpha first (resampling filters can overshoot), and fully
+ * transparent source runs are skipped.
+ */
+void blend_over_row(uint8_t* dst, const uint8_t* src, int count);
+
+/** dst = a * (255 - w) / 255 + b * w / 255, with one weight per pixel. dst may alias a or b. */
+void mix_row(uint8_t* dst, const uint8_t* a, const uint8_t* b, const uint8_t* weight, int count);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_PREMULTIPLIED_H
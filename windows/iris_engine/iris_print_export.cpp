@@ -0,0 +1,555 @@
+/**
+ * Iris Engine — Streaming print export — implementation.
+ */
+
+#include "iris_print_export.h"
+#include "iris_thread_pool.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(IRIS_ENGINE_HAS_ZLIB) && IRIS_ENGINE_HAS_ZLIB
+#include <zlib.h>
+#define IRIS_PRINT_ZLIB 1
+#else
+#define IRIS_PRINT_ZLIB 0
+#endif
+
+namespace iris {
+
+namespace {
+
+constexpr double kCmPerInch = 2.54;
+constexpr double kMetersPerInch = 0.0254;
+constexpr int kMaxPrintSide = 1 << 18;
+constexpr size_t kStripBytes = size_t{4} << 20;
+// TIFF strips are the unit of parallel compression; output strips are a whole number of them.
+constexpr int kTiffRowsPerStrip = 16;
+constexpr int kPhaseBits = 5;  // sampler phase layout (cv::INTER_TAB_SIZE)
+constexpr int kPhases = 1 << kPhaseBits;
+constexpr int kDeflateLevel = 3;  // same trade-off as the PNG encoder default
+constexpr size_t kIdatChunkBytes = 64 * 1024;
+constexpr size_t kStoredBlockBytes = 65535;
+constexpr uint64_t kTiffMaxOffset = 0xFFFFFFFFull;
+
+std::filesystem::path to_fs_path(const char* utf8) {
+  return std::filesystem::path(reinterpret_cast<const char8_t*>(utf8));
+}
+
+ImageFormat print_format(ImageFormat format, const std::filesystem::path& path) {
+  if (format == ImageFormat::kTiff || format == ImageFormat::kPng) return format;
+  if (format != ImageFormat::kAuto) return ImageFormat::kAuto;  // unsupported for print
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return (ext == ".tif" || ext == ".tiff") ? ImageFormat::kTiff : ImageFormat::kPng;
+}
+
+const std::array<uint32_t, 256>& crc_table() {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      t[n] = c;
+    }
+    return t;
+  }();
+  return table;
+}
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t size) {
+  const auto& t = crc_table();
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) crc = t[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+void put_be32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v >> 24);
+  p[1] = static_cast<uint8_t>(v >> 16);
+  p[2] = static_cast<uint8_t>(v >> 8);
+  p[3] = static_cast<uint8_t>(v);
+}
+
+/** Receives the output image strip by strip, top to bottom. */
+class StripWriter {
+ public:
+  virtual ~StripWriter() = default;
+  /** [rows] rows of [channels]-byte pixels, [stride] bytes apart. */
+  virtual bool write(const uint8_t* rows, int count, size_t stride) = 0;
+  virtual bool finish() = 0;
+};
+
+// ---------------------------------------------------------------------------------------
+// TIFF: classic little-endian, chunky RGB(A) or CMYK, one IFD written after the strips.
+// ---------------------------------------------------------------------------------------
+
+class TiffWriter : public StripWriter {
+ public:
+  /** [icc] set = CMYK samples, tagged with that printer profile. */
+  TiffWriter(std::ofstream& out, int width, int height, int channels, int dpi, int num_threads,
+             const std::vector<uint8_t>* icc)
+      : out_(out), width_(width), height_(height), channels_(channels), dpi_(dpi), threads_(num_threads),
+        icc_(icc) {
+    const uint8_t header[8] = {'I', 'I', 42, 0, 0, 0, 0, 0};  // IFD offset patched in finish()
+    out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+    offset_ = sizeof(header);
+  }
+
+  bool write(const uint8_t* rows, int count, size_t stride) override {
+    const size_t row_bytes = static_cast<size_t>(width_) * static_cast<size_t>(channels_);
+    const int strips = (count + kTiffRowsPerStrip - 1) / kTiffRowsPerStrip;
+    std::vector<std::vector<uint8_t>> packed(static_cast<size_t>(strips));
+    // Strips are independent, so they are packed and compressed in parallel.
+    parallel_for_rows(strips, threads_, [&](int s0, int s1) {
+      for (int s = s0; s < s1; ++s) {
+        const int r0 = s * kTiffRowsPerStrip;
+        const int r1 = std::min(count, r0 + kTiffRowsPerStrip);
+        std::vector<uint8_t> raw(row_bytes * static_cast<size_t>(r1 - r0));
+        for (int r = r0; r < r1; ++r) {
+          std::memcpy(raw.data() + row_bytes * static_cast<size_t>(r - r0),
+                      rows + stride * static_cast<size_t>(r), row_bytes);
+        }
+        packed[static_cast<size_t>(s)] = compress(std::move(raw));
+      }
+    }, 1);
+    for (const auto& strip : packed) {
+      if (strip.empty() || offset_ + strip.size() > kTiffMaxOffset) return false;
+      strip_offsets_.push_back(static_cast<uint32_t>(offset_));
+      strip_counts_.push_back(static_cast<uint32_t>(strip.size()));
+      out_.write(reinterpret_cast<const char*>(strip.data()), static_cast<std::streamsize>(strip.size()));
+      offset_ += strip.size();
+    }
+    return static_cast<bool>(out_);
+  }
+
+  bool finish() override {
+    if (offset_ & 1) put(std::vector<uint8_t>{0});  // IFD entries must start on a word boundary
+    const uint32_t bits_at = static_cast<uint32_t>(offset_);
+    std::vector<uint8_t> blob;
+    for (int c = 0; c < channels_; ++c) append16(blob, 8);
+    const uint32_t res_at = bits_at + static_cast<uint32_t>(blob.size());
+    append32(blob, static_cast<uint32_t>(dpi_));  // XResolution = dpi / 1
+    append32(blob, 1);
+    const uint32_t offsets_at = bits_at + static_cast<uint32_t>(blob.size());
+    for (uint32_t v : strip_offsets_) append32(blob, v);
+    const uint32_t counts_at = bits_at + static_cast<uint32_t>(blob.size());
+    for (uint32_t v : strip_counts_) append32(blob, v);
+    uint32_t icc_at = 0;
+    if (icc_) {
+      if (blob.size() & 1) blob.push_back(0);
+      icc_at = bits_at + static_cast<uint32_t>(blob.size());
+      blob.insert(blob.end(), icc_->begin(), icc_->end());
+      if (blob.size() & 1) blob.push_back(0);
+    }
+    if (offset_ + blob.size() + 256 > kTiffMaxOffset) return false;
+    put(blob);
+    const uint32_t ifd_at = static_cast<uint32_t>(offset_);
+
+    const uint32_t n = static_cast<uint32_t>(strip_offsets_.size());
+    std::vector<uint8_t> ifd;
+    int entries = 0;
+    auto entry = [&](uint16_t tag, uint16_t type, uint32_t count, uint32_t value) {
+      append16(ifd, tag);
+      append16(ifd, type);
+      append32(ifd, count);
+      append32(ifd, value);
+      ++entries;
+    };
+    constexpr uint16_t kShort = 3, kLong = 4, kRational = 5, kUndefined = 7;
+    // A single value of up to 4 bytes sits in the entry itself, left-justified.
+    entry(256, kLong, 1, static_cast<uint32_t>(width_));
+    entry(257, kLong, 1, static_cast<uint32_t>(height_));
+    entry(258, kShort, static_cast<uint32_t>(channels_), bits_at);
+    entry(259, kShort, 1, IRIS_PRINT_ZLIB ? 8 : 1);  // Adobe Deflate / none
+    entry(262, kShort, 1, icc_ ? 5 : 2);             // separated (CMYK) / RGB
+    entry(273, kLong, n, n == 1 ? strip_offsets_[0] : offsets_at);
+    entry(277, kShort, 1, static_cast<uint32_t>(channels_));
+    entry(278, kLong, 1, kTiffRowsPerStrip);
+    entry(279, kLong, n, n == 1 ? strip_counts_[0] : counts_at);
+    entry(282, kRational, 1, res_at);
+    entry(283, kRational, 1, res_at);
+    entry(284, kShort, 1, 1);  // chunky
+    entry(296, kShort, 1, 2);  // inch
+    if (icc_) entry(332, kShort, 1, 1);  // InkSet: CMYK
+    if (channels_ == 4 && !icc_) entry(338, kShort, 1, 2);  // unassociated alpha
+    if (icc_) entry(34675, kUndefined, static_cast<uint32_t>(icc_->size()), icc_at);  // ICC profile
+    std::vector<uint8_t> table;
+    append16(table, static_cast<uint16_t>(entries));
+    table.insert(table.end(), ifd.begin(), ifd.end());
+    append32(table, 0);  // no next IFD
+    put(table);
+
+    out_.seekp(4);
+    std::vector<uint8_t> at;
+    append32(at, ifd_at);
+    out_.write(reinterpret_cast<const char*>(at.data()), 4);
+    return static_cast<bool>(out_);
+  }
+
+ private:
+  std::ofstream& out_;
+  int width_, height_, channels_, dpi_, threads_;
+  const std::vector<uint8_t>* icc_;
+  uint64_t offset_ = 0;
+  std::vector<uint32_t> strip_offsets_;
+  std::vector<uint32_t> strip_counts_;
+
+  static void append16(std::vector<uint8_t>& v, uint16_t x) {
+    v.push_back(static_cast<uint8_t>(x));
+    v.push_back(static_cast<uint8_t>(x >> 8));
+  }
+  static void append32(std::vector<uint8_t>& v, uint32_t x) {
+    for (int i = 0; i < 4; ++i) v.push_back(static_cast<uint8_t>(x >> (8 * i)));
+  }
+  void put(const std::vector<uint8_t>& bytes) {
+    out_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    offset_ += bytes.size();
+  }
+
+  static std::vector<uint8_t> compress(std::vector<uint8_t> raw) {
+#if IRIS_PRINT_ZLIB
+    uLongf size = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> z(size);
+    if (compress2(z.data(), &size, raw.data(), static_cast<uLong>(raw.size()), kDeflateLevel) != Z_OK) return {};
+    z.resize(size);
+    return z;
+#else
+    return raw;
+#endif
+  }
+};
+
+// ---------------------------------------------------------------------------------------
+// PNG: IHDR + pHYs, Paeth-filtered rows deflated into a stream of IDAT chunks.
+// ---------------------------------------------------------------------------------------
+
+class PngWriter : public StripWriter {
+ public:
+  PngWriter(std::ofstream& out, int width, int height, int channels, int dpi)
+      : out_(out), channels_(channels), row_bytes_(static_cast<size_t>(width) * static_cast<size_t>(channels)),
+        prev_(row_bytes_, 0), filtered_(row_bytes_ + 1) {
+    static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    out_.write(reinterpret_cast<const char*>(kSignature), sizeof(kSignature));
+    uint8_t ihdr[13];
+    put_be32(ihdr, static_cast<uint32_t>(width));
+    put_be32(ihdr + 4, static_cast<uint32_t>(height));
+    ihdr[8] = 8;                          // bit depth
+    ihdr[9] = channels == 4 ? 6 : 2;      // RGBA / RGB
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;   // deflate, adaptive filtering, no interlace
+    chunk("IHDR", ihdr, sizeof(ihdr));
+    uint8_t phys[9];
+    const uint32_t ppm = static_cast<uint32_t>(std::lround(dpi / kMetersPerInch));
+    put_be32(phys, ppm);
+    put_be32(phys + 4, ppm);
+    phys[8] = 1;  // meters
+    chunk("pHYs", phys, sizeof(phys));
+#if IRIS_PRINT_ZLIB
+    ok_ = deflateInit(&z_, kDeflateLevel) == Z_OK;
+#else
+    const uint8_t zlib_header[2] = {0x78, 0x01};
+    pending_.insert(pending_.end(), zlib_header, zlib_header + 2);
+    block_.reserve(kStoredBlockBytes);
+#endif
+    idat_.reserve(kIdatChunkBytes);
+  }
+
+  ~PngWriter() override {
+#if IRIS_PRINT_ZLIB
+    if (ok_) deflateEnd(&z_);
+#endif
+  }
+
+  bool write(const uint8_t* rows, int count, size_t stride) override {
+    for (int r = 0; r < count && ok_; ++r) {
+      const uint8_t* row = rows + stride * static_cast<size_t>(r);
+      filter_paeth(row);
+      std::memcpy(prev_.data(), row, row_bytes_);
+      feed(filtered_.data(), filtered_.size(), false);
+    }
+    return ok_ && static_cast<bool>(out_);
+  }
+
+  bool finish() override {
+    if (!ok_) return false;
+    feed(nullptr, 0, true);
+    flush_idat();
+    chunk("IEND", nullptr, 0);
+    return ok_ && static_cast<bool>(out_);
+  }
+
+ private:
+  std::ofstream& out_;
+  int channels_;
+  size_t row_bytes_;
+  std::vector<uint8_t> prev_;
+  std::vector<uint8_t> filtered_;
+  std::vector<uint8_t> idat_;
+  bool ok_ = true;
+#if IRIS_PRINT_ZLIB
+  z_stream z_{};
+#else
+  std::vector<uint8_t> pending_;  // zlib bytes not yet moved into idat_
+  std::vector<uint8_t> block_;    // raw bytes of the stored block being filled
+  uint32_t adler_a_ = 1, adler_b_ = 0;
+#endif
+
+  void chunk(const char* type, const uint8_t* data, size_t size) {
+    uint8_t head[8];
+    put_be32(head, static_cast<uint32_t>(size));
+    std::memcpy(head + 4, type, 4);
+    uint32_t crc = crc32_update(0, head + 4, 4);
+    if (size) crc = crc32_update(crc, data, size);
+    uint8_t tail[4];
+    put_be32(tail, crc);
+    out_.write(reinterpret_cast<const char*>(head), 8);
+    if (size) out_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    out_.write(reinterpret_cast<const char*>(tail), 4);
+  }
+
+  void flush_idat() {
+    if (idat_.empty()) return;
+    chunk("IDAT", idat_.data(), idat_.size());
+    idat_.clear();
+  }
+
+  void emit(const uint8_t* data, size_t size) {
+    while (size > 0) {
+      const size_t take = std::min(size, kIdatChunkBytes - idat_.size());
+      idat_.insert(idat_.end(), data, data + take);
+      data += take;
+      size -= take;
+      if (idat_.size() == kIdatChunkBytes) flush_idat();
+    }
+  }
+
+  /** Filter type 4 (Paeth) against the previous row; the first row sees zeros. */
+  void filter_paeth(const uint8_t* row) {
+    uint8_t* f = filtered_.data();
+    f[0] = 4;
+    const int bpp = channels_;
+    for (size_t i = 0; i < row_bytes_; ++i) {
+      const int a = i >= static_cast<size_t>(bpp) ? row[i - bpp] : 0;
+      const int b = prev_[i];
+      const int c = i >= static_cast<size_t>(bpp) ? prev_[i - bpp] : 0;
+      const int p = a + b - c;
+      const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+      const int pred = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+      f[i + 1] = static_cast<uint8_t>(row[i] - pred);
+    }
+  }
+
+#if IRIS_PRINT_ZLIB
+  void feed(const uint8_t* data, size_t size, bool last) {
+    uint8_t buf[16384];
+    z_.next_in = const_cast<Bytef*>(data);
+    z_.avail_in = static_cast<uInt>(size);
+    int rc;
+    do {
+      z_.next_out = buf;
+      z_.avail_out = sizeof(buf);
+      rc = deflate(&z_, last ? Z_FINISH : Z_NO_FLUSH);
+      if (rc == Z_STREAM_ERROR) {
+        ok_ = false;
+        return;
+      }
+      emit(buf, sizeof(buf) - z_.avail_out);
+    } while (z_.avail_out == 0 || (last && rc != Z_STREAM_END));
+  }
+#else
+  /** Stored (uncompressed) deflate blocks of up to 65535 bytes, then the Adler-32. */
+  void feed(const uint8_t* data, size_t size, bool last) {
+    for (size_t i = 0; i < size; ++i) {
+      adler_a_ = (adler_a_ + data[i]) % 65521u;
+      adler_b_ = (adler_b_ + adler_a_) % 65521u;
+    }
+    while (size > 0) {
+      const size_t take = std::min(size, kStoredBlockBytes - block_.size());
+      block_.insert(block_.end(), data, data + take);
+      data += take;
+      size -= take;
+      if (block_.size() == kStoredBlockBytes) store_block(false);
+    }
+    if (last) {
+      store_block(true);
+      uint8_t adler[4];
+      put_be32(adler, (adler_b_ << 16) | adler_a_);
+      pending_.insert(pending_.end(), adler, adler + 4);
+      emit(pending_.data(), pending_.size());
+      pending_.clear();
+    }
+  }
+
+  void store_block(bool final_block) {
+    const uint16_t len = static_cast<uint16_t>(block_.size());
+    const uint16_t nlen = static_cast<uint16_t>(~len);
+    const uint8_t head[5] = {static_cast<uint8_t>(final_block ? 1 : 0), static_cast<uint8_t>(len),
+                             static_cast<uint8_t>(len >> 8), static_cast<uint8_t>(nlen),
+                             static_cast<uint8_t>(nlen >> 8)};
+    pending_.insert(pending_.end(), head, head + 5);
+    pending_.insert(pending_.end(), block_.begin(), block_.end());
+    block_.clear();
+    emit(pending_.data(), pending_.size());
+    pending_.clear();
+  }
+#endif
+};
+
+/**
+ * Per-column / per-row source positions for scaling [src] to [out_w] x [out_h], in the
+ * sampler's integer + 5-bit phase layout. Pixel centres are aligned.
+ */
+struct ScaleAxis {
+  std::vector<int16_t> pos;
+  std::vector<uint16_t> phase;
+
+  ScaleAxis(int src, int out) : pos(static_cast<size_t>(out)), phase(static_cast<size_t>(out)) {
+    const double scale = static_cast<double>(src) / out;
+    for (int i = 0; i < out; ++i) {
+      const double s = std::clamp((i + 0.5) * scale - 0.5, -0.5, src - 0.5);
+      const int fixed = static_cast<int>(std::lround(s * kPhases));
+      const int whole = fixed >= 0 ? fixed / kPhases : -((-fixed + kPhases - 1) / kPhases);
+      pos[static_cast<size_t>(i)] = static_cast<int16_t>(whole);
+      phase[static_cast<size_t>(i)] = static_cast<uint16_t>(fixed - whole * kPhases);
+    }
+  }
+};
+
+}  // namespace
+
+bool print_output_size(int src_w, int src_h, int dpi, double width_cm, int* out_w, int* out_h) {
+  if (src_w <= 0 || src_h <= 0 || dpi <= 0 || width_cm < 0 || !out_w || !out_h) return false;
+  const double w = width_cm > 0 ? std::round(width_cm / kCmPerInch * dpi) : src_w;
+  const double h = std::max(1.0, std::round(w * src_h / src_w));
+  if (w < 1 || w > kMaxPrintSide || h > kMaxPrintSide) return false;
+  *out_w = static_cast<int>(w);
+  *out_h = static_cast<int>(h);
+  return true;
+}
+
+bool export_print_file(const char* path, const uint8_t* rgba, int width, int height,
+                       const PrintExportOptions& options) {
+  if (!path || !rgba) return false;
+  int out_w = 0, out_h = 0;
+  if (!print_output_size(width, height, options.dpi, options.width_cm, &out_w, &out_h)) return false;
+  const std::filesystem::path target = to_fs_path(path);
+  const ImageFormat format = print_format(options.format, target);
+  if (format == ImageFormat::kAuto) return false;
+  std::shared_ptr<const CmykTransform> cmyk;
+  if (!options.cmyk.empty()) {
+    if (format != ImageFormat::kTiff) return false;  // PNG has no CMYK
+    cmyk = acquire_cmyk_transform(options.cmyk);
+    if (!cmyk) return false;
+  }
+
+  // A print smaller than the source is area-reduced once (at most source-sized); a larger
+  // one is interpolated strip by strip from the source itself.
+  cv::Mat src(height, width, CV_8UC4, const_cast<uint8_t*>(rgba));
+  const bool enlarge = out_w > width || out_h > height;
+  if (!enlarge && (out_w != width || out_h != height)) {
+    cv::Mat reduced;
+    cv::resize(src, reduced, cv::Size(out_w, out_h), 0, 0, cv::INTER_AREA);
+    src = reduced;
+  }
+  if (enlarge && (width > INT16_MAX || height > INT16_MAX)) return false;  // sampler coordinates
+
+  const int channels = cmyk || options.keep_alpha ? 4 : 3;
+  int strip_rows = options.strip_rows > 0
+                       ? options.strip_rows
+                       : static_cast<int>(std::max<size_t>(1, kStripBytes / (static_cast<size_t>(out_w) * 4)));
+  if (format == ImageFormat::kTiff) {
+    strip_rows = (strip_rows + kTiffRowsPerStrip - 1) / kTiffRowsPerStrip * kTiffRowsPerStrip;
+  }
+  strip_rows = std::min(strip_rows, out_h);
+  const int threads = options.num_threads;
+
+  std::filesystem::path tmp = target;
+  tmp += ".partial";
+  bool ok = false;
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    std::unique_ptr<StripWriter> writer;
+    if (format == ImageFormat::kTiff) {
+      writer = std::make_unique<TiffWriter>(out, out_w, out_h, channels, options.dpi, threads,
+                                            cmyk ? &cmyk_profile_bytes(*cmyk) : nullptr);
+    } else {
+      writer = std::make_unique<PngWriter>(out, out_w, out_h, channels, options.dpi);
+    }
+
+    std::unique_ptr<ScaleAxis> ax, ay;
+    cv::Mat map_xy, map_frac;
+    if (enlarge) {
+      ax = std::make_unique<ScaleAxis>(width, out_w);
+      ay = std::make_unique<ScaleAxis>(height, out_h);
+      map_xy.create(strip_rows, out_w, CV_16SC2);
+      map_frac.create(strip_rows, out_w, CV_16UC1);
+    }
+    cv::Mat strip(strip_rows, out_w, CV_8UC4);
+    cv::Mat packed;
+    ok = true;
+    for (int y0 = 0; y0 < out_h && ok; y0 += strip_rows) {
+      const int rows = std::min(strip_rows, out_h - y0);
+      const uint8_t* data;
+      size_t stride;
+      if (enlarge) {
+        parallel_for_rows(rows, threads, [&](int r0, int r1) {
+          for (int r = r0; r < r1; ++r) {
+            int16_t* xy = map_xy.ptr<int16_t>(r);
+            uint16_t* fr = map_frac.ptr<uint16_t>(r);
+            const int16_t sy = ay->pos[static_cast<size_t>(y0 + r)];
+            const uint16_t py = static_cast<uint16_t>(ay->phase[static_cast<size_t>(y0 + r)] << kPhaseBits);
+            for (int x = 0; x < out_w; ++x) {
+              xy[2 * x] = ax->pos[static_cast<size_t>(x)];
+              xy[2 * x + 1] = sy;
+              fr[x] = static_cast<uint16_t>(py | ax->phase[static_cast<size_t>(x)]);
+            }
+          }
+          remap_rows(src, map_xy, map_frac, strip, r0, r1, options.interpolation);
+        }, 4);
+        data = strip.ptr<uint8_t>(0);
+        stride = strip.step;
+      } else {
+        data = src.ptr<uint8_t>(y0);
+        stride = src.step;
+      }
+      if (cmyk) {
+        packed.create(rows, out_w, CV_8UC4);
+        parallel_for_rows(rows, threads, [&](int r0, int r1) {
+          cmyk_transform_rows(*cmyk, data, stride, packed.ptr<uint8_t>(0), packed.step, out_w, r0, r1);
+        }, 4);
+        data = packed.ptr<uint8_t>(0);
+        stride = packed.step;
+      } else if (channels == 3) {
+        const cv::Mat rows_rgba(rows, out_w, CV_8UC4, const_cast<uint8_t*>(data), stride);
+        cv::cvtColor(rows_rgba, packed, cv::COLOR_RGBA2RGB);
+        data = packed.ptr<uint8_t>(0);
+        stride = packed.step;
+      }
+      ok = writer->write(data, rows, stride);
+    }
+    ok = ok && writer->finish();
+  }
+  std::error_code ec;
+  if (ok) {
+    std::filesystem::rename(tmp, target, ec);
+    if (!ec) return true;
+  }
+  std::filesystem::remove(tmp, ec);
+  return false;
+}
+
+}  // namespace iris
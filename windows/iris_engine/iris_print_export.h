@@ -0,0 +1,58 @@
+/**
+ * Iris Engine — Streaming print export (2026).
+ *
+ * Writes the image at a physical print size, e.g. 60 cm at 600 dpi (about 14,000 px
+ * wide), as TIFF with resolution tags or PNG with a pHYs chunk. The output is resampled
+ * and encoded strip by strip: each strip of output rows is gathered from the source,
+ * compressed and written before the next one. The full output raster is never held,
+ * so peak memory is the source plus a few strips, however large the print is.
+ *
+ * Compression uses zlib when the engine is built with it (IRIS_ENGINE_HAS_ZLIB): Deflate
+ * TIFF strips, compressed in parallel, and a normal PNG stream. Without zlib, TIFF
+ * strips are stored uncompressed and PNG uses stored deflate blocks. Both are still
+ * valid files.
+ *
+ * With a printer profile the output is a CMYK TIFF: each strip is composited over paper
+ * white and converted through the cached ICC transform (iris_color_management.h), and
+ * the profile is embedded in the file.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_PRINT_EXPORT_H
+#define IRIS_ENGINE_IRIS_PRINT_EXPORT_H
+
+#include <cstdint>
+
+#include "iris_codec.h"
+#include "iris_color_management.h"
+#include "iris_sampler.h"
+
+namespace iris {
+
+struct PrintExportOptions {
+  int dpi = 300;
+  double width_cm = 0;                  // printed width; 0 = keep the pixel size, only tag the DPI
+  ImageFormat format = ImageFormat::kAuto;  // kTiff or kPng; kAuto = from the extension
+  Interpolation interpolation = Interpolation::kBicubic;
+  bool keep_alpha = true;               // RGBA (unassociated alpha) instead of RGB
+  int strip_rows = 0;                   // output rows per strip; 0 = about 4 MB strips
+  int num_threads = 0;
+  CmykProfile cmyk;                     // profile set = CMYK TIFF; keep_alpha is ignored
+};
+
+/**
+ * Output pixel size for printing [src_w] x [src_h] at [dpi] and [width_cm], aspect kept.
+ * False when the inputs are invalid or the result exceeds what the writers support.
+ */
+bool print_output_size(int src_w, int src_h, int dpi, double width_cm, int* out_w, int* out_h);
+
+/**
+ * Writes [rgba] (width * height * 4 bytes, tightly packed) to [path] (UTF-8) at the
+ * print size. Images smaller than the source are area-reduced first, larger ones are
+ * interpolated per strip. The file is written to a sibling temporary and renamed.
+ */
+bool export_print_file(const char* path, const uint8_t* rgba, int width, int height,
+                       const PrintExportOptions& options);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_PRINT_EXPORT_H
@@ -0,0 +1,238 @@
+/**
+ * Iris Engine — Interpolating gather kernels — implementation.
+ * One template per (kernel, channels); 2D weight tables per sub-pixel phase are built
+ * once and normalized to exactly 1 << kWeightBits so flat regions stay flat.
+ */
+
+#include "iris_sampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IRIS_SAMPLER_SSE2 1
+#include <emmintrin.h>
+#else
+#define IRIS_SAMPLER_SSE2 0
+#endif
+
+namespace iris {
+
+namespace {
+
+constexpr int kPhaseBits = 5;
+constexpr int kPhases = 1 << kPhaseBits;  // matches cv::INTER_TAB_SIZE
+constexpr int kWeightBits = 14;
+constexpr int kWeightOne = 1 << kWeightBits;
+constexpr double kPi = 3.14159265358979323846;
+
+struct NearestKernel {
+  static constexpr int kTaps = 1;
+  static double weight(double) { return 1.0; }
+};
+
+struct BilinearKernel {
+  static constexpr int kTaps = 2;
+  static double weight(double t) {
+    t = std::fabs(t);
+    return t < 1.0 ? 1.0 - t : 0.0;
+  }
+};
+
+struct BicubicKernel {
+  static constexpr int kTaps = 4;
+  static double weight(double t) {
+    constexpr double a = -0.5;  // Catmull-Rom
+    t = std::fabs(t);
+    if (t < 1.0) return ((a + 2.0) * t - (a + 3.0)) * t * t + 1.0;
+    if (t < 2.0) return ((a * t - 5.0 * a) * t + 8.0 * a) * t - 4.0 * a;
+    return 0.0;
+  }
+};
+
+struct Lanczos3Kernel {
+  static constexpr int kTaps = 6;
+  static double weight(double t) {
+    t = std::fabs(t);
+    if (t < 1e-9) return 1.0;
+    if (t >= 3.0) return 0.0;
+    const double x = kPi * t;
+    return 3.0 * std::sin(x) * std::sin(x / 3.0) / (x * x);
+  }
+};
+
+/** Row-major kTaps x kTaps weights for each of the kPhases^2 phases (index = fy*32 + fx). */
+template <class K>
+std::vector<int16_t> build_weight_table() {
+  constexpr int T = K::kTaps;
+  constexpr int first = T / 2 - 1;  // tap offset of the leftmost tap
+  std::vector<int16_t> table(static_cast<size_t>(kPhases) * kPhases * T * T);
+  double wx[T], wy[T];
+  for (int py = 0; py < kPhases; ++py) {
+    for (int px = 0; px < kPhases; ++px) {
+      double sx = 0, sy = 0;
+      for (int i = 0; i < T; ++i) {
+        wx[i] = K::weight(i - first - static_cast<double>(px) / kPhases);
+        wy[i] = K::weight(i - first - static_cast<double>(py) / kPhases);
+        sx += wx[i];
+        sy += wy[i];
+      }
+      int16_t* w = &table[static_cast<size_t>(py * kPhases + px) * T * T];
+      int sum = 0, peak = 0;
+      for (int j = 0; j < T; ++j) {
+        for (int i = 0; i < T; ++i) {
+          const int v = static_cast<int>(std::lround(wy[j] / sy * wx[i] / sx * kWeightOne));
+          w[j * T + i] = static_cast<int16_t>(v);
+          sum += v;
+          if (v > w[peak]) peak = j * T + i;
+        }
+      }
+      w[peak] = static_cast<int16_t>(w[peak] + (kWeightOne - sum));
+    }
+  }
+  return table;
+}
+
+template <class K>
+const int16_t* weight_table() {
+  static const std::vector<int16_t> table = build_weight_table<K>();
+  return table.data();
+}
+
+inline uint8_t clamp_u8(int v) {
+  return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/** Filtered sample at integer position (ix, iy), phase f; taps clamped to the image. */
+template <class K, int C>
+inline void filter_pixel(const uint8_t* base, size_t step, int w, int h,
+                         int ix, int iy, int f, const int16_t* table, uint8_t* out) {
+  constexpr int T = K::kTaps;
+  constexpr int first = T / 2 - 1;
+  const int16_t* wt = table + static_cast<size_t>(f) * T * T;
+  int xo[T];
+  const uint8_t* rows[T];
+  for (int i = 0; i < T; ++i) {
+    xo[i] = std::clamp(ix - first + i, 0, w - 1) * C;
+    rows[i] = base + static_cast<size_t>(std::clamp(iy - first + i, 0, h - 1)) * step;
+  }
+#if IRIS_SAMPLER_SSE2
+  if constexpr (C == 4) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_set1_epi32(1 << (kWeightBits - 1));
+    for (int j = 0; j < T; ++j) {
+      const int16_t* wr = wt + j * T;
+      for (int i = 0; i < T; i += 2) {
+        int32_t p0, p1;
+        std::memcpy(&p0, rows[j] + xo[i], 4);
+        std::memcpy(&p1, rows[j] + xo[i + 1], 4);
+        // r0 r1 g0 g1 b0 b1 a0 a1 as int16, weights (w0, w1) repeated: one madd per tap pair.
+        const __m128i px = _mm_unpacklo_epi8(
+          _mm_unpacklo_epi8(_mm_cvtsi32_si128(p0), _mm_cvtsi32_si128(p1)), zero);
+        const __m128i ww = _mm_set1_epi32(static_cast<int32_t>(
+          static_cast<uint16_t>(wr[i]) | (static_cast<uint32_t>(static_cast<uint16_t>(wr[i + 1])) << 16)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(px, ww));
+      }
+    }
+    acc = _mm_srai_epi32(acc, kWeightBits);
+    const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(acc, acc), zero);
+    const int32_t v = _mm_cvtsi128_si32(packed);
+    std::memcpy(out, &v, 4);
+    return;
+  }
+#endif
+  int acc[C];
+  for (int c = 0; c < C; ++c) acc[c] = 1 << (kWeightBits - 1);
+  for (int j = 0; j < T; ++j) {
+    const int16_t* wr = wt + j * T;
+    for (int i = 0; i < T; ++i) {
+      const uint8_t* p = rows[j] + xo[i];
+      for (int c = 0; c < C; ++c) acc[c] += p[c] * wr[i];
+    }
+  }
+  for (int c = 0; c < C; ++c) out[c] = clamp_u8(acc[c] >> kWeightBits);
+}
+
+template <class K, int C>
+void gather_rows(const cv::Mat& src, const cv::Mat& map_xy, const cv::Mat& map_frac,
+                 cv::Mat& dst, int y_begin, int y_end) {
+  const int w = src.cols, h = src.rows;
+  const size_t step = src.step;
+  const uint8_t* base = src.ptr<uint8_t>(0);
+  const int16_t* table = K::kTaps > 1 ? weight_table<K>() : nullptr;
+  const int half = kPhases / 2;
+  for (int y = y_begin; y < y_end; ++y) {
+    const int16_t* xy = map_xy.ptr<int16_t>(y);
+    const uint16_t* fr = map_frac.ptr<uint16_t>(y);
+    uint8_t* d = dst.ptr<uint8_t>(y);
+    for (int x = 0; x < dst.cols; ++x, d += C) {
+      const int ix = xy[2 * x], iy = xy[2 * x + 1];
+      const int f = fr[x] & (kPhases * kPhases - 1);
+      const int nx = ix + ((f & (kPhases - 1)) >= half);
+      const int ny = iy + ((f >> kPhaseBits) >= half);
+      if (nx < 0 || ny < 0 || nx >= w || ny >= h) {
+        std::memset(d, 0, C);
+        continue;
+      }
+      if constexpr (K::kTaps == 1) {
+        std::memcpy(d, base + static_cast<size_t>(ny) * step + static_cast<size_t>(nx) * C, C);
+      } else {
+        filter_pixel<K, C>(base, step, w, h, ix, iy, f, table, d);
+      }
+    }
+  }
+}
+
+template <int C>
+void dispatch(const cv::Mat& src, const cv::Mat& map_xy, const cv::Mat& map_frac,
+              cv::Mat& dst, int y_begin, int y_end, Interpolation mode) {
+  switch (mode) {
+    case Interpolation::kNearest:
+      gather_rows<NearestKernel, C>(src, map_xy, map_frac, dst, y_begin, y_end);
+      break;
+    case Interpolation::kBicubic:
+      gather_rows<BicubicKernel, C>(src, map_xy, map_frac, dst, y_begin, y_end);
+      break;
+    case Interpolation::kLanczos3:
+      gather_rows<Lanczos3Kernel, C>(src, map_xy, map_frac, dst, y_begin, y_end);
+      break;
+    case Interpolation::kBilinear:
+    default:
+      gather_rows<BilinearKernel, C>(src, map_xy, map_frac, dst, y_begin, y_end);
+      break;
+  }
+}
+
+}  // namespace
+
+Interpolation interpolation_from_int(int value) {
+  switch (value) {
+    case static_cast<int>(Interpolation::kNearest): return Interpolation::kNearest;
+    case static_cast<int>(Interpolation::kBicubic): return Interpolation::kBicubic;
+    case static_cast<int>(Interpolation::kLanczos3): return Interpolation::kLanczos3;
+    default: return Interpolation::kBilinear;
+  }
+}
+
+bool remap_rows(const cv::Mat& src, const cv::Mat& map_xy, const cv::Mat& map_frac,
+                cv::Mat& dst, int y_begin, int y_end, Interpolation mode) {
+  if (src.empty() || map_xy.type() != CV_16SC2 || map_frac.type() != CV_16UC1) return false;
+  if (dst.type() != src.type() || dst.rows != map_xy.rows || dst.cols != map_xy.cols ||
+      map_frac.rows != map_xy.rows || map_frac.cols != map_xy.cols) {
+    return false;
+  }
+  y_begin = std::max(0, y_begin);
+  y_end = std::min(dst.rows, y_end);
+  if (src.type() == CV_8UC4) {
+    dispatch<4>(src, map_xy, map_frac, dst, y_begin, y_end, mode);
+    return true;
+  }
+  if (src.type() == CV_8UC1) {
+    dispatch<1>(src, map_xy, map_frac, dst, y_begin, y_end, mode);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace iris
@@ -0,0 +1,41 @@
+/**
+ * Iris Engine — Interpolating gather kernels (2026).
+ *
+ * Kernels are specialized at compile time by interpolation mode and channel count and
+ * use 14-bit fixed-point weights (SSE2 across the four RGBA channels when available).
+ * Coordinates come in the cv::convertMaps CV_16SC2 + CV_16UC1 layout: integer source
+ * position plus a 5-bit x/y phase (cv::INTER_TAB_SIZE = 32).
+ */
+
+#ifndef IRIS_ENGINE_IRIS_SAMPLER_H
+#define IRIS_ENGINE_IRIS_SAMPLER_H
+
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+namespace iris {
+
+enum class Interpolation : int32_t {
+  kNearest = 1,
+  kBilinear = 2,
+  kBicubic = 3,   // Catmull-Rom, 4x4 taps
+  kLanczos3 = 4,  // 6x6 taps
+};
+
+/** Maps an FFI value to a mode; unknown values (including 0) give bilinear. */
+Interpolation interpolation_from_int(int value);
+
+/**
+ * dst rows [y_begin, y_end) = src sampled at (map_xy, map_frac) for the same rows.
+ * src/dst: CV_8UC1 or CV_8UC4, dst already allocated at map size.
+ * A sample whose nearest source pixel lies outside src is written as 0 (transparent);
+ * filter taps that fall outside are clamped to the edge.
+ * Returns false on unsupported types or mismatched sizes.
+ */
+bool remap_rows(const cv::Mat& src, const cv::Mat& map_xy, const cv::Mat& map_frac,
+                cv::Mat& dst, int y_begin, int y_end, Interpolation mode);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_SAMPLER_H
@@ -0,0 +1,295 @@
+/**
+ * Iris Engine — Stage timers, memory counters and session traces — implementation.
+ */
+
+#include "iris_stats.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef PSAPI_VERSION
+#define PSAPI_VERSION 2  // K32GetProcessMemoryInfo from kernel32, no psapi.lib
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace iris {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kDefaultMaxTraceEvents = 1 << 20;
+
+thread_local EngineStats* t_current = nullptr;
+
+void store_max(std::atomic<uint64_t>& slot, uint64_t value) {
+  uint64_t seen = slot.load(std::memory_order_relaxed);
+  while (value > seen && !slot.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+  }
+}
+
+/** Small stable id per thread for trace rows. */
+int trace_thread_id() {
+  static std::atomic<int> next{1};
+  thread_local const int id = next.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+
+struct TraceEvent {
+  Stage stage;
+  int tid;
+  const void* stats;  // handle stats the stage counted toward
+  Clock::time_point start;
+  uint64_t dur_ns;
+};
+
+struct TraceSession {
+  std::mutex mutex;
+  std::atomic<bool> active{false};
+  std::vector<TraceEvent> events;
+  size_t max_events = 0;
+  uint64_t dropped = 0;
+  Clock::time_point origin;
+};
+
+TraceSession& trace_session() {
+  static TraceSession* session = new TraceSession();  // never destroyed: timers may run at exit
+  return *session;
+}
+
+void trace_record(Stage stage, Clock::time_point start, uint64_t dur_ns) {
+  TraceSession& s = trace_session();
+  if (!s.active.load(std::memory_order_relaxed)) return;
+  const TraceEvent e{stage, trace_thread_id(), t_current, start, dur_ns};
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.active.load(std::memory_order_relaxed)) return;
+  if (s.events.size() >= s.max_events) {
+    ++s.dropped;
+    return;
+  }
+  s.events.push_back(e);
+}
+
+}  // namespace
+
+const char* stage_name(Stage stage) {
+  switch (stage) {
+    case Stage::kDecode: return "decode";
+    case Stage::kColorConvert: return "color_convert";
+    case Stage::kHough: return "hough";
+    case Stage::kInpaint: return "inpaint";
+    case Stage::kClahe: return "clahe";
+    case Stage::kWarp: return "warp";
+    case Stage::kCopyOut: return "copy_out";
+  }
+  return "unknown";
+}
+
+void EngineStats::add_stage(Stage stage, uint64_t ns) {
+  StageCounters& c = stages_[static_cast<int>(stage)];
+  c.calls.fetch_add(1, std::memory_order_relaxed);
+  c.total_ns.fetch_add(ns, std::memory_order_relaxed);
+  store_max(c.max_ns, ns);
+}
+
+void EngineStats::add_allocation(size_t bytes) {
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void EngineStats::set_held_bytes(size_t bytes) {
+  held_.store(bytes, std::memory_order_relaxed);
+  raise_peak();
+}
+
+void EngineStats::add_transient(size_t bytes) {
+  transient_.fetch_add(bytes, std::memory_order_relaxed);
+  raise_peak();
+}
+
+void EngineStats::remove_transient(size_t bytes) {
+  transient_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void EngineStats::raise_peak() {
+  store_max(peak_, held_.load(std::memory_order_relaxed) + transient_.load(std::memory_order_relaxed));
+}
+
+StatsSnapshot EngineStats::snapshot() const {
+  StatsSnapshot s;
+  for (int i = 0; i < kStageCount; ++i) {
+    s.stages[i].calls = stages_[i].calls.load(std::memory_order_relaxed);
+    s.stages[i].total_ns = stages_[i].total_ns.load(std::memory_order_relaxed);
+    s.stages[i].max_ns = stages_[i].max_ns.load(std::memory_order_relaxed);
+  }
+  s.allocations = allocations_.load(std::memory_order_relaxed);
+  s.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+  s.resident_bytes = held_.load(std::memory_order_relaxed) + transient_.load(std::memory_order_relaxed);
+  s.peak_bytes = peak_.load(std::memory_order_relaxed);
+  return s;
+}
+
+void EngineStats::reset() {
+  for (StageCounters& c : stages_) {
+    c.calls.store(0, std::memory_order_relaxed);
+    c.total_ns.store(0, std::memory_order_relaxed);
+    c.max_ns.store(0, std::memory_order_relaxed);
+  }
+  allocations_.store(0, std::memory_order_relaxed);
+  allocated_bytes_.store(0, std::memory_order_relaxed);
+  // What is held now stays held; the peak restarts from it.
+  peak_.store(held_.load(std::memory_order_relaxed) + transient_.load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+}
+
+EngineStats& process_stats() {
+  static EngineStats* stats = new EngineStats();  // never destroyed: timers may run at exit
+  return *stats;
+}
+
+StatsScope::StatsScope(EngineStats* stats) : previous_(t_current) {
+  if (stats) t_current = stats;
+}
+
+StatsScope::~StatsScope() { t_current = previous_; }
+
+EngineStats* current_stats() { return t_current; }
+
+void count_allocation(size_t bytes) {
+  process_stats().add_allocation(bytes);
+  if (t_current) t_current->add_allocation(bytes);
+}
+
+StageTimer::StageTimer(Stage stage) : stage_(stage), start_(Clock::now()) {}
+
+StageTimer::~StageTimer() {
+  const auto dur = Clock::now() - start_;
+  const uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count());
+  process_stats().add_stage(stage_, ns);
+  if (t_current) t_current->add_stage(stage_, ns);
+  trace_record(stage_, start_, ns);
+}
+
+TransientBytes::TransientBytes(size_t bytes) : stats_(t_current), bytes_(bytes) {
+  count_allocation(bytes);
+  process_stats().add_transient(bytes);
+  if (stats_) stats_->add_transient(bytes);
+}
+
+TransientBytes::~TransientBytes() {
+  process_stats().remove_transient(bytes_);
+  if (stats_) stats_->remove_transient(bytes_);
+}
+
+void process_memory(uint64_t* working_set, uint64_t* peak_working_set) {
+  uint64_t now = 0, peak = 0;
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc{};
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+    now = static_cast<uint64_t>(pmc.WorkingSetSize);
+    peak = static_cast<uint64_t>(pmc.PeakWorkingSetSize);
+  }
+#else
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    peak = static_cast<uint64_t>(usage.ru_maxrss);  // bytes
+#else
+    peak = static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // KiB
+#endif
+  }
+  if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+    unsigned long long size = 0, resident = 0;
+    if (std::fscanf(f, "%llu %llu", &size, &resident) == 2) {
+      now = static_cast<uint64_t>(resident) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+    std::fclose(f);
+  }
+#endif
+  if (working_set) *working_set = now;
+  if (peak_working_set) *peak_working_set = std::max(peak, now);
+}
+
+std::string stats_to_json(const StatsSnapshot& s) {
+  uint64_t working_set = 0, peak_working_set = 0;
+  process_memory(&working_set, &peak_working_set);
+  std::string json = "{\"stages\":{";
+  char buf[256];
+  for (int i = 0; i < kStageCount; ++i) {
+    const StageTotals& t = s.stages[i];
+    std::snprintf(buf, sizeof(buf), "%s\"%s\":{\"calls\":%" PRIu64 ",\"total_ms\":%.3f,\"max_ms\":%.3f}",
+                  i ? "," : "", stage_name(static_cast<Stage>(i)), t.calls, t.total_ns / 1e6, t.max_ns / 1e6);
+    json += buf;
+  }
+  std::snprintf(buf, sizeof(buf),
+                "},\"allocations\":%" PRIu64 ",\"allocated_bytes\":%" PRIu64 ",\"resident_bytes\":%" PRIu64
+                ",\"peak_bytes\":%" PRIu64 ",\"process_working_set_bytes\":%" PRIu64
+                ",\"process_peak_working_set_bytes\":%" PRIu64 "}",
+                s.allocations, s.allocated_bytes, s.resident_bytes, s.peak_bytes, working_set, peak_working_set);
+  json += buf;
+  return json;
+}
+
+void trace_start(int max_events) {
+  TraceSession& s = trace_session();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.events.clear();
+  s.max_events = static_cast<size_t>(max_events > 0 ? max_events : kDefaultMaxTraceEvents);
+  s.dropped = 0;
+  s.origin = Clock::now();
+  s.active.store(true, std::memory_order_relaxed);
+}
+
+bool trace_active() { return trace_session().active.load(std::memory_order_relaxed); }
+
+bool trace_stop(const char* path) {
+  TraceSession& s = trace_session();
+  std::vector<TraceEvent> events;
+  uint64_t dropped = 0;
+  Clock::time_point origin;
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.active.load(std::memory_order_relaxed)) return false;
+    s.active.store(false, std::memory_order_relaxed);
+    events.swap(s.events);
+    dropped = s.dropped;
+    origin = s.origin;
+  }
+  if (!path) return true;
+
+  // Complete ("X") events in microseconds; one row per engine thread, the handle's stats in args.
+  std::ofstream out(std::filesystem::path(reinterpret_cast<const char8_t*>(path)), std::ios::trunc);
+  if (!out) return false;
+  out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << dropped << "},\"traceEvents\":[";
+  char buf[256];
+  for (size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent& e = events[i];
+    const double ts = std::chrono::duration<double, std::micro>(e.start - origin).count();
+    std::snprintf(buf, sizeof(buf),
+                  "%s\n{\"name\":\"%s\",\"cat\":\"iris\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,"
+                  "\"args\":{\"stats\":\"%p\"}}",
+                  i ? "," : "", stage_name(e.stage), ts, e.dur_ns / 1e3, e.tid, e.stats);
+    out << buf;
+  }
+  out << "\n]}\n";
+  return static_cast<bool>(out);
+}
+
+}  // namespace iris
@@ -0,0 +1,156 @@
+/**
+ * Iris Engine — Stage timers, memory counters and session traces (2026).
+ *
+ * Kernels wrap their stages (decode, colour conversion, Hough, inpaint, CLAHE, warp,
+ * copy-out) in a StageTimer. Each timed stage is added to the process-wide totals and
+ * to the EngineStats bound to the calling thread by a StatsScope. IrisObject and
+ * CommandBuffer::submit bind their handle's stats, so a stage counts toward the handle
+ * it ran for even when the call came through a job or a batch worker. Stages on pool
+ * workers (row bands) are timed on the thread that fans them out.
+ *
+ * Handles also count image-sized allocations and track the bytes they hold: pixels, the
+ * pre-cut alpha and transient stage buffers. The peak of those is reported with the
+ * process working set.
+ *
+ * While a trace is recording, every timed stage is also logged as a Chrome trace event
+ * (chrome://tracing, Perfetto). Timers cost two clock reads and a few relaxed atomics.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_STATS_H
+#define IRIS_ENGINE_IRIS_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace iris {
+
+enum class Stage : int {
+  kDecode = 0,
+  kColorConvert,
+  kHough,
+  kInpaint,
+  kClahe,
+  kWarp,
+  kCopyOut,
+};
+
+constexpr int kStageCount = 7;
+
+/** Stable lower-case name (JSON keys, trace event names). */
+const char* stage_name(Stage stage);
+
+struct StageTotals {
+  uint64_t calls = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+};
+
+struct StatsSnapshot {
+  StageTotals stages[kStageCount];
+  uint64_t allocations = 0;      // image-sized buffers allocated
+  uint64_t allocated_bytes = 0;
+  uint64_t resident_bytes = 0;   // held now (pixels, alpha, in-flight stage buffers)
+  uint64_t peak_bytes = 0;       // high-water mark of resident_bytes
+};
+
+/** Counters of one handle, or of the process. Thread-safe. */
+class EngineStats {
+ public:
+  void add_stage(Stage stage, uint64_t ns);
+  void add_allocation(size_t bytes);
+  /** Bytes held between calls (pixels, alpha); raises the peak. */
+  void set_held_bytes(size_t bytes);
+  /** Stage buffers alive for the duration of a call; raise the peak while held. */
+  void add_transient(size_t bytes);
+  void remove_transient(size_t bytes);
+  StatsSnapshot snapshot() const;
+  void reset();
+
+ private:
+  struct StageCounters {
+    std::atomic<uint64_t> calls{0}, total_ns{0}, max_ns{0};
+  };
+  StageCounters stages_[kStageCount];
+  std::atomic<uint64_t> allocations_{0}, allocated_bytes_{0};
+  std::atomic<uint64_t> held_{0}, transient_{0}, peak_{0};
+
+  void raise_peak();
+};
+
+/** Totals of every stage on every thread, with or without a handle. */
+EngineStats& process_stats();
+
+/** Binds [stats] to the calling thread until destroyed (nests; null keeps the current). */
+class StatsScope {
+ public:
+  explicit StatsScope(EngineStats* stats);
+  ~StatsScope();
+  StatsScope(const StatsScope&) = delete;
+  StatsScope& operator=(const StatsScope&) = delete;
+
+ private:
+  EngineStats* previous_;
+};
+
+/** Stats bound to the calling thread, or null. */
+EngineStats* current_stats();
+
+/** Counts an image-sized allocation for the current handle and the process. */
+void count_allocation(size_t bytes);
+
+/** Times one stage from construction to destruction. */
+class StageTimer {
+ public:
+  explicit StageTimer(Stage stage);
+  ~StageTimer();
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+ private:
+  Stage stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * A stage buffer of [bytes] alive in this scope: counted as an allocation and as
+ * resident for the current handle (and the process) until destroyed.
+ */
+class TransientBytes {
+ public:
+  explicit TransientBytes(size_t bytes);
+  ~TransientBytes();
+  TransientBytes(const TransientBytes&) = delete;
+  TransientBytes& operator=(const TransientBytes&) = delete;
+
+ private:
+  EngineStats* stats_;
+  size_t bytes_;
+};
+
+/** Process working set and its peak in bytes (0 where the platform cannot tell). */
+void process_memory(uint64_t* working_set, uint64_t* peak_working_set);
+
+/** [snapshot] (plus the process memory) as a JSON object. */
+std::string stats_to_json(const StatsSnapshot& snapshot);
+
+/**
+ * Starts recording a trace session, dropping any unsaved one. At most [max_events]
+ * stages are kept (<= 0 = 1M); later ones are counted as dropped.
+ */
+void trace_start(int max_events);
+
+/** True while a session is recording. */
+bool trace_active();
+
+/**
+ * Stops recording and writes the session as Chrome trace-event JSON to [path] (UTF-8);
+ * a null path discards it. Returns false if nothing was recording or the write failed.
+ */
+bool trace_stop(const char* path);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_STATS_H
@@ -0,0 +1,173 @@
+/**
+ * Iris Engine — Work-stealing thread pool implementation.
+ */
+
+#include "iris_thread_pool.h"
+#include <algorithm>
+
+namespace iris {
+
+namespace {
+
+thread_local int t_worker_index = -1;  // index into the pool's queues, -1 off-pool
+
+std::atomic<int> g_default_threads{0};  // 0 = hardware
+
+/** Shared between the caller and helper tasks of one parallel_for_rows call. */
+struct BandState {
+  std::atomic<int> next{0};
+  std::atomic<int> done{0};
+  int num_bands = 0;
+  int band_rows = 0;
+  int rows = 0;
+  const std::function<void(int, int)>* fn = nullptr;
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+void drain_bands(BandState& st) {
+  for (;;) {
+    const int b = st.next.fetch_add(1);
+    if (b >= st.num_bands) return;
+    const int y0 = b * st.band_rows;
+    const int y1 = std::min(st.rows, y0 + st.band_rows);
+    (*st.fn)(y0, y1);
+    if (st.done.fetch_add(1) + 1 == st.num_bands) {
+      std::lock_guard<std::mutex> lock(st.mutex);
+      st.finished.notify_all();
+    }
+  }
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(int num_workers) {
+  const int n = std::max(0, num_workers);
+  queues_.reserve(n);
+  for (int i = 0; i < n; ++i) queues_.push_back(std::make_unique<WorkerQueue>());
+  workers_.reserve(n);
+  for (int i = 0; i < n; ++i) workers_.emplace_back([this, i] { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& t : workers_) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  const int n = num_workers();
+  const int q = t_worker_index >= 0 && t_worker_index < n
+                  ? t_worker_index
+                  : static_cast<int>(next_queue_.fetch_add(1) % static_cast<unsigned>(n));
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    pending_.fetch_add(1);
+  }
+  {
+    std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+    queues_[q]->tasks.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+bool ThreadPool::try_pop(int index, std::function<void()>& task) {
+  const int n = num_workers();
+  {
+    WorkerQueue& own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  for (int k = 1; k < n; ++k) {
+    WorkerQueue& victim = *queues_[(index + k) % n];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::worker_loop(int index) {
+  t_worker_index = index;
+  for (;;) {
+    std::function<void()> task;
+    if (try_pop(index, task)) {
+      pending_.fetch_sub(1);
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait(lock, [this] { return stopping_ || pending_.load() > 0; });
+    if (stopping_ && pending_.load() == 0) return;
+  }
+}
+
+int hardware_thread_count() {
+  const unsigned hw = std::thread::hardware_concurrency();
+  return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+ThreadPool& engine_pool() {
+  // Never destroyed: joining threads from a DLL's static destructors can deadlock
+  // on the Windows loader lock at process exit.
+  static ThreadPool* pool = new ThreadPool(hardware_thread_count() - 1);
+  return *pool;
+}
+
+void set_default_thread_count(int num_threads) {
+  g_default_threads.store(num_threads > 0 ? num_threads : 0);
+}
+
+int default_thread_count() {
+  const int n = g_default_threads.load();
+  return n > 0 ? std::min(n, hardware_thread_count()) : hardware_thread_count();
+}
+
+int resolve_thread_count(int requested) {
+  if (requested <= 0) return default_thread_count();
+  return std::min(requested, hardware_thread_count());
+}
+
+void parallel_for_rows(int rows, int num_threads,
+                       const std::function<void(int, int)>& fn,
+                       int min_band_rows) {
+  if (rows <= 0) return;
+  const int threads = resolve_thread_count(num_threads);
+  // A few bands per thread so stealing can even out uneven rows (e.g. annulus spans).
+  const int band_rows = std::max(std::max(1, min_band_rows), (rows + threads * 4 - 1) / (threads * 4));
+  const int num_bands = (rows + band_rows - 1) / band_rows;
+  if (threads <= 1 || num_bands <= 1) {
+    fn(0, rows);
+    return;
+  }
+
+  auto st = std::make_shared<BandState>();
+  st->num_bands = num_bands;
+  st->band_rows = band_rows;
+  st->rows = rows;
+  st->fn = &fn;
+
+  ThreadPool& pool = engine_pool();
+  const int helpers = std::min({threads - 1, num_bands - 1, pool.num_workers()});
+  for (int i = 0; i < helpers; ++i) pool.submit([st] { drain_bands(*st); });
+  drain_bands(*st);
+
+  std::unique_lock<std::mutex> lock(st->mutex);
+  st->finished.wait(lock, [&st] { return st->done.load() == st->num_bands; });
+}
+
+}  // namespace iris
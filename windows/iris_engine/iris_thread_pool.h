@@ -0,0 +1,81 @@
+/**
+ * Iris Engine — Work-stealing thread pool and row-band parallel loops (2026).
+ *
+ * One pool is owned by the engine and shared by every handle. Kernels split their
+ * row loops into bands with parallel_for_rows(); each band writes disjoint rows, so
+ * output is bit-identical at any thread count.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_THREAD_POOL_H
+#define IRIS_ENGINE_IRIS_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace iris {
+
+/**
+ * Fixed set of workers, one deque each. Workers pop their own deque LIFO and steal
+ * FIFO from the others when idle. Tasks submitted from a worker go to its own deque.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_workers);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void submit(std::function<void()> task);
+  int num_workers() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void worker_loop(int index);
+  bool try_pop(int index, std::function<void()>& task);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> workers_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::atomic<int> pending_{0};
+  std::atomic<unsigned> next_queue_{0};
+  bool stopping_ = false;
+};
+
+/** Engine-owned pool (created on first use, hardware_concurrency - 1 workers). */
+ThreadPool& engine_pool();
+
+/** Hardware thread count (at least 1). */
+int hardware_thread_count();
+
+/** Process-wide default budget used when a handle or call passes 0. <= 0 resets to hardware. */
+void set_default_thread_count(int num_threads);
+int default_thread_count();
+
+/** Effective budget: [requested] if > 0, else the default; never above hardware. */
+int resolve_thread_count(int requested);
+
+/**
+ * Runs fn(y_begin, y_end) over [0, rows) in row bands on the engine pool.
+ * The caller takes bands too and returns once every band is done, so nested calls
+ * from pool workers cannot deadlock. num_threads <= 0 uses the default budget.
+ */
+void parallel_for_rows(int rows, int num_threads,
+                       const std::function<void(int, int)>& fn,
+                       int min_band_rows = 16);
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_THREAD_POOL_H
@@ -0,0 +1,140 @@
+/**
+ * Phase 1: Cut-and-warp remap tables — implementation.
+ * Maps are built with one sqrt per output pixel (no trig) and cached LRU by radii
+ * under a byte budget.
+ */
+
+#include "iris_warp_map.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <utility>
+
+namespace iris {
+
+namespace {
+
+constexpr int kPhaseBits = 5;
+constexpr int kPhases = 1 << kPhaseBits;  // cv::INTER_TAB_SIZE
+constexpr int16_t kOutsideCoord = -16;    // nearest source pixel is off the ROI
+
+std::mutex g_cache_mutex;
+std::list<std::pair<WarpMapKey, std::shared_ptr<const WarpMap>>> g_cache;  // front = most recent
+size_t g_cache_bytes = 0;
+
+inline int32_t quantize(double v) {
+  return static_cast<int32_t>(std::lround(v * WARP_MAP_SUBPIXEL));
+}
+
+std::shared_ptr<const WarpMap> build_warp_map(const WarpMapKey& key) {
+  const double q = 1.0 / WARP_MAP_SUBPIXEL;
+  const double ir = key.iris_r_q * q;
+  const double pr = key.pupil_r_q * q;
+  const double pr_half = PUPIL_SHRINK * pr;
+  const double annulus_src = ir - pr;
+  const double annulus_dst = ir - pr_half;
+  const int side = key.side;
+
+  auto map = std::make_shared<WarpMap>();
+  map->center = side * 0.5;
+  map->offsets.create(side, side, CV_32SC2);
+  for (int k = 0; k < side; ++k) {
+    int32_t* o = map->offsets.ptr<int32_t>(k);
+    const double dy_c = k + 0.5 - map->center;
+    for (int j = 0; j < side; ++j) {
+      const double dx_c = j + 0.5 - map->center;
+      const double r_dst = std::sqrt(dx_c * dx_c + dy_c * dy_c);
+      if (r_dst > ir || r_dst < pr_half || annulus_dst <= 0) {
+        o[2 * j] = kWarpMapOutside;
+        o[2 * j + 1] = 0;
+        continue;
+      }
+      // Map r_dst in [pr_half, ir] -> r_src in [pr, ir]; direction is unchanged.
+      const double t = std::clamp((r_dst - pr_half) / annulus_dst, 0.0, 1.0);
+      const double r_src = pr + t * annulus_src;
+      const double s = r_dst > 1e-12 ? r_src / r_dst : 0.0;
+      o[2 * j] = static_cast<int32_t>(std::lround(dx_c * s * kPhases));
+      o[2 * j + 1] = static_cast<int32_t>(std::lround(dy_c * s * kPhases));
+    }
+  }
+  return map;
+}
+
+}  // namespace
+
+WarpMapKey make_warp_map_key(double iris_r, double pupil_r) {
+  WarpMapKey key;
+  key.iris_r_q = quantize(iris_r);
+  key.pupil_r_q = quantize(pupil_r);
+  // One pixel of slack on each side keeps the whole disc inside the map wherever the
+  // destination grid snaps.
+  key.side = static_cast<int32_t>(std::ceil(2.0 * key.iris_r_q / WARP_MAP_SUBPIXEL)) + 2;
+  return key;
+}
+
+std::shared_ptr<const WarpMap> acquire_warp_map(const WarpMapKey& key) {
+  {
+    std::lock_guard<std::mutex> lock(g_cache_mutex);
+    for (auto it = g_cache.begin(); it != g_cache.end(); ++it) {
+      if (it->first == key) {
+        g_cache.splice(g_cache.begin(), g_cache, it);
+        return g_cache.front().second;
+      }
+    }
+  }
+  // Build outside the lock; a concurrent miss on the same key just builds twice.
+  std::shared_ptr<const WarpMap> map = build_warp_map(key);
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  g_cache.emplace_front(key, map);
+  g_cache_bytes += map->bytes();
+  while (g_cache.size() > 1 && g_cache_bytes > kWarpMapCacheBytes) {
+    g_cache_bytes -= g_cache.back().second->bytes();
+    g_cache.pop_back();
+  }
+  return map;
+}
+
+WarpPlacement place_warp_map(const WarpMap& map, double dst_cx, double dst_cy,
+                             double roi_cx, double roi_cy, int roi_w, int roi_h) {
+  WarpPlacement at;
+  at.map_x0 = static_cast<int>(std::lround(map.center - dst_cx));
+  at.map_y0 = static_cast<int>(std::lround(map.center - dst_cy));
+  at.center_x_q = std::llround(roi_cx * kPhases);
+  at.center_y_q = std::llround(roi_cy * kPhases);
+  at.roi_w = roi_w;
+  at.roi_h = roi_h;
+  return at;
+}
+
+void warp_map_row(const WarpMap& map, const WarpPlacement& at, int y, int width,
+                  int16_t* xy, uint16_t* frac) {
+  const int k = at.map_y0 + y;
+  const int32_t* o = (k >= 0 && k < map.offsets.rows) ? map.offsets.ptr<int32_t>(k) : nullptr;
+  // Clamp like the old edge-replicating sampler.
+  const int64_t max_x = static_cast<int64_t>(at.roi_w - 1) * kPhases;
+  const int64_t max_y = static_cast<int64_t>(at.roi_h - 1) * kPhases;
+  for (int x = 0; x < width; ++x) {
+    const int j = at.map_x0 + x;
+    if (!o || j < 0 || j >= map.offsets.cols || o[2 * j] == kWarpMapOutside) {
+      xy[2 * x] = kOutsideCoord;
+      xy[2 * x + 1] = kOutsideCoord;
+      frac[x] = 0;
+      continue;
+    }
+    const int64_t sx = std::clamp<int64_t>(at.center_x_q + o[2 * j], 0, max_x);
+    const int64_t sy = std::clamp<int64_t>(at.center_y_q + o[2 * j + 1], 0, max_y);
+    xy[2 * x] = static_cast<int16_t>(sx >> kPhaseBits);
+    xy[2 * x + 1] = static_cast<int16_t>(sy >> kPhaseBits);
+    frac[x] = static_cast<uint16_t>(((sy & (kPhases - 1)) << kPhaseBits) | (sx & (kPhases - 1)));
+  }
+}
+
+void clear_warp_map_cache() {
+  std::lock_guard<std::mutex> lock(g_cache_mutex);
+  g_cache.clear();
+  g_cache_bytes = 0;
+}
+
+}  // namespace iris
@@ -0,0 +1,96 @@
+/**
+ * Phase 1: Cut-and-warp remap tables (2026).
+ * Destination→source offset maps for the radial pupil-shrink warp, built once per
+ * (iris radius, pupil radius) and kept in a byte-capped process-wide cache. The maps
+ * are relative to the iris center, so dragging a circle reuses the same map: only the
+ * per-row placement (integer + fractional center offset, ROI clamp) runs per cut.
+ * Requires OpenCV.
+ */
+
+#ifndef IRIS_ENGINE_IRIS_WARP_MAP_H
+#define IRIS_ENGINE_IRIS_WARP_MAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include <opencv2/core.hpp>
+
+namespace iris {
+
+constexpr double PUPIL_SHRINK = 0.5;  // final pupil = 50% of original
+
+/** Sub-pixel quantization of cached radii: 1/64 px. */
+constexpr int WARP_MAP_SUBPIXEL = 64;
+
+/** Process-wide budget for cached maps; the most recent map is kept even when larger. */
+constexpr size_t kWarpMapCacheBytes = size_t{128} << 20;
+
+/** Warp geometry independent of where the circle sits: radii quantized to 1/WARP_MAP_SUBPIXEL px. */
+struct WarpMapKey {
+  int32_t iris_r_q;
+  int32_t pupil_r_q;
+  int32_t side;  // map is side x side, centered on the iris
+
+  bool operator==(const WarpMapKey& o) const {
+    return iris_r_q == o.iris_r_q && pupil_r_q == o.pupil_r_q && side == o.side;
+  }
+};
+
+/**
+ * Center-relative remap table. offsets (CV_32SC2) holds, for map pixel (j, k) at
+ * (j + 0.5 - center, k + 0.5 - center) from the iris center, the source position minus
+ * the iris center in 1/32 px (cv::INTER_TAB_SIZE). Pixels outside the annulus hold
+ * kWarpMapOutside in x.
+ */
+struct WarpMap {
+  cv::Mat offsets;
+  double center = 0;
+
+  size_t bytes() const { return offsets.total() * offsets.elemSize(); }
+};
+
+constexpr int32_t kWarpMapOutside = INT32_MIN;
+
+/** Where a map lands for one cut; see place_warp_map. */
+struct WarpPlacement {
+  int map_x0 = 0;          // map column under destination column 0
+  int map_y0 = 0;
+  int64_t center_x_q = 0;  // iris center in source ROI px, 1/32 px
+  int64_t center_y_q = 0;
+  int roi_w = 0;           // samples are clamped to the ROI
+  int roi_h = 0;
+};
+
+/** Quantizes the radii into a cache key (side follows from the iris radius). */
+WarpMapKey make_warp_map_key(double iris_r, double pupil_r);
+
+/**
+ * Returns the remap table for [key], building it on a cache miss.
+ * Thread-safe; the returned map stays valid after eviction.
+ */
+std::shared_ptr<const WarpMap> acquire_warp_map(const WarpMapKey& key);
+
+/**
+ * Places [map] for a cut: the iris center sits at (dst_cx, dst_cy) in destination pixels
+ * and at (roi_cx, roi_cy) in the roi_w x roi_h source ROI. The destination grid snaps to
+ * the nearest map pixel (output shifts by at most half a pixel); the source side keeps
+ * the full sub-pixel center.
+ */
+WarpPlacement place_warp_map(const WarpMap& map, double dst_cx, double dst_cy,
+                             double roi_cx, double roi_cy, int roi_w, int roi_h);
+
+/**
+ * Destination row [y] of [width] pixels in the remap_rows layout (iris_sampler.h):
+ * xy = integer ROI position pairs, frac = 5-bit y/x phase. Pixels outside the annulus
+ * or the map point off the ROI so the gather writes them transparent.
+ */
+void warp_map_row(const WarpMap& map, const WarpPlacement& at, int y, int width,
+                  int16_t* xy, uint16_t* frac);
+
+/** Drops all cached maps. */
+void clear_warp_map_cache();
+
+}  // namespace iris
+
+#endif  // IRIS_ENGINE_IRIS_WARP_MAP_H